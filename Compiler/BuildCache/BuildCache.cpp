@@ -0,0 +1,308 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "BuildCache.h"
+#include <algorithm>
+#include <utility>
+#include "../Common/FileIO.h"
+
+namespace nand2tetris::jack {
+
+    namespace {
+        // Bump whenever the layout below changes.
+        constexpr std::string_view MAGIC = "JACKCACHE";
+        constexpr std::uint32_t FORMAT_VERSION = 6;
+
+        // --- Encoding: little-endian integers, strings as a 32-bit length followed by the bytes ---
+
+        class Writer {
+            public:
+                void u8(const std::uint8_t v) { out.push_back(static_cast<char>(v)); }
+
+                void u32(const std::uint32_t v) {
+                    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+                }
+
+                void u64(const std::uint64_t v) {
+                    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+                }
+
+                void str(const std::string_view s) {
+                    u32(static_cast<std::uint32_t>(s.size()));
+                    out.append(s);
+                }
+
+                const std::string& bytes() const { return out; }
+
+            private:
+                std::string out;
+        };
+
+        /// Thrown by Reader when the data runs out or does not make sense.
+        struct Corrupt {};
+
+        class Reader {
+            public:
+                explicit Reader(const std::string_view data) : data(data) {}
+
+                std::uint8_t u8() {
+                    need(1);
+                    return static_cast<std::uint8_t>(data[pos++]);
+                }
+
+                std::uint32_t u32() {
+                    need(4);
+                    std::uint32_t v = 0;
+                    for (int i = 0; i < 4; ++i) v |= static_cast<std::uint32_t>(static_cast<unsigned char>(data[pos++])) << (8 * i);
+                    return v;
+                }
+
+                std::uint64_t u64() {
+                    need(8);
+                    std::uint64_t v = 0;
+                    for (int i = 0; i < 8; ++i) v |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[pos++])) << (8 * i);
+                    return v;
+                }
+
+                std::string str() {
+                    const std::uint32_t n = u32();
+                    need(n);
+                    std::string s(data.substr(pos, n));
+                    pos += n;
+                    return s;
+                }
+
+                /// Reads an element count, rejecting values that could not possibly fit in the rest of the data.
+                std::uint32_t count() {
+                    const std::uint32_t n = u32();
+                    if (n > data.size() - pos) throw Corrupt{};
+                    return n;
+                }
+
+                bool atEnd() const { return pos == data.size(); }
+
+            private:
+                std::string_view data;
+                std::size_t pos = 0;
+
+                void need(const std::size_t n) const {
+                    if (n > data.size() - pos) throw Corrupt{};
+                }
+        };
+
+        void writeInlineBody(Writer& w, const InlineBody& body) {
+            w.u8(body.argCount);
+            w.u8(body.localCount);
+            w.u8(body.labelCount);
+            w.u8((body.isMethod ? 1 : 0) | (body.usesStatics ? 2 : 0));
+            w.u32(static_cast<std::uint32_t>(body.code.size()));
+            for (const VMInstruction& in : body.code) {
+                w.u8(static_cast<std::uint8_t>(in.op));
+                w.u8(static_cast<std::uint8_t>(in.segment));
+                w.u8(static_cast<std::uint8_t>(in.command));
+                w.u32(static_cast<std::uint32_t>(in.value));
+                w.u32(in.symbol);
+            }
+        }
+
+        // The body is expanded without further checks, so anything it could not have been written as is corrupt.
+        InlineBody readInlineBody(Reader& r) {
+            InlineBody body;
+            body.argCount = r.u8();
+            body.localCount = r.u8();
+            body.labelCount = r.u8();
+            const std::uint8_t flags = r.u8();
+            body.isMethod = (flags & 1) != 0;
+            body.usesStatics = (flags & 2) != 0;
+            if (body.argCount + body.localCount > InlineTable::MAX_SLOTS) throw Corrupt{};
+            body.code.resize(r.count());
+            for (VMInstruction& in : body.code) {
+                const std::uint8_t op = r.u8();
+                const std::uint8_t segment = r.u8();
+                const std::uint8_t command = r.u8();
+                in.value = static_cast<std::int32_t>(r.u32());
+                in.symbol = r.u32();
+                if (op > static_cast<std::uint8_t>(VMOp::IF_GOTO) || segment > static_cast<std::uint8_t>(Segment::TEMP) ||
+                    command > static_cast<std::uint8_t>(Command::NOT)) {
+                    throw Corrupt{};
+                }
+                in.op = static_cast<VMOp>(op);
+                in.segment = static_cast<Segment>(segment);
+                in.command = static_cast<Command>(command);
+                if ((in.is(VMOp::LABEL) || in.is(VMOp::GOTO) || in.is(VMOp::IF_GOTO)) && in.symbol >= body.labelCount) throw Corrupt{};
+            }
+            return body;
+        }
+
+        void writeEntry(Writer& w, const CacheEntry& e) {
+            w.str(e.sourcePath);
+            w.u64(e.sourceSize);
+            w.u64(static_cast<std::uint64_t>(e.sourceTime));
+            w.u64(e.sourceHash);
+
+            w.str(e.className);
+            w.u32(e.classOffset);
+            w.u32(static_cast<std::uint32_t>(e.methods.size()));
+            for (const CachedMethod& m : e.methods) {
+                w.str(m.name);
+                w.str(m.returnType);
+                w.u32(static_cast<std::uint32_t>(m.parameters.size()));
+                for (const std::string& p : m.parameters) w.str(p);
+                w.u8(m.isStatic ? 1 : 0);
+                w.u32(m.offset);
+            }
+            w.u32(static_cast<std::uint32_t>(e.calls.size()));
+            for (const CachedCalls& c : e.calls) {
+                w.str(c.subroutine);
+                w.u32(static_cast<std::uint32_t>(c.callees.size()));
+                for (const auto& [className, subroutine] : c.callees) {
+                    w.str(className);
+                    w.str(subroutine);
+                }
+            }
+
+            w.u32(static_cast<std::uint32_t>(e.dependencies.size()));
+            for (const CachedDependency& d : e.dependencies) {
+                w.str(d.className);
+                w.u64(d.fingerprint);
+            }
+            w.str(e.vmCode);
+            w.u32(static_cast<std::uint32_t>(e.pooledStrings.size()));
+            for (const std::string& s : e.pooledStrings) w.str(s);
+            w.u32(e.declaredStatics);
+            w.u32(e.poolableLiterals);
+            w.u32(e.poolLimit);
+            w.u32(static_cast<std::uint32_t>(e.removed.size()));
+            for (const std::string& s : e.removed) w.str(s);
+            w.u32(static_cast<std::uint32_t>(e.inlineBodies.size()));
+            for (const CachedInline& i : e.inlineBodies) {
+                w.str(i.subroutine);
+                writeInlineBody(w, i.body);
+            }
+        }
+
+        CacheEntry readEntry(Reader& r) {
+            CacheEntry e;
+            e.sourcePath = r.str();
+            e.sourceSize = r.u64();
+            e.sourceTime = static_cast<std::int64_t>(r.u64());
+            e.sourceHash = r.u64();
+
+            e.className = r.str();
+            e.classOffset = r.u32();
+            e.methods.resize(r.count());
+            for (CachedMethod& m : e.methods) {
+                m.name = r.str();
+                m.returnType = r.str();
+                m.parameters.resize(r.count());
+                for (std::string& p : m.parameters) p = r.str();
+                m.isStatic = r.u8() != 0;
+                m.offset = r.u32();
+            }
+            e.calls.resize(r.count());
+            for (CachedCalls& c : e.calls) {
+                c.subroutine = r.str();
+                c.callees.resize(r.count());
+                for (auto& [className, subroutine] : c.callees) {
+                    className = r.str();
+                    subroutine = r.str();
+                }
+            }
+
+            e.dependencies.resize(r.count());
+            for (CachedDependency& d : e.dependencies) {
+                d.className = r.str();
+                d.fingerprint = r.u64();
+            }
+            e.vmCode = r.str();
+            e.pooledStrings.resize(r.count());
+            for (std::string& s : e.pooledStrings) s = r.str();
+            e.declaredStatics = r.u32();
+            e.poolableLiterals = r.u32();
+            e.poolLimit = r.u32();
+            e.removed.resize(r.count());
+            for (std::string& s : e.removed) s = r.str();
+            e.inlineBodies.resize(r.count());
+            for (CachedInline& i : e.inlineBodies) {
+                i.subroutine = r.str();
+                i.body = readInlineBody(r);
+            }
+            return e;
+        }
+
+        // "dir/./Main.jack" and "dir/Main.jack" are the same file.
+        std::string keyFor(const std::string& sourcePath) {
+            return std::filesystem::path(sourcePath).lexically_normal().string();
+        }
+    }
+
+    BuildCache::BuildCache(std::filesystem::path file, std::string configKey)
+        : file(std::move(file)), configKey(std::move(configKey)) {}
+
+    void BuildCache::load() {
+        entries.clear();
+        const std::optional<std::string> data = readFile(file);
+        if (!data) return;
+
+        try {
+            Reader r(*data);
+            if (r.str() != MAGIC || r.u32() != FORMAT_VERSION || r.str() != configKey) return;
+
+            const std::uint32_t n = r.count();
+            std::unordered_map<std::string, CacheEntry> loaded;
+            loaded.reserve(n);
+            for (std::uint32_t i = 0; i < n; ++i) {
+                CacheEntry e = readEntry(r);
+                std::string key = keyFor(e.sourcePath);
+                loaded.emplace(std::move(key), std::move(e));
+            }
+            if (!r.atEnd()) return;
+            entries = std::move(loaded);
+        } catch (const Corrupt&) {
+            // Fall through with an empty cache: everything gets rebuilt and the file rewritten.
+        }
+    }
+
+    const CacheEntry* BuildCache::find(const std::string& sourcePath) const {
+        const auto it = entries.find(keyFor(sourcePath));
+        return it == entries.end() ? nullptr : &it->second;
+    }
+
+    void BuildCache::replace(std::vector<CacheEntry> newEntries) {
+        entries.clear();
+        entries.reserve(newEntries.size());
+        for (CacheEntry& e : newEntries) {
+            std::string key = keyFor(e.sourcePath);
+            entries.insert_or_assign(std::move(key), std::move(e));
+        }
+    }
+
+    void BuildCache::save() const {
+        // Sorted by path, so the same build always writes the same file.
+        std::vector<const CacheEntry*> sorted;
+        sorted.reserve(entries.size());
+        for (const auto& [key, e] : entries) sorted.push_back(&e);
+        std::sort(sorted.begin(), sorted.end(), [](const CacheEntry* a, const CacheEntry* b) {
+            return a->sourcePath < b->sourcePath;
+        });
+
+        Writer w;
+        w.str(MAGIC);
+        w.u32(FORMAT_VERSION);
+        w.str(configKey);
+        w.u32(static_cast<std::uint32_t>(sorted.size()));
+        for (const CacheEntry* e : sorted) writeEntry(w, *e);
+        writeFileAtomically(file, w.bytes());
+    }
+
+    std::optional<SourceStamp> BuildCache::stamp(const std::filesystem::path& path) {
+        std::error_code ec;
+        const std::uintmax_t size = std::filesystem::file_size(path, ec);
+        if (ec) return std::nullopt;
+        const auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) return std::nullopt;
+        return SourceStamp{static_cast<std::uint64_t>(size),
+                           static_cast<std::int64_t>(time.time_since_epoch().count())};
+    }
+}
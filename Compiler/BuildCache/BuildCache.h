@@ -0,0 +1,150 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_BUILD_CACHE_H
+#define NAND2TETRIS_BUILD_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../CodeGenerator/Inliner.h"
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief A subroutine signature as stored in the cache (by name: NameIds do not survive the process).
+     */
+    struct CachedMethod {
+        std::string name;
+        std::string returnType;
+        std::vector<std::string> parameters;
+        bool isStatic = false;
+        std::uint32_t offset = 0; ///< Byte offset of the declaration.
+    };
+
+    /**
+     * @brief What one subroutine of a cached class calls, as (class, subroutine) names.
+     */
+    struct CachedCalls {
+        std::string subroutine;
+        std::vector<std::pair<std::string, std::string>> callees;
+    };
+
+    /**
+     * @brief A subroutine of a cached class that other classes inline (--inline).
+     */
+    struct CachedInline {
+        std::string subroutine;
+        InlineBody body;
+    };
+
+    /**
+     * @brief Another class a cached file relied on, and what the registry said about it at the time.
+     */
+    struct CachedDependency {
+        std::string className;
+        std::uint64_t fingerprint = 0; ///< GlobalRegistry::fingerprint() of that class.
+    };
+
+    /**
+     * @brief Everything the compiler remembers about one successfully compiled .jack file.
+     */
+    struct CacheEntry {
+        std::string sourcePath;         ///< Absolute path of the .jack file.
+        std::uint64_t sourceSize = 0;   ///< File size when it was compiled.
+        std::int64_t sourceTime = 0;    ///< Modification time when it was compiled.
+        std::uint64_t sourceHash = 0;   ///< fnv1a of the file contents.
+
+        std::string className;
+        std::uint32_t classOffset = 0;  ///< Byte offset of the class declaration.
+        std::vector<CachedMethod> methods;  ///< The signatures the class exports.
+        std::vector<CachedCalls> calls;     ///< Its part of the call graph, for --dce.
+
+        std::vector<CachedDependency> dependencies;
+        std::string vmCode;             ///< The generated .vm file.
+        std::vector<std::string> pooledStrings; ///< Literals the class takes from the StringPool.
+        std::uint32_t declaredStatics = 0;  ///< Statics the class declares, for the static segment's budget.
+        std::uint32_t poolableLiterals = 0; ///< Distinct literals it would pool, capped at StringPool::MAX_PER_CLASS.
+        std::uint32_t poolLimit = 0;        ///< The per-class pooling limit vmCode was generated with.
+        std::vector<std::string> removed; ///< Subroutines left out of vmCode as unreachable (--dce).
+        std::vector<CachedInline> inlineBodies; ///< Its subroutines small enough to inline (--inline).
+    };
+
+    /**
+     * @brief Size and modification time of a file: cheap to read, and enough to notice nearly every edit.
+     */
+    struct SourceStamp {
+        std::uint64_t size = 0;
+        std::int64_t time = 0;
+
+        bool operator==(const SourceStamp& other) const { return size == other.size && time == other.time; }
+    };
+
+    /**
+     * @brief Persistent record of the previous build, used to skip files that cannot have changed.
+     *
+     * A file is up to date when its source is unchanged and every class it depends on still has the same
+     * fingerprint; its signatures and .vm code are then taken from the cache instead of being rebuilt.
+     *
+     * The cache is only an optimisation. A missing, unreadable, corrupt or outdated cache file (including
+     * one written with different compiler settings) is treated as empty and simply overwritten.
+     */
+    class BuildCache {
+        public:
+            /**
+             * @param file Where the cache lives (normally next to Main.jack).
+             * @param configKey Describes the compiler settings; a cache written under another key is ignored.
+             */
+            BuildCache(std::filesystem::path file, std::string configKey);
+
+            /**
+             * @brief Reads the cache file, if there is a usable one.
+             */
+            void load();
+
+            /**
+             * @brief Looks up the entry recorded for a source file.
+             *
+             * @return The entry, or nullptr if the file was not part of the previous build.
+             */
+            const CacheEntry* find(const std::string& sourcePath) const;
+
+            /**
+             * @brief Makes `entries` what find() returns; anything not listed is forgotten.
+             *
+             * Only changes the cache in memory, so a long-running compiler (--daemon) can keep it
+             * between builds and write it out with save() only when a build changed it.
+             */
+            void replace(std::vector<CacheEntry> entries);
+
+            /**
+             * @brief Replaces the cache file with the entries held in memory.
+             *
+             * @throws std::runtime_error If the file cannot be written.
+             */
+            void save() const;
+
+            /**
+             * @brief Number of entries loaded.
+             */
+            std::size_t size() const { return entries.size(); }
+
+            /**
+             * @brief Reads the size and modification time of a file.
+             */
+            static std::optional<SourceStamp> stamp(const std::filesystem::path& path);
+
+        private:
+            std::filesystem::path file;
+            std::string configKey;
+            std::unordered_map<std::string, CacheEntry> entries; ///< Keyed by normalised source path.
+    };
+}
+
+#endif //NAND2TETRIS_BUILD_CACHE_H
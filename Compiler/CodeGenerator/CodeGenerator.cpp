@@ -3,38 +3,257 @@
 //
 
 #include "CodeGenerator.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include "StringPool.h"
+#include "../SemanticAnalyser/StandardLibrary.h"
 
 namespace nand2tetris::jack {
-    CodeGenerator::CodeGenerator(const GlobalRegistry &registry, std::ostream &out,SymbolTable& table):registry
-    (registry),writer(out),symbolTable(table){}
+    namespace {
+        /// The VM segment a variable of the given kind lives in.
+        Segment segmentOf(const SymbolKind kind) {
+            switch (kind) {
+                case SymbolKind::STATIC: return Segment::STATIC;
+                case SymbolKind::FIELD:  return Segment::THIS;
+                case SymbolKind::ARG:    return Segment::ARG;
+                case SymbolKind::LCL:    return Segment::LOCAL;
+                default:                 return Segment::TEMP; // Unreachable after semantic analysis
+            }
+        }
+    }
+
+    CodeGenerator::CodeGenerator(const GlobalRegistry &registry, VMWriter &writer, const bool poolStrings,
+                                 const std::size_t poolLimit, const CallGraph* reachable, const InlineTable* inliner):registry
+    (registry),writer(writer),reachable(reachable),inliner(inliner),poolStrings(poolStrings),poolLimit(poolLimit){}
+
+    CodeGenerator::CodeGenerator(const CodeGenerator& context, VMWriter& writer) : registry(context.registry),
+        writer(writer), currentClassName(context.currentClassName), fieldCount(context.fieldCount),
+        reachable(context.reachable), inliner(context.inliner), poolStrings(context.poolStrings), poolLimit(context.poolLimit),
+        poolingClass(context.poolingClass), poolBase(context.poolBase), pooled(context.pooled) {}
 
     std::string CodeGenerator::getUniqueLabel() {
         return "L" + std::to_string(labelCounter++);
     }
 
     void CodeGenerator::compileClass(const ClassNode &node) {
-        currentClassName=node.getClassName();
+        beginClass(node);
 
         // Compile Subroutines
         for (const auto& sub : node.subroutineDecs) {
-            compileSubroutine(*sub);
+            if (emits(*sub)) compileSubroutine(*sub);
+        }
+
+        endClass();
+    }
+
+    void CodeGenerator::beginClass(const ClassNode& node) {
+        currentClassName=node.getClassName();
+        fieldCount = node.fieldCount;
+
+        // OS classes compiled from source may run before Main.main fills the pool.
+        poolingClass = poolStrings && !isBuiltinClass(currentClassName);
+        poolBase = node.staticCount;
+        pooled.clear();
+        if (poolingClass) {
+            for (const auto& sub : node.subroutineDecs) {
+                if (emits(*sub)) poolStatements(sub->statements);
+            }
+        }
+    }
+
+    bool CodeGenerator::emits(const SubroutineDecNode& node) const {
+        return !reachable || reachable->isReachable(currentClassName, node.name);
+    }
+
+    void CodeGenerator::endClass() {
+        if (!pooled.empty()) compileStringSetter();
+    }
+
+    void CodeGenerator::appendSubroutine(const CodeGenerator& fragment) {
+        const VMCode& from = fragment.writer.code();
+        VMCode& into = writer.code();
+        std::vector<std::uint32_t> symbols(from.symbolCount(), UINT32_MAX);
+        for (VMInstruction instruction : from.instructions) {
+            if (instruction.is(VMOp::LABEL) || instruction.is(VMOp::GOTO) || instruction.is(VMOp::IF_GOTO)) {
+                // Every label comes from getUniqueLabel(): "L" and a number counted from 0 in the fragment.
+                std::uint32_t& symbol = symbols[instruction.symbol];
+                if (symbol == UINT32_MAX) {
+                    const std::string_view text = from.symbolText(instruction.symbol);
+                    const int number = std::stoi(std::string(text.substr(1)));
+                    symbol = into.symbol("L" + std::to_string(labelCounter + number));
+                }
+                instruction.symbol = symbol;
+            } else if (instruction.is(VMOp::CALL) || instruction.is(VMOp::FUNCTION)) {
+                std::uint32_t& symbol = symbols[instruction.symbol];
+                if (symbol == UINT32_MAX) symbol = into.symbol(from.symbolText(instruction.symbol));
+                instruction.symbol = symbol;
+            }
+            into.instructions.push_back(instruction);
         }
+        labelCounter += fragment.labelCounter;
+        inlined.insert(inlined.end(), fragment.inlined.begin(), fragment.inlined.end());
+    }
+
+    std::optional<InlineBody> CodeGenerator::inlineBodyOf(const SubroutineDecNode& node) const {
+        if (node.subType == SubroutineType::CONSTRUCTOR) return std::nullopt;
+        const bool isMethod = node.subType == SubroutineType::METHOD;
+        const int argCount = static_cast<int>(node.parameters.size()) + (isMethod ? 1 : 0);
+        if (argCount + node.localCount > InlineTable::MAX_SLOTS) return std::nullopt;
+
+        VMWriter fragmentWriter(32);
+        CodeGenerator fragment(*this, fragmentWriter);
+        fragment.inliner = nullptr; // The body as written: a body to inline never contains a call anyway.
+        fragment.compileSubroutine(node);
+        const std::vector<VMInstruction>& code = fragmentWriter.code().instructions;
+
+        // Skip the function header and, for a method, `push argument 0` / `pop pointer 0`.
+        const std::size_t begin = isMethod ? 3 : 1;
+        if (code.size() <= begin || !code.back().is(VMOp::RETURN) || code.size() - begin - 1 > InlineTable::MAX_INSTRUCTIONS) {
+            return std::nullopt;
+        }
+
+        InlineBody body;
+        body.argCount = static_cast<std::uint8_t>(argCount);
+        body.localCount = static_cast<std::uint8_t>(node.localCount);
+        body.isMethod = isMethod;
+        std::vector<std::uint32_t> labels; // Symbol of each label, by its number in the body.
+        bool returnsEarly = false;
+        for (std::size_t i = begin; i + 1 < code.size(); ++i) {
+            VMInstruction in = code[i];
+            switch (in.op) {
+                case VMOp::CALL:
+                case VMOp::FUNCTION:
+                    return std::nullopt;
+                case VMOp::PUSH:
+                case VMOp::POP:
+                    // `this` itself can only be read, through the receiver, and only in a method.
+                    if (in.segment == Segment::POINTER && in.value == 0 && (in.op == VMOp::POP || !isMethod)) return std::nullopt;
+                    if (in.segment == Segment::STATIC) body.usesStatics = true;
+                    break;
+                case VMOp::LABEL:
+                case VMOp::GOTO:
+                case VMOp::IF_GOTO: {
+                    const auto it = std::find(labels.begin(), labels.end(), in.symbol);
+                    in.symbol = static_cast<std::uint32_t>(it - labels.begin());
+                    if (it == labels.end()) labels.push_back(code[i].symbol);
+                    break;
+                }
+                case VMOp::RETURN:
+                    returnsEarly = true; // Becomes a jump to the end, once the end has a label number.
+                    break;
+                case VMOp::ARITHMETIC:
+                    break;
+            }
+            body.code.push_back(in);
+        }
+        if (returnsEarly) {
+            const auto end = static_cast<std::uint32_t>(labels.size());
+            for (VMInstruction& in : body.code) {
+                if (in.is(VMOp::RETURN)) in = {VMOp::GOTO, Segment::CONST, Command::ADD, 0, end};
+            }
+            body.code.push_back({VMOp::LABEL, Segment::CONST, Command::ADD, 0, end});
+            labels.push_back(UINT32_MAX);
+        }
+        body.labelCount = static_cast<std::uint8_t>(labels.size());
+        return body;
+    }
+
+    int CodeGenerator::pooledSlot(const std::string_view literal) const {
+        if (!poolingClass) return -1;
+        const auto it = std::find(pooled.begin(), pooled.end(), literal);
+        if (it == pooled.end()) return -1;
+        return poolBase + static_cast<int>(it - pooled.begin());
+    }
+
+    void CodeGenerator::poolStatements(const NodeList<StatementNode>& stmts) {
+        for (const StatementNode* stmt : stmts) {
+            switch (stmt->getType()) {
+                case ASTNodeType::LET_STATEMENT: {
+                    auto& n = static_cast<const LetStatementNode&>(*stmt); // NOLINT(*-pro-type-static-cast-downcast)
+                    poolExpression(n.indexExpr);
+                    poolExpression(n.valueExpr);
+                    break;
+                }
+                case ASTNodeType::IF_STATEMENT: {
+                    auto& n = static_cast<const IfStatementNode&>(*stmt); // NOLINT(*-pro-type-static-cast-downcast)
+                    poolExpression(n.condition);
+                    poolStatements(n.ifStatements);
+                    poolStatements(n.elseStatements);
+                    break;
+                }
+                case ASTNodeType::WHILE_STATEMENT: {
+                    auto& n = static_cast<const WhileStatementNode&>(*stmt); // NOLINT(*-pro-type-static-cast-downcast)
+                    poolExpression(n.condition);
+                    poolStatements(n.body);
+                    break;
+                }
+                case ASTNodeType::DO_STATEMENT:
+                    poolExpression(static_cast<const DoStatementNode&>(*stmt).callExpression); // NOLINT(*-pro-type-static-cast-downcast)
+                    break;
+                case ASTNodeType::RETURN_STATEMENT:
+                    poolExpression(static_cast<const ReturnStatementNode&>(*stmt).expression); // NOLINT(*-pro-type-static-cast-downcast)
+                    break;
+                default: break;
+            }
+        }
+    }
+
+    void CodeGenerator::poolExpression(const ExpressionNode* node) {
+        if (!node || pooled.size() >= poolLimit) return;
+        switch (node->getType()) {
+            case ASTNodeType::STRING_LITERAL: {
+                const std::string_view literal = static_cast<const StringLiteralNode*>(node)->value; // NOLINT(*-pro-type-static-cast-downcast)
+                if (std::find(pooled.begin(), pooled.end(), literal) == pooled.end()) pooled.push_back(literal);
+                break;
+            }
+            case ASTNodeType::BINARY_OP: {
+                auto* n = static_cast<const BinaryOpNode*>(node); // NOLINT(*-pro-type-static-cast-downcast)
+                poolExpression(n->left);
+                poolExpression(n->right);
+                break;
+            }
+            case ASTNodeType::UNARY_OP:
+                poolExpression(static_cast<const UnaryOpNode*>(node)->term); // NOLINT(*-pro-type-static-cast-downcast)
+                break;
+            case ASTNodeType::IDENTIFIER:
+                poolExpression(static_cast<const IdentifierNode*>(node)->indexExpr); // NOLINT(*-pro-type-static-cast-downcast)
+                break;
+            case ASTNodeType::SUBROUTINE_CALL:
+                for (const ExpressionNode* arg : static_cast<const CallNode*>(node)->arguments) poolExpression(arg); // NOLINT(*-pro-type-static-cast-downcast)
+                break;
+            default: break;
+        }
+    }
+
+    void CodeGenerator::compileStringSetter() {
+        writer.writeFunction(nameOf(currentClassName), StringPool::SETTER, 0);
+        for (std::size_t i = 0; i < pooled.size(); ++i) {
+            writer.writePush(Segment::ARG, static_cast<int>(i));
+            writer.writePop(Segment::STATIC, poolBase + static_cast<int>(i));
+        }
+        writer.writePush(Segment::CONST, 0);
+        writer.writeReturn();
     }
 
     void CodeGenerator::compileSubroutine(const SubroutineDecNode& node) {
-        symbolTable.startSubroutineFromHistory(node.name);
+        currentSubroutine = node.name;
 
         // Write Function Declaration
-        const std::string funcName=std::string(currentClassName) + "." + std::string(node.name);
-        const int nLocals = symbolTable.varCount(SymbolKind::LCL);
-        writer.writeFunction(funcName, nLocals);
+        writer.writeFunction(nameOf(currentClassName), nameOf(node.name), node.localCount);
+
+        // The program starts here, so this is where the string pool gets built.
+        if (poolStrings && currentClassName == Interner::seeded("Main") && node.name == Interner::seeded("main") &&
+            node.subType == SubroutineType::FUNCTION) {
+            writer.writeCall(StringPool::INIT_FUNCTION, 0);
+            writer.writePop(Segment::TEMP, 0);
+        }
 
         // Handle Constructor/Method specific setup
         if (node.subType == SubroutineType::CONSTRUCTOR) {
             // Constructor: allocate memory for instance
             // Size = number of fields in the class
-            const int nFields = symbolTable.varCount(SymbolKind::FIELD);
-            writer.writePush(Segment::CONST, nFields);
+            writer.writePush(Segment::CONST, fieldCount);
             writer.writeCall("Memory.alloc", 1);
             writer.writePop(Segment::POINTER, 0); // Set 'this' to the new address
         }
@@ -48,7 +267,7 @@ namespace nand2tetris::jack {
     }
 
 
-    void CodeGenerator::compileStatements(const std::vector<std::unique_ptr<StatementNode>> &stmts) {
+    void CodeGenerator::compileStatements(const NodeList<StatementNode>& stmts) {
         for (const auto& stmt : stmts) {
             switch (stmt->getType()) {
                 case ASTNodeType::LET_STATEMENT: compileLet(static_cast<const LetStatementNode&>(*stmt));break; // NOLINT(*-pro-type-static-cast-downcast)
@@ -84,17 +303,7 @@ namespace nand2tetris::jack {
             // Array Assignment: arr[i] = expr
 
             // 1. Push array base address
-            const SymbolKind kind = symbolTable.kindOf(node.varName);
-            const int index = symbolTable.indexOf(node.varName);
-            Segment seg;
-            switch(kind) {
-                case SymbolKind::STATIC: seg = Segment::STATIC; break;
-                case SymbolKind::FIELD:  seg = Segment::THIS;   break;
-                case SymbolKind::ARG:    seg = Segment::ARG;    break;
-                case SymbolKind::LCL:    seg = Segment::LOCAL;  break;
-                default: seg=Segment::TEMP; break;
-            }
-            writer.writePush(seg, index);
+            writer.writePush(segmentOf(node.target.kind), node.target.index);
 
             // 2. Push index and add to base
             compileExpression(*node.indexExpr);
@@ -111,19 +320,7 @@ namespace nand2tetris::jack {
         }else {
             // Simple Assignment: var = expr
             compileExpression(*node.valueExpr);
-
-            const SymbolKind kind = symbolTable.kindOf(node.varName);
-            const int index = symbolTable.indexOf(node.varName);
-
-            Segment seg;
-            switch(kind) {
-                case SymbolKind::STATIC: seg = Segment::STATIC; break;
-                case SymbolKind::FIELD:  seg = Segment::THIS;   break;
-                case SymbolKind::ARG:    seg = Segment::ARG;    break;
-                case SymbolKind::LCL:    seg = Segment::LOCAL;  break;
-                default: seg = Segment::TEMP; break; // Should be unreachable given semantic checks
-            }
-            writer.writePop(seg, index);
+            writer.writePop(segmentOf(node.target.kind), node.target.index);
         }
     }
 
@@ -166,6 +363,10 @@ namespace nand2tetris::jack {
     void CodeGenerator::compileExpression(const ExpressionNode &node) {
         if (node.getType()==ASTNodeType::BINARY_OP) {
             const auto& bin = static_cast<const BinaryOpNode&>(node); // NOLINT(*-pro-type-static-cast-downcast)
+            if (bin.byDoubling) {
+                compileDoubling(bin);
+                return;
+            }
             compileExpression(*bin.left);
             compileExpression(*bin.right);
             switch(bin.op) {
@@ -182,7 +383,7 @@ namespace nand2tetris::jack {
             }
         }else if (node.getType()==ASTNodeType::UNARY_OP) {
             const auto& un = static_cast<const UnaryOpNode&>(node);// NOLINT(*-pro-type-static-cast-downcast)
-            compileTerm(*un.term); // Evaluate term first
+            compileExpression(*un.term); // Evaluate the operand first (it may itself be an operation)
 
             if (un.op == '-') writer.writeArithmetic(Command::NEG);
             else if (un.op == '~') writer.writeArithmetic(Command::NOT);
@@ -191,6 +392,35 @@ namespace nand2tetris::jack {
         }
     }
 
+    void CodeGenerator::compileDoubling(const BinaryOpNode& node) {
+        // The ConstantFolder writes c as a literal, negated when negative.
+        const ExpressionNode* constant = node.right;
+        const bool negative = constant->getType() == ASTNodeType::UNARY_OP;
+        if (negative) constant = static_cast<const UnaryOpNode*>(constant)->term; // NOLINT(*-pro-type-static-cast-downcast)
+        const int multiplier = static_cast<const IntegerLiteralNode*>(constant)->value; // NOLINT(*-pro-type-static-cast-downcast)
+
+        int bit = 0;
+        while ((multiplier >> (bit + 1)) != 0) ++bit;
+        compileExpression(*node.left);
+        bool onlyOperand = true; // While the product is still `x`, pushing `x` again is shorter than temp 0.
+        for (--bit; bit >= 0; --bit) {
+            if (onlyOperand) {
+                compileExpression(*node.left);
+                onlyOperand = false;
+            } else {
+                writer.writePop(Segment::TEMP, 0);
+                writer.writePush(Segment::TEMP, 0);
+                writer.writePush(Segment::TEMP, 0);
+            }
+            writer.writeArithmetic(Command::ADD);
+            if ((multiplier >> bit) & 1) {
+                compileExpression(*node.left);
+                writer.writeArithmetic(Command::ADD);
+            }
+        }
+        if (negative) writer.writeArithmetic(Command::NEG);
+    }
+
     void CodeGenerator::compileTerm(const ExpressionNode& node) {
         switch (node.getType()) {
             case ASTNodeType::INTEGER_LITERAL:{
@@ -200,7 +430,11 @@ namespace nand2tetris::jack {
             }
             case ASTNodeType::STRING_LITERAL:{
                 auto& n = static_cast<const StringLiteralNode&>(node);// NOLINT(*-pro-type-static-cast-downcast)
-                writer.writeStringConstant(n.value);
+                if (const int slot = pooledSlot(n.value); slot >= 0) {
+                    writer.writePush(Segment::STATIC, slot);
+                } else {
+                    writer.writeStringConstant(n.value);
+                }
                 break;
             }
             case ASTNodeType::KEYWORD_LITERAL: {
@@ -217,17 +451,8 @@ namespace nand2tetris::jack {
             }
             case ASTNodeType::IDENTIFIER: {
                 auto& n = static_cast<const IdentifierNode&>(node);// NOLINT(*-pro-type-static-cast-downcast)
-                const SymbolKind kind = symbolTable.kindOf(n.name);
-                const int index = symbolTable.indexOf(n.name);
-                Segment seg;
-
-                switch(kind) {
-                    case SymbolKind::STATIC: seg = Segment::STATIC; break;
-                    case SymbolKind::FIELD:  seg = Segment::THIS;   break;
-                    case SymbolKind::ARG:    seg = Segment::ARG;    break;
-                    case SymbolKind::LCL:    seg = Segment::LOCAL;  break;
-                    default: seg = Segment::TEMP; break;
-                }
+                const Segment seg = segmentOf(n.binding.kind);
+                const int index = n.binding.index;
                 if (n.indexExpr) {
                     // Array Access: x[i]
                     writer.writePush(seg, index); // Push Array Base
@@ -252,33 +477,23 @@ namespace nand2tetris::jack {
 
     void CodeGenerator::compileSubroutineCall(const CallNode &node) {
         int nArgs=0;
-        std::string funcName = std::string(node.functionName);
+        NameId targetClass;
 
-        if (node.classNameOrVar.empty()) {
+        if (node.classNameOrVar == Interner::EMPTY) {
             // Implicit 'this' call: foo() -> Class.foo(this)
             writer.writePush(Segment::POINTER, 0); // Push 'this'
-            funcName = std::string(currentClassName) + "." + funcName;
+            targetClass = currentClassName;
             nArgs = 1;
         }else {
             // Check if classNameOrVar is a variable (instance call) or a class (static call)
-            if (symbolTable.kindOf(node.classNameOrVar) != SymbolKind::NONE) {
+            if (node.receiver.kind != SymbolKind::NONE) {
                 // It is a variable: a.foo() -> ClassOfA.foo(a)
-                const SymbolKind kind = symbolTable.kindOf(node.classNameOrVar);
-                const int index = symbolTable.indexOf(node.classNameOrVar);
-                const std::string type = std::string(symbolTable.typeOf(node.classNameOrVar));
-                Segment seg;
-                switch(kind) {
-                    case SymbolKind::STATIC: seg = Segment::STATIC; break;
-                    case SymbolKind::FIELD:  seg = Segment::THIS;   break;
-                    case SymbolKind::ARG:    seg = Segment::ARG;    break;
-                    default: seg = Segment::LOCAL; break;
-                }
-                writer.writePush(seg, index); // Push the object instance
-                funcName = type + "." + funcName;
+                writer.writePush(segmentOf(node.receiver.kind), node.receiver.index); // Push the object instance
+                targetClass = node.receiver.type;
                 nArgs = 1;
             }else {
                 // It is a class: Math.abs() -> Math.abs()
-                funcName = std::string(node.classNameOrVar) + "." + funcName;
+                targetClass = node.classNameOrVar;
                 nArgs = 0;
             }
 
@@ -290,6 +505,65 @@ namespace nand2tetris::jack {
             nArgs++;
         }
 
-        writer.writeCall(funcName, nArgs);
+        // Another class cannot see the callee's statics, so such a body only inlines into its own class.
+        if (inliner) {
+            const InlineBody* body = inliner->find(targetClass, node.functionName);
+            if (body && (!body->usesStatics || targetClass == currentClassName)) {
+                inlineCall(*body);
+                inlined.push_back({currentSubroutine, {targetClass, node.functionName}});
+                return;
+            }
+        }
+
+        writer.writeCall(nameOf(targetClass), nameOf(node.functionName), nArgs);
+    }
+
+    void CodeGenerator::inlineCall(const InlineBody& body) {
+        constexpr int FIRST_SLOT = 1;
+        const int firstLocal = FIRST_SLOT + body.argCount;
+        for (int i = body.argCount - 1; i >= 0; --i) writer.writePop(Segment::TEMP, FIRST_SLOT + i);
+        for (int i = 0; i < body.localCount; ++i) {
+            writer.writePush(Segment::CONST, 0);
+            writer.writePop(Segment::TEMP, firstLocal + i);
+        }
+
+        std::vector<std::string> labels;
+        labels.reserve(body.labelCount);
+        for (int i = 0; i < body.labelCount; ++i) labels.push_back(getUniqueLabel());
+
+        for (const VMInstruction& in : body.code) {
+            switch (in.op) {
+                case VMOp::PUSH:
+                case VMOp::POP: {
+                    Segment segment = in.segment;
+                    int index = in.value;
+                    if (segment == Segment::ARG) {
+                        segment = Segment::TEMP;
+                        index += FIRST_SLOT;
+                    } else if (segment == Segment::LOCAL) {
+                        segment = Segment::TEMP;
+                        index += firstLocal;
+                    } else if (segment == Segment::POINTER && index == 0) {
+                        segment = Segment::TEMP; // `this` is the receiver, argument 0.
+                        index = FIRST_SLOT;
+                    } else if (segment == Segment::THIS) {
+                        writer.writePush(Segment::TEMP, FIRST_SLOT);
+                        writer.writePop(Segment::POINTER, 1);
+                        segment = Segment::THAT;
+                    }
+                    if (in.op == VMOp::PUSH) {
+                        writer.writePush(segment, index);
+                    } else {
+                        writer.writePop(segment, index);
+                    }
+                    break;
+                }
+                case VMOp::ARITHMETIC: writer.writeArithmetic(in.command); break;
+                case VMOp::LABEL:      writer.writeLabel(labels[in.symbol]); break;
+                case VMOp::GOTO:       writer.writeGoto(labels[in.symbol]); break;
+                case VMOp::IF_GOTO:    writer.writeIf(labels[in.symbol]); break;
+                default: break; // Bodies hold no calls, functions or returns.
+            }
+        }
     }
 }
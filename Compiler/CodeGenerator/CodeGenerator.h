@@ -4,18 +4,32 @@
 
 #ifndef NAND2TETRIS_CODE_GENERATOR_H
 #define NAND2TETRIS_CODE_GENERATOR_H
+#include "Inliner.h"
+#include "StringPool.h"
 #include "../Parser/AST.h"
+#include "../SemanticAnalyser/CallGraph.h"
 #include "../SemanticAnalyser/GlobalRegistry.h"
-#include "../SemanticAnalyser/SymbolTable.h"
 #include "../VMWriter/VMWriter.h"
+#include <optional>
+#include <string_view>
+#include <vector>
 
 namespace nand2tetris::jack {
 
+    /**
+     * @brief A call site that got the callee's code instead of a call (--inline).
+     */
+    struct InlinedCall {
+        NameId caller = Interner::EMPTY; ///< Subroutine of the class being compiled.
+        SubroutineRef callee;
+    };
+
     /**
      * @brief Generates VM code from the Abstract Syntax Tree (AST).
      *
      * This class traverses the AST and emits corresponding VM commands using the VMWriter.
-     * It manages symbol tables for variable resolution and handles control flow logic.
+     * Variables are emitted from the slot bindings the SemanticAnalyser recorded on the AST, so no symbol
+     * table is consulted here.
      */
     class CodeGenerator {
         public:
@@ -23,46 +37,136 @@ namespace nand2tetris::jack {
              * @brief Constructs a CodeGenerator.
              *
              * @param registry The global registry containing class and method signatures.
-             * @param out The output stream to write VM code to.
-             * @param table Symbol table for code generation
+             * @param writer The writer that collects the generated VM code.
+             * @param poolStrings Take string literals from the StringPool instead of building them in place.
+             * @param poolLimit With pooling, how many literals a class may pool (StringPool::perClassLimit).
+             * @param reachable With dead code elimination, the solved call graph: subroutines it cannot
+             *                  reach are left out. Null to emit everything.
+             * @param inliner With inlining, the bodies to copy into their call sites. Null to call everything.
+             */
+            CodeGenerator(const GlobalRegistry& registry, VMWriter& writer, bool poolStrings = false,
+                          std::size_t poolLimit = StringPool::MAX_PER_CLASS, const CallGraph* reachable = nullptr, const InlineTable* inliner = nullptr);
+
+            /**
+             * @brief Constructs a generator for one subroutine of the class `context` is compiling.
+             *
+             * The fragment it writes is put back with appendSubroutine(). Fragments are independent, so
+             * the subroutines of one class can be generated concurrently.
+             *
+             * @param context A generator between beginClass() and endClass().
+             * @param writer The writer that collects this subroutine's code.
              */
-            CodeGenerator(const GlobalRegistry& registry, std::ostream& out,SymbolTable& table);
+            CodeGenerator(const CodeGenerator& context, VMWriter& writer);
 
             /**
              * @brief Compiles a class node into VM code.
              *
+             * Same as beginClass(), compileSubroutine() for every subroutine emits() accepts, then endClass().
+             *
              * @param node The root node of the class AST.
              */
             void compileClass(const ClassNode& node);
-        private:
-            const GlobalRegistry& registry; ///< Reference to the global registry.
-            VMWriter writer;                ///< Helper to write VM commands.
-            SymbolTable& symbolTable;        ///< Symbol table for variable resolution.
-            std::string_view currentClassName; ///< Name of the class currently being compiled.
-            int labelCounter = 0;           ///< Counter for generating unique labels.
 
             /**
-             * @brief Generates a unique label string.
-             * @return A unique label (e.g., "L1", "L2").
+             * @brief Starts a class: sets up the class-wide state and assigns the string pool slots.
              */
-            std::string getUniqueLabel();
+            void beginClass(const ClassNode& node);
 
             /**
-             * @brief Compiles a subroutine declaration.
+             * @brief True unless dead code elimination leaves the subroutine of the current class out.
+             */
+            bool emits(const SubroutineDecNode& node) const;
+
+            /**
+             * @brief Compiles a subroutine declaration of the current class.
              *
-             * Sets up the symbol table, writes the function declaration, handles constructor/method setup,
+             * Writes the function declaration, handles constructor/method setup,
              * and compiles the body statements.
              *
              * @param node The subroutine declaration node.
              */
             void compileSubroutine(const SubroutineDecNode& node);
 
+            /**
+             * @brief Appends the code of a subroutine generated by a fragment generator.
+             *
+             * Labels are renumbered as if the fragment had been compiled right here, so appending the
+             * fragments in declaration order gives exactly the code compileClass() would have.
+             *
+             * @param fragment A generator built from this one, after its compileSubroutine().
+             */
+            void appendSubroutine(const CodeGenerator& fragment);
+
+            /**
+             * @brief Finishes the class (writes the string pool setter, if the class has one).
+             */
+            void endClass();
+
+            /**
+             * @brief The literals the last compiled class takes from the StringPool, in static slot order.
+             */
+            const std::vector<std::string_view>& pooledStrings() const { return pooled; }
+
+            /**
+             * @brief Compiles a subroutine of the current class as an InlineBody, if it can be inlined.
+             *
+             * @return The body, or nothing if the subroutine calls anything, is a constructor, or is too big.
+             */
+            std::optional<InlineBody> inlineBodyOf(const SubroutineDecNode& node) const;
+
+            /**
+             * @brief The calls inlined so far, in the order they were generated.
+             */
+            const std::vector<InlinedCall>& inlinedCalls() const { return inlined; }
+        private:
+            const GlobalRegistry& registry; ///< Reference to the global registry.
+            VMWriter& writer;               ///< Helper to write VM commands.
+            NameId currentClassName = Interner::EMPTY; ///< Name of the class currently being compiled.
+            NameId currentSubroutine = Interner::EMPTY; ///< Name of the subroutine currently being compiled.
+            int fieldCount = 0;             ///< Fields of the current class (object size for constructors).
+            int labelCounter = 0;           ///< Counter for generating unique labels.
+
+            const CallGraph* reachable;             ///< Set with dead code elimination.
+            const InlineTable* inliner;             ///< Set with inlining.
+            std::vector<InlinedCall> inlined;       ///< Calls replaced by the callee's body.
+            const bool poolStrings;                 ///< Pooling was requested.
+            const std::size_t poolLimit;            ///< Literals a class may pool.
+            bool poolingClass = false;              ///< ...and applies to the current class.
+            int poolBase = 0;                       ///< First static slot after the class's own statics.
+            std::vector<std::string_view> pooled;   ///< Pooled literals of the current class.
+
+            /**
+             * @brief Returns the static slot holding a pooled literal.
+             * @return The slot, or -1 if the literal has to be built in place.
+             */
+            int pooledSlot(std::string_view literal) const;
+
+            /**
+             * @brief Gives string pool slots to the first literals of the class, in declaration order.
+             *
+             * Done up front rather than as literals are met, so the slots do not depend on the order in
+             * which subroutines are generated.
+             */
+            void poolStatements(const NodeList<StatementNode>& stmts);
+            void poolExpression(const ExpressionNode* node);
+
+            /**
+             * @brief Writes `<Class>.$strings`, which stores the pooled literals in their static slots.
+             */
+            void compileStringSetter();
+
+            /**
+             * @brief Generates a unique label string.
+             * @return A unique label (e.g., "L1", "L2").
+             */
+            std::string getUniqueLabel();
+
             /**
              * @brief Compiles a list of statements.
              *
              * @param stmts The vector of statement nodes.
              */
-            void compileStatements(const std::vector<std::unique_ptr<StatementNode>>& stmts);
+            void compileStatements(const NodeList<StatementNode>& stmts);
 
             /**
              * @brief Compiles a 'do' statement.
@@ -118,6 +222,16 @@ namespace nand2tetris::jack {
              */
             void compileExpression(const ExpressionNode& node);
 
+            /**
+             * @brief Compiles `x * c` marked by the ConstantFolder (BinaryOpNode::byDoubling) without Math.multiply.
+             *
+             * From the top bit of |c| down, the product is doubled (kept in temp 0 to push it twice) and
+             * `x` is added for each set bit: O(log c) commands. Negative multipliers end with a `neg`.
+             *
+             * @param node The multiplication; `x` costs a single push, `c` is a constant.
+             */
+            void compileDoubling(const BinaryOpNode& node);
+
             /**
              * @brief Compiles a term (integer, string, keyword, identifier, unary op).
              *
@@ -133,6 +247,14 @@ namespace nand2tetris::jack {
              * @param node The call node.
              */
             void compileSubroutineCall(const CallNode& node);
+
+            /**
+             * @brief Writes an inlined body in place of a call whose arguments are already pushed.
+             *
+             * The arguments go to temp 1 onwards, fields of the receiver are reached through `that`, and
+             * the labels are renamed so they cannot clash with the caller's ones.
+             */
+            void inlineCall(const InlineBody& body);
     };
 
 
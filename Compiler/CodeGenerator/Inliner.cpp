@@ -0,0 +1,42 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "Inliner.h"
+#include <optional>
+#include <utility>
+#include "CodeGenerator.h"
+
+namespace nand2tetris::jack {
+
+    void InlineTable::addClass(const GlobalRegistry& registry, const ClassNode& node, const bool poolStrings,
+                               const std::size_t poolLimit) {
+        // The class context decides the field count and the string pool slots, as in compileJob.
+        VMWriter unused(0);
+        CodeGenerator context(registry, unused, poolStrings, poolLimit);
+        context.beginClass(node);
+        for (const SubroutineDecNode* sub : node.getSubroutines()) {
+            if (std::optional<InlineBody> body = context.inlineBodyOf(*sub)) {
+                add(node.getClassName(), sub->getName(), std::move(*body));
+            }
+        }
+    }
+
+    void InlineTable::add(const NameId className, const NameId subroutine, InlineBody body) {
+        const auto [it, added] = bodies.insert_or_assign(key(className, subroutine), std::move(body));
+        if (added) classes[className].push_back(subroutine);
+    }
+
+    const InlineBody* InlineTable::find(const NameId className, const NameId subroutine) const {
+        const auto it = bodies.find(key(className, subroutine));
+        return it == bodies.end() ? nullptr : &it->second;
+    }
+
+    std::vector<std::pair<NameId, const InlineBody*>> InlineTable::bodiesOf(const NameId className) const {
+        std::vector<std::pair<NameId, const InlineBody*>> result;
+        const auto it = classes.find(className);
+        if (it == classes.end()) return result;
+        for (const NameId subroutine : it->second) result.emplace_back(subroutine, find(className, subroutine));
+        return result;
+    }
+}
@@ -0,0 +1,95 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_INLINER_H
+#define NAND2TETRIS_INLINER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../Common/Interner.h"
+#include "../VMWriter/VMCode.h"
+
+namespace nand2tetris::jack {
+
+    class ClassNode;
+    class GlobalRegistry;
+
+    /**
+     * @brief The code of a small leaf subroutine, ready to be copied into its callers (--inline).
+     *
+     * The code is the subroutine's VM code without the function header, the method prologue and the final
+     * return; a return anywhere else has become a jump to the end. At the call site the arguments (and
+     * the receiver of a method) are popped into temp 1, 2, ... and the locals follow them, so the code
+     * still refers to `argument i` and `local i` and the call site maps them onto the temps. Labels are
+     * numbered 0 .. labelCount - 1 in the symbol field.
+     */
+    struct InlineBody {
+        std::uint8_t argCount = 0;   ///< Including the receiver for a method.
+        std::uint8_t localCount = 0;
+        std::uint8_t labelCount = 0;
+        bool isMethod = false;       ///< Reads or writes fields through `this`, i.e. through temp 1.
+        bool usesStatics = false;    ///< Static variables are per class, so it is only inlined into its own class.
+        std::vector<VMInstruction> code;
+    };
+
+    /**
+     * @brief The subroutines of the program that are small enough to inline, by class and name.
+     *
+     * A subroutine qualifies if it calls nothing (not even implicitly: no `*`, `/`, strings built in
+     * place or object allocation), is not a constructor, has at most MAX_INSTRUCTIONS VM commands and
+     * fits its arguments and locals into temp 1-7 (temp 0 stays free for the array assignments of both
+     * the caller and the callee).
+     *
+     * Filled once every class is analysed and read-only while classes are generated.
+     */
+    class InlineTable {
+        public:
+            /// Largest body that is inlined; a Hack call and return cost far more than this.
+            static constexpr std::size_t MAX_INSTRUCTIONS = 16;
+
+            /// Temps 1-7 hold the arguments and locals of an inlined body.
+            static constexpr int MAX_SLOTS = 7;
+
+            /**
+             * @brief Adds every qualifying subroutine of an analysed class.
+             *
+             * @param poolStrings Whether the build pools string literals, as the class will be generated.
+             * @param poolLimit How many literals a class may pool, as the class will be generated.
+             */
+            void addClass(const GlobalRegistry& registry, const ClassNode& node, bool poolStrings, std::size_t poolLimit);
+
+            /**
+             * @brief Adds one body, e.g. from the build cache.
+             */
+            void add(NameId className, NameId subroutine, InlineBody body);
+
+            /**
+             * @brief The body of a subroutine, or nullptr if it is not inlined.
+             */
+            const InlineBody* find(NameId className, NameId subroutine) const;
+
+            /**
+             * @brief The bodies of one class, for the build cache.
+             */
+            std::vector<std::pair<NameId, const InlineBody*>> bodiesOf(NameId className) const;
+
+            /**
+             * @brief The number of subroutines in the table.
+             */
+            std::size_t size() const { return bodies.size(); }
+
+        private:
+            static std::uint64_t key(const NameId className, const NameId subroutine) {
+                return static_cast<std::uint64_t>(className) << 32 | subroutine;
+            }
+
+            std::unordered_map<std::uint64_t, InlineBody> bodies;
+            std::unordered_map<NameId, std::vector<NameId>> classes; ///< Inlined subroutines in declaration order.
+    };
+}
+
+#endif //NAND2TETRIS_INLINER_H
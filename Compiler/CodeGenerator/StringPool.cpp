@@ -0,0 +1,48 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "StringPool.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace nand2tetris::jack {
+
+    std::size_t StringPool::perClassLimit(const std::size_t budget, const std::vector<std::size_t>& literals) {
+        for (std::size_t limit = MAX_PER_CLASS; limit > 0; --limit) {
+            std::size_t slots = 0;
+            for (const std::size_t count : literals) slots += std::min(count, limit);
+            if (slots <= budget) return limit;
+        }
+        return 0;
+    }
+
+    void StringPool::writeInit(VMWriter& writer, std::vector<ClassStrings> classes) {
+        std::sort(classes.begin(), classes.end(), [](const ClassStrings& a, const ClassStrings& b) {
+            return a.className < b.className;
+        });
+
+        // One local per distinct literal, numbered by first use.
+        std::vector<std::string_view> distinct;
+        std::unordered_map<std::string_view, int> local;
+        for (const ClassStrings& cls : classes) {
+            for (const std::string& s : cls.strings) {
+                if (local.emplace(s, static_cast<int>(distinct.size())).second) distinct.push_back(s);
+            }
+        }
+
+        writer.writeFunction(CLASS_NAME, "init", static_cast<int>(distinct.size()));
+        for (std::size_t i = 0; i < distinct.size(); ++i) {
+            writer.writeStringConstant(distinct[i]);
+            writer.writePop(Segment::LOCAL, static_cast<int>(i));
+        }
+        for (const ClassStrings& cls : classes) {
+            if (cls.strings.empty()) continue;
+            for (const std::string& s : cls.strings) writer.writePush(Segment::LOCAL, local[s]);
+            writer.writeCall(cls.className, SETTER, static_cast<int>(cls.strings.size()));
+            writer.writePop(Segment::TEMP, 0);
+        }
+        writer.writePush(Segment::CONST, 0);
+        writer.writeReturn();
+    }
+}
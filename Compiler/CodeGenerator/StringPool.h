@@ -0,0 +1,68 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_STRING_POOL_H
+#define NAND2TETRIS_STRING_POOL_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../VMWriter/VMWriter.h"
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief The string literals one class takes from the pool, in the order of its static slots.
+     */
+    struct ClassStrings {
+        std::string className;
+        std::vector<std::string> strings;
+    };
+
+    /**
+     * @brief Builds every string literal of the program once, at start-up.
+     *
+     * Each class keeps the literals it uses in static variables after its own, so a literal costs a
+     * single `push static`. The class gets a generated function `<Class>.$strings` that takes those
+     * strings as arguments and stores them. The pool itself is the function `$StringPool.init` in its
+     * own file: it builds each distinct literal of the whole program once, hands every class its
+     * strings, and is called at the top of `Main.main`. The `$` keeps the generated names apart from
+     * anything a Jack program can declare.
+     *
+     * The pooled slots and the statics the classes declare share the 240 words of the Hack static segment
+     * (RAM 16-255), so a program with many literals pools fewer of them per class (see perClassLimit); the
+     * rest are built in place as with `--strict-strings`.
+     *
+     * Pooled strings are shared, so a program that modifies or disposes of a literal sees the change
+     * at every other use of it; `--strict-strings` keeps the standard behaviour of building the string
+     * anew each time the literal is evaluated.
+     */
+    struct StringPool {
+        static constexpr std::string_view CLASS_NAME = "$StringPool";
+        static constexpr std::string_view INIT_FUNCTION = "$StringPool.init";
+        static constexpr std::string_view FILE_NAME = "$StringPool.vm";
+        static constexpr std::string_view SETTER = "$strings";
+
+        /// The Hack static segment has 240 words for the whole program, so each class only pools a few.
+        static constexpr std::size_t MAX_PER_CLASS = 16;
+
+        /**
+         * @brief How many literals each class may pool so that every pooled slot fits the static segment.
+         *
+         * @param budget The static words left once every class has its declared statics.
+         * @param literals Per class that pools, its distinct literals (at most MAX_PER_CLASS).
+         * @return MAX_PER_CLASS if every literal fits; otherwise the largest limit whose slots still fit.
+         */
+        static std::size_t perClassLimit(std::size_t budget, const std::vector<std::size_t>& literals);
+
+        /**
+         * @brief Writes `$StringPool.init` for the given classes.
+         *
+         * The result does not depend on the order of `classes`.
+         */
+        static void writeInit(VMWriter& writer, std::vector<ClassStrings> classes);
+    };
+}
+
+#endif //NAND2TETRIS_STRING_POOL_H
@@ -0,0 +1,42 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "Arena.h"
+#include <cstdint>
+
+namespace nand2tetris::jack {
+
+    Arena::Arena(const std::size_t blockSize) : blockSize(blockSize) {}
+
+    std::byte* Arena::newBlock(const std::size_t bytes) {
+        blocks.push_back(std::make_unique<std::byte[]>(bytes));
+        reserved += bytes;
+        return blocks.back().get();
+    }
+
+    void* Arena::allocate(const std::size_t bytes, const std::size_t align) {
+        const auto current = reinterpret_cast<std::uintptr_t>(cursor);
+        const std::size_t padding = (align - current % align) % align;
+
+        if (cursor == nullptr || padding + bytes > static_cast<std::size_t>(limit - cursor)) {
+            // Oversized requests get a dedicated block so they do not waste the tail of a shared one.
+            // new[] storage is aligned for any fundamental type, which covers every AST node.
+            if (bytes > blockSize / 4) {
+                used += bytes;
+                return newBlock(bytes);
+            }
+            cursor = newBlock(blockSize);
+            limit = cursor + blockSize;
+            std::byte* result = cursor;
+            cursor += bytes;
+            used += bytes;
+            return result;
+        }
+
+        std::byte* result = cursor + padding;
+        cursor = result + bytes;
+        used += padding + bytes;
+        return result;
+    }
+}
@@ -0,0 +1,97 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_ARENA_H
+#define NAND2TETRIS_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Span.h"
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief A bump allocator that frees everything it handed out in one go.
+     *
+     * Memory is carved from large blocks in allocation order, so objects built together (an AST, for
+     * instance) sit next to each other in memory. Nothing is freed individually and no destructors are
+     * run: make() only accepts trivially destructible types, which is checked at compile time.
+     */
+    class Arena {
+        public:
+            /**
+             * @brief Creates an empty arena.
+             *
+             * @param blockSize Size of each block requested from the heap. Larger requests get their own block.
+             */
+            explicit Arena(std::size_t blockSize = 64 * 1024);
+
+            Arena(const Arena&) = delete;
+            Arena& operator=(const Arena&) = delete;
+
+            /**
+             * @brief Returns uninitialised storage for `bytes` bytes aligned to `align`.
+             */
+            void* allocate(std::size_t bytes, std::size_t align);
+
+            /**
+             * @brief Constructs a T inside the arena.
+             *
+             * @return A pointer that stays valid until the arena is destroyed.
+             */
+            template <typename T, typename... Args>
+            T* make(Args&&... args) {
+                static_assert(std::is_trivially_destructible_v<T>, "Arena never runs destructors");
+                ++objects;
+                return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            }
+
+            /**
+             * @brief Copies the contents of a vector into the arena.
+             *
+             * Lets callers collect items in a scratch vector and then freeze them next to their owner.
+             */
+            template <typename T>
+            Span<T> copyOf(const std::vector<T>& items) {
+                static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                              "Arena spans hold plain data only");
+                if (items.empty()) return {};
+                T* first = static_cast<T*>(allocate(sizeof(T) * items.size(), alignof(T)));
+                std::uninitialized_copy(items.begin(), items.end(), first);
+                return {first, items.size()};
+            }
+
+            /**
+             * @brief Returns the number of bytes handed out so far (including alignment padding).
+             */
+            std::size_t bytesUsed() const { return used; }
+
+            /**
+             * @brief Returns the number of bytes obtained from the heap.
+             */
+            std::size_t bytesReserved() const { return reserved; }
+
+            /**
+             * @brief Returns the number of objects constructed with make() (for an AST: its node count).
+             */
+            std::size_t objectCount() const { return objects; }
+
+        private:
+            std::vector<std::unique_ptr<std::byte[]>> blocks;
+            std::size_t blockSize;
+            std::byte* cursor = nullptr; ///< Next free byte in the current block.
+            std::byte* limit = nullptr;  ///< One past the end of the current block.
+            std::size_t used = 0;
+            std::size_t reserved = 0;
+            std::size_t objects = 0;
+
+            std::byte* newBlock(std::size_t bytes);
+    };
+}
+
+#endif //NAND2TETRIS_ARENA_H
@@ -0,0 +1,62 @@
+//
+// Created on 15/10/2026.
+//
+
+#include "Diagnostics.h"
+#include <algorithm>
+#include <exception>
+#include <tuple>
+#include <utility>
+
+namespace nand2tetris::jack {
+
+    CompileError::CompileError(std::string file, const std::uint32_t line, const std::uint32_t column,
+                               const std::string& message)
+        : std::runtime_error(message), where{std::move(file), line, column, message} {}
+
+    void Diagnostics::report(Diagnostic diagnostic) {
+        std::scoped_lock lock(mtx);
+        diagnostics.push_back(std::move(diagnostic));
+    }
+
+    void Diagnostics::reportCurrentException(const std::string& file) {
+        try {
+            throw;
+        } catch (const CompileError& e) {
+            Diagnostic diagnostic = e.diagnostic();
+            diagnostic.file = file;
+            report(std::move(diagnostic));
+        } catch (const std::exception& e) {
+            report({file, 0, 0, e.what()});
+        }
+    }
+
+    std::size_t Diagnostics::count() const {
+        std::scoped_lock lock(mtx);
+        return diagnostics.size();
+    }
+
+    std::vector<Diagnostic> Diagnostics::sorted() const {
+        std::vector<Diagnostic> result;
+        {
+            std::scoped_lock lock(mtx);
+            result = diagnostics;
+        }
+        std::stable_sort(result.begin(), result.end(), [](const Diagnostic& a, const Diagnostic& b) {
+            return std::tie(a.file, a.line, a.column) < std::tie(b.file, b.line, b.column);
+        });
+        return result;
+    }
+
+    void Diagnostics::print(std::ostream& out) const {
+        const std::vector<Diagnostic> all = sorted();
+        std::size_t files = 0;
+        for (std::size_t i = 0; i < all.size(); ++i) {
+            if (!all[i].file.empty() && (i == 0 || all[i].file != all[i - 1].file)) ++files;
+            out << all[i].message << '\n';
+        }
+        out << all.size() << (all.size() == 1 ? " error" : " errors");
+        if (files > 0) out << " in " << files << (files == 1 ? " file" : " files");
+        out << std::endl;
+    }
+}
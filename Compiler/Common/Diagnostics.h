@@ -0,0 +1,86 @@
+//
+// Created on 15/10/2026.
+//
+
+#ifndef NAND2TETRIS_DIAGNOSTICS_H
+#define NAND2TETRIS_DIAGNOSTICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief One error found in the program: where it is and the message as printed.
+     */
+    struct Diagnostic {
+        std::string file;       ///< The source path; empty for errors about the program as a whole.
+        std::uint32_t line = 0; ///< 0 if the error has no position in the file.
+        std::uint32_t column = 0;
+        std::string message;    ///< The full text, position included (e.g. "Main.jack:3:5: Expected ';'").
+    };
+
+    /**
+     * @brief An error in the source, thrown to leave the file or subroutine it was found in.
+     *
+     * what() is the message as printed. The job compiling the file catches it and hands the
+     * diagnostic to a Diagnostics sink, so it never travels further than one compilation unit.
+     */
+    class CompileError : public std::runtime_error {
+        public:
+            CompileError(std::string file, std::uint32_t line, std::uint32_t column, const std::string& message);
+
+            const Diagnostic& diagnostic() const { return where; }
+
+        private:
+            Diagnostic where;
+    };
+
+    /**
+     * @brief Collects the errors of a whole build, from any number of threads.
+     *
+     * Every unit reports its own errors and the build carries on with the others; at the end all of them
+     * are printed at once, sorted by file, line and column, so the order does not depend on the workers.
+     */
+    class Diagnostics {
+        public:
+            /**
+             * @brief Records an error.
+             */
+            void report(Diagnostic diagnostic);
+
+            /**
+             * @brief Records the exception being handled (call from a catch block) as an error in a file.
+             *
+             * A CompileError keeps its position; anything else is reported without one. The error is
+             * attributed to `file` either way, since that is the unit that failed.
+             */
+            void reportCurrentException(const std::string& file);
+
+            /**
+             * @brief Returns the number of errors so far.
+             */
+            std::size_t count() const;
+
+            /**
+             * @brief Returns every error, sorted by file, line and column (errors without a file first).
+             */
+            std::vector<Diagnostic> sorted() const;
+
+            /**
+             * @brief Prints every error, sorted, and a summary line such as "3 errors in 2 files".
+             */
+            void print(std::ostream& out) const;
+
+        private:
+            mutable std::mutex mtx;
+            std::vector<Diagnostic> diagnostics;
+    };
+}
+
+#endif //NAND2TETRIS_DIAGNOSTICS_H
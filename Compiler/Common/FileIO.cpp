@@ -0,0 +1,91 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "FileIO.h"
+#include <cstdio>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace nand2tetris::jack {
+
+    void writeFileAtomically(const std::filesystem::path& path, const std::string_view contents) {
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+
+        std::FILE* file = std::fopen(tempPath.string().c_str(), "wb");
+        if (!file) {
+            throw std::runtime_error("Could not open output file: " + path.string());
+        }
+        // Unbuffered, so the fwrite below turns into one write of the whole file.
+        std::setvbuf(file, nullptr, _IONBF, 0);
+        const bool written = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+        const bool closed = std::fclose(file) == 0;
+
+        std::error_code ec;
+        if (written && closed) {
+            std::filesystem::rename(tempPath, path, ec);
+            if (!ec) return;
+        }
+        std::filesystem::remove(tempPath, ec);
+        throw std::runtime_error("Could not write output file: " + path.string());
+    }
+
+    std::optional<std::string> readFile(const std::filesystem::path& path) {
+        std::FILE* file = std::fopen(path.string().c_str(), "rb");
+        if (!file) return std::nullopt;
+
+        std::string contents;
+        char chunk[64 * 1024];
+        std::size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            contents.append(chunk, n);
+        }
+        const bool failed = std::ferror(file) != 0;
+        std::fclose(file);
+        if (failed) return std::nullopt;
+        return contents;
+    }
+
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+#ifndef _WIN32
+        const int fd = ::open(path.string().c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Could not open file: " + path.string());
+        struct stat info{};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not read file: " + path.string());
+        }
+        size = static_cast<std::size_t>(info.st_size);
+        if (size > 0) {
+            void* view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Could not map file: " + path.string());
+            }
+            data = static_cast<const char*>(view);
+            mapped = true;
+        }
+        ::close(fd); // The mapping stays valid without the descriptor.
+#else
+        std::optional<std::string> contents = readFile(path);
+        if (!contents) throw std::runtime_error("Could not read file: " + path.string());
+        copy = std::move(*contents);
+        data = copy.data();
+        size = copy.size();
+#endif
+    }
+
+    MappedFile::~MappedFile() {
+#ifndef _WIN32
+        if (mapped) ::munmap(const_cast<char*>(data), size);
+#endif
+    }
+}
@@ -0,0 +1,61 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_FILE_IO_H
+#define NAND2TETRIS_FILE_IO_H
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief Replaces `path` with `contents` in a single write.
+     *
+     * The data goes to a temporary file next to `path` which is then renamed over it, so readers
+     * only ever see the old file or the complete new one.
+     *
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    void writeFileAtomically(const std::filesystem::path& path, std::string_view contents);
+
+    /**
+     * @brief Reads a whole file into memory.
+     *
+     * @return The contents, or nothing if the file does not exist or cannot be read.
+     */
+    std::optional<std::string> readFile(const std::filesystem::path& path);
+
+    /**
+     * @brief A whole file, mapped read-only into memory.
+     *
+     * Where mapping is not available (Windows), the file is read into memory instead.
+     */
+    class MappedFile {
+        public:
+            /**
+             * @throws std::runtime_error If the file cannot be opened or mapped.
+             */
+            explicit MappedFile(const std::filesystem::path& path);
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            /**
+             * @brief The contents; valid as long as the MappedFile lives.
+             */
+            std::string_view bytes() const { return {data, size}; }
+
+        private:
+            const char* data = nullptr;
+            std::size_t size = 0;
+            bool mapped = false;
+            std::string copy; ///< The contents when they were read rather than mapped.
+    };
+}
+
+#endif //NAND2TETRIS_FILE_IO_H
@@ -0,0 +1,31 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_HASH_H
+#define NAND2TETRIS_HASH_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace nand2tetris::jack {
+
+    inline constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+    inline constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+    /**
+     * @brief 64-bit FNV-1a hash of a byte string.
+     *
+     * Stable across runs and platforms, so it is safe to persist. Pass a previous result as `hash`
+     * to hash several pieces as if they were concatenated.
+     */
+    constexpr std::uint64_t fnv1a(const std::string_view bytes, std::uint64_t hash = FNV_OFFSET_BASIS) {
+        for (const char c : bytes) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+}
+
+#endif //NAND2TETRIS_HASH_H
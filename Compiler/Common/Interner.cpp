@@ -0,0 +1,54 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "Interner.h"
+#include <mutex>
+#include <stdexcept>
+
+namespace nand2tetris::jack {
+
+    Interner& Interner::global() {
+        static Interner instance;
+        return instance;
+    }
+
+    Interner::Interner() {
+        for (const std::string_view seed : SEEDED_NAMES) {
+            intern(seed);
+        }
+    }
+
+    NameId Interner::intern(const std::string_view text) {
+        // Fast path: almost every identifier in a file has been seen before.
+        {
+            std::shared_lock lock(mtx);
+            const auto it = ids.find(text);
+            if (it != ids.end()) return it->second;
+        }
+
+        std::unique_lock lock(mtx);
+        // Another thread may have inserted it between the two locks.
+        const auto it = ids.find(text);
+        if (it != ids.end()) return it->second;
+
+        const std::string_view stored = storage.emplace_back(text);
+        const auto id = static_cast<NameId>(byId.size());
+        byId.push_back(stored);
+        ids.emplace(stored, id);
+        return id;
+    }
+
+    std::string_view Interner::name(const NameId id) const {
+        std::shared_lock lock(mtx);
+        if (id >= byId.size()) {
+            throw std::out_of_range("Internal Compiler Error: unknown name id " + std::to_string(id));
+        }
+        return byId[id];
+    }
+
+    std::size_t Interner::size() const {
+        std::shared_lock lock(mtx);
+        return byId.size();
+    }
+}
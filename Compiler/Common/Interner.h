@@ -0,0 +1,150 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_INTERNER_H
+#define NAND2TETRIS_INTERNER_H
+
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief Dense integer handle for an interned name (identifier, type or class name).
+     *
+     * Two names are equal exactly when their IDs are equal, so lookups and type checks compare
+     * integers instead of strings.
+     */
+    using NameId = std::uint32_t;
+
+    /**
+     * @brief Names interned when the process starts, in ID order (the first entry gets ID 0).
+     *
+     * Because their IDs are fixed, code can refer to these names as compile-time constants: the ones the
+     * compiler tests for directly, and every name in the OS API so the standard library table can be
+     * built at compile time (see StandardLibrary.h).
+     */
+    inline constexpr std::string_view SEEDED_NAMES[] = {
+        // Must stay first and in this order: see the constants in Interner.
+        "", "int", "char", "boolean", "void", "null", "this", "String", "Array",
+
+        // OS classes.
+        "Math", "Output", "Screen", "Keyboard", "Memory", "Sys",
+
+        // OS subroutines.
+        "init", "abs", "multiply", "divide", "min", "max", "sqrt", "bit",
+        "new", "dispose", "length", "charAt", "setCharAt", "appendChar", "eraseLastChar", "intValue", "setInt",
+        "backSpace", "doubleQuote", "newLine", "int2String",
+        "moveCursor", "printChar", "printString", "printInt", "println", "initMap", "create", "getMap",
+        "incrementCursor", "decrementCursor",
+        "clearScreen", "setColor", "drawPixel", "drawLine", "drawRectangle", "drawCircle",
+        "keyPressed", "readChar", "readLine", "readInt",
+        "peek", "poke", "alloc", "deAlloc",
+        "halt", "error", "wait",
+
+        // Program entry point.
+        "Main", "main",
+    };
+
+    /**
+     * @brief A thread-safe, process-wide table mapping each distinct name to a dense NameId.
+     *
+     * Every file's tokenizer interns its identifiers here, which is what makes an ID from one file
+     * comparable with an ID from another. The interner keeps its own copy of each name, so the text
+     * returned by name() stays valid for the life of the process, independently of any source buffer.
+     *
+     * The names in SEEDED_NAMES are interned first, so they have fixed IDs.
+     */
+    class Interner {
+        public:
+            // The constants below must match the head of SEEDED_NAMES (checked after the class).
+            static constexpr NameId EMPTY   = 0; ///< ""
+            static constexpr NameId INT     = 1; ///< "int"
+            static constexpr NameId CHAR    = 2; ///< "char"
+            static constexpr NameId BOOLEAN = 3; ///< "boolean"
+            static constexpr NameId VOID    = 4; ///< "void"
+            static constexpr NameId NULL_   = 5; ///< "null"
+            static constexpr NameId THIS_   = 6; ///< "this"
+            static constexpr NameId STRING  = 7; ///< "String"
+            static constexpr NameId ARRAY   = 8; ///< "Array"
+
+            /**
+             * @brief Returns the fixed ID of a name in SEEDED_NAMES.
+             *
+             * Meant for constant expressions: asking for a name that is not seeded fails to compile.
+             */
+            static constexpr NameId seeded(const std::string_view text) {
+                for (std::size_t i = 0; i < std::size(SEEDED_NAMES); ++i) {
+                    if (SEEDED_NAMES[i] == text) return static_cast<NameId>(i);
+                }
+                throw std::logic_error("name is not seeded in the interner");
+            }
+
+            /**
+             * @brief Returns the process-wide interner.
+             */
+            static Interner& global();
+
+            Interner(const Interner&) = delete;
+            Interner& operator=(const Interner&) = delete;
+
+            /**
+             * @brief Returns the ID of a name, assigning the next free ID if it has not been seen before.
+             */
+            NameId intern(std::string_view text);
+
+            /**
+             * @brief Returns the text of an interned name.
+             *
+             * @throws std::out_of_range if the ID was never handed out.
+             */
+            std::string_view name(NameId id) const;
+
+            /**
+             * @brief Returns the number of distinct names interned so far.
+             */
+            std::size_t size() const;
+
+            /**
+             * @brief True for the primitive types int, char and boolean.
+             */
+            static bool isPrimitive(const NameId id) { return id == INT || id == CHAR || id == BOOLEAN; }
+
+        private:
+            Interner();
+
+            mutable std::shared_mutex mtx;
+            std::deque<std::string> storage;                 ///< Owned copies; deque elements never move.
+            std::vector<std::string_view> byId;              ///< ID -> text (views into storage).
+            std::unordered_map<std::string_view, NameId> ids; ///< Text -> ID.
+    };
+
+    static_assert(Interner::seeded("") == Interner::EMPTY && Interner::seeded("int") == Interner::INT &&
+                  Interner::seeded("char") == Interner::CHAR && Interner::seeded("boolean") == Interner::BOOLEAN &&
+                  Interner::seeded("void") == Interner::VOID && Interner::seeded("null") == Interner::NULL_ &&
+                  Interner::seeded("this") == Interner::THIS_ && Interner::seeded("String") == Interner::STRING &&
+                  Interner::seeded("Array") == Interner::ARRAY, "Interner constants are out of sync with SEEDED_NAMES");
+
+    // A repeated seed would be interned once and shift the IDs of every name after it.
+    static_assert([] {
+        for (std::size_t i = 0; i < std::size(SEEDED_NAMES); ++i) {
+            if (Interner::seeded(SEEDED_NAMES[i]) != i) return false;
+        }
+        return true;
+    }(), "SEEDED_NAMES contains a duplicate");
+
+    /**
+     * @brief Shorthand for Interner::global().name(id).
+     */
+    inline std::string_view nameOf(const NameId id) { return Interner::global().name(id); }
+}
+
+#endif //NAND2TETRIS_INTERNER_H
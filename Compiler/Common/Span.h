@@ -0,0 +1,37 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_SPAN_H
+#define NAND2TETRIS_SPAN_H
+
+#include <cstddef>
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief A read-only view of a contiguous run of objects owned by someone else.
+     *
+     * Used in place of std::vector wherever the storage is managed elsewhere: AST child lists living
+     * in an Arena, parameter lists in the frozen registry, or compile-time tables. The view itself is
+     * two words, trivially copyable, and usable in constant expressions.
+     */
+    template <typename T>
+    class Span {
+        public:
+            constexpr Span() = default;
+            constexpr Span(const T* first, const std::size_t count) : first(first), count(count) {}
+
+            constexpr const T* begin() const { return first; }
+            constexpr const T* end() const { return first + count; }
+            constexpr std::size_t size() const { return count; }
+            constexpr bool empty() const { return count == 0; }
+            constexpr const T& operator[](const std::size_t i) const { return first[i]; }
+
+        private:
+            const T* first = nullptr;
+            std::size_t count = 0;
+    };
+}
+
+#endif //NAND2TETRIS_SPAN_H
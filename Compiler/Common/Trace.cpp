@@ -0,0 +1,104 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "Trace.h"
+#include <cstdio>
+#include "FileIO.h"
+
+namespace nand2tetris::jack {
+
+    namespace {
+        void appendJsonString(std::string& out, const std::string_view text) {
+            out += '"';
+            for (const char c : text) {
+                switch (c) {
+                    case '"':  out += "\\\""; break;
+                    case '\\': out += "\\\\"; break;
+                    case '\n': out += "\\n"; break;
+                    case '\t': out += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            char escaped[8];
+                            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                            out += escaped;
+                        } else {
+                            out += c;
+                        }
+                }
+            }
+            out += '"';
+        }
+    }
+
+    TraceRecorder::TraceRecorder() : origin(std::chrono::steady_clock::now()) {
+        threads.emplace(std::this_thread::get_id(), 0);
+    }
+
+    std::uint64_t TraceRecorder::now() const {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - origin).count());
+    }
+
+    std::uint32_t TraceRecorder::threadNumber() {
+        const auto [it, added] = threads.emplace(std::this_thread::get_id(), static_cast<std::uint32_t>(threads.size()));
+        return it->second;
+    }
+
+    void TraceRecorder::begin(const std::string_view category, const std::string_view name, const std::string_view file) {
+        const std::uint64_t micros = now();
+        std::scoped_lock lock(mtx);
+        events.push_back({'B', threadNumber(), micros, std::string(category), std::string(name), std::string(file), {}});
+    }
+
+    void TraceRecorder::end(std::vector<TraceArg> args) {
+        const std::uint64_t micros = now();
+        std::scoped_lock lock(mtx);
+        events.push_back({'E', threadNumber(), micros, {}, {}, {}, std::move(args)});
+    }
+
+    void TraceRecorder::write(const std::filesystem::path& path) const {
+        std::scoped_lock lock(mtx);
+        std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        // Name the tracks first, so they read "main", "worker 1", ... instead of bare numbers.
+        for (std::uint32_t t = 0; t < threads.size(); ++t) {
+            out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + std::to_string(t) +
+                   ",\"args\":{\"name\":\"" + (t == 0 ? std::string("main") : "worker " + std::to_string(t)) + "\"}},\n";
+        }
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            const Event& e = events[i];
+            out += "{\"ph\":\"";
+            out += e.phase;
+            out += "\",\"pid\":1,\"tid\":" + std::to_string(e.thread) + ",\"ts\":" + std::to_string(e.micros);
+            if (e.phase == 'B') {
+                out += ",\"cat\":";
+                appendJsonString(out, e.category);
+                out += ",\"name\":";
+                appendJsonString(out, e.name);
+                out += ",\"args\":{\"file\":";
+                appendJsonString(out, e.file);
+                out += '}';
+            } else if (!e.args.empty()) {
+                out += ",\"args\":{";
+                for (std::size_t a = 0; a < e.args.size(); ++a) {
+                    if (a > 0) out += ',';
+                    appendJsonString(out, e.args[a].first);
+                    out += ':' + std::to_string(e.args[a].second);
+                }
+                out += '}';
+            }
+            out += i + 1 < events.size() ? "},\n" : "}\n";
+        }
+        out += "]}\n";
+        writeFileAtomically(path, out);
+    }
+
+    TraceSpan::TraceSpan(TraceRecorder* recorder, const std::string_view category, const std::string_view name,
+                         const std::string_view file) : recorder(recorder) {
+        if (recorder) recorder->begin(category, name, file);
+    }
+
+    TraceSpan::~TraceSpan() {
+        if (recorder) recorder->end(std::move(args));
+    }
+}
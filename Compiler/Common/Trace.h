@@ -0,0 +1,109 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_TRACE_H
+#define NAND2TETRIS_TRACE_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief A counter attached to the end of a traced span (e.g. bytes read, tokens, VM commands).
+     */
+    using TraceArg = std::pair<const char*, std::uint64_t>;
+
+    /**
+     * @brief Records a timeline of the build (--trace) in the Chrome trace event format.
+     *
+     * Each span becomes a begin/end event pair on the thread that ran it, so the file opens in Perfetto
+     * or chrome://tracing with one track per worker. Threads are numbered in the order they first record
+     * something; the thread that created the recorder is number 0 and named "main".
+     *
+     * Safe to use from any number of threads. Recording takes a lock, which is fine at a few events per
+     * file and subroutine task.
+     */
+    class TraceRecorder {
+        public:
+            TraceRecorder();
+
+            /**
+             * @brief Opens a span on the calling thread.
+             *
+             * @param category The phase ("parse", "analyse", "codegen"), shown and filterable as the category.
+             * @param name The title of the span, typically the file name.
+             * @param file The full path of the file, kept as an argument of the span.
+             */
+            void begin(std::string_view category, std::string_view name, std::string_view file);
+
+            /**
+             * @brief Closes the innermost open span of the calling thread.
+             *
+             * @param args Counters for the span; Perfetto shows them together with those of begin().
+             */
+            void end(std::vector<TraceArg> args = {});
+
+            /**
+             * @brief Writes every event recorded so far as a JSON trace file.
+             *
+             * @throws std::runtime_error If the file cannot be written.
+             */
+            void write(const std::filesystem::path& path) const;
+
+        private:
+            struct Event {
+                char phase;             ///< 'B' or 'E'.
+                std::uint32_t thread;
+                std::uint64_t micros;   ///< Since the recorder was created.
+                std::string category;   ///< Begin events only.
+                std::string name;       ///< Begin events only.
+                std::string file;       ///< Begin events only.
+                std::vector<TraceArg> args;
+            };
+
+            std::chrono::steady_clock::time_point origin;
+            mutable std::mutex mtx;
+            std::vector<Event> events;
+            std::unordered_map<std::thread::id, std::uint32_t> threads;
+
+            std::uint64_t now() const;
+            std::uint32_t threadNumber(); ///< Caller holds mtx.
+    };
+
+    /**
+     * @brief A span that ends when it goes out of scope, also when an exception passes through.
+     *
+     * Does nothing without a recorder, so call sites need no check of their own.
+     */
+    class TraceSpan {
+        public:
+            TraceSpan(TraceRecorder* recorder, std::string_view category, std::string_view name, std::string_view file);
+            ~TraceSpan();
+
+            TraceSpan(const TraceSpan&) = delete;
+            TraceSpan& operator=(const TraceSpan&) = delete;
+
+            /**
+             * @brief Adds a counter to the end event.
+             */
+            void set(const char* key, const std::uint64_t value) {
+                if (recorder) args.emplace_back(key, value);
+            }
+
+        private:
+            TraceRecorder* recorder;
+            std::vector<TraceArg> args;
+    };
+}
+
+#endif //NAND2TETRIS_TRACE_H
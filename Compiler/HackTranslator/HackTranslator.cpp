@@ -0,0 +1,366 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "HackTranslator.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <unordered_set>
+
+namespace nand2tetris::jack {
+
+	namespace {
+		// The shared routines. Each call site loads its return address into D and jumps to one of them.
+		//
+		// $CALL expects the callee's address in R13 and the argument count in R14, pushes the frame
+		// (return address, LCL, ARG, THIS, THAT), repositions ARG and LCL and jumps to the callee.
+		// $RETURN is the whole of `return`. $EQ, $GT and $LT replace the two topmost values with the
+		// result of comparing them (-1 or 0) and return to the address kept in R15; $GT and $LT also
+		// leave the result in D.
+		constexpr std::string_view BOOTSTRAP =
+			"@256\nD=A\n@SP\nM=D\n"
+			"@Sys.init\nD=A\n@R13\nM=D\n@R14\nM=0\n@$bootstrap.end\nD=A\n@$CALL\n0;JMP\n"
+			"($bootstrap.end)\n@$bootstrap.end\n0;JMP\n";
+
+		constexpr std::string_view CALL =
+			"($CALL)\n"
+			"@SP\nA=M\nM=D\n"
+			"@LCL\nD=M\n@SP\nAM=M+1\nM=D\n"
+			"@ARG\nD=M\n@SP\nAM=M+1\nM=D\n"
+			"@THIS\nD=M\n@SP\nAM=M+1\nM=D\n"
+			"@THAT\nD=M\n@SP\nAM=M+1\nM=D\n"
+			"@SP\nMD=M+1\n@LCL\nM=D\n"
+			"@R14\nD=D-M\n@5\nD=D-A\n@ARG\nM=D\n"
+			"@R13\nA=M\n0;JMP\n";
+
+		constexpr std::string_view RETURN =
+			"($RETURN)\n"
+			"@5\nD=A\n@LCL\nA=M-D\nD=M\n@R13\nM=D\n"
+			"@SP\nAM=M-1\nD=M\n@ARG\nA=M\nM=D\n"
+			"D=A+1\n@SP\nM=D\n"
+			"@LCL\nAM=M-1\nD=M\n@THAT\nM=D\n"
+			"@LCL\nAM=M-1\nD=M\n@THIS\nM=D\n"
+			"@LCL\nAM=M-1\nD=M\n@ARG\nM=D\n"
+			"@LCL\nA=M-1\nD=M\n@LCL\nM=D\n"
+			"@R13\nA=M\n0;JMP\n";
+
+		void appendComparison(std::string& out, const std::string_view name, const std::string_view jump) {
+			const std::string trueLabel = "$" + std::string(name) + ".true";
+			out += "($";
+			out += name;
+			out += ")\n@R15\nM=D\n@SP\nAM=M-1\nD=M\nA=A-1\nD=M-D\nM=-1\n@";
+			out += trueLabel;
+			out += "\nD;";
+			out += jump;
+			out += "\n@SP\nA=M-1\nM=0\n(";
+			out += trueLabel;
+			out += ")\n@R15\nA=M\n0;JMP\n";
+		}
+
+		// x - y overflows when x and y have different signs (e.g. -30000 < 30000), so the sign of x
+		// decides those cases and only same-sign operands are subtracted. `negativeFirst` is the result
+		// when x is negative and y is not: true for LT, false for GT.
+		void appendOrdering(std::string& out, const std::string_view name, const std::string_view jump,
+		                    const bool negativeFirst) {
+			const std::string prefix = "$" + std::string(name);
+			const std::string trueLabel = prefix + ".true";
+			const std::string falseLabel = prefix + ".false";
+			out += "(" + prefix + ")\n@R15\nM=D\n@SP\nAM=M-1\nD=M\n@R13\nM=D\n@SP\nA=M-1\nD=M\n";
+			out += "@" + prefix + ".xneg\nD;JLT\n";
+			out += "@R13\nD=M\n@" + (negativeFirst ? falseLabel : trueLabel) + "\nD;JLT\n";
+			out += "@" + prefix + ".same\n0;JMP\n";
+			out += "(" + prefix + ".xneg)\n@R13\nD=M\n@" + (negativeFirst ? trueLabel : falseLabel) + "\nD;JGE\n";
+			out += "(" + prefix + ".same)\n@SP\nA=M-1\nD=M\n@R13\nD=D-M\n@" + trueLabel + "\nD;" + std::string(jump) + "\n";
+			out += "(" + falseLabel + ")\nD=0\n@" + prefix + ".end\n0;JMP\n";
+			out += "(" + trueLabel + ")\nD=-1\n";
+			out += "(" + prefix + ".end)\n@SP\nA=M-1\nM=D\n@R15\nA=M\n0;JMP\n";
+		}
+
+		// Indexed by Segment; the symbol holding the base address, for the segments that have one.
+		constexpr std::string_view BASE_SYMBOL[] = {"", "ARG", "LCL", "", "THIS", "THAT", "", ""};
+
+		// Indexed by Command, for EQ, GT and LT: the shared routine.
+		constexpr std::string_view COMPARE_ROUTINE[] = {"$EQ", "$GT", "$LT"};
+
+		bool isComparison(const VMInstruction& in) {
+			return in.is(Command::EQ) || in.is(Command::GT) || in.is(Command::LT);
+		}
+
+		int comparisonIndex(const Command command) {
+			return static_cast<int>(command) - static_cast<int>(Command::EQ);
+		}
+
+		// Translates one class; holds what the instructions are relative to.
+		class ClassTranslator {
+			public:
+				ClassTranslator(const VMCode& code, const std::string_view fileName) : code(code), fileName(fileName) {
+					out.reserve(code.instructions.size() * 24);
+				}
+
+				std::string run() {
+					const std::vector<VMInstruction>& ins = code.instructions;
+					for (std::size_t i = 0; i < ins.size(); ++i) {
+						const VMInstruction& in = ins[i];
+						// A comparison only feeding an if-goto (optionally through a `not`) needs no boolean.
+						if (isComparison(in)) {
+							const bool negated = i + 2 < ins.size() && ins[i + 1].is(Command::NOT) && ins[i + 2].is(VMOp::IF_GOTO);
+							if (negated || (i + 1 < ins.size() && ins[i + 1].is(VMOp::IF_GOTO))) {
+								const std::size_t jump = negated ? i + 2 : i + 1;
+								compareAndJump(in.command, ins[jump].symbol, negated);
+								i = jump;
+								continue;
+							}
+						}
+						translate(in);
+					}
+					return std::move(out);
+				}
+
+			private:
+				const VMCode& code;
+				std::string_view fileName;
+				std::string_view function; ///< The function being translated, which scopes its labels.
+				std::string out;
+				int returnLabels = 0;
+
+				void append(const int value) {
+					char digits[16];
+					const auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+					out.append(digits, end);
+				}
+
+				void label(const std::uint32_t symbol) {
+					out += function;
+					out += '$';
+					out += code.symbolText(symbol);
+				}
+
+				// Loads a fresh return address into D and jumps to `routine`; the code returns right after.
+				void jumpAndReturn(const std::string_view routine) {
+					const int id = returnLabels++;
+					out += '@';
+					out += function;
+					out += "$ret.";
+					append(id);
+					out += "\nD=A\n@";
+					out += routine;
+					out += "\n0;JMP\n(";
+					out += function;
+					out += "$ret.";
+					append(id);
+					out += ")\n";
+				}
+
+				void pushD() {
+					out += "@SP\nAM=M+1\nA=A-1\nM=D\n";
+				}
+
+				// Puts A on the register or static variable a fixed segment entry lives in.
+				void fixedAddress(const Segment segment, const int index) {
+					out += '@';
+					if (segment == Segment::STATIC) {
+						out += fileName;
+						out += '.';
+						append(index);
+					} else {
+						append(index + (segment == Segment::POINTER ? 3 : 5));
+					}
+					out += '\n';
+				}
+
+				void push(const Segment segment, const int index) {
+					if (segment == Segment::CONST) {
+						if (index == 0 || index == 1) {
+							out += index == 0 ? "@SP\nAM=M+1\nA=A-1\nM=0\n" : "@SP\nAM=M+1\nA=A-1\nM=1\n";
+							return;
+						}
+						out += '@';
+						append(index);
+						out += "\nD=A\n";
+					} else if (BASE_SYMBOL[static_cast<int>(segment)].empty()) {
+						fixedAddress(segment, index);
+						out += "D=M\n";
+					} else {
+						out += '@';
+						if (index <= 1) {
+							out += BASE_SYMBOL[static_cast<int>(segment)];
+							out += index == 0 ? "\nA=M\nD=M\n" : "\nA=M+1\nD=M\n";
+						} else {
+							append(index);
+							out += "\nD=A\n@";
+							out += BASE_SYMBOL[static_cast<int>(segment)];
+							out += "\nA=D+M\nD=M\n";
+						}
+					}
+					pushD();
+				}
+
+				void pop(const Segment segment, const int index) {
+					if (segment == Segment::CONST) {
+						out += "@SP\nM=M-1\n"; // Not something Jack generates; the value is dropped.
+						return;
+					}
+					if (BASE_SYMBOL[static_cast<int>(segment)].empty()) {
+						out += "@SP\nAM=M-1\nD=M\n";
+						fixedAddress(segment, index);
+						out += "M=D\n";
+						return;
+					}
+					const std::string_view base = BASE_SYMBOL[static_cast<int>(segment)];
+					// Stepping A up is shorter than computing the address in R13 for the first few slots.
+					if (index <= 4) {
+						out += "@SP\nAM=M-1\nD=M\n@";
+						out += base;
+						out += "\nA=M\n";
+						for (int step = 0; step < index; ++step) out += "A=A+1\n";
+						out += "M=D\n";
+						return;
+					}
+					out += '@';
+					append(index);
+					out += "\nD=A\n@";
+					out += base;
+					out += "\nD=D+M\n@R13\nM=D\n@SP\nAM=M-1\nD=M\n@R13\nA=M\nM=D\n";
+				}
+
+				void arithmetic(const Command command) {
+					switch (command) {
+						case Command::ADD: out += "@SP\nAM=M-1\nD=M\nA=A-1\nM=D+M\n"; break;
+						case Command::SUB: out += "@SP\nAM=M-1\nD=M\nA=A-1\nM=M-D\n"; break;
+						case Command::AND: out += "@SP\nAM=M-1\nD=M\nA=A-1\nM=D&M\n"; break;
+						case Command::OR:  out += "@SP\nAM=M-1\nD=M\nA=A-1\nM=D|M\n"; break;
+						case Command::NEG: out += "@SP\nA=M-1\nM=-M\n"; break;
+						case Command::NOT: out += "@SP\nA=M-1\nM=!M\n"; break;
+						case Command::EQ:
+						case Command::GT:
+						case Command::LT:
+							jumpAndReturn(COMPARE_ROUTINE[comparisonIndex(command)]);
+							break;
+					}
+				}
+
+				void compareAndJump(const Command command, const std::uint32_t target, const bool negated) {
+					if (command == Command::EQ) {
+						// x - y is 0 exactly when x = y, overflow or not.
+						out += "@SP\nAM=M-1\nD=M\n@SP\nAM=M-1\nD=M-D\n@";
+						label(target);
+						out += "\nD;";
+						out += negated ? "JNE" : "JEQ";
+						out += '\n';
+						return;
+					}
+					// The ordering routines leave their result in D, so only the pushed copy is dropped.
+					jumpAndReturn(COMPARE_ROUTINE[comparisonIndex(command)]);
+					out += "@SP\nAM=M-1\n@";
+					label(target);
+					out += negated ? "\nD;JEQ\n" : "\nD;JNE\n";
+				}
+
+				void call(const std::uint32_t symbol, const int nArgs) {
+					if (nArgs <= 1) {
+						out += nArgs == 0 ? "@R14\nM=0\n" : "@R14\nM=1\n";
+					} else {
+						out += '@';
+						append(nArgs);
+						out += "\nD=A\n@R14\nM=D\n";
+					}
+					out += '@';
+					out += code.symbolText(symbol);
+					out += "\nD=A\n@R13\nM=D\n";
+					jumpAndReturn("$CALL");
+				}
+
+				void functionEntry(const std::uint32_t symbol, const int nLocals) {
+					function = code.symbolText(symbol);
+					returnLabels = 0;
+					out += '(';
+					out += function;
+					out += ")\n";
+					if (nLocals == 0) return;
+					out += "@SP\nA=M\n";
+					for (int local = 0; local < nLocals; ++local) out += local == 0 ? "M=0\n" : "A=A+1\nM=0\n";
+					out += "D=A+1\n@SP\nM=D\n";
+				}
+
+				void translate(const VMInstruction& in) {
+					switch (in.op) {
+						case VMOp::PUSH: push(in.segment, in.value); break;
+						case VMOp::POP: pop(in.segment, in.value); break;
+						case VMOp::ARITHMETIC: arithmetic(in.command); break;
+						case VMOp::LABEL:
+							out += '(';
+							label(in.symbol);
+							out += ")\n";
+							break;
+						case VMOp::GOTO:
+							out += '@';
+							label(in.symbol);
+							out += "\n0;JMP\n";
+							break;
+						case VMOp::IF_GOTO:
+							out += "@SP\nAM=M-1\nD=M\n@";
+							label(in.symbol);
+							out += "\nD;JNE\n";
+							break;
+						case VMOp::CALL: call(in.symbol, in.value); break;
+						case VMOp::FUNCTION: functionEntry(in.symbol, in.value); break;
+						case VMOp::RETURN: out += "@$RETURN\n0;JMP\n"; break;
+					}
+				}
+		};
+	}
+
+	std::string HackTranslator::runtime() {
+		std::string out;
+		out += BOOTSTRAP;
+		out += CALL;
+		out += RETURN;
+		appendComparison(out, "EQ", "JEQ");
+		appendOrdering(out, "GT", "JGT", false);
+		appendOrdering(out, "LT", "JLT", true);
+		return out;
+	}
+
+	std::string HackTranslator::translate(const VMCode& code, const std::string_view fileName) {
+		return ClassTranslator(code, fileName).run();
+	}
+
+	// Function names are the only symbols with a '.' and no '$' that do not end in a static's index:
+	// labels and return addresses always contain a '$'.
+	std::vector<std::string> HackTranslator::undefinedFunctions(const std::string_view program) {
+		std::unordered_set<std::string_view> defined;
+		std::vector<std::string_view> referenced;
+		std::size_t at = 0;
+		while (at < program.size()) {
+			std::size_t end = program.find('\n', at);
+			if (end == std::string_view::npos) end = program.size();
+			const std::string_view line = program.substr(at, end - at);
+			at = end + 1;
+			if (line.size() < 2 || (line[0] != '@' && line[0] != '(')) continue;
+			const std::string_view name = line[0] == '(' ? line.substr(1, line.size() - 2) : line.substr(1);
+			const std::size_t dot = name.rfind('.');
+			if (dot == std::string_view::npos || dot + 1 >= name.size() || name.find('$') != std::string_view::npos ||
+				std::isdigit(static_cast<unsigned char>(name[dot + 1]))) continue;
+			if (line[0] == '(') {
+				defined.insert(name);
+			} else {
+				referenced.push_back(name);
+			}
+		}
+
+		std::vector<std::string> undefined;
+		std::unordered_set<std::string_view> seen;
+		for (const std::string_view name : referenced) {
+			if (!defined.count(name) && seen.insert(name).second) undefined.emplace_back(name);
+		}
+		return undefined;
+	}
+
+	std::size_t HackTranslator::instructionCount(const std::string_view program) {
+		const auto lines = static_cast<std::size_t>(std::count(program.begin(), program.end(), '\n'));
+		std::size_t labels = program.empty() || program[0] != '(' ? 0 : 1;
+		for (std::size_t at = program.find("\n("); at != std::string_view::npos; at = program.find("\n(", at + 1)) ++labels;
+		return lines - labels;
+	}
+}
@@ -0,0 +1,62 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_HACK_TRANSLATOR_H
+#define NAND2TETRIS_HACK_TRANSLATOR_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../VMWriter/VMCode.h"
+
+namespace nand2tetris::jack {
+
+	/**
+	 * @brief Lowers VM code straight to Hack assembly (--emit=asm), without going through .vm text.
+	 *
+	 * The output follows the nand2tetris VM translator's conventions: statics are `File.i`, labels are
+	 * scoped as `Function$label`, and return addresses as `Function$ret.N`. To keep the code small, the
+	 * frame setup of `call`, the frame teardown of `return` and the three comparisons are not inlined but
+	 * jumped to, once per program, by runtime(). An `eq` that is directly followed by an if-goto becomes
+	 * a single conditional jump instead; `gt` and `lt` compare the signs first, since subtracting
+	 * operands of different signs can overflow, and so always go through their routine.
+	 *
+	 * Translating a class only reads its VMCode, so classes can be translated in parallel and then
+	 * concatenated in any order after runtime().
+	 */
+	class HackTranslator {
+		public:
+			/// Instructions the Hack ROM holds; addresses beyond it cannot be loaded into A.
+			static constexpr std::size_t ROM_SIZE = 32768;
+
+			/**
+			 * @brief The start of every program: the bootstrap (SP = 256, call Sys.init) followed by the
+			 *        shared call, return and comparison routines.
+			 */
+			static std::string runtime();
+
+			/**
+			 * @brief Translates the VM code of one class.
+			 *
+			 * @param fileName Names the class's static variables (`fileName.i`); the class name.
+			 */
+			static std::string translate(const VMCode& code, std::string_view fileName);
+
+			/**
+			 * @brief The functions a linked program refers to but does not define, in order of first use.
+			 *
+			 * These are typically OS classes whose sources were not compiled with the program: the VM
+			 * emulator provides them built in, a Hack computer does not.
+			 */
+			static std::vector<std::string> undefinedFunctions(std::string_view program);
+
+			/**
+			 * @brief The number of instructions in a program, i.e. its lines that are not labels.
+			 */
+			static std::size_t instructionCount(std::string_view program);
+	};
+}
+
+#endif //NAND2TETRIS_HACK_TRANSLATOR_H
@@ -0,0 +1,147 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "ProgramLinker.h"
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <system_error>
+#include "../Common/FileIO.h"
+#include "../Common/Hash.h"
+
+namespace nand2tetris::jack {
+
+    namespace {
+        constexpr std::string_view INDEX_HEADER = "jack-link 1";
+
+        constexpr std::string_view PUSH_STATIC = "push static ";
+        constexpr std::string_view POP_STATIC = "pop static ";
+
+        bool startsWith(const std::string_view line, const std::string_view prefix) {
+            return line.substr(0, prefix.size()) == prefix;
+        }
+
+        // Same parts at the same places, so changed classes can be overwritten where they are.
+        bool sameLayout(const std::vector<LinkedPart>& a, const std::vector<LinkedPart>& b) {
+            return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const LinkedPart& x, const LinkedPart& y) {
+                return x.name == y.name && x.offset == y.offset && x.size == y.size;
+            });
+        }
+
+        // Overwrites the given parts of an existing file. False if that fails.
+        bool patchParts(const std::filesystem::path& path, const std::string& text,
+                        const std::vector<const LinkedPart*>& changed) {
+            std::FILE* file = std::fopen(path.string().c_str(), "r+b");
+            if (!file) return false;
+            std::setvbuf(file, nullptr, _IONBF, 0);
+            bool written = true;
+            for (const LinkedPart* part : changed) {
+                written = std::fseek(file, static_cast<long>(part->offset), SEEK_SET) == 0 &&
+                          std::fwrite(text.data() + part->offset, 1, part->size, file) == part->size;
+                if (!written) break;
+            }
+            return std::fclose(file) == 0 && written;
+        }
+    }
+
+    void ProgramLinker::append(const std::string_view name, const std::string_view code) {
+        const std::size_t offset = text.size();
+        text.append(code);
+        addPart(name, offset);
+    }
+
+    void ProgramLinker::appendVm(const std::string_view name, const std::string_view code) {
+        const std::size_t offset = text.size();
+        const std::size_t base = statics;
+        std::size_t used = 0;
+        std::size_t start = 0;
+        while (start < code.size()) {
+            std::size_t end = code.find('\n', start);
+            end = end == std::string_view::npos ? code.size() : end + 1;
+            const std::string_view line = code.substr(start, end - start);
+            start = end;
+
+            const std::string_view prefix = startsWith(line, PUSH_STATIC) ? PUSH_STATIC
+                                            : startsWith(line, POP_STATIC) ? POP_STATIC
+                                                                           : std::string_view();
+            if (prefix.empty()) {
+                text.append(line);
+                continue;
+            }
+            std::size_t i = prefix.size();
+            std::size_t value = 0;
+            while (i < line.size() && line[i] >= '0' && line[i] <= '9') value = value * 10 + (line[i++] - '0');
+            used = std::max(used, value + 1);
+            text.append(prefix);
+            text.append(std::to_string(base + value));
+            text.append(line.substr(i));
+        }
+        statics += used;
+        addPart(name, offset);
+    }
+
+    void ProgramLinker::addPart(const std::string_view name, const std::size_t offset) {
+        const std::string_view code = std::string_view(text).substr(offset);
+        index.push_back({std::string(name), offset, code.size(), fnv1a(code)});
+    }
+
+    std::string ProgramLinker::renderIndex() const {
+        std::ostringstream out;
+        out << INDEX_HEADER << '\n';
+        for (const LinkedPart& part : index) {
+            out << part.name << ' ' << part.offset << ' ' << part.size << ' ' << std::hex << part.hash << std::dec << '\n';
+        }
+        return out.str();
+    }
+
+    ProgramLinker::WriteResult ProgramLinker::write(const std::filesystem::path& path) const {
+        const std::filesystem::path indexPath = indexPathOf(path);
+        const std::optional<std::vector<LinkedPart>> previous = readIndex(indexPath);
+        std::error_code ec;
+        const std::uintmax_t existingSize = std::filesystem::file_size(path, ec);
+
+        if (previous && !ec && existingSize == text.size() && sameLayout(*previous, index)) {
+            std::vector<const LinkedPart*> changed;
+            for (std::size_t i = 0; i < index.size(); ++i) {
+                if (index[i].hash != (*previous)[i].hash) changed.push_back(&index[i]);
+            }
+            if (changed.empty()) return {Outcome::UNCHANGED, 0};
+
+            // Without an index a half-patched program is never taken for up to date.
+            std::filesystem::remove(indexPath, ec);
+            if (patchParts(path, text, changed)) {
+                writeFileAtomically(indexPath, renderIndex());
+                return {Outcome::PATCHED, changed.size()};
+            }
+        }
+
+        std::filesystem::remove(indexPath, ec);
+        writeFileAtomically(path, text);
+        writeFileAtomically(indexPath, renderIndex());
+        return {Outcome::WRITTEN, index.size()};
+    }
+
+    std::filesystem::path ProgramLinker::indexPathOf(const std::filesystem::path& path) {
+        std::filesystem::path indexPath = path;
+        indexPath += ".index";
+        return indexPath;
+    }
+
+    std::optional<std::vector<LinkedPart>> ProgramLinker::readIndex(const std::filesystem::path& path) {
+        const std::optional<std::string> contents = readFile(path);
+        if (!contents) return std::nullopt;
+
+        std::istringstream in(*contents);
+        std::string header;
+        if (!std::getline(in, header) || header != INDEX_HEADER) return std::nullopt;
+
+        std::vector<LinkedPart> parts;
+        LinkedPart part;
+        while (in >> part.name >> part.offset >> part.size >> std::hex >> part.hash >> std::dec) {
+            parts.push_back(part);
+        }
+        if (!in.eof()) return std::nullopt;
+        return parts;
+    }
+}
@@ -0,0 +1,110 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_PROGRAM_LINKER_H
+#define NAND2TETRIS_PROGRAM_LINKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief Where one class sits in a linked program, as recorded in the program's index.
+     */
+    struct LinkedPart {
+        std::string name;       ///< The class, or ProgramLinker::RUNTIME_PART for the code in front of the classes.
+        std::size_t offset = 0; ///< Byte offset in the program.
+        std::size_t size = 0;   ///< Bytes of code.
+        std::uint64_t hash = 0; ///< fnv1a of the code.
+    };
+
+    /**
+     * @brief Joins the code of every class into one program file (--output, --emit=asm), with an index.
+     *
+     * Parts are appended in the order given; the caller sorts them so the program does not depend on
+     * which worker finished first. The index, `<program>.index`, lists each part's offset, size and hash,
+     * so a relink can tell what changed without reading the program: an identical program is not written
+     * at all, one whose classes all kept their size only has the changed classes rewritten in place, and
+     * anything else replaces the file in one write.
+     */
+    class ProgramLinker {
+        public:
+            /// The name of the part that is not a class, e.g. the bootstrap and runtime of a Hack program.
+            static constexpr std::string_view RUNTIME_PART = "(runtime)";
+
+            /// Statics live in RAM 16-255, whatever the number of classes.
+            static constexpr std::size_t MAX_STATICS = 240;
+
+            enum class Outcome {WRITTEN, PATCHED, UNCHANGED};
+
+            struct WriteResult {
+                Outcome outcome = Outcome::WRITTEN;
+                std::size_t partsWritten = 0;
+            };
+
+            /**
+             * @brief Appends code as it is, e.g. Hack assembly, which names its statics per class already.
+             */
+            void append(std::string_view name, std::string_view code);
+
+            /**
+             * @brief Appends the .vm code of a class, renumbering its static variables after those of the
+             *        classes before it.
+             *
+             * The VM emulator scopes statics by file, so in one .vm file every class would otherwise share
+             * `static 0, 1, ...`.
+             */
+            void appendVm(std::string_view name, std::string_view code);
+
+            /**
+             * @brief The program linked so far.
+             */
+            const std::string& program() const { return text; }
+
+            /**
+             * @brief The parts appended so far, in program order.
+             */
+            const std::vector<LinkedPart>& parts() const { return index; }
+
+            /**
+             * @brief The number of static variables the .vm parts use together.
+             */
+            std::size_t staticCount() const { return statics; }
+
+            /**
+             * @brief Writes the program to `path` and its index next to it, reusing what is already there.
+             *
+             * @throws std::runtime_error If either file cannot be written.
+             */
+            WriteResult write(const std::filesystem::path& path) const;
+
+            /**
+             * @brief The index file of a program.
+             */
+            static std::filesystem::path indexPathOf(const std::filesystem::path& path);
+
+            /**
+             * @brief Reads the index of a program.
+             *
+             * @return The parts, or nothing if there is no index or it cannot be read.
+             */
+            static std::optional<std::vector<LinkedPart>> readIndex(const std::filesystem::path& path);
+
+        private:
+            void addPart(std::string_view name, std::size_t offset);
+            std::string renderIndex() const;
+
+            std::string text;
+            std::vector<LinkedPart> index;
+            std::size_t statics = 0;
+    };
+}
+
+#endif //NAND2TETRIS_PROGRAM_LINKER_H
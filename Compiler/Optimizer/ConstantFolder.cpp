@@ -0,0 +1,306 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "ConstantFolder.h"
+#include <vector>
+
+namespace nand2tetris::jack {
+
+    namespace {
+        // At most 14 doublings and 14 additions, still shorter to run than the loop of Math.multiply.
+        constexpr int MAX_DOUBLING_MULTIPLIER = 1 << 14;
+
+        std::int16_t wrap(const int value) {
+            return static_cast<std::int16_t>(static_cast<std::uint16_t>(value));
+        }
+    }
+
+    ConstantFolder::ConstantFolder(const GlobalRegistry& registry, Arena& arena)
+        : arena(arena), osMath(!registry.isDeclared(Interner::seeded("Math")) || registry.isOsSource(Interner::seeded("Math"))) {}
+
+    void ConstantFolder::foldClass(ClassNode& node) {
+        for (SubroutineDecNode* sub : node.subroutineDecs) {
+            foldSubroutine(*sub);
+        }
+    }
+
+    void ConstantFolder::foldSubroutine(SubroutineDecNode& node) {
+        foldStatements(node.statements);
+    }
+
+    void ConstantFolder::foldStatements(const NodeList<StatementNode>& statements) {
+        for (StatementNode* stmt : statements) {
+            switch (stmt->getType()) {
+                case ASTNodeType::LET_STATEMENT: {
+                    auto& let = static_cast<LetStatementNode&>(*stmt); // NOLINT(*-pro-type-static-cast-downcast)
+                    if (let.indexExpr) let.indexExpr = fold(let.indexExpr);
+                    let.valueExpr = fold(let.valueExpr);
+                    break;
+                }
+                case ASTNodeType::IF_STATEMENT: {
+                    auto& ifStmt = static_cast<IfStatementNode&>(*stmt); // NOLINT(*-pro-type-static-cast-downcast)
+                    ifStmt.condition = fold(ifStmt.condition);
+                    foldStatements(ifStmt.ifStatements);
+                    foldStatements(ifStmt.elseStatements);
+                    break;
+                }
+                case ASTNodeType::WHILE_STATEMENT: {
+                    auto& whileStmt = static_cast<WhileStatementNode&>(*stmt); // NOLINT(*-pro-type-static-cast-downcast)
+                    whileStmt.condition = fold(whileStmt.condition);
+                    foldStatements(whileStmt.body);
+                    break;
+                }
+                case ASTNodeType::DO_STATEMENT:
+                    foldArguments(*static_cast<DoStatementNode&>(*stmt).callExpression); // NOLINT(*-pro-type-static-cast-downcast)
+                    break;
+                case ASTNodeType::RETURN_STATEMENT: {
+                    auto& ret = static_cast<ReturnStatementNode&>(*stmt); // NOLINT(*-pro-type-static-cast-downcast)
+                    if (ret.expression) ret.expression = fold(ret.expression);
+                    break;
+                }
+                default: break;
+            }
+        }
+    }
+
+    ExpressionNode* ConstantFolder::fold(ExpressionNode* node) {
+        switch (node->getType()) {
+            case ASTNodeType::BINARY_OP: {
+                auto& bin = static_cast<BinaryOpNode&>(*node); // NOLINT(*-pro-type-static-cast-downcast)
+                bin.left = fold(bin.left);
+                bin.right = fold(bin.right);
+                return foldBinary(bin);
+            }
+            case ASTNodeType::UNARY_OP: {
+                auto& un = static_cast<UnaryOpNode&>(*node); // NOLINT(*-pro-type-static-cast-downcast)
+                un.term = fold(un.term);
+                return foldUnary(un);
+            }
+            case ASTNodeType::IDENTIFIER: {
+                auto& id = static_cast<IdentifierNode&>(*node); // NOLINT(*-pro-type-static-cast-downcast)
+                if (id.indexExpr) id.indexExpr = fold(id.indexExpr);
+                return node;
+            }
+            case ASTNodeType::SUBROUTINE_CALL:
+                foldArguments(static_cast<CallNode&>(*node)); // NOLINT(*-pro-type-static-cast-downcast)
+                return node;
+            default:
+                return node;
+        }
+    }
+
+    void ConstantFolder::foldArguments(CallNode& call) {
+        std::vector<ExpressionNode*> folded;
+        folded.reserve(call.arguments.size());
+        bool changed = false;
+        for (ExpressionNode* arg : call.arguments) {
+            folded.push_back(fold(arg));
+            changed |= folded.back() != arg;
+        }
+        if (changed) call.arguments = arena.copyOf(folded);
+    }
+
+    ExpressionNode* ConstantFolder::foldUnary(UnaryOpNode& node) {
+        std::int16_t value;
+        if (constantValue(node.term, value)) {
+            if (isCanonical(&node)) return &node;
+            return makeConstant(node.op == '-' ? wrap(-value) : wrap(~value), node);
+        }
+        // --x and ~~x
+        if (node.term->getType() == ASTNodeType::UNARY_OP) {
+            const auto& inner = static_cast<const UnaryOpNode&>(*node.term); // NOLINT(*-pro-type-static-cast-downcast)
+            if (inner.op == node.op) return inner.term;
+        }
+        return &node;
+    }
+
+    ExpressionNode* ConstantFolder::foldBinary(BinaryOpNode& node) {
+        std::int16_t l = 0, r = 0;
+        const bool leftConstant = constantValue(node.left, l);
+        const bool rightConstant = constantValue(node.right, r);
+
+        if (leftConstant && rightConstant) {
+            int result;
+            switch (node.op) {
+                case '+': result = l + r; break;
+                case '-': result = l - r; break;
+                case '&': result = l & r; break;
+                case '|': result = l | r; break;
+                case '<': result = l < r ? -1 : 0; break;
+                case '>': result = l > r ? -1 : 0; break;
+                case '=': result = l == r ? -1 : 0; break;
+                case '*':
+                    if (!osMath) return &node;
+                    result = l * r;
+                    break;
+                case '/':
+                    // Leave the run-time error of a division by zero (and the one overflow) to Math.divide.
+                    if (!osMath || r == 0 || (l == INT16_MIN && r == -1)) return &node;
+                    result = l / r;
+                    break;
+                default: return &node;
+            }
+            return makeConstant(wrap(result), node);
+        }
+        if (rightConstant) return foldWithConstant(node, node.left, r, true);
+        if (leftConstant) return foldWithConstant(node, node.right, l, false);
+        return &node;
+    }
+
+    ExpressionNode* ConstantFolder::foldWithConstant(BinaryOpNode& node, ExpressionNode* other, const std::int16_t value,
+                                                     const bool constantOnRight) {
+        switch (node.op) {
+            case '+':
+            case '-': {
+                if (node.op == '-' && !constantOnRight) {
+                    return value == 0 ? makeNegation(other, node) : &node;
+                }
+                const std::int16_t offset = node.op == '+' ? value : wrap(-value);
+                // Already `x + c` / `x - c` in its shortest form.
+                if (constantOnRight && value > 0 && !isOffset(other)) return &node;
+                return makeOffset(other, offset, node);
+            }
+            case '*':
+                if (!osMath) break;
+                if (value == 1) return other;
+                if (value == -1) return makeNegation(other, node);
+                if (value == 0 && isPure(other)) return makeConstant(0, node);
+                if (isSimple(other) && value != INT16_MIN && (value < 0 ? -value : value) <= MAX_DOUBLING_MULTIPLIER) {
+                    return makeDoubling(other, value, node);
+                }
+                break;
+            case '/':
+                if (osMath && constantOnRight && value == 1) return other;
+                break;
+            case '&':
+                if (value == -1) return other;
+                if (value == 0 && isPure(other)) return makeConstant(0, node);
+                break;
+            case '|':
+                if (value == 0) return other;
+                if (value == -1 && isPure(other)) return makeConstant(-1, node);
+                break;
+            default: break;
+        }
+        return &node;
+    }
+
+    // --- Node classification ---
+
+    bool ConstantFolder::constantValue(const ExpressionNode* node, std::int16_t& value) {
+        switch (node->getType()) {
+            case ASTNodeType::INTEGER_LITERAL:
+                value = wrap(static_cast<const IntegerLiteralNode*>(node)->value); // NOLINT(*-pro-type-static-cast-downcast)
+                return true;
+            case ASTNodeType::KEYWORD_LITERAL: {
+                const Keyword keyword = static_cast<const KeywordLiteralNode*>(node)->value; // NOLINT(*-pro-type-static-cast-downcast)
+                if (keyword == Keyword::TRUE_) { value = -1; return true; }
+                if (keyword == Keyword::FALSE_ || keyword == Keyword::NULL_) { value = 0; return true; }
+                return false;
+            }
+            case ASTNodeType::UNARY_OP: {
+                const auto* un = static_cast<const UnaryOpNode*>(node); // NOLINT(*-pro-type-static-cast-downcast)
+                std::int16_t term;
+                if (!constantValue(un->term, term)) return false;
+                value = un->op == '-' ? wrap(-term) : wrap(~term);
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    // A constant already written the way makeConstant() would write it.
+    bool ConstantFolder::isCanonical(const ExpressionNode* node) {
+        if (node->getType() == ASTNodeType::INTEGER_LITERAL || node->getType() == ASTNodeType::KEYWORD_LITERAL) return true;
+        if (node->getType() != ASTNodeType::UNARY_OP) return false;
+        const auto* un = static_cast<const UnaryOpNode*>(node); // NOLINT(*-pro-type-static-cast-downcast)
+        if (un->term->getType() != ASTNodeType::INTEGER_LITERAL) return false;
+        const int k = static_cast<const IntegerLiteralNode*>(un->term)->value; // NOLINT(*-pro-type-static-cast-downcast)
+        return (un->op == '-' && k > 0) || (un->op == '~' && k == INT16_MAX);
+    }
+
+    // `x + c` or `x - c`.
+    bool ConstantFolder::isOffset(const ExpressionNode* node) {
+        if (node->getType() != ASTNodeType::BINARY_OP) return false;
+        const auto* bin = static_cast<const BinaryOpNode*>(node); // NOLINT(*-pro-type-static-cast-downcast)
+        std::int16_t value;
+        return (bin->op == '+' || bin->op == '-') && constantValue(bin->right, value);
+    }
+
+    // Evaluating the expression has no effect besides its value: no calls (including `*` and `/`) and no strings.
+    bool ConstantFolder::isPure(const ExpressionNode* node) {
+        switch (node->getType()) {
+            case ASTNodeType::INTEGER_LITERAL:
+            case ASTNodeType::KEYWORD_LITERAL:
+                return true;
+            case ASTNodeType::IDENTIFIER: {
+                const auto* id = static_cast<const IdentifierNode*>(node); // NOLINT(*-pro-type-static-cast-downcast)
+                return !id->indexExpr || isPure(id->indexExpr);
+            }
+            case ASTNodeType::UNARY_OP:
+                return isPure(static_cast<const UnaryOpNode*>(node)->term); // NOLINT(*-pro-type-static-cast-downcast)
+            case ASTNodeType::BINARY_OP: {
+                const auto* bin = static_cast<const BinaryOpNode*>(node); // NOLINT(*-pro-type-static-cast-downcast)
+                return (bin->op != '*' || bin->byDoubling) && bin->op != '/' && isPure(bin->left) && isPure(bin->right);
+            }
+            default:
+                return false;
+        }
+    }
+
+    // An operand that costs a single push, so it can be evaluated repeatedly.
+    bool ConstantFolder::isSimple(const ExpressionNode* node) {
+        if (node->getType() == ASTNodeType::IDENTIFIER) {
+            return !static_cast<const IdentifierNode*>(node)->indexExpr; // NOLINT(*-pro-type-static-cast-downcast)
+        }
+        return node->getType() == ASTNodeType::KEYWORD_LITERAL &&
+               static_cast<const KeywordLiteralNode*>(node)->value == Keyword::THIS_; // NOLINT(*-pro-type-static-cast-downcast)
+    }
+
+    // --- Node construction ---
+
+    // `push constant` only takes 0..32767, so negative values are built with `-` (or `~` for -32768).
+    ExpressionNode* ConstantFolder::makeConstant(const std::int16_t value, const Node& at) {
+        const std::uint32_t offset = at.getOffset();
+        if (value >= 0) return arena.make<IntegerLiteralNode>(value, offset);
+        if (value == INT16_MIN) {
+            return arena.make<UnaryOpNode>('~', arena.make<IntegerLiteralNode>(INT16_MAX, offset), offset);
+        }
+        return arena.make<UnaryOpNode>('-', arena.make<IntegerLiteralNode>(-value, offset), offset);
+    }
+
+    ExpressionNode* ConstantFolder::makeNegation(ExpressionNode* term, const Node& at) {
+        std::int16_t value;
+        if (constantValue(term, value)) return makeConstant(wrap(-value), at);
+        if (term->getType() == ASTNodeType::UNARY_OP) {
+            const auto* un = static_cast<const UnaryOpNode*>(term); // NOLINT(*-pro-type-static-cast-downcast)
+            if (un->op == '-') return un->term;
+        }
+        return arena.make<UnaryOpNode>('-', term, at.getOffset());
+    }
+
+    // base + offset, merged with an offset base already has: (x + c1) - c2 -> x + (c1 - c2).
+    ExpressionNode* ConstantFolder::makeOffset(ExpressionNode* base, std::int16_t offset, const Node& at) {
+        // isOffset guarantees a constant on the right; checking it anyway keeps `inner` defined.
+        std::int16_t inner = 0;
+        if (isOffset(base) && constantValue(static_cast<const BinaryOpNode*>(base)->right, inner)) { // NOLINT(*-pro-type-static-cast-downcast)
+            const auto* bin = static_cast<const BinaryOpNode*>(base); // NOLINT(*-pro-type-static-cast-downcast)
+            offset = wrap((bin->op == '+' ? inner : -inner) + offset);
+            base = bin->left;
+        }
+        if (offset == 0) return base;
+        if (offset < 0 && offset != INT16_MIN) {
+            return arena.make<BinaryOpNode>(base, '-', makeConstant(wrap(-offset), at), at.getOffset());
+        }
+        return arena.make<BinaryOpNode>(base, '+', makeConstant(offset, at), at.getOffset());
+    }
+
+    // operand * multiplier, with the operand on the left, marked for CodeGenerator::compileDoubling().
+    ExpressionNode* ConstantFolder::makeDoubling(ExpressionNode* operand, const std::int16_t multiplier, const Node& at) {
+        auto* product = arena.make<BinaryOpNode>(operand, '*', makeConstant(multiplier, at), at.getOffset());
+        product->byDoubling = true;
+        return product;
+    }
+}
@@ -0,0 +1,70 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_CONSTANT_FOLDER_H
+#define NAND2TETRIS_CONSTANT_FOLDER_H
+
+#include <cstdint>
+#include "../Common/Arena.h"
+#include "../Parser/AST.h"
+#include "../SemanticAnalyser/GlobalRegistry.h"
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief Simplifies the expressions of an analysed class before code generation (-O1).
+     *
+     * Jack has no operator precedence: `a op b op c` always means `(a op b) op c`, and the parser already
+     * builds the tree that way, so folding bottom-up keeps the language's evaluation order. All arithmetic
+     * wraps to 16 bits like the Hack machine. The rewrites:
+     * - **Folding**: operators whose operands are constants (integer literals, `true`, `false`, `null`
+     *   and `-`/`~` applied to constants) are evaluated, and `x + c1 + c2` becomes `x + (c1 + c2)`.
+     * - **Identities**: `x + 0`, `x * 1`, `x / 1`, `x & true`, `x | 0`, `0 - x`, `x * -1`, `--x`, `~~x`,
+     *   and `x * 0` / `x & false` / `x | true` when `x` has no side effects.
+     * - **Strength reduction**: `x * c` for a variable `x` and `|c| <= 2^14` is compiled as a chain of
+     *   doublings and additions, one per bit of `c`, instead of a call to Math.multiply.
+     *
+     * `*` and `/` are only touched while Math is the OS class (built in or compiled from the OS sources),
+     * since a program may declare its own.
+     * New nodes come from the arena of the class.
+     */
+    class ConstantFolder {
+        public:
+            ConstantFolder(const GlobalRegistry& registry, Arena& arena);
+
+            /**
+             * @brief Rewrites every expression of the class in place.
+             */
+            void foldClass(ClassNode& node);
+
+            /**
+             * @brief Rewrites every expression of one analysed subroutine in place (see --single-pass).
+             */
+            void foldSubroutine(SubroutineDecNode& node);
+
+        private:
+            Arena& arena;
+            bool osMath; ///< Math is the OS class, so `*` and `/` have their arithmetic meaning.
+
+            void foldStatements(const NodeList<StatementNode>& statements);
+            ExpressionNode* fold(ExpressionNode* node);
+            ExpressionNode* foldUnary(UnaryOpNode& node);
+            ExpressionNode* foldBinary(BinaryOpNode& node);
+            ExpressionNode* foldWithConstant(BinaryOpNode& node, ExpressionNode* other, std::int16_t value, bool constantOnRight);
+            void foldArguments(CallNode& call);
+
+            static bool constantValue(const ExpressionNode* node, std::int16_t& value);
+            static bool isCanonical(const ExpressionNode* node);
+            static bool isOffset(const ExpressionNode* node);
+            static bool isPure(const ExpressionNode* node);
+            static bool isSimple(const ExpressionNode* node);
+
+            ExpressionNode* makeConstant(std::int16_t value, const Node& at);
+            ExpressionNode* makeNegation(ExpressionNode* term, const Node& at);
+            ExpressionNode* makeOffset(ExpressionNode* base, std::int16_t offset, const Node& at);
+            ExpressionNode* makeDoubling(ExpressionNode* operand, std::int16_t multiplier, const Node& at);
+    };
+}
+
+#endif //NAND2TETRIS_CONSTANT_FOLDER_H
@@ -0,0 +1,387 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "Peephole.h"
+#include <algorithm>
+#include <string>
+
+namespace nand2tetris::jack {
+
+    namespace {
+        // Every rule shrinks the code or removes a `not` from a branch, so this is only a safety net.
+        constexpr int MAX_ROUNDS = 16;
+
+        constexpr std::size_t NO_POSITION = static_cast<std::size_t>(-1);
+
+        VMInstruction push(const Segment segment, const int index) {
+            VMInstruction in{VMOp::PUSH};
+            in.segment = segment;
+            in.value = index;
+            return in;
+        }
+
+        VMInstruction arithmetic(const Command command) {
+            VMInstruction in{VMOp::ARITHMETIC};
+            in.command = command;
+            return in;
+        }
+
+        VMInstruction jump(const VMOp op, const std::uint32_t label) {
+            VMInstruction in{op};
+            in.symbol = label;
+            return in;
+        }
+
+        bool isComparison(const VMInstruction& in) {
+            return in.is(Command::EQ) || in.is(Command::LT) || in.is(Command::GT);
+        }
+
+        bool isJump(const VMInstruction& in) {
+            return in.is(VMOp::GOTO) || in.is(VMOp::IF_GOTO);
+        }
+
+        std::int16_t wrap(const int value) {
+            return static_cast<std::int16_t>(static_cast<std::uint16_t>(value));
+        }
+
+        /**
+         * @brief Recognises a constant ending just before `end`: `push constant k`, optionally followed by
+         * one `neg` or `not`.
+         *
+         * @return The number of instructions it spans (0 if there is none), with its value in `value`.
+         */
+        std::size_t constantBefore(const std::vector<VMInstruction>& code, const std::size_t end, std::int16_t& value) {
+            if (end >= 1 && code[end - 1].isPush(Segment::CONST)) {
+                value = wrap(code[end - 1].value);
+                return 1;
+            }
+            if (end >= 2 && code[end - 2].isPush(Segment::CONST)) {
+                const int k = code[end - 2].value;
+                if (code[end - 1].is(Command::NEG)) { value = wrap(-k); return 2; }
+                if (code[end - 1].is(Command::NOT)) { value = wrap(~k); return 2; }
+            }
+            return 0;
+        }
+
+        std::size_t constantLength(const std::int16_t value) {
+            return value >= 0 ? 1 : 2;
+        }
+
+        /// Appends the shortest sequence that pushes `value` (push constant only takes 0..32767).
+        void emitConstant(std::vector<VMInstruction>& out, const std::int16_t value) {
+            if (value >= 0) {
+                out.push_back(push(Segment::CONST, value));
+            } else if (value == INT16_MIN) {
+                out.push_back(push(Segment::CONST, INT16_MAX));
+                out.push_back(arithmetic(Command::NOT));
+            } else {
+                out.push_back(push(Segment::CONST, -value));
+                out.push_back(arithmetic(Command::NEG));
+            }
+        }
+
+        /**
+         * @brief Length of the simple value ending before `end` that can be pushed after `pop pointer 1`
+         * without changing its result: a constant or a push that does not read `that`, `pointer` or `temp 0`.
+         */
+        std::size_t simpleValueBefore(const std::vector<VMInstruction>& code, const std::size_t end) {
+            std::int16_t value;
+            if (const std::size_t n = constantBefore(code, end, value)) return n;
+            if (end < 1 || !code[end - 1].is(VMOp::PUSH)) return 0;
+            const VMInstruction& in = code[end - 1];
+            if (in.segment == Segment::THAT || in.segment == Segment::POINTER) return 0;
+            if (in.segment == Segment::TEMP && in.value == 0) return 0;
+            return 1;
+        }
+    }
+
+    PeepholeOptimizer::PeepholeOptimizer(VMCode& code) : code(code), instructions(code.instructions) {}
+
+    OptimizationStats PeepholeOptimizer::run() {
+        OptimizationStats stats;
+        stats.before = instructions.size();
+        for (int round = 0; round < MAX_ROUNDS; ++round) {
+            bool changed = simplifyLocally();
+            changed |= fuseBranches();
+            changed |= cleanUpControlFlow();
+            if (!changed) break;
+        }
+        stats.after = instructions.size();
+        return stats;
+    }
+
+    void PeepholeOptimizer::countLabels() {
+        labelPosition.assign(code.symbolCount(), NO_POSITION);
+        labelReferences.assign(code.symbolCount(), 0);
+        for (std::size_t i = 0; i < instructions.size(); ++i) {
+            const VMInstruction& in = instructions[i];
+            if (in.is(VMOp::LABEL)) labelPosition[in.symbol] = i;
+            else if (isJump(in)) ++labelReferences[in.symbol];
+        }
+    }
+
+    // --- Local rules: applied to the tail of the output as each instruction is appended ---
+
+    bool PeepholeOptimizer::simplifyLocally() {
+        std::vector<VMInstruction> out;
+        out.reserve(instructions.size());
+        bool changed = false;
+        for (const VMInstruction& in : instructions) {
+            out.push_back(in);
+            while (reduceTail(out)) changed = true;
+        }
+        if (changed) instructions = std::move(out);
+        return changed;
+    }
+
+    bool PeepholeOptimizer::reduceTail(std::vector<VMInstruction>& out) const {
+        const std::size_t n = out.size();
+        const VMInstruction& last = out[n - 1];
+        std::int16_t value;
+
+        // push k; neg|not  (on an already folded constant) -> shortest form of the result.
+        if (last.is(Command::NEG) || last.is(Command::NOT)) {
+            if (const std::size_t length = constantBefore(out, n - 1, value)) {
+                const std::int16_t folded = last.is(Command::NEG) ? wrap(-value) : wrap(~value);
+                if (constantLength(folded) < length + 1) {
+                    out.resize(n - 1 - length);
+                    emitConstant(out, folded);
+                    return true;
+                }
+            }
+        }
+
+        // <constant>; if-goto L -> goto L, or nothing when the constant is false.
+        if (last.is(VMOp::IF_GOTO)) {
+            if (const std::size_t length = constantBefore(out, n - 1, value)) {
+                const std::uint32_t label = last.symbol;
+                out.resize(n - 1 - length);
+                if (value != 0) out.push_back(jump(VMOp::GOTO, label));
+                return true;
+            }
+        }
+
+        if (n >= 2) {
+            const VMInstruction& prev = out[n - 2];
+
+            // not; not  and  neg; neg
+            if ((last.is(Command::NOT) && prev.is(Command::NOT)) || (last.is(Command::NEG) && prev.is(Command::NEG))) {
+                out.resize(n - 2);
+                return true;
+            }
+
+            // push x; pop x
+            if (prev.is(VMOp::PUSH) && last.is(VMOp::POP) && prev.segment != Segment::CONST &&
+                prev.segment == last.segment && prev.value == last.value) {
+                out.resize(n - 2);
+                return true;
+            }
+        }
+
+        // Array store: <value>; pop temp 0; pop pointer 1; push temp 0; pop that 0
+        //           -> pop pointer 1; <value>; pop that 0
+        if (n >= 5 && last.isPop(Segment::THAT) && last.value == 0 &&
+            out[n - 2].isPush(Segment::TEMP) && out[n - 2].value == 0 &&
+            out[n - 3].isPop(Segment::POINTER) && out[n - 3].value == 1 &&
+            out[n - 4].isPop(Segment::TEMP) && out[n - 4].value == 0) {
+            if (const std::size_t length = simpleValueBefore(out, n - 4)) {
+                const std::size_t first = n - 4 - length;
+                const VMInstruction setThat = out[n - 3];
+                const VMInstruction store = last;
+                for (std::size_t i = length; i > 0; --i) out[first + i] = out[first + i - 1];
+                out[first] = setThat;
+                out[first + length + 1] = store;
+                out.resize(first + length + 2);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // --- Inverted-branch fusion ---
+
+    bool PeepholeOptimizer::fuseBranches() {
+        countLabels();
+        std::vector<char> removed(instructions.size(), 0);
+        bool changed = false;
+        for (std::size_t i = 0; i < instructions.size(); ++i) {
+            if (instructions[i].is(VMOp::LABEL)) changed |= rotateLoop(i, removed);
+            else if (instructions[i].is(VMOp::IF_GOTO)) changed |= swapIfElse(i, removed);
+        }
+        if (!changed) return false;
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < instructions.size(); ++i) {
+            if (!removed[i]) instructions[kept++] = instructions[i];
+        }
+        instructions.resize(kept);
+        return true;
+    }
+
+    /*
+     * while (cond) { body }, where cond ends in a comparison:
+     *
+     *     label A                 goto T
+     *     <cond>                  label A
+     *     not                     <body>
+     *     if-goto E       ->      label T
+     *     <body>                  <cond>
+     *     goto A                  if-goto A
+     *     label E                 label E
+     *
+     * Each iteration then runs one branch instead of a `not`, an `if-goto` and a `goto`.
+     */
+    bool PeepholeOptimizer::rotateLoop(const std::size_t labelIndex, std::vector<char>& removed) {
+        const std::uint32_t head = instructions[labelIndex].symbol;
+        if (labelReferences[head] != 1) return false;
+
+        // The condition must be straight-line code ending in `<comparison>; not; if-goto E`.
+        std::size_t branch = labelIndex + 1;
+        while (branch < instructions.size()) {
+            const VMOp op = instructions[branch].op;
+            if (op == VMOp::IF_GOTO) break;
+            if (op == VMOp::LABEL || op == VMOp::GOTO || op == VMOp::FUNCTION || op == VMOp::RETURN) return false;
+            ++branch;
+        }
+        if (branch == instructions.size() || branch < labelIndex + 3) return false;
+        if (!instructions[branch - 1].is(Command::NOT) || !isComparison(instructions[branch - 2])) return false;
+
+        const std::uint32_t exit = instructions[branch].symbol;
+        const std::size_t exitIndex = labelPosition[exit];
+        if (exitIndex == NO_POSITION || exitIndex <= branch + 1) return false;
+        const VMInstruction& back = instructions[exitIndex - 1];
+        if (!back.is(VMOp::GOTO) || back.symbol != head) return false;
+
+        std::string testName(code.symbolText(head));
+        testName += "_T";
+        std::uint32_t test;
+        if (code.findSymbol(testName, test)) return false;
+        test = code.symbol(testName);
+        labelPosition.push_back(NO_POSITION);
+        labelReferences.push_back(1);
+
+        std::vector<VMInstruction> rotated;
+        rotated.reserve(exitIndex - labelIndex);
+        rotated.push_back(jump(VMOp::GOTO, test));
+        rotated.push_back(instructions[labelIndex]);
+        rotated.insert(rotated.end(), instructions.begin() + static_cast<std::ptrdiff_t>(branch + 1),
+                       instructions.begin() + static_cast<std::ptrdiff_t>(exitIndex - 1));
+        rotated.push_back(jump(VMOp::LABEL, test));
+        rotated.insert(rotated.end(), instructions.begin() + static_cast<std::ptrdiff_t>(labelIndex + 1),
+                       instructions.begin() + static_cast<std::ptrdiff_t>(branch - 1));
+        rotated.push_back(jump(VMOp::IF_GOTO, head));
+
+        // Same length as before: the `not` makes room for `goto T`.
+        const std::vector<char> holes(removed.begin() + static_cast<std::ptrdiff_t>(branch + 1),
+                                      removed.begin() + static_cast<std::ptrdiff_t>(exitIndex - 1));
+        std::fill(removed.begin() + static_cast<std::ptrdiff_t>(labelIndex),
+                  removed.begin() + static_cast<std::ptrdiff_t>(exitIndex), 0);
+        std::copy(holes.begin(), holes.end(), removed.begin() + static_cast<std::ptrdiff_t>(labelIndex + 2));
+        place(labelIndex, rotated);
+        return true;
+    }
+
+    /*
+     * if (cond) { then } else { else }, where cond ends in a comparison:
+     *
+     *     <cond>                  <cond>
+     *     not                     if-goto X
+     *     if-goto X               <else>
+     *     <then>          ->      goto Y
+     *     goto Y                  label X
+     *     label X                 <then>
+     *     <else>                  label Y
+     *     label Y
+     */
+    bool PeepholeOptimizer::swapIfElse(const std::size_t branchIndex, std::vector<char>& removed) {
+        if (branchIndex < 2 || !instructions[branchIndex - 1].is(Command::NOT) || removed[branchIndex - 1] ||
+            !isComparison(instructions[branchIndex - 2])) return false;
+
+        const std::uint32_t elseLabel = instructions[branchIndex].symbol;
+        if (labelReferences[elseLabel] != 1) return false;
+        const std::size_t elseIndex = labelPosition[elseLabel];
+        if (elseIndex == NO_POSITION || elseIndex <= branchIndex + 1) return false;
+
+        const VMInstruction& skip = instructions[elseIndex - 1];
+        if (!skip.is(VMOp::GOTO)) return false;
+        const std::uint32_t endLabel = skip.symbol;
+        const std::size_t endIndex = labelPosition[endLabel];
+        if (endIndex == NO_POSITION || endIndex <= elseIndex + 1) return false;
+
+        std::vector<VMInstruction> swapped;
+        swapped.reserve(endIndex - branchIndex + 2);
+        swapped.push_back(instructions[branchIndex]);
+        swapped.insert(swapped.end(), instructions.begin() + static_cast<std::ptrdiff_t>(elseIndex + 1),
+                       instructions.begin() + static_cast<std::ptrdiff_t>(endIndex));
+        swapped.push_back(skip);
+        swapped.push_back(instructions[elseIndex]);
+        swapped.insert(swapped.end(), instructions.begin() + static_cast<std::ptrdiff_t>(branchIndex + 1),
+                       instructions.begin() + static_cast<std::ptrdiff_t>(elseIndex - 1));
+
+        // Keep the holes of already rewritten code with their instructions.
+        const std::vector<char> thenHoles(removed.begin() + static_cast<std::ptrdiff_t>(branchIndex + 1),
+                                          removed.begin() + static_cast<std::ptrdiff_t>(elseIndex - 1));
+        const std::vector<char> elseHoles(removed.begin() + static_cast<std::ptrdiff_t>(elseIndex + 1),
+                                          removed.begin() + static_cast<std::ptrdiff_t>(endIndex));
+        std::size_t at = branchIndex + 1;
+        for (const char h : elseHoles) removed[at++] = h;
+        removed[at++] = 0;
+        removed[at++] = 0;
+        for (const char h : thenHoles) removed[at++] = h;
+
+        removed[branchIndex - 1] = 1;
+        place(branchIndex, swapped);
+        return true;
+    }
+
+    void PeepholeOptimizer::place(const std::size_t first, const std::vector<VMInstruction>& replacement) {
+        for (std::size_t i = 0; i < replacement.size(); ++i) {
+            instructions[first + i] = replacement[i];
+            if (replacement[i].is(VMOp::LABEL)) labelPosition[replacement[i].symbol] = first + i;
+        }
+    }
+
+    // --- Control-flow clean-up ---
+
+    bool PeepholeOptimizer::cleanUpControlFlow() {
+        countLabels();
+        std::vector<VMInstruction> out;
+        out.reserve(instructions.size());
+        const std::size_t n = instructions.size();
+        std::size_t i = 0;
+        while (i < n) {
+            const VMInstruction& in = instructions[i];
+
+            if (in.is(VMOp::LABEL) && labelReferences[in.symbol] == 0) {
+                ++i;
+                continue;
+            }
+
+            if (in.is(VMOp::GOTO)) {
+                // A jump over nothing but labels, one of which is its target.
+                bool toNext = false;
+                for (std::size_t j = i + 1; j < n && instructions[j].is(VMOp::LABEL); ++j) {
+                    if (instructions[j].symbol == in.symbol) { toNext = true; break; }
+                }
+                if (toNext) {
+                    ++i;
+                    continue;
+                }
+            }
+
+            out.push_back(in);
+            ++i;
+
+            // Nothing after an unconditional jump runs until the next label or function.
+            if (in.is(VMOp::GOTO) || in.is(VMOp::RETURN)) {
+                while (i < n && !instructions[i].is(VMOp::LABEL) && !instructions[i].is(VMOp::FUNCTION)) ++i;
+            }
+        }
+
+        if (out.size() == instructions.size()) return false;
+        instructions = std::move(out);
+        return true;
+    }
+}
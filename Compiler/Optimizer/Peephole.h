@@ -0,0 +1,74 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_PEEPHOLE_H
+#define NAND2TETRIS_PEEPHOLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../VMWriter/VMCode.h"
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief How much a pass shrank a class's code.
+     */
+    struct OptimizationStats {
+        std::size_t before = 0; ///< VM commands on entry.
+        std::size_t after = 0;  ///< VM commands on exit.
+
+        std::size_t saved() const { return before - after; }
+    };
+
+    /**
+     * @brief Rewrites short VM command sequences into cheaper equivalents (-O1).
+     *
+     * Works on the instruction list of one class, after code generation and before rendering. The rules:
+     * - **Constants**: `push constant k` followed by `neg`/`not` is evaluated with 16-bit wraparound and
+     *   re-emitted in its shortest form; `not not` and `neg neg` cancel out.
+     * - **Constant branches**: `if-goto` on a constant becomes a plain `goto` or disappears.
+     * - **Redundant push/pop**: `push x` / `pop x` pairs vanish, and an array store of a simple value skips
+     *   the temp 0 round-trip.
+     * - **Inverted-branch fusion**: when a condition ends in a comparison, the `not` before `if-goto` is
+     *   removed by branching on the comparison directly: while loops are rotated to test at the bottom and
+     *   if/else blocks are swapped.
+     * - **Clean-up**: unreachable code after `goto`/`return`, jumps to the next command and unreferenced
+     *   labels are dropped.
+     *
+     * Two properties of the code CodeGenerator emits are relied upon: `temp 0` is scratch that is always
+     * written before it is read, and labels are unique within a class.
+     */
+    class PeepholeOptimizer {
+        public:
+            explicit PeepholeOptimizer(VMCode& code);
+
+            /**
+             * @brief Applies every rule until none matches any more.
+             */
+            OptimizationStats run();
+
+        private:
+            VMCode& code;
+            std::vector<VMInstruction>& instructions;
+
+            // Per label symbol, refreshed by countLabels().
+            std::vector<std::size_t> labelPosition;
+            std::vector<std::uint32_t> labelReferences;
+
+            void countLabels();
+
+            bool simplifyLocally();
+            bool reduceTail(std::vector<VMInstruction>& out) const;
+
+            bool fuseBranches();
+            bool rotateLoop(std::size_t labelIndex, std::vector<char>& removed);
+            bool swapIfElse(std::size_t branchIndex, std::vector<char>& removed);
+            void place(std::size_t first, const std::vector<VMInstruction>& replacement);
+
+            bool cleanUpControlFlow();
+    };
+}
+
+#endif //NAND2TETRIS_PEEPHOLE_H
@@ -5,12 +5,13 @@
 #ifndef NAND2TETRIS_AST_H
 #define NAND2TETRIS_AST_H
 
+#include <cstdint>
 #include <string>
 #include <utility>
-#include <vector>
-#include <memory>
 #include<iostream>
 #include "../Tokenizer/TokenTypes.h"
+#include "../Common/Arena.h"
+#include "../Common/Interner.h"
 
 namespace nand2tetris::jack {
 
@@ -43,12 +44,41 @@ namespace nand2tetris::jack {
         IDENTIFIER          ///< IdentifierNode
     };
 
+    /**
+     * @brief A list of child nodes, stored in the same Arena as the nodes themselves.
+     */
+    template <typename T>
+    using NodeList = Span<T*>;
+
+    /**
+     * @brief Enumeration representing the kind of symbol.
+     */
+    enum class SymbolKind {
+        STATIC, ///< Static variable (class-level, shared).
+        FIELD,  ///< Field variable (class-level, instance-specific).
+        ARG,    ///< Argument variable (subroutine-level).
+        LCL,    ///< Local variable (subroutine-level).
+        NONE    ///< Represents a symbol not found in the table.
+    };
+
+    /**
+     * @brief What a variable name refers to, resolved once by the SemanticAnalyser.
+     *
+     * Stored on the nodes that name variables so that code generation needs no symbol table.
+     */
+    struct Binding {
+        SymbolKind kind = SymbolKind::NONE; ///< NONE until resolved, and for names that are not variables.
+        int index = -1;                     ///< Position within the kind's segment.
+        NameId type = Interner::EMPTY;      ///< The declared type.
+    };
+
     /**
      * @brief Base class for all nodes in the Abstract Syntax Tree (AST).
      *
-     * All specific AST nodes inherit from this class. It provides a virtual destructor
-     * to ensure proper cleanup of derived classes. It also stores the location (line, column)
-     * of the node in the source code for error reporting.
+     * All specific AST nodes inherit from this class. Nodes are placed in the Arena of their
+     * CompilationUnit and released together with it, so no node destructor is ever run; every
+     * node type must therefore stay trivially destructible. It also stores where the node starts in the
+     * source, as a byte offset; the line and column are only worked out (see LineIndex) for an error.
      */
     class Node {
         public:
@@ -56,11 +86,9 @@ namespace nand2tetris::jack {
              * @brief Constructs a Node.
              *
              * @param nodeType The specific type of this AST node.
-             * @param l The line number in the source code.
-             * @param c The column number in the source code.
+             * @param offset The byte offset of the node's first token in the source.
              */
-            explicit Node(const ASTNodeType nodeType, const int l, const int c):nodeType(nodeType),line(l),column(c){};
-            virtual ~Node() = default;
+            explicit Node(const ASTNodeType nodeType, const std::uint32_t offset):offset(offset),nodeType(nodeType){};
 
             /**
              * @brief Prints the XML representation of the AST node.
@@ -77,22 +105,19 @@ namespace nand2tetris::jack {
             ASTNodeType getType() const {return nodeType;};
 
             /**
-             * @brief Gets the line number of the node.
-             * @return The line number.
+             * @brief Gets the byte offset of the node in its source file.
+             * @return The offset of the node's first token.
              */
-            int getLine() const { return line; }
-
-            /**
-             * @brief Gets the column number of the node.
-             * @return The column number.
-             */
-            int getCol() const { return column; }
+            std::uint32_t getOffset() const { return offset; }
         protected:
-            const int line;   ///< Line number in source.
-            const int column; ///< Column number in source.
+            ~Node() = default; ///< Non-virtual: nodes are never deleted through a base pointer.
+
+            const std::uint32_t offset; ///< Byte offset in source.
             ASTNodeType nodeType; ///< The type of the node.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
     };
 
     /**
@@ -111,24 +136,26 @@ namespace nand2tetris::jack {
     class ClassVarDecNode final : public Node {
         protected:
             ClassVarKind kind; ///< The kind of variable (static or field).
-            std::string_view type; ///< The data type of the variable(s) (e.g., "int", "boolean", "MyClass").
-            std::vector<std::string_view> varNames; ///< A list of variable names declared in this statement.
+            NameId type; ///< The data type of the variable(s) (e.g., "int", "boolean", "MyClass").
+            Span<NameId> varNames; ///< A list of variable names declared in this statement.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs a ClassVarDecNode.
              *
              * @param k The kind of variable.
              * @param t The type of the variable.
-             * @param names A vector of variable names.
-             * @param l the line on source code.
-             * @param c the column on source code.
+             * @param names The variable names (stored in the arena).
+             * @param offset The byte offset in the source.
              */
-            ClassVarDecNode(const ClassVarKind k, const std::string_view t, std::vector<std::string_view> names, const int
-                l, const int c)
-                :Node(ASTNodeType::CLASS_VAR_DEC,l,c),kind(k),type(t), varNames(std::move(names)) {};
-            ~ClassVarDecNode() override = default;
+            ClassVarDecNode(const ClassVarKind k, const NameId t, Span<NameId> names, const std::uint32_t offset)
+                :Node(ASTNodeType::CLASS_VAR_DEC,offset),kind(k),type(t), varNames(names) {};
+
+            ClassVarKind getKind() const { return kind; }
+            std::size_t getVarCount() const { return varNames.size(); }
 
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
@@ -136,15 +163,15 @@ namespace nand2tetris::jack {
 
                 out << sp << "  <keyword> " << (kind == ClassVarKind::STATIC ? "static" : "field") << " </keyword>\n";
 
-                if (type == "int" || type == "char" || type == "boolean") {
-                    out << sp << "  <keyword> " << type << " </keyword>\n";
+                if (Interner::isPrimitive(type)) {
+                    out << sp << "  <keyword> " << nameOf(type) << " </keyword>\n";
                 } else {
-                    out << sp << "  <identifier> " << type << " </identifier>\n";
+                    out << sp << "  <identifier> " << nameOf(type) << " </identifier>\n";
                 }
 
 
                 for (size_t i = 0; i < varNames.size(); ++i) {
-                    out << sp << "  <identifier> " << varNames[i] << " </identifier>\n";
+                    out << sp << "  <identifier> " << nameOf(varNames[i]) << " </identifier>\n";
                     if (i < varNames.size() - 1) out << sp << "  <symbol> , </symbol>\n";
                 }
                 out << sp << "  <symbol> ; </symbol>\n";
@@ -159,22 +186,22 @@ namespace nand2tetris::jack {
      */
     class VarDecNode final : public Node {
         protected:
-            std::string_view type; ///< The data type of the variable(s).
-            std::vector<std::string_view> varNames; ///< A list of variable names declared.
+            NameId type; ///< The data type of the variable(s).
+            Span<NameId> varNames; ///< A list of variable names declared.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs a VarDecNode.
              *
              * @param t The type of the variable.
-             * @param names A vector of variable names.
-             * @param l The line number.
-             * @param c The column number.
+             * @param names The variable names (stored in the arena).
+             * @param offset The byte offset in the source.
              */
-            VarDecNode(const std::string_view t, std::vector<std::string_view> names, const int l, const int c)
-                : Node(ASTNodeType::VAR_DEC,l,c),type(t), varNames(std::move(names)) {};
-            ~VarDecNode() override = default;
+            VarDecNode(const NameId t, Span<NameId> names, const std::uint32_t offset)
+                : Node(ASTNodeType::VAR_DEC,offset),type(t), varNames(names) {};
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
 
@@ -187,15 +214,15 @@ namespace nand2tetris::jack {
 
                 // The type (int, char, boolean, or className)
                 // We treat the type as a keyword if it's a primitive, or an identifier if it's a class.
-                if (type == "int" || type == "char" || type == "boolean") {
-                    out << sp << "  <keyword> " << type << " </keyword>\n";
+                if (Interner::isPrimitive(type)) {
+                    out << sp << "  <keyword> " << nameOf(type) << " </keyword>\n";
                 } else {
-                    out << sp << "  <identifier> " << type << " </identifier>\n";
+                    out << sp << "  <identifier> " << nameOf(type) << " </identifier>\n";
                 }
 
                 // List of variable names separated by commas
                 for (size_t i = 0; i < varNames.size(); ++i) {
-                    out << sp << "  <identifier> " << varNames[i] << " </identifier>\n";
+                    out << sp << "  <identifier> " << nameOf(varNames[i]) << " </identifier>\n";
 
                     // Output a comma symbol if there are more names in the list
                     if (i < varNames.size() - 1) {
@@ -225,8 +252,8 @@ namespace nand2tetris::jack {
      * Example: `int x` in `function void foo(int x)`
      */
     struct Parameter {
-        std::string_view type; ///< The data type of the parameter.
-        std::string_view name; ///< The name of the parameter.
+        NameId type; ///< The data type of the parameter.
+        NameId name; ///< The name of the parameter.
     };
 
     /**
@@ -238,9 +265,10 @@ namespace nand2tetris::jack {
         protected:
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
-            explicit StatementNode(const ASTNodeType nodeType,const int l, const int c):Node(nodeType,l,c){};
-            ~StatementNode() override = default;
+            explicit StatementNode(const ASTNodeType nodeType,const std::uint32_t offset):Node(nodeType,offset){};
     };
 
     /**
@@ -252,9 +280,10 @@ namespace nand2tetris::jack {
         protected:
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
-            explicit ExpressionNode(const ASTNodeType nodeType,const int l, const int c):Node(nodeType,l,c){};
-            ~ExpressionNode() override = default;
+            explicit ExpressionNode(const ASTNodeType nodeType,const std::uint32_t offset):Node(nodeType,offset){};
     };
 
     /**
@@ -267,15 +296,15 @@ namespace nand2tetris::jack {
             int value; ///< The integer value.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs an IntegerLiteralNode.
              * @param val The integer value.
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              */
-            explicit IntegerLiteralNode(const int val,const int l, const int c) : ExpressionNode(ASTNodeType::INTEGER_LITERAL,l,c),value(val) {}
-            ~IntegerLiteralNode() override = default;
+            explicit IntegerLiteralNode(const int val,const std::uint32_t offset) : ExpressionNode(ASTNodeType::INTEGER_LITERAL,offset),value(val) {}
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
                 out << sp << "<term>\n";  // Add Wrapper
@@ -294,15 +323,15 @@ namespace nand2tetris::jack {
             std::string_view value; ///< The string value (without quotes).
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs a StringLiteralNode.
              * @param val The string content.
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              */
-            explicit StringLiteralNode(const std::string_view val,const int l, const int c) : ExpressionNode(ASTNodeType::STRING_LITERAL,l,c),value(val) {}
-            ~StringLiteralNode() override = default;
+            explicit StringLiteralNode(const std::string_view val,const std::uint32_t offset) : ExpressionNode(ASTNodeType::STRING_LITERAL,offset),value(val) {}
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
                 out << sp << "<term>\n";  // Add Wrapper
@@ -321,14 +350,15 @@ namespace nand2tetris::jack {
             Keyword value; ///< The keyword value.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs a KeywordLiteralNode.
              * @param val The keyword.
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              */
-            explicit KeywordLiteralNode(const Keyword val, const int l, const int c) :ExpressionNode(ASTNodeType::KEYWORD_LITERAL,l,c),value(val) {}
+            explicit KeywordLiteralNode(const Keyword val, const std::uint32_t offset) :ExpressionNode(ASTNodeType::KEYWORD_LITERAL,offset),value(val) {}
             void printXml(std::ostream& out, const int indent) const override {
                 std::string val;
                 switch(value) {
@@ -368,24 +398,24 @@ namespace nand2tetris::jack {
      */
     class BinaryOpNode final : public ExpressionNode {
         protected:
-            std::unique_ptr<ExpressionNode> left; ///< The left operand.
+            ExpressionNode* left; ///< The left operand.
             char op; ///< The operator symbol ('+', '-', '*', '/', '&', '|', '<', '>', '=').
-            std::unique_ptr<ExpressionNode> right; ///< The right operand.
+            ExpressionNode* right; ///< The right operand.
+            bool byDoubling = false; ///< Set by the ConstantFolder on `x * c`: compiled as doublings, not Math.multiply.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs a BinaryOpNode.
              * @param l The left operand.
              * @param o The operator character.
              * @param r The right operand.
-             * @param line The line number.
-             * @param column The column number.
+             * @param offset The byte offset in the source.
              */
-            BinaryOpNode(std::unique_ptr<ExpressionNode> l, const char o, std::unique_ptr<ExpressionNode> r,const int
-                line, const int column)
-                : ExpressionNode(ASTNodeType::BINARY_OP,line, column),left(std::move(l)), op(o), right(std::move(r)) {}
-            ~BinaryOpNode() override = default;
+            BinaryOpNode(ExpressionNode* l, const char o, ExpressionNode* r,const std::uint32_t offset)
+                : ExpressionNode(ASTNodeType::BINARY_OP,offset),left(l), op(o), right(r) {}
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
                 // Left Term
@@ -409,20 +439,20 @@ namespace nand2tetris::jack {
     class UnaryOpNode final : public ExpressionNode {
         protected:
             char op; ///< The operator symbol ('-', '~').
-            std::unique_ptr<ExpressionNode> term; ///< The operand.
+            ExpressionNode* term; ///< The operand.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs a UnaryOpNode.
              * @param o The operator character.
              * @param t The operand.
-             * @param line The line number.
-             * @param column The column number.
+             * @param offset The byte offset in the source.
              */
-            UnaryOpNode(const char o, std::unique_ptr<ExpressionNode> t,const int line, const int column)
-                : ExpressionNode(ASTNodeType::UNARY_OP,line, column),op(o), term(std::move(t)) {}
-            ~UnaryOpNode() override = default;
+            UnaryOpNode(const char o, ExpressionNode* t,const std::uint32_t offset)
+                : ExpressionNode(ASTNodeType::UNARY_OP,offset),op(o), term(t) {}
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
                 out << sp << "<term>\n";
@@ -441,24 +471,25 @@ namespace nand2tetris::jack {
      */
     class CallNode final : public ExpressionNode {
         protected:
-            std::string_view classNameOrVar; ///< The class name or variable name (optional). Empty if implicit `this`.
-            std::string_view functionName;   ///< The name of the subroutine being called.
-            std::vector<std::unique_ptr<ExpressionNode>> arguments; ///< The list of arguments passed to the call.
+            NameId classNameOrVar; ///< The class name or variable name (optional). Interner::EMPTY if implicit `this`.
+            NameId functionName;   ///< The name of the subroutine being called.
+            NodeList<ExpressionNode> arguments; ///< The list of arguments passed to the call.
+            mutable Binding receiver; ///< The variable `classNameOrVar` names, if it is one (set by the analyser).
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs a CallNode.
              * @param cv The class or variable name (can be empty).
              * @param fn The function name.
              * @param args The arguments.
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              */
-            CallNode(const std::string_view cv, const std::string_view fn,
-                std::vector<std::unique_ptr<ExpressionNode>> args,const int l,const int c)
-                : ExpressionNode(ASTNodeType::SUBROUTINE_CALL,l,c),classNameOrVar(cv), functionName(fn), arguments(std::move(args)) {}
-            ~CallNode() override = default;
+            CallNode(const NameId cv, const NameId fn,
+                NodeList<ExpressionNode> args,const std::uint32_t offset)
+                : ExpressionNode(ASTNodeType::SUBROUTINE_CALL,offset),classNameOrVar(cv), functionName(fn), arguments(args) {}
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
                 out << sp << "<term>\n";
@@ -468,11 +499,11 @@ namespace nand2tetris::jack {
 
             void printRaw(std::ostream& out, const int indent) const {
                 const std::string sp(indent, ' ');
-                if (!classNameOrVar.empty()) {
-                    out << sp << "<identifier> " << classNameOrVar << " </identifier>\n";
+                if (classNameOrVar != Interner::EMPTY) {
+                    out << sp << "<identifier> " << nameOf(classNameOrVar) << " </identifier>\n";
                     out << sp << "<symbol> . </symbol>\n";
                 }
-                out << sp << "<identifier> " << functionName << " </identifier>\n";
+                out << sp << "<identifier> " << nameOf(functionName) << " </identifier>\n";
                 out << sp << "<symbol> ( </symbol>\n";
                 out << sp << "<expressionList>\n";
                 for (size_t i = 0; i < arguments.size(); ++i) {
@@ -495,26 +526,27 @@ namespace nand2tetris::jack {
      */
     class IdentifierNode final : public ExpressionNode {
         protected:
-            std::string_view name; ///< The name of the identifier.
-            std::unique_ptr<ExpressionNode> indexExpr; ///< The index expression if it's an array access, otherwise nullptr.
+            NameId name; ///< The name of the identifier.
+            ExpressionNode* indexExpr; ///< The index expression if it's an array access, otherwise nullptr.
+            mutable Binding binding; ///< The variable, set by the analyser.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs an IdentifierNode.
              * @param n The identifier name.
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              * @param idx The index expression (optional).
              */
-        explicit IdentifierNode(const std::string_view n,const int l, const int c,std::unique_ptr<ExpressionNode> idx = nullptr)
-                : ExpressionNode(ASTNodeType::IDENTIFIER,l,c) ,name(n), indexExpr(std::move(idx)) {}
-            ~IdentifierNode() override = default;
+        explicit IdentifierNode(const NameId n,const std::uint32_t offset,ExpressionNode* idx = nullptr)
+                : ExpressionNode(ASTNodeType::IDENTIFIER,offset) ,name(n), indexExpr(idx) {}
             void printXml(std::ostream& out, const int indent) const override {
 
                 const std::string sp(indent, ' ');
                 out << sp << "<term>\n";  // Add Wrapper
-                out << sp << "  <identifier> " << name << " </identifier>\n";
+                out << sp << "  <identifier> " << nameOf(name) << " </identifier>\n";
                 if (indexExpr) {
                     out << sp << "  <symbol> [ </symbol>\n";
                     out << sp << "  <expression>\n";
@@ -533,29 +565,30 @@ namespace nand2tetris::jack {
      */
     class LetStatementNode final : public StatementNode {
         protected:
-            std::string_view varName; ///< The name of the variable being assigned to.
-            std::unique_ptr<ExpressionNode> indexExpr; ///< The index expression for array assignment (optional).
-            std::unique_ptr<ExpressionNode> valueExpr; ///< The expression evaluating to the new value.
+            NameId varName; ///< The name of the variable being assigned to.
+            ExpressionNode* indexExpr; ///< The index expression for array assignment (optional).
+            ExpressionNode* valueExpr; ///< The expression evaluating to the new value.
+            mutable Binding target; ///< The assigned variable, set by the analyser.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs a LetStatementNode.
              * @param name The variable name.
              * @param idx The index expression (can be nullptr).
              * @param val The value expression.
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              */
-            LetStatementNode(const std::string_view name, std::unique_ptr<ExpressionNode> idx,
-                             std::unique_ptr<ExpressionNode> val,const int l, const int c)
-                : StatementNode(ASTNodeType::LET_STATEMENT,l,c) ,varName(name), indexExpr(std::move(idx)), valueExpr(std::move(val)) {}
-            ~LetStatementNode() override = default;
+            LetStatementNode(const NameId name, ExpressionNode* idx,
+                             ExpressionNode* val,const std::uint32_t offset)
+                : StatementNode(ASTNodeType::LET_STATEMENT,offset) ,varName(name), indexExpr(idx), valueExpr(val) {}
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
                 out << sp << "<letStatement>\n";
                 out << sp << "  <keyword> let </keyword>\n";
-                out << sp << "  <identifier> " << varName << " </identifier>\n";
+                out << sp << "  <identifier> " << nameOf(varName) << " </identifier>\n";
 
                 if (indexExpr) {
                     out << sp << "  <symbol> [ </symbol>\n";
@@ -581,25 +614,25 @@ namespace nand2tetris::jack {
      */
     class IfStatementNode final : public StatementNode {
         protected:
-            std::unique_ptr<ExpressionNode> condition; ///< The condition expression.
-            std::vector<std::unique_ptr<StatementNode>> ifStatements; ///< The statements to execute if true.
-            std::vector<std::unique_ptr<StatementNode>> elseStatements; ///< The statements to execute if false (optional).
+            ExpressionNode* condition; ///< The condition expression.
+            NodeList<StatementNode> ifStatements; ///< The statements to execute if true.
+            NodeList<StatementNode> elseStatements; ///< The statements to execute if false (optional).
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs an IfStatementNode.
              * @param cond The condition.
              * @param ifStmts The 'if' block statements.
              * @param elseStmts The 'else' block statements.
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              */
-            IfStatementNode(std::unique_ptr<ExpressionNode> cond, std::vector<std::unique_ptr<StatementNode>> ifStmts,
-                            std::vector<std::unique_ptr<StatementNode>> elseStmts,const int l, const int c)
-                : StatementNode(ASTNodeType::IF_STATEMENT,l,c) ,condition(std::move(cond)), ifStatements(std::move(ifStmts)),
-                elseStatements(std::move(elseStmts)){};
-            ~IfStatementNode() override = default;
+            IfStatementNode(ExpressionNode* cond, NodeList<StatementNode> ifStmts,
+                            NodeList<StatementNode> elseStmts,const std::uint32_t offset)
+                : StatementNode(ASTNodeType::IF_STATEMENT,offset) ,condition(cond), ifStatements(ifStmts),
+                elseStatements(elseStmts){};
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
                 out << sp << "<ifStatement>\n";
@@ -635,22 +668,22 @@ namespace nand2tetris::jack {
      */
     class WhileStatementNode final : public StatementNode {
         protected:
-            std::unique_ptr<ExpressionNode> condition; ///< The loop condition.
-            std::vector<std::unique_ptr<StatementNode>> body; ///< The loop body statements.
+            ExpressionNode* condition; ///< The loop condition.
+            NodeList<StatementNode> body; ///< The loop body statements.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs a WhileStatementNode.
              * @param cond The condition.
              * @param b The body statements.
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              */
-            WhileStatementNode(std::unique_ptr<ExpressionNode> cond, std::vector<std::unique_ptr<StatementNode>> b,
-                const int l,const int c)
-                : StatementNode(ASTNodeType::WHILE_STATEMENT,l,c),condition(std::move(cond)), body(std::move(b)) {}
-            ~WhileStatementNode() override = default;
+            WhileStatementNode(ExpressionNode* cond, NodeList<StatementNode> b,
+                const std::uint32_t offset)
+                : StatementNode(ASTNodeType::WHILE_STATEMENT,offset),condition(cond), body(b) {}
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
                 out << sp << "<whileStatement>\n";
@@ -678,19 +711,19 @@ namespace nand2tetris::jack {
      */
     class DoStatementNode final : public StatementNode {
         protected:
-            std::unique_ptr<CallNode> callExpression; ///< The subroutine call expression.
+            CallNode* callExpression; ///< The subroutine call expression.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs a DoStatementNode.
              * @param call The call expression.
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              */
-            explicit DoStatementNode(std::unique_ptr<CallNode> call,const int l, const int c) : StatementNode(ASTNodeType::DO_STATEMENT,l,c),
-                callExpression(std::move(call)){};
-            ~DoStatementNode() override = default;
+            explicit DoStatementNode(CallNode* call,const std::uint32_t offset) : StatementNode(ASTNodeType::DO_STATEMENT,offset),
+                callExpression(call){};
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
                 out << sp << "<doStatement>\n";
@@ -711,20 +744,20 @@ namespace nand2tetris::jack {
      */
     class ReturnStatementNode final : public StatementNode {
         protected:
-            std::unique_ptr<ExpressionNode> expression; ///< The return value expression (optional).
+            ExpressionNode* expression; ///< The return value expression (optional).
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
 
         public:
             /**
              * @brief Constructs a ReturnStatementNode.
              * @param expr The return expression (can be nullptr).
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              */
-            explicit ReturnStatementNode(std::unique_ptr<ExpressionNode> expr,const int l,const int c) : StatementNode
-                (ASTNodeType::RETURN_STATEMENT,l,c), expression(std::move(expr)) {}
-            ~ReturnStatementNode() override = default;
+            explicit ReturnStatementNode(ExpressionNode* expr,const std::uint32_t offset) : StatementNode
+                (ASTNodeType::RETURN_STATEMENT,offset), expression(expr) {}
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
                 out << sp << "<returnStatement>\n";
@@ -747,14 +780,18 @@ namespace nand2tetris::jack {
     class SubroutineDecNode final : public Node {
         protected:
             SubroutineType subType; ///< The type of subroutine (constructor, function, method).
-            std::string_view returnType; ///< The return type (e.g., "void", "int", "MyClass").
-            std::string_view name; ///< The name of the subroutine.
-            std::vector<Parameter> parameters; ///< The list of parameters.
-
-            std::vector<std::unique_ptr<VarDecNode>> localVars; ///< The local variable declarations.
-            std::vector<std::unique_ptr<StatementNode>> statements; ///< The body statements.
+            NameId returnType; ///< The return type (e.g., "void", "int", "MyClass").
+            NameId name; ///< The name of the subroutine.
+            Span<Parameter> parameters; ///< The list of parameters.
+
+            NodeList<VarDecNode> localVars; ///< The local variable declarations.
+            NodeList<StatementNode> statements; ///< The body statements.
+            mutable int localCount = 0; ///< Number of local variables, set by the analyser.
+            friend class Parser;
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
 
         public:
             /**
@@ -765,17 +802,14 @@ namespace nand2tetris::jack {
              * @param parameters The list of parameters.
              * @param vars The local variables.
              * @param stmts The body statements.
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              */
-            SubroutineDecNode(const SubroutineType st, const std::string_view ret, const std::string_view n,
-                std::vector<Parameter> parameters, std::vector<std::unique_ptr<VarDecNode>> vars,
-                std::vector<std::unique_ptr<StatementNode>> stmts,const int l, const int c)
-                : Node(ASTNodeType::SUBROUTINE_DEC,l,c),subType(st), returnType(ret), name(n),parameters(std::move
-                    (parameters)),localVars(std::move
-                    (vars)),statements(std::move(stmts)) {};
+            SubroutineDecNode(const SubroutineType st, const NameId ret, const NameId n,
+                Span<Parameter> parameters, NodeList<VarDecNode> vars,
+                NodeList<StatementNode> stmts,const std::uint32_t offset)
+                : Node(ASTNodeType::SUBROUTINE_DEC,offset),subType(st), returnType(ret), name(n),parameters(parameters),localVars(vars),statements(stmts) {};
 
-            ~SubroutineDecNode() override = default;
+            NameId getName() const { return name; }
 
             void printXml(std::ostream& out, const int indent) const override {
                 const std::string sp(indent, ' ');
@@ -783,22 +817,22 @@ namespace nand2tetris::jack {
                 const std::string typeStr = (subType == SubroutineType::CONSTRUCTOR ? "constructor" :
                                       (subType == SubroutineType::FUNCTION ? "function" : "method"));
                 out << sp << "  <keyword> " << typeStr << " </keyword>\n";
-                if (returnType == "int" || returnType == "void" || returnType == "boolean" || returnType == "char") {
-                    out << sp << "  <keyword> " << returnType << " </keyword>\n";
+                if (Interner::isPrimitive(returnType) || returnType == Interner::VOID) {
+                    out << sp << "  <keyword> " << nameOf(returnType) << " </keyword>\n";
                 } else {
-                    out << sp << "  <identifier> " << returnType << " </identifier>\n";
+                    out << sp << "  <identifier> " << nameOf(returnType) << " </identifier>\n";
                 }
 
-                out << sp << "  <identifier> " << name << " </identifier>\n";
+                out << sp << "  <identifier> " << nameOf(name) << " </identifier>\n";
                 out << sp << "  <symbol> ( </symbol>\n";
                 out << sp << "  <parameterList>\n";
                 for (size_t i = 0; i < parameters.size(); ++i) {
-                    if (parameters[i].type=="int"||parameters[i].type=="boolean"||parameters[i].type=="char") {
-                        out<< sp << "  <keyword>"<<parameters[i].type<<" </keyword>\n";
+                    if (Interner::isPrimitive(parameters[i].type)) {
+                        out<< sp << "  <keyword>"<<nameOf(parameters[i].type)<<" </keyword>\n";
                     }else {
-                        out << sp << "  <identifier> " << parameters[i].type << " </identifier>\n";
+                        out << sp << "  <identifier> " << nameOf(parameters[i].type) << " </identifier>\n";
                     }
-                    out << sp << "    <identifier> " << parameters[i].name << " </identifier>\n";
+                    out << sp << "    <identifier> " << nameOf(parameters[i].name) << " </identifier>\n";
                     if (i < parameters.size() - 1) out << sp << "    <symbol> , </symbol>\n";
                 }
                 out << sp << "  </parameterList>\n";
@@ -822,39 +856,53 @@ namespace nand2tetris::jack {
      */
     class ClassNode final : public Node {
         protected:
-            std::string_view className; ///< The name of the class.
-            std::vector<std::unique_ptr<ClassVarDecNode>> classVars; ///< The class-level variable declarations.
-            std::vector<std::unique_ptr<SubroutineDecNode>> subroutineDecs; ///< The subroutine declarations.
+            NameId className; ///< The name of the class.
+            NodeList<ClassVarDecNode> classVars; ///< The class-level variable declarations.
+            NodeList<SubroutineDecNode> subroutineDecs; ///< The subroutine declarations.
+            mutable int fieldCount = 0;  ///< Number of field variables, set by the analyser.
+            mutable int staticCount = 0; ///< Number of static variables, set by the analyser.
             friend class SemanticAnalyser;
             friend class CodeGenerator;
+            friend class ConstantFolder;
+            friend class BinaryWriter;
         public:
             /**
              * @brief Constructs a ClassNode.
              * @param className The name of the class.
              * @param classVars The list of class variables (Static and Field)
              * @param subroutineDecs The list of subroutine declarations (constructors, method, function)
-             * @param l The line number.
-             * @param c The column number.
+             * @param offset The byte offset in the source.
              */
-            explicit ClassNode(const std::string_view className,std::vector<std::unique_ptr<ClassVarDecNode>>
-                classVars,std::vector<std::unique_ptr<SubroutineDecNode>> subroutineDecs,const int l, const int c) :
-                Node(ASTNodeType::CLASS,l,c),className(className),
-                classVars(std::move(classVars)), subroutineDecs(std::move(subroutineDecs)) {};
-            ~ClassNode() override = default;
+            explicit ClassNode(const NameId className,NodeList<ClassVarDecNode>
+                classVars,NodeList<SubroutineDecNode> subroutineDecs,const std::uint32_t offset) :
+                Node(ASTNodeType::CLASS,offset),className(className),
+                classVars(classVars), subroutineDecs(subroutineDecs) {};
             void printXml(std::ostream& out, int indent)const override {
                 out << "<class>\n";
                 out << "  <keyword> class </keyword>\n";
-                out << "  <identifier> " << className << " </identifier>\n";
+                out << "  <identifier> " << nameOf(className) << " </identifier>\n";
                 out << "  <symbol> { </symbol>\n";
                 for (const auto& var : classVars) var->printXml(out, 2);
                 for (const auto& sub : subroutineDecs) sub->printXml(out, 2);
                 out << "  <symbol> } </symbol>\n";
                 out << "</class>\n";
             }
-            std::string_view getClassName()const { return className; }
+            NameId getClassName()const { return className; }
             std::size_t get_Number_of_Subroutines()const {return subroutineDecs.size();}
+            NodeList<SubroutineDecNode> getSubroutines() const { return subroutineDecs; }
             std::size_t get_Number_of_classVars() const {return classVars.size();}
 
+            /**
+             * @brief The static variables the class declares, counted from the tree (before any analysis).
+             */
+            std::size_t countDeclaredStatics() const {
+                std::size_t count = 0;
+                for (const ClassVarDecNode* var : classVars) {
+                    if (var->getKind() == ClassVarKind::STATIC) count += var->getVarCount();
+                }
+                return count;
+            }
+
 
     };
 }
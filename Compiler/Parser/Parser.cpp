@@ -6,17 +6,21 @@
 #include "AST.h"
 #include "../Tokenizer/Tokenizer.h"
 #include "../SemanticAnalyser/GlobalRegistry.h"
+#include "../Common/Diagnostics.h"
 #include <filesystem>
+#include <optional>
+#include <stdexcept>
 namespace fs = std::filesystem;
 
 namespace nand2tetris::jack {
-    Parser::Parser(Tokenizer &tokenizer, GlobalRegistry& registry):tokenizer(tokenizer),globalRegistry(registry) {
+    Parser::Parser(Tokenizer &tokenizer, GlobalRegistry& registry, Arena& arena, const bool registerSignatures):
+        tokenizer(tokenizer),globalRegistry(registry),arena(arena),registerSignatures(registerSignatures) {
         // Initialize the parser by pointing to the first token available in the tokenizer.
         // The tokenizer is assumed to be already initialized and pointing to the first token.
         currentToken=&tokenizer.current();
     }
 
-    std::unique_ptr<ClassNode> Parser::parse() {
+    ClassNode* Parser::parse() {
         // The entry point for parsing a Jack file. Every Jack file must contain exactly one class.
         auto classNode = parseClass();
 
@@ -31,12 +35,38 @@ namespace nand2tetris::jack {
     }
 
 
+    void Parser::deferBodies(const std::vector<SourceRange>& bodies) {
+        bodyRanges = Span<SourceRange>(bodies.data(), bodies.size());
+        nextBody = 0;
+    }
+
+    void Parser::parseBody(const DeferredBody& body) {
+        parseSubroutineBody(*body.subroutine);
+
+        // The range ends with the body's closing brace, so anything else means the ranges were wrong.
+        if (currentToken->getType() != TokenType::END_OF_FILE) {
+            tokenizer.errorHere("Syntax Error: Unexpected tokens after subroutine body.");
+        }
+    }
+
     void Parser::advance() {
         // Move the tokenizer forward to the next token and update our local reference.
         tokenizer.advance();
         currentToken = &tokenizer.current();
     }
 
+    std::string_view Parser::currentText() const {
+        return tokenizer.text(*currentToken);
+    }
+
+    NameId Parser::currentName() const {
+        // Identifiers were interned by the tokenizer; type keywords (int, char, ...) are pre-seeded.
+        if (currentToken->getType() == TokenType::IDENTIFIER) {
+            return currentToken->getName();
+        }
+        return Interner::global().intern(currentText());
+    }
+
     bool Parser::check(const TokenType type) const {
         // Check if the current token matches the expected type without consuming it.
         return currentToken->getType()==type;
@@ -44,7 +74,7 @@ namespace nand2tetris::jack {
 
     bool Parser::check(const std::string_view text) const {
         // Check if the current token's text value matches the expected string without consuming it.
-        return currentToken->getValue()==text;
+        return currentText()==text;
     }
 
     void Parser::consume(const TokenType type, const std::string_view errorMessage) {
@@ -53,7 +83,7 @@ namespace nand2tetris::jack {
         if (check(type)) {
             advance();
         } else {
-            tokenizer.errorAt(currentToken->getLine(),currentToken->getColumn(), errorMessage);
+            tokenizer.errorAt(currentToken->start(), errorMessage);
         }
     }
 
@@ -63,48 +93,46 @@ namespace nand2tetris::jack {
         if (check(text)) {
             advance();
         } else {
-            tokenizer.errorAt(currentToken->getLine(),currentToken->getColumn(), errorMessage);
+            tokenizer.errorAt(currentToken->start(), errorMessage);
         }
     }
 
-    std::unique_ptr<ClassNode> Parser::parseClass() {
+    ClassNode* Parser::parseClass() {
         // Grammar: 'class' className '{' classVarDec* subroutineDec* '}'
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+        const std::uint32_t offset = currentToken->start();
 
         // 1. Expect 'class' keyword
         consume("class", "Expected 'class' keyword");
 
         // 2. Expect class name (identifier)
-        std::string_view className = currentToken->getValue();
+        const NameId className = currentName();
         consume(TokenType::IDENTIFIER, "Expected class name");
 
         const fs::path filePath(tokenizer.getFilePath());
         const std::string expectedName = filePath.stem().string();
 
-        if (className != expectedName) {
+        if (nameOf(className) != expectedName) {
             tokenizer.errorHere("Class name mismatch. The class defined in '" +
                                 filePath.filename().string() + "' must be named '" + expectedName +
-                                "', but found '" + std::string(className) + "'.");
+                                "', but found '" + std::string(nameOf(className)) + "'.");
         }
 
         currentClassName=className;
-        if (globalRegistry.classExists(className)) {
-            tokenizer.errorHere("Duplicate class definition: Class '" + std::string(className) + "' is already "
+        if (registerSignatures && !globalRegistry.registerClass(className)) {
+            tokenizer.errorHere("Duplicate class definition: Class '" + std::string(nameOf(className)) + "' is already "
                                                                                                  "defined.");
         }
-        globalRegistry.registerClass(className);
 
         // 3. Expect opening brace '{'
         consume("{", "Expected '{'");
 
-        std::vector<std::unique_ptr<ClassVarDecNode>> classVars;
-        std::vector<std::unique_ptr<SubroutineDecNode>> subroutineDecs;
+        std::vector<ClassVarDecNode*> classVars;
+        std::vector<SubroutineDecNode*> subroutineDecs;
 
         // 4. Parse class body: variable declarations followed by subroutine declarations.
         // We loop until we hit the closing brace '}'.
         while (!check("}")) {
-            const std::string_view val=currentToken->getValue();
+            const std::string_view val=currentText();
 
             // Distinguish between class variables (static/field) and subroutines (constructor/method/function).
             if (val=="static"||val=="field") {
@@ -113,20 +141,19 @@ namespace nand2tetris::jack {
                 subroutineDecs.push_back(parseSubroutine());
             }else {
                 // If we encounter anything else, it's a syntax error.
-                tokenizer.errorAt(currentToken->getLine(),currentToken->getColumn(), "Expected class variable or subroutine declaration");
+                tokenizer.errorAt(currentToken->start(), "Expected class variable or subroutine declaration");
             }
         }
 
         // 5. Expect closing brace '}'
         consume("}", "Expected '}' to close class body");
 
-        return std::make_unique<ClassNode>(className, std::move(classVars), std::move(subroutineDecs), line, col);
+        return arena.make<ClassNode>(className, arena.copyOf(classVars), arena.copyOf(subroutineDecs), offset);
     }
 
-    std::unique_ptr<ClassVarDecNode> Parser::parseClassVarDec() {
+    ClassVarDecNode* Parser::parseClassVarDec() {
         // Grammar: ('static' | 'field') type varName (',' varName)* ';'
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+        const std::uint32_t offset = currentToken->start();
 
         // 1. Determine if it's a static or field variable.
         // We assume the caller has already verified the token is "static" or "field".
@@ -140,18 +167,18 @@ namespace nand2tetris::jack {
         advance(); // Consume 'static' or 'field'
 
         // 2. Parse the type (int, char, boolean, or a class name).
-        std::string_view type = currentToken->getValue();
+        const NameId type = currentName();
         if (check("int")||check("boolean")||check("char")||check(TokenType::IDENTIFIER)) {
             advance();
         }else {
-            tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(), "Expected variable type (int, char, boolean, or class name)");
+            tokenizer.errorAt(currentToken->start(), "Expected variable type (int, char, boolean, or class name)");
         }
 
         // 3. Parse the list of variable names.
-        std::vector<std::string_view> names;
+        std::vector<NameId> names;
 
         // The first variable name is mandatory.
-        names.push_back(currentToken->getValue());
+        names.push_back(currentName());
         consume(TokenType::IDENTIFIER, "Expected variable name");
 
         // Handle multiple variables declared in the same line (e.g., static int x, y, z;)
@@ -160,36 +187,35 @@ namespace nand2tetris::jack {
                 advance(); // Consume the comma
             } else if (check(TokenType::IDENTIFIER)) {
                 // Predictive error handling: if we see an identifier but no comma, it's a likely syntax error.
-                tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(), "Missing ',' between variable identifiers");
+                tokenizer.errorAt(currentToken->start(), "Missing ',' between variable identifiers");
             } else if (check(";")) {
                 // Valid end of the list
                 break;
             }else {
-                tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(),"Expected ',' or ';' after variable name");
+                tokenizer.errorAt(currentToken->start(), "Expected ',' or ';' after variable name");
             }
 
             // Consume the next variable name
-            names.push_back(currentToken->getValue());
+            names.push_back(currentName());
             consume(TokenType::IDENTIFIER, "Expected variable name");
         }
 
         // 4. Expect the closing semicolon.
         consume(";", "Expected ';' at the end of variable declaration");
 
-        return std::make_unique<ClassVarDecNode>(kind, type, std::move(names), line, col);
+        return arena.make<ClassVarDecNode>(kind, type, arena.copyOf(names), offset);
     }
 
-    std::unique_ptr<SubroutineDecNode> Parser::parseSubroutine() {
+    SubroutineDecNode* Parser::parseSubroutine() {
         // Grammar: ('constructor' | 'function' | 'method') ('void' | type) subroutineName '(' parameterList ')'
         // subroutineBody: '{' varDec* statements '}'
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+        const std::uint32_t offset = currentToken->start();
 
         // 1. Determine the subroutine type (constructor, function, or method).
         SubroutineType type;
-        if (currentToken->getValue()=="constructor") {
+        if (currentText()=="constructor") {
             type=SubroutineType::CONSTRUCTOR;
-        }else if (currentToken->getValue()=="function") {
+        }else if (currentText()=="function") {
             type=SubroutineType::FUNCTION;
         }else {
             type=SubroutineType::METHOD;
@@ -198,19 +224,19 @@ namespace nand2tetris::jack {
 
         // 2. Parse the return type.
         // Can be 'void', a primitive type (int, boolean, char), or a class name (identifier).
-        std::string_view returnType;
-        if (currentToken->getValue()=="void") {
-            returnType="void";
+        NameId returnType = Interner::EMPTY;
+        if (currentText()=="void") {
+            returnType=Interner::VOID;
             advance();
         }else if (check("int")||check("boolean")||check("char")||check(TokenType::IDENTIFIER)) {
-            returnType=currentToken->getValue();
+            returnType=currentName();
             advance();
         }else {
-            tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(), "Expected return type void, int, char, boolean, or class name");
+            tokenizer.errorAt(currentToken->start(), "Expected return type void, int, char, boolean, or class name");
         }
 
         // 3. Parse the subroutine name.
-        std::string_view subroutineName=currentToken->getValue();
+        const NameId subroutineName=currentName();
         consume(TokenType::IDENTIFIER, "Expected subroutine name");
 
         // 4. Parse the parameter list enclosed in parentheses.
@@ -222,15 +248,15 @@ namespace nand2tetris::jack {
             // Loop to parse parameters separated by commas.
             while (true) {
                 // Parse parameter type
-                const std::string_view pType = currentToken->getValue();
+                const NameId pType = currentName();
                 if (check("int")||check("boolean")||check("char")||check(TokenType::IDENTIFIER)) {
                     advance();
                 }else {
-                    tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(), "Expected parameter type (int, char, boolean, or class name)");
+                    tokenizer.errorAt(currentToken->start(), "Expected parameter type (int, char, boolean, or class name)");
                 }
 
                 // Parse parameter name
-                const std::string_view pName = currentToken->getValue();
+                const NameId pName = currentName();
                 consume(TokenType::IDENTIFIER, "Expected parameter name");
 
                 parameters.push_back({pType, pName});
@@ -244,10 +270,10 @@ namespace nand2tetris::jack {
                     // PREDICTIVE ERROR: If we see a type-like keyword or an identifier,
                     // they definitely just forgot the comma.
                     if (check("int") || check("boolean") || check("char") || check(TokenType::IDENTIFIER)) {
-                        tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(), "Missing ',' between parameters");
+                        tokenizer.errorAt(currentToken->start(), "Missing ',' between parameters");
                     }
                     // If it's not a type, they probably forgot to close the list.
-                    tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(), "Expected ')' to close parameter list");
+                    tokenizer.errorAt(currentToken->start(), "Expected ')' to close parameter list");
                 }
             }
         }
@@ -256,27 +282,60 @@ namespace nand2tetris::jack {
         consume(")", "Expected ')' to close parameter list");
 
         //Convert AST Parameters to String Vector for Registry
-        std::vector<std::string_view> paramTypes;
+        std::vector<NameId> paramTypes;
         paramTypes.reserve(parameters.size());
         for (const auto& p : parameters) {
             paramTypes.push_back(p.type);
         }
 
         const bool isStatic = (type == SubroutineType::FUNCTION || type == SubroutineType::CONSTRUCTOR);
-        globalRegistry.registerMethod(
-        currentClassName,      // We saved this in parseClass
-        subroutineName,        // Parsed earlier in this function
-        returnType,            // Parsed earlier in this function
-        paramTypes,            // Created just now
-        isStatic,
-        line,                  // From start of subroutine
-        col
-    );
-
-        // 5. Parse the subroutine body.
+        if (registerSignatures) {
+            const std::optional<std::uint32_t> previous = globalRegistry.registerMethod(
+                currentClassName,      // We saved this in parseClass
+                subroutineName,        // Parsed earlier in this function
+                returnType,            // Parsed earlier in this function
+                paramTypes,            // Created just now
+                isStatic,
+                offset                 // From start of subroutine
+            );
+            if (previous) {
+                const SourcePosition at = tokenizer.lines().position(offset);
+                const SourcePosition before = tokenizer.lines().position(*previous);
+                throw CompileError(tokenizer.getFilePath(), at.line, at.column,
+                    "Semantic Error [" + std::string(nameOf(currentClassName)) + ".jack:" + std::to_string(at.line) + ":" +
+                    std::to_string(at.column) + "]: " +
+                    "Subroutine '" + std::string(nameOf(subroutineName)) + "' is already defined in class '" +
+                    std::string(nameOf(currentClassName)) + "' (Previous declaration at line " +
+                    std::to_string(before.line) + " " + std::to_string(before.column) + ").");
+            }
+        }
+
+        // 5. Parse the subroutine body, unless another parser is going to.
+        auto* node = arena.make<SubroutineDecNode>(type,returnType,subroutineName,arena.copyOf(parameters),
+                                                   NodeList<VarDecNode>(), NodeList<StatementNode>(), offset);
+        if (!deferBody(*node)) {
+            parseSubroutineBody(*node);
+        }
+        return node;
+    }
+
+    bool Parser::deferBody(SubroutineDecNode& node) {
+        if (nextBody >= bodyRanges.size() || !check("{")) return false;
+        const SourceRange& range = bodyRanges[nextBody];
+        if (currentToken->offset != range.begin) return false;
+
+        ++nextBody;
+        deferred.push_back({&node, range});
+        tokenizer.resumeAfter(range);
+        currentToken = &tokenizer.current();
+        return true;
+    }
+
+    void Parser::parseSubroutineBody(SubroutineDecNode& node) {
+        // Grammar: '{' varDec* statements '}'
         consume("{","Expected '{' to open subroutine body");
 
-        std::vector<std::unique_ptr<VarDecNode>> localVars;
+        std::vector<VarDecNode*> localVars;
 
         // Parse local variable declarations (must come before statements).
         while (check("var")) {
@@ -284,34 +343,32 @@ namespace nand2tetris::jack {
         }
 
         // Parse statements until the closing brace.
-        std::vector<std::unique_ptr<StatementNode> > statements = parseStatements();
+        node.statements = parseStatements();
+        node.localVars = arena.copyOf(localVars);
 
         consume("}","Expected '}' to close subroutine body");
-
-        return std::make_unique<SubroutineDecNode>(type,returnType,subroutineName,parameters,std::move(localVars),std::move(statements), line, col);
     }
 
-    std::unique_ptr<VarDecNode> Parser::parseVarDec() {
+    VarDecNode* Parser::parseVarDec() {
         // Grammar: 'var' type varName (',' varName)* ';'
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+        const std::uint32_t offset = currentToken->start();
 
         // 1. Consume 'var' keyword.
         consume("var", "Expected 'var' keyword");
 
         // 2. Parse the type (int, char, boolean, or a class name).
-        std::string_view type = currentToken->getValue();
+        const NameId type = currentName();
         if (check("int")||check("boolean")||check("char")||check(TokenType::IDENTIFIER)) {
             advance();
         }else {
-            tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(), "Expected variable type (int, char, boolean, or class name)");
+            tokenizer.errorAt(currentToken->start(), "Expected variable type (int, char, boolean, or class name)");
         }
 
         // 3. Parse the list of variable names.
-        std::vector<std::string_view> names;
+        std::vector<NameId> names;
 
         // First variable name is mandatory.
-        names.push_back(currentToken->getValue());
+        names.push_back(currentName());
         consume(TokenType::IDENTIFIER, "Expected variable name");
 
         // Handle multiple variables declared in the same line (e.g., var int x, y, z;)
@@ -320,31 +377,31 @@ namespace nand2tetris::jack {
                 advance(); // Consume the comma
             } else if (check(TokenType::IDENTIFIER)) {
                 // Predictive error handling: if we see an identifier but no comma, it's a likely syntax error.
-                tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(), "Missing ',' between variable identifiers");
+                tokenizer.errorAt(currentToken->start(), "Missing ',' between variable identifiers");
             } else {
                 break; // No comma and no identifier? The list is finished.
             }
 
             // Consume the next variable name
-            names.push_back(currentToken->getValue());
+            names.push_back(currentName());
             consume(TokenType::IDENTIFIER, "Expected variable name");
         }
 
         // 4. Expect the closing semicolon.
         consume(";", "Expected ';' at the end of variable declaration");
 
-        return std::make_unique<VarDecNode>(type,std::move(names), line, col);
+        return arena.make<VarDecNode>(type,arena.copyOf(names), offset);
     }
 
-    std::vector<std::unique_ptr<StatementNode>> Parser::parseStatements() {
-        std::vector<std::unique_ptr<StatementNode>> list;
+    NodeList<StatementNode> Parser::parseStatements() {
+        std::vector<StatementNode*> list;
         while (!check("}")) {
             list.push_back(parseStatement());
         }
-        return list;
+        return arena.copyOf(list);
     }
 
-    std::unique_ptr<StatementNode> Parser::parseStatement() {
+    StatementNode* Parser::parseStatement() {
         if (check("let")) {
             return parseLetStatement();
         }
@@ -362,22 +419,21 @@ namespace nand2tetris::jack {
         }
 
         // The 'Junk' Handler:
-        tokenizer.errorAt(currentToken->getLine(),currentToken->getColumn(), "Unknown statement or unexpected text");
+        tokenizer.errorAt(currentToken->start(), "Unknown statement or unexpected text");
     }
 
-    std::unique_ptr<LetStatementNode> Parser::parseLetStatement() {
+    LetStatementNode* Parser::parseLetStatement() {
         // Grammar: 'let' varName ('[' expression ']')? '=' expression ';'
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+        const std::uint32_t offset = currentToken->start();
 
         //move past let:
         consume("let","Expected a 'let' keyword");
 
         //get the variable name
-        std::string_view varName=currentToken->getValue();
+        const NameId varName=currentName();
         consume(TokenType::IDENTIFIER,"Expected variable name");
 
-        std::unique_ptr<ExpressionNode> indexExpr=nullptr; ///< The index expression for array assignment (optional).
+        ExpressionNode* indexExpr=nullptr; ///< The index expression for array assignment (optional).
         if (check("[")) {
             advance();
             indexExpr=parseExpression();
@@ -386,39 +442,35 @@ namespace nand2tetris::jack {
         // Checkpoint 2: If we didn't see '[', we MUST see '='.
         // If we see an identifier here, it's a specific error.
         else if (check(TokenType::IDENTIFIER)) {
-            tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(),
-                              "Unexpected identifier; perhaps you forgot a '[' for an array?");
+            tokenizer.errorAt(currentToken->start(), "Unexpected identifier; perhaps you forgot a '[' for an array?");
         }
         // If we see anything else that isn't '=', it's a general assignment error.
         else if (!check("=")) {
-            tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(),
-                              "Expected '=' after variable name");
+            tokenizer.errorAt(currentToken->start(), "Expected '=' after variable name");
         }
 
         consume("=","Expected an `=`");
 
-        std::unique_ptr<ExpressionNode> exp=parseExpression();
+        ExpressionNode* exp=parseExpression();
 
         consume(";", "Expected ';' at end of let statement");
 
-        return std::make_unique<LetStatementNode>(varName, std::move(indexExpr), std::move(exp), line, col);
+        return arena.make<LetStatementNode>(varName, indexExpr, exp, offset);
     }
 
-    std::unique_ptr<IfStatementNode> Parser::parseIfStatement() {
+    IfStatementNode* Parser::parseIfStatement() {
         // Grammar: 'if' '(' expression ')' '{' statements '}' ('else' '{' statements '}')?
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+        const std::uint32_t offset = currentToken->start();
 
         consume("if", "Expected 'if' keyword");
 
         // 1. Condition Header '('
         consume("(", "Expected '(' after 'if'");
-        std::unique_ptr<ExpressionNode> condition=parseExpression();
+        ExpressionNode* condition=parseExpression();
         // 2. Condition Closer ')'
         // If it's missing, we check if they accidentally started the block '{' early.
         if (check("{")) {
-            tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(),
-                              "Missing ')' before opening brace '{'");
+            tokenizer.errorAt(currentToken->start(), "Missing ')' before opening brace '{'");
         }
 
         consume(")", "Expected ')' after if-condition");
@@ -426,10 +478,10 @@ namespace nand2tetris::jack {
 
         // 3. If-Body '{ statements }'
         consume("{", "Expected '{' to start if-block");
-        std::vector<std::unique_ptr<StatementNode>> ifStatements=parseStatements();
+        NodeList<StatementNode> ifStatements = parseStatements();
         consume("}", "Expected '}' to close if-block");
 
-        std::vector<std::unique_ptr<StatementNode>> elseStatements;
+        NodeList<StatementNode> elseStatements;
         if (check("else")) {
             advance(); // consume 'else'
             consume("{", "Expected '{' to start else-block");
@@ -437,41 +489,39 @@ namespace nand2tetris::jack {
             consume("}", "Expected '}' to close else-block");
         }
 
-        return std::make_unique<IfStatementNode>(std::move(condition), std::move(ifStatements), std::move(elseStatements), line, col);
+        return arena.make<IfStatementNode>(condition, ifStatements, elseStatements, offset);
     }
 
 
-    std::unique_ptr<WhileStatementNode> Parser::parseWhileStatement() {
+    WhileStatementNode* Parser::parseWhileStatement() {
         // Grammar: 'while' '(' expression ')' '{' statements '}'
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+        const std::uint32_t offset = currentToken->start();
 
         consume("while", "Expected 'while' keyword");
 
         // 1. Condition
         consume("(", "Expected '(' after 'while'");
-        std::unique_ptr<ExpressionNode> condition = parseExpression();
+        ExpressionNode* condition = parseExpression();
         if (check("{")) {
-            tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(),"Missing ')' before opening brace '{'");
+            tokenizer.errorAt(currentToken->start(), "Missing ')' before opening brace '{'");
         }
         consume(")", "Expected ')' after while-condition");
 
         // 2. Body
         consume("{", "Expected '{' to start while-loop body");
-        std::vector<std::unique_ptr<StatementNode>> body = parseStatements();
+        NodeList<StatementNode> body = parseStatements();
         consume("}", "Expected '}' to close while-loop body");
 
-        return std::make_unique<WhileStatementNode>(std::move(condition), std::move(body), line, col);
+        return arena.make<WhileStatementNode>(condition, body, offset);
     }
 
-    std::unique_ptr<ReturnStatementNode> Parser::parseReturnStatement() {
+    ReturnStatementNode* Parser::parseReturnStatement() {
         // Grammar: 'return' expression? ';'
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+        const std::uint32_t offset = currentToken->start();
 
         consume("return", "Expected 'return' keyword");
 
-        std::unique_ptr<ExpressionNode> value = nullptr;
+        ExpressionNode* value = nullptr;
 
         // 1. Check if there is an expression to return.
         // In Jack, if the next token is not ';', it MUST be an expression.
@@ -479,8 +529,7 @@ namespace nand2tetris::jack {
             // Handle "junk" or missing semicolon cases:
             // If we see a '}' or another statement keyword, they likely forgot the ';'
             if (check("}") || check("let") || check("if") || check("while") || check("do")) {
-                tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(),
-                                  "Missing ';' after return keyword");
+                tokenizer.errorAt(currentToken->start(), "Missing ';' after return keyword");
             }
             // It's not a ';' and not a new block/statement, so it must be an expression.
             value = parseExpression();
@@ -489,40 +538,38 @@ namespace nand2tetris::jack {
         // 2. Final check for the semicolon
         consume(";", "Expected ';' after return statement");
 
-        return std::make_unique<ReturnStatementNode>(std::move(value), line, col);
+        return arena.make<ReturnStatementNode>(value, offset);
     }
 
 
-    std::unique_ptr<DoStatementNode> Parser::parseDoStatement() {
+    DoStatementNode* Parser::parseDoStatement() {
         //Grammar: `do' subroutineName '('expressionList')'|(className|varName)`.` subroutineName
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+        const std::uint32_t offset = currentToken->start();
 
         consume("do","Expected 'do' keyword");
-        std::unique_ptr<CallNode> call = parseSubroutineCall();
+        CallNode* call = parseSubroutineCall();
         consume(";", "Expected ';' after do subroutine call");
-        return std::make_unique<DoStatementNode>(std::move(call), line, col);
+        return arena.make<DoStatementNode>(call, offset);
 
     }
 
-    std::unique_ptr<ExpressionNode> Parser::parseExpression() {
+    ExpressionNode* Parser::parseExpression() {
         // Grammar: term (op term)*
         // op: + - * / & | < > =
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+        const std::uint32_t offset = currentToken->start();
 
         // 1. Compile the first term
-        std::unique_ptr<ExpressionNode> left_term=parseTerm();
+        ExpressionNode* left_term=parseTerm();
 
         // 2. Look for binary operators: +, -, *, /, &, |, <, >, =
         while (isBinaryOp()) {
-            char op = currentToken->getValue()[0];
+            char op = currentText()[0];
             advance(); // consume the operator
-            std::unique_ptr<ExpressionNode> right_term = parseTerm();
+            ExpressionNode* right_term = parseTerm();
 
             // Wrap the existing 'left' and the new 'right' into a new BinaryOpNode
             // This handles left-associativity (e.g., 1 + 2 + 3)
-            left_term = std::make_unique<BinaryOpNode>(std::move(left_term), op, std::move(right_term), line, col);
+            left_term = arena.make<BinaryOpNode>(left_term, op, right_term, offset);
         }
 
         return left_term;
@@ -534,106 +581,104 @@ namespace nand2tetris::jack {
             return false;
         }
 
-        const std::string_view val = currentToken->getValue();
+        const std::string_view val = currentText();
 
         return val == "+" || val == "-" || val == "*" || val == "/" ||
            val == "&" || val == "|" || val == "<" || val == ">" || val == "=";
     }
 
 
-    std::unique_ptr<ExpressionNode> Parser::parseTerm() {
+    ExpressionNode* Parser::parseTerm() {
         // Grammar: integerConstant | stringConstant | keywordConstant | varName |
         //          varName '[' expression ']' | subroutineCall | '(' expression ')' | unaryOp term
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+        const std::uint32_t offset = currentToken->start();
 
         // 1. Integer Constant
         if (check(TokenType::INT_CONST)) {
-            const auto* intToken = static_cast<const IntToken*>(currentToken);// NOLINT(*-pro-type-static-cast-downcast)
-            int val = intToken->getInt();
+            int val = currentToken->getInt();
             advance();
-            return std::make_unique<IntegerLiteralNode>(val, line, col);
+            return arena.make<IntegerLiteralNode>(val, offset);
         }
 
         // 2. String Constant
         if (check(TokenType::STRING_CONST)) {
-            std::string_view val = currentToken->getValue();
+            std::string_view val = currentText();
             advance();
-            return std::make_unique<StringLiteralNode>(val, line, col);
+            return arena.make<StringLiteralNode>(val, offset);
         }
 
         // 3. Keyword Constant (true, false, null, this)
         if (currentToken->getType()==TokenType::KEYWORD) {
-            const std::string_view val=currentToken->getValue();
+            const std::string_view val=currentText();
 
             if (val == "true") {
                 advance();
-                return std::make_unique<KeywordLiteralNode>(Keyword::TRUE_, line, col);
+                return arena.make<KeywordLiteralNode>(Keyword::TRUE_, offset);
             } else if (val == "false") {
                 advance();
-                return std::make_unique<KeywordLiteralNode>(Keyword::FALSE_, line, col);
+                return arena.make<KeywordLiteralNode>(Keyword::FALSE_, offset);
             } else if (val == "null") {
                 advance();
-                return std::make_unique<KeywordLiteralNode>(Keyword::NULL_, line, col);
+                return arena.make<KeywordLiteralNode>(Keyword::NULL_, offset);
             } else if (val == "this") {
                 advance();
-                return std::make_unique<KeywordLiteralNode>(Keyword::THIS_, line, col);
+                return arena.make<KeywordLiteralNode>(Keyword::THIS_, offset);
             }else {
-                tokenizer.errorAt(currentToken->getLine(),currentToken->getColumn(),"Inappropriate keyword used in expression.");
+                tokenizer.errorAt(currentToken->start(), "Inappropriate keyword used in expression.");
             }
         }
 
 
         // 4. Identifier (Variable, Array Access, or Subroutine Call)
         if (check(TokenType::IDENTIFIER)) {
-            std::string_view name = currentToken->getValue();
+            const NameId name = currentName();
 
             // Use PEEK to distinguish between x, x[i], and x.method()
             const Token& next = tokenizer.peek();
-            if (next.getValue()=="[") {
+            if (tokenizer.text(next)=="[") {
                 // Array Access: varName '[' expression ']'
                 advance(); //consume name
                 advance(); // consume '['
-                std::unique_ptr<ExpressionNode> exp=parseExpression();
+                ExpressionNode* exp=parseExpression();
                 consume("]", "Expected ']' after array index");
-                return std::make_unique<IdentifierNode>(name, line, col, std::move(exp));
-            }else if (next.getValue()=="("||next.getValue()==".") {
+                return arena.make<IdentifierNode>(name, offset, exp);
+            }else if (tokenizer.text(next)=="("||tokenizer.text(next)==".") {
                 // Subroutine Call
                 return parseSubroutineCall();
             }else {
                 // Simple Variable
                 advance();
-                return std::make_unique<IdentifierNode>(name, line, col);
+                return arena.make<IdentifierNode>(name, offset);
             }
         }
 
         // 5. Parenthesized Expression: '(' expression ')'
         if (check("(")) {
             advance();
-            std::unique_ptr<ExpressionNode> expr = parseExpression();
+            ExpressionNode* expr = parseExpression();
             consume(")", "Expected ')' to close expression");
             return expr;
         }
 
         // 6. Unary Operators: '-' or '~'
         if (check("-") || check("~")) {
-            char op = currentToken->getValue()[0];
+            char op = currentText()[0];
             advance();
-            std::unique_ptr<ExpressionNode> term = parseTerm();
-            return std::make_unique<UnaryOpNode>(op, std::move(term), line, col);
+            ExpressionNode* term = parseTerm();
+            return arena.make<UnaryOpNode>(op, term, offset);
         }
 
-        const std::string err = "Expected an expression term, but found '" + std::string(currentToken->getValue()) + "'";
-        tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(), err);
+        const std::string err = "Expected an expression term, but found '" + std::string(currentText()) + "'";
+        tokenizer.errorAt(currentToken->start(), err);
     }
 
 
-    std::vector<std::unique_ptr<ExpressionNode>> Parser::parseExpressionList() {
-        std::vector<std::unique_ptr<ExpressionNode>> list;
+    NodeList<ExpressionNode> Parser::parseExpressionList() {
+        std::vector<ExpressionNode*> list;
 
         // 1. Handle the empty list case: do method()
         if (check(")")) {
-            return list;
+            return arena.copyOf(list);
         }
 
         // 2. Parse the first mandatory expression (must exist if not followed immediately by ')'
@@ -652,30 +697,28 @@ namespace nand2tetris::jack {
             else {
                 // FOCUSED ERROR: If we find a new term/junk without a comma or closing ')'.
                 // Because errorAt throws an exception, this safely terminates the parse.
-                tokenizer.errorAt(currentToken->getLine(), currentToken->getColumn(),
-                                  "Expected ',' between arguments");
+                tokenizer.errorAt(currentToken->start(), "Expected ',' between arguments");
             }
         }
 
-        return list;
+        return arena.copyOf(list);
     }
 
-    std::unique_ptr<CallNode> Parser::parseSubroutineCall() {
-        int line = currentToken->getLine();
-        int col = currentToken->getColumn();
+    CallNode* Parser::parseSubroutineCall() {
+        const std::uint32_t offset = currentToken->start();
 
         // Save the first identifier to determine context later
-        const std::string_view firstPart = currentToken->getValue();
+        const NameId firstPart = currentName();
         consume(TokenType::IDENTIFIER, "Expected subroutine, class, or variable name");
 
-        std::string_view classNameOrVar;
-        std::string_view subroutineName;
+        NameId classNameOrVar = Interner::EMPTY;
+        NameId subroutineName = Interner::EMPTY;
 
         // 1. Check for the dot '.' symbol (indicates a call on an object or a static class method)
         if (check(".")) {
             advance(); // Move past '.'
             classNameOrVar = firstPart; // The first part was the class/variable name
-            subroutineName = currentToken->getValue();
+            subroutineName = currentName();
             consume(TokenType::IDENTIFIER, "Expected subroutine name after '.'");
         } else {
             // 2. Direct call (e.g., draw()): The first part was the actual subroutine name
@@ -686,13 +729,13 @@ namespace nand2tetris::jack {
         consume("(", "Expected '(' for argument list");
 
         // Call our helper to parse zero or more expressions
-        std::vector<std::unique_ptr<ExpressionNode>> agrs = parseExpressionList();
+        NodeList<ExpressionNode> agrs = parseExpressionList();
 
         // Ensure the argument list is properly closed
         consume(")", "Expected ')' to close argument list");
 
         // Return the AST node with all captured information
-        return std::make_unique<CallNode>(classNameOrVar, subroutineName, std::move(agrs), line, col);
+        return arena.make<CallNode>(classNameOrVar, subroutineName, agrs, offset);
     }
     
 }
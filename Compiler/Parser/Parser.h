@@ -13,6 +13,14 @@
 
 namespace nand2tetris::jack {
 
+    /**
+     * @brief A subroutine whose body the parser skipped, to be filled in by Parser::parseBody().
+     */
+    struct DeferredBody {
+        SubroutineDecNode* subroutine; ///< The declaration, with no locals or statements yet.
+        SourceRange range;             ///< The body, `{` to `}` inclusive.
+    };
+
     /**
      * @brief A recursive descent parser for the Jack language.
      *
@@ -23,7 +31,12 @@ namespace nand2tetris::jack {
     class Parser {
         Tokenizer& tokenizer;           ///< Reference to the tokenizer providing the token stream.
         GlobalRegistry& globalRegistry;
+        Arena& arena;                   ///< Owns every node this parser creates.
+        bool registerSignatures;        ///< Whether the class and its subroutines go into the registry.
         const Token* currentToken = nullptr; ///< Pointer to the current token being processed.
+        Span<SourceRange> bodyRanges;        ///< Subroutine bodies to skip, from deferBodies().
+        std::size_t nextBody = 0;            ///< First entry of bodyRanges not yet reached.
+        std::vector<DeferredBody> deferred;  ///< Bodies skipped so far.
 
         // --- Helper Methods ---
 
@@ -34,6 +47,16 @@ namespace nand2tetris::jack {
          */
         void advance();
 
+        /**
+         * @brief Returns the source text of the current token.
+         */
+        std::string_view currentText() const;
+
+        /**
+         * @brief Returns the interned name of the current token.
+         */
+        NameId currentName() const;
+
         /**
          * @brief Checks if the current token matches a specific type.
          *
@@ -75,117 +98,133 @@ namespace nand2tetris::jack {
          *
          * Grammar: 'class' className '{' classVarDec* subroutineDec* '}'
          *
-         * @return A unique_ptr to the resulting ClassNode.
+         * @return A pointer to the resulting ClassNode.
          */
-        std::unique_ptr<ClassNode> parseClass();
+        ClassNode* parseClass();
 
         /**
          * @brief Parses a static or field variable declaration.
          *
          * Grammar: ('static' | 'field') type varName (',' varName)* ';'
          *
-         * @return A unique_ptr to the resulting ClassVarDecNode.
+         * @return A pointer to the resulting ClassVarDecNode.
          */
-        std::unique_ptr<ClassVarDecNode> parseClassVarDec();
+        ClassVarDecNode* parseClassVarDec();
 
         /**
          * @brief Parses a subroutine (constructor, function, or method).
          *
          * Grammar: ('constructor' | 'function' | 'method') ('void' | type) subroutineName '(' parameterList ')' subroutineBody
          *
-         * @return A unique_ptr to the resulting SubroutineDecNode.
+         * @return A pointer to the resulting SubroutineDecNode.
+         */
+        SubroutineDecNode* parseSubroutine();
+
+        /**
+         * @brief Parses a subroutine body into an existing declaration.
+         *
+         * Grammar: '{' varDec* statements '}'
+         *
+         * @param node The declaration that receives the local variables and statements.
+         */
+        void parseSubroutineBody(SubroutineDecNode& node);
+
+        /**
+         * @brief Skips the body of the subroutine being parsed if it is the next one from deferBodies().
+         *
+         * @return True if the body was skipped and recorded in `deferred`.
          */
-        std::unique_ptr<SubroutineDecNode> parseSubroutine();
+        bool deferBody(SubroutineDecNode& node);
 
         /**
          * @brief Parses a local variable declaration.
          *
          * Grammar: 'var' type varName (',' varName)* ';'
          *
-         * @return A unique_ptr to the resulting VarDecNode.
+         * @return A pointer to the resulting VarDecNode.
          */
-        std::unique_ptr<VarDecNode> parseVarDec();
+        VarDecNode* parseVarDec();
 
         /**
          * @brief Parses a sequence of statements.
          *
          * Grammar: statement*
          *
-         * @return A vector of unique_ptrs to StatementNodes.
+         * @return The list of StatementNodes.
          */
-        std::vector<std::unique_ptr<StatementNode>> parseStatements();
+        NodeList<StatementNode> parseStatements();
 
         /**
          * @brief Parses a single statement.
          *
          * Dispatches to specific statement parsers (let, if, while, do, return) based on the keyword.
          *
-         * @return A unique_ptr to the resulting StatementNode.
+         * @return A pointer to the resulting StatementNode.
          */
-        std::unique_ptr<StatementNode> parseStatement();
+        StatementNode* parseStatement();
 
         /**
          * @brief Parses a 'let' statement.
          *
          * Grammar: 'let' varName ('[' expression ']')? '=' expression ';'
          *
-         * @return A unique_ptr to the resulting LetStatementNode.
+         * @return A pointer to the resulting LetStatementNode.
          */
-        std::unique_ptr<LetStatementNode> parseLetStatement();
+        LetStatementNode* parseLetStatement();
 
         /**
          * @brief Parses an 'if' statement.
          *
          * Grammar: 'if' '(' expression ')' '{' statements '}' ('else' '{' statements '}')?
          *
-         * @return A unique_ptr to the resulting IfStatementNode.
+         * @return A pointer to the resulting IfStatementNode.
          */
-        std::unique_ptr<IfStatementNode> parseIfStatement();
+        IfStatementNode* parseIfStatement();
 
         /**
          * @brief Parses a 'while' statement.
          *
          * Grammar: 'while' '(' expression ')' '{' statements '}'
          *
-         * @return A unique_ptr to the resulting WhileStatementNode.
+         * @return A pointer to the resulting WhileStatementNode.
          */
-        std::unique_ptr<WhileStatementNode> parseWhileStatement();
+        WhileStatementNode* parseWhileStatement();
 
         /**
          * @brief Parses a 'do' statement.
          *
          * Grammar: 'do' subroutineCall ';'
          *
-         * @return A unique_ptr to the resulting DoStatementNode.
+         * @return A pointer to the resulting DoStatementNode.
          */
-        std::unique_ptr<DoStatementNode> parseDoStatement();
+        DoStatementNode* parseDoStatement();
 
         /**
          * @brief Parses a 'return' statement.
          *
          * Grammar: 'return' expression? ';'
          *
-         * @return A unique_ptr to the resulting ReturnStatementNode.
+         * @return A pointer to the resulting ReturnStatementNode.
          */
-        std::unique_ptr<ReturnStatementNode> parseReturnStatement();
+        ReturnStatementNode* parseReturnStatement();
 
         /**
          * @brief Parses an expression.
          *
          * Grammar: term (op term)*
          *
-         * @return A unique_ptr to the resulting ExpressionNode.
+         * @return A pointer to the resulting ExpressionNode.
          */
-        std::unique_ptr<ExpressionNode> parseExpression();
+        ExpressionNode* parseExpression();
 
         /**
          * @brief Parses a term within an expression.
          *
          * Grammar: integerConstant | stringConstant | keywordConstant | varName | varName '[' expression ']' | subroutineCall | '(' expression ')' | unaryOp term
          *
-         * @return A unique_ptr to the resulting ExpressionNode (which is a specific type of term).
+         * @return A pointer to the resulting ExpressionNode (which is a specific type of term).
          */
-        std::unique_ptr<ExpressionNode> parseTerm();
+        ExpressionNode* parseTerm();
 
         /**
          * @brief Parses a comma-separated list of expressions.
@@ -193,18 +232,18 @@ namespace nand2tetris::jack {
          * Used in subroutine calls.
          * Grammar: (expression (',' expression)*)?
          *
-         * @return A vector of expression nodes.
+         * @return The list of expression nodes.
          */
-        std::vector<std::unique_ptr<ExpressionNode>> parseExpressionList();
+        NodeList<ExpressionNode> parseExpressionList();
 
         /**
          * @brief Parses a subroutine call.
          *
          * Grammar: subroutineName '(' expressionList ')' | (className | varName) '.' subroutineName '(' expressionList ')'
          *
-         * @return A unique_ptr to the resulting CallNode.
+         * @return A pointer to the resulting CallNode.
          */
-        std::unique_ptr<CallNode> parseSubroutineCall();
+        CallNode* parseSubroutineCall();
 
         /**
          * @brief Checks if the current token is a binary operator.
@@ -215,7 +254,7 @@ namespace nand2tetris::jack {
          */
         bool isBinaryOp() const;
 
-        std::string_view currentClassName;
+        NameId currentClassName = Interner::EMPTY;
 
         public:
             /**
@@ -223,17 +262,48 @@ namespace nand2tetris::jack {
              *
              * @param tokenizer The tokenizer instance to use.
              * @param registry
+             * @param arena The arena the AST is allocated in. It must outlive the returned tree.
+             * @param registerSignatures False if the registry already holds this class's signatures
+             *                           (restored from the build cache), so they are not registered twice.
              */
-            explicit Parser(Tokenizer& tokenizer, GlobalRegistry &registry);
+            explicit Parser(Tokenizer& tokenizer, GlobalRegistry &registry, Arena& arena, bool registerSignatures = true);
 
             /**
              * @brief Parses the entire token stream into an Abstract Syntax Tree.
              *
              * Starts parsing from the 'class' rule.
              *
-             * @return A unique_ptr to the root ClassNode of the AST.
+             * @return A pointer to the root ClassNode of the AST (owned by the arena).
+             */
+            ClassNode* parse();
+
+            /**
+             * @brief Makes parse() skip over subroutine bodies, leaving them to parseBody().
+             *
+             * The class outline (fields and subroutine signatures, all registered as usual) is parsed
+             * here; a body is skipped when it starts exactly where the next range does, so a range list
+             * that disagrees with the real syntax only means the body is parsed in place instead.
+             *
+             * @param bodies Subroutine bodies in source order, as found by Tokenizer::scanSubroutineBodies().
+             *               The list must outlive the call to parse().
+             */
+            void deferBodies(const std::vector<SourceRange>& bodies);
+
+            /**
+             * @brief The bodies skipped so far, in source order (also valid after parse() has thrown).
+             */
+            const std::vector<DeferredBody>& deferredBodies() const { return deferred; }
+
+            /**
+             * @brief Parses a body skipped by another parser of the same file.
+             *
+             * This parser must be reading just that body, i.e. be built on
+             * `Tokenizer(file, body.range)`, with registerSignatures off.
+             *
+             * @param body The body to parse; its declaration is completed in place.
+             * @throws std::runtime_error on a syntax error, exactly as parse() would have reported it.
              */
-            std::unique_ptr<ClassNode> parse();
+            void parseBody(const DeferredBody& body);
     };
 };
 
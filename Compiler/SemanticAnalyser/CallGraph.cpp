@@ -0,0 +1,65 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "CallGraph.h"
+#include <string_view>
+#include <utility>
+
+namespace nand2tetris::jack {
+
+    namespace {
+        // Called without a call in the source: by the VM bootstrap (Sys.init), by Sys.init (Main.main) and
+        // by the code generator (constructors, '*', '/' and string constants).
+        constexpr std::pair<std::string_view, std::string_view> DEFAULT_ROOTS[] = {
+            {"Main", "main"}, {"Sys", "init"}, {"Memory", "alloc"}, {"Math", "multiply"},
+            {"Math", "divide"}, {"String", "new"}, {"String", "appendChar"},
+        };
+    }
+
+    void CallGraph::addClass(const NameId className, const std::vector<SubroutineCalls>& subroutines) {
+        std::vector<NameId>& order = classes[className];
+        for (const SubroutineCalls& sub : subroutines) {
+            order.push_back(sub.subroutine);
+            nodes[key(className, sub.subroutine)].callees = sub.callees;
+        }
+    }
+
+    void CallGraph::addDefaultRoots() {
+        Interner& names = Interner::global();
+        for (const auto& [className, subroutine] : DEFAULT_ROOTS) {
+            roots.push_back({names.intern(className), names.intern(subroutine)});
+        }
+    }
+
+    void CallGraph::solve() {
+        reachableCount = 0;
+        for (auto& [k, node] : nodes) node.reachable = false;
+
+        std::vector<SubroutineRef> pending = roots;
+        while (!pending.empty()) {
+            const SubroutineRef next = pending.back();
+            pending.pop_back();
+            const auto it = nodes.find(key(next.className, next.subroutine));
+            if (it == nodes.end() || it->second.reachable) continue;
+            it->second.reachable = true;
+            ++reachableCount;
+            pending.insert(pending.end(), it->second.callees.begin(), it->second.callees.end());
+        }
+    }
+
+    bool CallGraph::isReachable(const NameId className, const NameId subroutine) const {
+        const auto it = nodes.find(key(className, subroutine));
+        return it == nodes.end() || it->second.reachable;
+    }
+
+    std::vector<NameId> CallGraph::unreachableOf(const NameId className) const {
+        std::vector<NameId> unreachable;
+        const auto it = classes.find(className);
+        if (it == classes.end()) return unreachable;
+        for (const NameId sub : it->second) {
+            if (!isReachable(className, sub)) unreachable.push_back(sub);
+        }
+        return unreachable;
+    }
+}
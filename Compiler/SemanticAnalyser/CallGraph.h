@@ -0,0 +1,104 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_CALL_GRAPH_H
+#define NAND2TETRIS_CALL_GRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "../Common/Interner.h"
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief A subroutine of the program, by class and subroutine name.
+     */
+    struct SubroutineRef {
+        NameId className = Interner::EMPTY;
+        NameId subroutine = Interner::EMPTY;
+
+        bool operator==(const SubroutineRef& other) const {
+            return className == other.className && subroutine == other.subroutine;
+        }
+        bool operator<(const SubroutineRef& other) const {
+            return className != other.className ? className < other.className : subroutine < other.subroutine;
+        }
+    };
+
+    /**
+     * @brief The subroutines one subroutine calls, as resolved by the SemanticAnalyser.
+     */
+    struct SubroutineCalls {
+        NameId subroutine = Interner::EMPTY;
+        std::vector<SubroutineRef> callees; ///< Sorted, without duplicates.
+    };
+
+    /**
+     * @brief The whole program's call graph, for dead subroutine elimination (--dce).
+     *
+     * Every class the build emits adds its subroutines and their call edges; solve() then marks what can
+     * be reached from the roots (Main.main and whatever the generated code and the VM bootstrap call
+     * without a call in the source). Calls to classes the program does not declare, i.e. the built-in
+     * OS, lead nowhere: that code is not emitted by this build anyway.
+     *
+     * Not thread-safe; it is built after analysis, on one thread.
+     */
+    class CallGraph {
+        public:
+            /**
+             * @brief Adds the subroutines of a class, in declaration order, with their calls.
+             */
+            void addClass(NameId className, const std::vector<SubroutineCalls>& subroutines);
+
+            /**
+             * @brief Adds the entry points: Main.main, Sys.init and the OS routines the code generator
+             *        calls on its own (Memory.alloc, Math.multiply, String.new, ...).
+             */
+            void addDefaultRoots();
+
+            /**
+             * @brief Marks every subroutine reachable from the roots.
+             */
+            void solve();
+
+            /**
+             * @brief True if the subroutine can run: reachable after solve(), or not in the graph at all.
+             */
+            bool isReachable(NameId className, NameId subroutine) const;
+
+            /**
+             * @brief The subroutines of a class solve() found unreachable, in declaration order.
+             */
+            std::vector<NameId> unreachableOf(NameId className) const;
+
+            /**
+             * @brief Number of subroutines in the graph.
+             */
+            std::size_t subroutineCount() const { return nodes.size(); }
+
+            /**
+             * @brief Number of subroutines solve() found unreachable.
+             */
+            std::size_t unreachableCount() const { return nodes.size() - reachableCount; }
+
+        private:
+            struct Node {
+                std::vector<SubroutineRef> callees;
+                bool reachable = false;
+            };
+
+            static std::uint64_t key(const NameId className, const NameId subroutine) {
+                return static_cast<std::uint64_t>(className) << 32 | subroutine;
+            }
+
+            std::unordered_map<std::uint64_t, Node> nodes;
+            std::unordered_map<NameId, std::vector<NameId>> classes; ///< Subroutines in declaration order.
+            std::vector<SubroutineRef> roots;
+            std::size_t reachableCount = 0;
+    };
+}
+
+#endif //NAND2TETRIS_CALL_GRAPH_H
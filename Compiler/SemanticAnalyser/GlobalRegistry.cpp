@@ -3,167 +3,239 @@
 //
 
 #include "GlobalRegistry.h"
+#include "StandardLibrary.h"
+#include "../Common/Hash.h"
+#include <algorithm>
+#include <stdexcept>
 
 namespace nand2tetris::jack {
-    void GlobalRegistry::registerClass(const std::string_view className) {
-        std::scoped_lock lock(mtx);
-        // Insert the class name into the set of known classes.
-        classes.insert(className);
+    namespace {
+        std::uint64_t signatureHash(const NameId name, const MethodSignature& sig) {
+            std::uint64_t hash = fnv1a(nameOf(name));
+            hash = fnv1a(sig.isStatic ? "|function|" : "|method|", hash);
+            hash = fnv1a(nameOf(sig.returnType), hash);
+            for (const NameId param : sig.parameters) {
+                hash = fnv1a(",", hash);
+                hash = fnv1a(nameOf(param), hash);
+            }
+            return hash;
+        }
     }
 
-    GlobalRegistry::GlobalRegistry() {
-        loadStandardLibrary();
+    bool GlobalRegistry::registerClass(const NameId className) {
+        if (frozen) throw std::logic_error("GlobalRegistry::registerClass called after freeze()");
+        Shard& shard = shardFor(className);
+        std::scoped_lock lock(shard.mtx);
+        // Mark the class as declared; report whether someone else got there first.
+        PendingClass& entry = shard.classes[className];
+        if (entry.declared) return false;
+        entry.declared = true;
+        return true;
     }
 
-    void GlobalRegistry::registerMethod(const std::string_view className, const std::string_view methodName,
-                                        const std::string_view returnType, const std::vector<std::string_view> &params, const bool isStatic,const int
-                                        line, const int column) {
-        std::scoped_lock lock(mtx);
+    void GlobalRegistry::markOsSource(const NameId className) {
+        if (frozen) throw std::logic_error("GlobalRegistry::markOsSource called after freeze()");
+        Shard& shard = shardFor(className);
+        std::scoped_lock lock(shard.mtx);
+        shard.classes[className].osSource = true;
+    }
 
-        // Check for duplicate method definition within the same class.
-        if (methods[className].count(methodName)) {
-            const auto& existing = methods[className][methodName];
-            const std::string msg =
-                "Semantic Error [" + std::to_string(line) + ":" + std::to_string(column) + "]: " +
-                "Subroutine '" + std::string(methodName) + "' is already defined in class '" +
-                std::string(className) + "' (Previous declaration at line " +
-                std::to_string(existing.line)+" "+std::to_string(existing.column) + ").";
+    std::optional<std::uint32_t> GlobalRegistry::registerMethod(const NameId className, const NameId methodName,
+                                        const NameId returnType, const std::vector<NameId> &params, const bool isStatic,
+                                        const std::uint32_t offset) {
+        if (frozen) throw std::logic_error("GlobalRegistry::registerMethod called after freeze()");
+        Shard& shard = shardFor(className);
+        std::scoped_lock lock(shard.mtx);
+        auto& classMethods = shard.classes[className].methods;
 
-            throw std::runtime_error(msg);
-        }
+        // Check for duplicate method definition within the same class; the caller knows the source
+        // and turns the offsets into a message.
+        const auto existingIt = classMethods.find(methodName);
+        if (existingIt != classMethods.end()) return existingIt->second.offset;
 
         // Store the method signature.
-        methods[className][methodName] = {returnType, params, isStatic, line,column};
+        classMethods.emplace(methodName, PendingMethod{returnType, params, isStatic, offset});
+        return std::nullopt;
+    }
+
+    void GlobalRegistry::freeze() {
+        if (frozen) throw std::logic_error("GlobalRegistry::freeze called twice");
+
+        // Gather every class from every shard and lay them out in NameId order.
+        std::vector<std::pair<NameId, PendingClass*>> pending;
+        for (Shard& shard : shards) {
+            std::scoped_lock lock(shard.mtx);
+            for (auto& [name, entry] : shard.classes) {
+                pending.emplace_back(name, &entry);
+            }
+        }
+        std::sort(pending.begin(), pending.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        classTable.clear();
+        methodTable.clear();
+        parameterPool.clear();
+        classTable.reserve(pending.size());
+        NameId maxName = 0;
+        int declaredClassCount = 0;
+
+        // Reserve up front so the parameter spans handed out below never move.
+        std::size_t totalParams = 0;
+        for (const auto& [name, entry] : pending) {
+            for (const auto& [methodName, method] : entry->methods) totalParams += method.parameters.size();
+        }
+        parameterPool.reserve(totalParams);
+
+        for (auto& [name, entry] : pending) {
+            const auto first = static_cast<std::uint32_t>(methodTable.size());
+            for (const auto& [methodName, method] : entry->methods) {
+                const Span<NameId> params(parameterPool.data() + parameterPool.size(), method.parameters.size());
+                parameterPool.insert(parameterPool.end(), method.parameters.begin(), method.parameters.end());
+                methodTable.push_back({methodName, MethodSignature{method.returnType, params, method.isStatic,
+                                                                   method.offset}});
+            }
+            std::sort(methodTable.begin() + first, methodTable.end(),
+                      [](const MethodRecord& a, const MethodRecord& b) { return a.name < b.name; });
+
+            classTable.push_back({name, entry->declared, entry->osSource, first,
+                                  static_cast<std::uint32_t>(methodTable.size()) - first});
+            if (entry->declared) ++declaredClassCount;
+            maxName = std::max(maxName, name);
+        }
+
+        // Direct-mapped class index: NameIds are dense, so this stays small.
+        classSlots.assign(pending.empty() ? 0 : static_cast<std::size_t>(maxName) + 1, 0);
+        for (std::size_t i = 0; i < classTable.size(); ++i) {
+            classSlots[classTable[i].name] = static_cast<std::uint32_t>(i) + 1;
+        }
+
+        // Count the OS classes the program did not replace with its own.
+        frozen = true;
+        classCount = declaredClassCount;
+        for (std::size_t i = 0; i < STANDARD_LIBRARY.size(); ++i) {
+            const NameId cls = STANDARD_LIBRARY[i].className;
+            if ((i == 0 || STANDARD_LIBRARY[i - 1].className != cls) && !isDeclared(cls)) ++classCount;
+        }
+
+        // The registration maps are no longer needed, unless thaw() is to reopen them.
+        if (reusable) return;
+        for (Shard& shard : shards) {
+            std::scoped_lock lock(shard.mtx);
+            shard.classes.clear();
+        }
+    }
+
+    void GlobalRegistry::thaw() {
+        if (!reusable || !frozen) throw std::logic_error("GlobalRegistry::thaw called on a registry it cannot reopen");
+        frozen = false;
+    }
+
+    void GlobalRegistry::removeClass(const NameId className) {
+        if (frozen) throw std::logic_error("GlobalRegistry::removeClass called after freeze()");
+        Shard& shard = shardFor(className);
+        std::scoped_lock lock(shard.mtx);
+        shard.classes.erase(className);
+    }
+
+    void GlobalRegistry::requireFrozen() const {
+        if (!frozen) throw std::logic_error("GlobalRegistry queried before freeze()");
     }
 
-    bool GlobalRegistry::classExists(const std::string_view className) const {
+    const GlobalRegistry::ClassRecord* GlobalRegistry::findClass(const NameId className) const {
+        requireFrozen();
+        if (className >= classSlots.size() || classSlots[className] == 0) {
+            return nullptr;
+        }
+        return &classTable[classSlots[className] - 1];
+    }
+
+    bool GlobalRegistry::isDeclared(const NameId className) const {
+        const ClassRecord* record = findClass(className);
+        return record && record->declared;
+    }
+
+    bool GlobalRegistry::isOsSource(const NameId className) const {
+        const ClassRecord* record = findClass(className);
+        return record && record->declared && record->osSource;
+    }
+
+    bool GlobalRegistry::classExists(const NameId className) const {
         // Built-in primitive types are always considered "existing classes" for type checking purposes.
-        if (className=="int"||className=="boolean"||className=="char") {
+        if (Interner::isPrimitive(className)) {
             return true;
         }
 
-        // Standard Library classes (simulated)
-        // Note: These are commented out in the original code, implying they might be registered manually
-        // or handled differently. If they are part of the compilation unit, they will be in 'classes'.
-        /*if (className == "Array" || className == "String" || className == "Math" || className == "Output" ||
-            className == "Screen" || className == "Keyboard" || className == "Memory" || className == "Sys") return
-            true;*/
+        // Check against the set of classes registered during parsing, then the OS.
+        return isDeclared(className) || isBuiltinClass(className);
+    }
 
-        // Check against the set of user-defined classes registered so far.
-        return classes.count(className);
+    bool GlobalRegistry::methodExists(const NameId className, const NameId methodName)const {
+        return findSignature(className, methodName) != nullptr;
     }
 
-    bool GlobalRegistry::methodExists(const std::string_view className, const std::string_view methodName)const {
-        // First, check if the class exists in our method map.
-        const auto it = methods.find(className);
-        if (it == methods.end()) {
-            return false;
+    const MethodSignature* GlobalRegistry::findSignature(const NameId className, const NameId methodName) const {
+        // Look up the class; anything the program does not declare falls through to the OS table.
+        const ClassRecord* record = findClass(className);
+        if (!record || !record->declared) {
+            return findBuiltin(className, methodName);
+        }
+
+        // Binary search the class's sorted method run.
+        const auto first = methodTable.begin() + record->firstMethod;
+        const auto last = first + record->methodCount;
+        const auto it = std::lower_bound(first, last, methodName,
+                                         [](const MethodRecord& m, const NameId name) { return m.name < name; });
+        if (it == last || it->name != methodName) {
+            return nullptr;
         }
-        // Then, check if the method exists within that class.
-        return it->second.count(methodName);
+        return &it->signature;
     }
 
-    MethodSignature GlobalRegistry::getSignature(const std::string_view className,
-                                                 const std::string_view methodName) const {
-        // Look up the class.
-        const auto it=methods.find(className);
-        if (it!=methods.end()) {
-            // Look up the method within the class.
-            const auto sit=it->second.find(methodName);
-            if (sit!=it->second.end()) {
-                return sit->second;
-            }
+    const MethodSignature& GlobalRegistry::getSignature(const NameId className,
+                                                        const NameId methodName) const {
+        if (const MethodSignature* sig = findSignature(className, methodName)) {
+            return *sig;
         }
         // If not found, this indicates a logic error in the compiler (caller should have checked existence).
-        throw std::runtime_error("Internal Compiler Error: Signature lookup failed for " + std::string(className) + "." + std::string(methodName));
+        throw std::runtime_error("Internal Compiler Error: Signature lookup failed for " + std::string(nameOf(className)) + "." + std::string(nameOf(methodName)));
+    }
+
+    std::vector<std::pair<NameId, const MethodSignature*>> GlobalRegistry::methodsOf(const NameId className) const {
+        std::vector<std::pair<NameId, const MethodSignature*>> methods;
+        const ClassRecord* record = findClass(className);
+        if (!record || !record->declared) return methods;
+
+        methods.reserve(record->methodCount);
+        for (std::uint32_t m = record->firstMethod; m < record->firstMethod + record->methodCount; ++m) {
+            methods.emplace_back(methodTable[m].name, &methodTable[m].signature);
+        }
+        return methods;
+    }
+
+    std::vector<NameId> GlobalRegistry::declaredClasses() const {
+        requireFrozen();
+        std::vector<NameId> names;
+        for (const ClassRecord& record : classTable) {
+            if (record.declared) names.push_back(record.name);
+        }
+        return names;
+    }
+
+    std::uint64_t GlobalRegistry::fingerprint(const NameId className) const {
+        // Methods are combined by addition so the result does not depend on table order (which follows NameIds).
+        std::uint64_t sum = FNV_OFFSET_BASIS;
+        if (isDeclared(className)) {
+            for (const auto& [name, sig] : methodsOf(className)) sum += signatureHash(name, *sig);
+            return sum;
+        }
+        const Span<BuiltinMethod> builtins = builtinMethodsOf(className);
+        if (builtins.empty()) return 0;
+        for (const BuiltinMethod& m : builtins) sum += signatureHash(m.name, m.signature);
+        return sum;
     }
 
     int GlobalRegistry::getClassCount() const {
-        return static_cast<int>(classes.size());
-    }
-
-    void GlobalRegistry::loadStandardLibrary() {
-        // --- MATH CLASS ---
-        registerClass("Math");
-        registerMethod("Math", "init",      "void", {},             true,  0, 0);
-        registerMethod("Math", "abs",       "int",  {"int"},        true,  0, 0);
-        registerMethod("Math", "multiply",  "int",  {"int", "int"}, true,  0, 0);
-        registerMethod("Math", "divide",    "int",  {"int", "int"}, true,  0, 0);
-        registerMethod("Math", "min",       "int",  {"int", "int"}, true,  0, 0);
-        registerMethod("Math", "max",       "int",  {"int", "int"}, true,  0, 0);
-        registerMethod("Math", "sqrt",      "int",  {"int"},        true,  0, 0);
-        registerMethod("Math","bit","boolean",{"int","int"},true,0,0);
-
-        // --- STRING CLASS ---
-        // Note: Constructors ('new') are usually treated as 'static' in the OS API logic
-        // because you call them on the class (String.new), not an object.
-        registerClass("String");
-        registerMethod("String", "new",           "String", {"int"},           true,  0, 0);
-        registerMethod("String", "dispose",       "void",   {},                false, 0, 0);
-        registerMethod("String", "length",        "int",    {},                false, 0, 0);
-        registerMethod("String", "charAt",        "char",   {"int"},           false, 0, 0);
-        registerMethod("String", "setCharAt",     "void",   {"int", "char"},   false, 0, 0);
-        registerMethod("String", "appendChar",    "String", {"char"},          false, 0, 0);
-        registerMethod("String", "eraseLastChar", "void",   {},                false, 0, 0);
-        registerMethod("String", "intValue",      "int",    {},                false, 0, 0);
-        registerMethod("String", "setInt",        "void",   {"int"},           false, 0, 0);
-        registerMethod("String", "backSpace",     "char",   {},                false, 0, 0);
-        registerMethod("String", "doubleQuote",   "char",   {},                false, 0, 0);
-        registerMethod("String", "newLine",       "char",   {},                false, 0, 0);
-        registerMethod("String","int2String","void",{},false,0,0);
-
-        // --- ARRAY CLASS ---
-        registerClass("Array");
-        registerMethod("Array", "new",     "Array", {"int"}, true,  0, 0);
-        registerMethod("Array", "dispose", "void",  {},      false, 0, 0);
-
-        // --- OUTPUT CLASS ---
-        registerClass("Output");
-        registerMethod("Output", "init", "void", {}, true, 0, 0);
-        registerMethod("Output", "moveCursor", "void", {"int", "int"}, true, 0, 0);
-        registerMethod("Output", "printChar", "void", {"char"}, true, 0, 0);
-        registerMethod("Output", "printString", "void", {"String"}, true, 0, 0);
-        registerMethod("Output", "printInt", "void", {"int"}, true, 0, 0);
-        registerMethod("Output", "println", "void", {}, true, 0, 0);
-        registerMethod("Output", "backSpace", "void", {}, true, 0, 0);
-        registerMethod("Output", "initMap", "void", {}, true, 0, 0);
-        registerMethod("Output", "create", "void", {"int","int","int","int","int","int","int","int","int","int","int","int"}, true, 0, 0);
-        registerMethod("Output", "getMap", "Array", {"char"}, true, 0, 0);
-        registerMethod("Output", "incrementCursor", "void", {}, true, 0, 0);
-        registerMethod("Output", "decrementCursor", "void", {}, true, 0, 0);
-
-        // --- SCREEN CLASS ---
-        registerClass("Screen");
-        registerMethod("Screen", "init",          "void", {},                              true, 0, 0);
-        registerMethod("Screen", "clearScreen",   "void", {},                              true, 0, 0);
-        registerMethod("Screen", "setColor",      "void", {"boolean"},                     true, 0, 0);
-        registerMethod("Screen", "drawPixel",     "void", {"int", "int"},                  true, 0, 0);
-        registerMethod("Screen", "drawLine",      "void", {"int", "int", "int", "int"},    true, 0, 0);
-        registerMethod("Screen", "drawRectangle", "void", {"int", "int", "int", "int"},    true, 0, 0);
-        registerMethod("Screen", "drawCircle",    "void", {"int", "int", "int"},           true, 0, 0);
-
-        // --- KEYBOARD CLASS ---
-        registerClass("Keyboard");
-        registerMethod("Keyboard", "init",       "void",   {},         true, 0, 0);
-        registerMethod("Keyboard", "keyPressed", "char",   {},         true, 0, 0);
-        registerMethod("Keyboard", "readChar",   "char",   {},         true, 0, 0);
-        registerMethod("Keyboard", "readLine",   "String", {"String"}, true, 0, 0);
-        registerMethod("Keyboard", "readInt",    "int",    {"String"}, true, 0, 0);
-
-        // --- MEMORY CLASS ---
-        registerClass("Memory");
-        registerMethod("Memory", "init",    "void", {},             true, 0, 0);
-        registerMethod("Memory", "peek",    "int",  {"int"},        true, 0, 0);
-        registerMethod("Memory", "poke",    "void", {"int", "int"}, true, 0, 0);
-        registerMethod("Memory", "alloc",   "int",  {"int"},        true, 0, 0);
-        registerMethod("Memory", "deAlloc", "void", {"Array"},        true, 0, 0);
-
-        // --- SYS CLASS ---
-        registerClass("Sys");
-        registerMethod("Sys", "init",  "void", {},      true, 0, 0);
-        registerMethod("Sys", "halt",  "void", {},      true, 0, 0);
-        registerMethod("Sys", "error", "void", {"int"}, true, 0, 0);
-        registerMethod("Sys", "wait",  "void", {"int"}, true, 0, 0);
+        requireFrozen();
+        return classCount;
     }
 
     void GlobalRegistry::dumpToJSON(const std::string &filename) const {
@@ -173,28 +245,35 @@ namespace nand2tetris::jack {
 
         bool firstMethod = true;
 
-        // Iterate over all classes
-        for (const auto& [className, methodMap] : methods) {
-
-            // Iterate over all methods in this class
-            for (const auto& [methodName, sig] : methodMap) {
-                if (!firstMethod) out << ",\n";
-                firstMethod = false;
-
-                out << "    {\n";
-                out << "      \"class\": \"" << className << "\",\n";
-                out << "      \"method\": \"" << methodName << "\",\n";
-                out << "      \"type\": \"" << (sig.isStatic ? "function" : "method") << "\",\n";
-                out << "      \"return\": \"" << sig.returnType << "\",\n";
-
-                // Format parameters: "int, char"
-                out << "      \"params\": \"";
-                for (size_t i = 0; i < sig.parameters.size(); ++i) {
-                    out << sig.parameters[i];
-                    if (i < sig.parameters.size() - 1) out << ", ";
-                }
-                out << "\"\n";
-                out << "    }";
+        requireFrozen();
+
+        const auto writeMethod = [&](const NameId className, const NameId methodName, const MethodSignature& sig) {
+            if (!firstMethod) out << ",\n";
+            firstMethod = false;
+
+            out << "    {\n";
+            out << "      \"class\": \"" << nameOf(className) << "\",\n";
+            out << "      \"method\": \"" << nameOf(methodName) << "\",\n";
+            out << "      \"type\": \"" << (sig.isStatic ? "function" : "method") << "\",\n";
+            out << "      \"return\": \"" << nameOf(sig.returnType) << "\",\n";
+
+            // Format parameters: "int, char"
+            out << "      \"params\": \"";
+            for (size_t i = 0; i < sig.parameters.size(); ++i) {
+                out << nameOf(sig.parameters[i]);
+                if (i < sig.parameters.size() - 1) out << ", ";
+            }
+            out << "\"\n";
+            out << "    }";
+        };
+
+        // The OS classes first (unless replaced), then every class from the program.
+        for (const BuiltinMethod& builtin : STANDARD_LIBRARY) {
+            if (!isDeclared(builtin.className)) writeMethod(builtin.className, builtin.name, builtin.signature);
+        }
+        for (const ClassRecord& record : classTable) {
+            for (std::uint32_t m = record.firstMethod; m < record.firstMethod + record.methodCount; ++m) {
+                writeMethod(record.name, methodTable[m].name, methodTable[m].signature);
             }
         }
 
@@ -4,12 +4,18 @@
 
 #ifndef NAND2TETRIS_GLOBAL_REGISTRY_H
 #define NAND2TETRIS_GLOBAL_REGISTRY_H
+#include <array>
+#include <cstdint>
 #include <vector>
+#include <string_view>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <mutex>
+#include <optional>
 #include <fstream>
 #include <sstream>
+#include "../Common/Interner.h"
+#include "../Common/Span.h"
 
 namespace nand2tetris::jack {
 
@@ -17,31 +23,53 @@ namespace nand2tetris::jack {
      * @brief Represents the signature of a Jack subroutine (method, function, or constructor).
      */
     struct MethodSignature {
-        std::string_view returnType;        ///< The return type of the subroutine (e.g., "int", "void").
-        std::vector<std::string_view> parameters; ///< List of parameter types.
+        NameId returnType;                  ///< The return type of the subroutine (e.g., "int", "void").
+        Span<NameId> parameters;            ///< List of parameter types (owned by the registry or the OS table).
         bool isStatic;                      ///< True if this is a static function.
-        int line;                           ///< Line number of the declaration.
-        int column;                         ///< Column number of the declaration.
+        std::uint32_t offset;               ///< Byte offset of the declaration in its source file.
     };
 
     /**
-     * @brief A thread-safe registry for tracking all classes and their methods across the entire program.
+     * @brief A registry for tracking all classes and their methods across the entire program.
      *
      * This class is used to perform semantic analysis, such as checking if a called method exists
      * and if the arguments match the expected parameters. It acts as a global symbol table for
      * class and subroutine definitions.
+     *
+     * The registry has two phases:
+     * - **Registration** (parsing): registerClass/registerMethod may be called from any number of
+     *   threads. Classes are spread over independently locked shards, so parsers working on different
+     *   classes rarely contend.
+     * - **Lookup** (analysis and code generation): after freeze() the registry is immutable. Lookups take
+     *   no locks, read from flat sorted tables, and return references into them.
+     *
+     * Lookups before freeze() and registrations after it are logic errors and throw std::logic_error.
+     *
+     * A reusable registry (the daemon's) keeps its registrations after freeze(), so thaw() can reopen it
+     * for the next build: only the classes that changed are removed and registered again.
+     *
+     * The Jack OS classes are not registered at all: they live in the compile-time STANDARD_LIBRARY
+     * table and are consulted for any class the program does not declare itself. A program that
+     * declares one of them (e.g. when compiling the OS sources) replaces the built-in class entirely.
      */
     class GlobalRegistry {
         public:
-            GlobalRegistry();
+            GlobalRegistry() = default;
+            explicit GlobalRegistry(const bool reusable) : reusable(reusable) {}
             ~GlobalRegistry()=default;
 
+            GlobalRegistry(const GlobalRegistry&) = delete;
+            GlobalRegistry& operator=(const GlobalRegistry&) = delete;
+
             /**
              * @brief Registers a new class in the registry.
              *
+             * Check and insert happen under one lock, so two files declaring the same class cannot both succeed.
+             *
              * @param className The name of the class to register.
+             * @return True if the class was new, false if it was already registered.
              */
-            void registerClass(std::string_view className);
+            bool registerClass(NameId className);
 
             /**
              * @brief Registers a new method (or function/constructor) for a specific class.
@@ -51,22 +79,56 @@ namespace nand2tetris::jack {
              * @param returnType The return type of the method.
              * @param params A vector of parameter types.
              * @param isStatic True if the method is static (function).
-             * @param line The line number of the declaration.
-             * @param column The column number of the declaration.
-             * @throws std::runtime_error If the method is already defined in the class.
+             * @param offset The byte offset of the declaration in its source file.
+             * @return Nothing if the method was new; if the class already has a method of that name, the
+             *         offset of the earlier declaration (the new one is not registered).
+             */
+            std::optional<std::uint32_t> registerMethod(NameId className, NameId methodName, NameId returnType,
+                                                        const std::vector<NameId> &params, bool isStatic,
+                                                        std::uint32_t offset);
+
+            /**
+             * @brief Records that a class is compiled from the OS sources (--os) rather than written by the program.
+             *
+             * @param className The name of the class, declared or about to be.
+             */
+            void markOsSource(NameId className);
+
+            /**
+             * @brief Ends the registration phase and builds the read-only lookup tables.
+             *
+             * Must be called once per registration phase, after every parser has finished and before any lookup.
+             */
+            void freeze();
+
+            /**
+             * @brief Reopens a frozen reusable registry for registration; lookups throw until the next freeze().
+             *
+             * @throws std::logic_error If the registry is not reusable or not frozen.
              */
-            void registerMethod(std::string_view className, std::string_view methodName, std::string_view returnType,
-                                const std::vector<std::string_view> &params, bool isStatic, int line, int column);
+            void thaw();
+
+            /**
+             * @brief Forgets a class and its methods, e.g. before its changed source is registered again.
+             *
+             * @param className The name of the class; nothing happens if it was never registered.
+             */
+            void removeClass(NameId className);
+
+            /**
+             * @brief True once freeze() has been called.
+             */
+            bool isFrozen() const { return frozen; }
 
             /**
              * @brief Checks if a class exists in the registry.
              *
-             * Also returns true for built-in types (int, boolean, char, void).
+             * Also returns true for built-in types (int, boolean, char, void) and the OS classes.
              *
              * @param className The name of the class to check.
              * @return True if the class exists or is a built-in type, false otherwise.
              */
-            bool classExists(std::string_view className) const;
+            bool classExists(NameId className) const;
 
             /**
              * @brief Checks if a method exists within a specific class.
@@ -75,7 +137,32 @@ namespace nand2tetris::jack {
              * @param methodName The name of the method.
              * @return True if the method exists, false otherwise.
              */
-            bool methodExists(std::string_view className,std::string_view methodName)const;
+            bool methodExists(NameId className,NameId methodName)const;
+
+            /**
+             * @brief Checks if the program itself declares a class, replacing any OS class of that name.
+             *
+             * @param className The name of the class to check.
+             * @return True for classes compiled from source, false for OS classes and unknown names.
+             */
+            bool isDeclared(NameId className) const;
+
+            /**
+             * @brief Checks if a declared class is the OS's own, compiled from its sources (see markOsSource()).
+             *
+             * @param className The name of the class to check.
+             * @return True if the class was marked, so it behaves exactly like the built-in OS class.
+             */
+            bool isOsSource(NameId className) const;
+
+            /**
+             * @brief Looks up the signature of a specific method.
+             *
+             * @param className The name of the class.
+             * @param methodName The name of the method.
+             * @return A pointer into the frozen tables, or nullptr if the method does not exist.
+             */
+            const MethodSignature* findSignature(NameId className, NameId methodName) const;
 
             /**
              * @brief Retrieves the signature of a specific method.
@@ -85,10 +172,33 @@ namespace nand2tetris::jack {
              * @return The MethodSignature struct containing details about the method.
              * @throws std::runtime_error If the method is not found.
              */
-            MethodSignature getSignature(std::string_view className,std::string_view methodName) const;
+            const MethodSignature& getSignature(NameId className,NameId methodName) const;
+
+            /**
+             * @brief Lists the subroutines of a class declared by the program, in no particular order.
+             *
+             * @return Name and signature pairs; empty if the class is not declared (OS classes included).
+             */
+            std::vector<std::pair<NameId, const MethodSignature*>> methodsOf(NameId className) const;
+
+            /**
+             * @brief Lists the classes declared by the program, in NameId order.
+             */
+            std::vector<NameId> declaredClasses() const;
+
+            /**
+             * @brief Summarises everything other classes can observe about a class.
+             *
+             * Covers each subroutine's name, kind, return type and parameter types, whether the class comes
+             * from the program or the OS. Declaration positions are left out. The value is built from the
+             * names themselves, not their NameIds, so it can be compared across runs.
+             *
+             * @return 0 if the class does not exist, otherwise a 64-bit hash.
+             */
+            std::uint64_t fingerprint(NameId className) const;
 
             /**
-             * @brief Returns the number of registered classes.
+             * @brief Returns the number of known classes: declared ones plus the OS classes they do not replace.
              * @return The count of classes.
              */
             int getClassCount()const;
@@ -99,12 +209,65 @@ namespace nand2tetris::jack {
              */
             void dumpToJSON(const std::string& filename) const;
         private:
-            // Map: ClassName -> (MethodName -> Signature)
-            std::unordered_map<std::string_view,std::unordered_map<std::string_view,MethodSignature>> methods;
-            // Set: ClassNames
-            std::unordered_set<std::string_view> classes;
-            mutable std::mutex mtx; // Thread safety
-            void loadStandardLibrary();
+            // --- Registration phase ---
+
+            /**
+             * @brief A method as registered; its parameters move into `parameterPool` on freeze.
+             */
+            struct PendingMethod {
+                NameId returnType;
+                std::vector<NameId> parameters;
+                bool isStatic;
+                std::uint32_t offset;
+            };
+
+            /**
+             * @brief Everything registered for one class name before the freeze.
+             */
+            struct PendingClass {
+                bool declared = false; ///< registerClass was called (methods may be registered first).
+                bool osSource = false; ///< markOsSource was called.
+                std::unordered_map<NameId, PendingMethod> methods;
+            };
+
+            /**
+             * @brief One independently locked slice of the pending classes, chosen by class NameId.
+             */
+            struct alignas(64) Shard {
+                std::mutex mtx;
+                std::unordered_map<NameId, PendingClass> classes;
+            };
+
+            static constexpr std::size_t SHARD_COUNT = 16;
+            std::array<Shard, SHARD_COUNT> shards;
+
+            Shard& shardFor(NameId className) { return shards[className % SHARD_COUNT]; }
+
+            // --- Lookup phase (built by freeze) ---
+
+            struct MethodRecord {
+                NameId name;
+                MethodSignature signature;
+            };
+
+            struct ClassRecord {
+                NameId name;
+                bool declared;
+                bool osSource;
+                std::uint32_t firstMethod; ///< Index of the first method in `methodTable`.
+                std::uint32_t methodCount; ///< Methods are sorted by NameId within the class.
+            };
+
+            std::vector<std::uint32_t> classSlots; ///< Class NameId -> index into `classTable` + 1 (0 = absent).
+            std::vector<ClassRecord> classTable;   ///< Sorted by class NameId.
+            std::vector<MethodRecord> methodTable; ///< All methods, grouped by class.
+            std::vector<NameId> parameterPool;     ///< Backing storage for every signature's parameters.
+            int classCount = 0;
+            bool frozen = false;
+            bool reusable = false; ///< Keeps `shards` after freeze(), for thaw().
+
+            const ClassRecord* findClass(NameId className) const;
+            void requireFrozen() const;
     };
 }
 
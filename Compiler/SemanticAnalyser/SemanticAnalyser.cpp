@@ -3,32 +3,69 @@
 //
 
 #include "SemanticAnalyser.h"
+#include <algorithm>
 #include <stdexcept>
 
 namespace nand2tetris::jack {
-    SemanticAnalyser::SemanticAnalyser(const GlobalRegistry &registry):registry(registry){};
+    SemanticAnalyser::SemanticAnalyser(const GlobalRegistry &registry, const LineIndex &lines):registry(registry),lines(lines){};
+
+    bool SemanticAnalyser::classExists(const NameId className) const {
+        if (!Interner::isPrimitive(className)) dependencies.push_back(className);
+        return registry.classExists(className);
+    }
+
+    const MethodSignature* SemanticAnalyser::findSignature(const NameId className, const NameId methodName) const {
+        dependencies.push_back(className);
+        return registry.findSignature(className, methodName);
+    }
+
+    std::vector<NameId> SemanticAnalyser::referencedClasses() const {
+        std::vector<NameId> classes = dependencies;
+        // A class always depends on itself; that is covered by its own source hash.
+        classes.erase(std::remove(classes.begin(), classes.end(), currentClassName), classes.end());
+        std::sort(classes.begin(), classes.end());
+        classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+        return classes;
+    }
 
     void SemanticAnalyser::error(const std::string_view message, const Node &node) const {
         // Format error message with file, line, and column information.
-        throw std::runtime_error("Semantic Error [" + std::string(currentClassName) + ".jack:" +
-            std::to_string(node.getLine()) + ":" + std::to_string(node.getCol()) + "]: " +
+        const SourcePosition at = lines.position(node.getOffset());
+        throw CompileError("", at.line, at.column, "Semantic Error [" + std::string(nameOf(currentClassName)) + ".jack:" +
+            std::to_string(at.line) + ":" + std::to_string(at.column) + "]: " +
             std::string(message));
     }
 
-    void SemanticAnalyser::checkTypeMatch(const std::string_view expected, const std::string_view actual, const Node &locationNode) const {
+    void SemanticAnalyser::define(SymbolTable &table, const NameId name, const NameId type, const SymbolKind kind,
+                                  const std::uint32_t offset) const {
+        const Symbol* existing = table.define(name, type, kind, offset);
+        if (!existing) return;
+        // Arguments have no node of their own: they are placed at the subroutine's line, column 0.
+        const auto format = [&](const SymbolKind k, const std::uint32_t at) {
+            const SourcePosition pos = lines.position(at);
+            return std::to_string(pos.line) + ":" + std::to_string(k == SymbolKind::ARG ? 0 : pos.column);
+        };
+        const SourcePosition at = lines.position(offset);
+        throw CompileError("", at.line, kind == SymbolKind::ARG ? 0 : at.column,
+            "Semantic Error [" + std::string(nameOf(currentClassName)) + ".jack:" + format(kind, offset) + "]: " +
+            "Variable '" + std::string(nameOf(name)) + "' is already defined as a " +
+            kindToString(existing->kind) + " at [" + format(existing->kind, existing->declOffset) + "].");
+    }
+
+    void SemanticAnalyser::checkTypeMatch(const NameId expected, const NameId actual, const Node &locationNode) const {
         // 1. Exact Match
         if (expected == actual) return;
 
         // 2. Handle 'null' (assignable to any object)
-        if (actual == "null") return;
+        if (actual == Interner::NULL_) return;
 
         // Helper booleans
         // Note: void is not a primitive or an object variable type
-        const bool expectedIsPrimitive = (expected == "int" || expected == "char" || expected == "boolean");
-        const bool actualIsPrimitive   = (actual == "int" || actual == "char" || actual == "boolean");
+        const bool expectedIsPrimitive = Interner::isPrimitive(expected);
+        const bool actualIsPrimitive   = Interner::isPrimitive(actual);
 
-        const bool expectedIsObject = !expectedIsPrimitive && expected != "void";
-        const bool actualIsObject   = !actualIsPrimitive   && actual != "void";
+        const bool expectedIsObject = !expectedIsPrimitive && expected != Interner::VOID;
+        const bool actualIsObject   = !actualIsPrimitive   && actual != Interner::VOID;
 
         // 3. Primitives are fluid (int <-> char <-> boolean)
         // Jack allows mixing these freely (e.g. math with chars, bools as ints)
@@ -40,13 +77,13 @@ namespace nand2tetris::jack {
 
         // Case A: Object -> int
         // (e.g. if (student == 0), or let address = student)
-        if (expected == "int" && actualIsObject) {
+        if (expected == Interner::INT && actualIsObject) {
             return;
         }
 
         // Case B: int -> Object (Your previous error)
         // (e.g. let student = array[i]; // array access returns int)
-        if (expectedIsObject && actual == "int") {
+        if (expectedIsObject && actual == Interner::INT) {
             return;
         }
 
@@ -54,90 +91,108 @@ namespace nand2tetris::jack {
 
         // Case C: Object -> Array
         // (e.g. do Memory.deAlloc(student); )
-        if (expected == "Array" && actualIsObject) {
+        if (expected == Interner::ARRAY && actualIsObject) {
             return;
         }
 
         // If none of the above pass, it is a genuine error.
         // e.g. Assigning 'Student' to 'School' (where neither is Array/int)
-        error("Type Mismatch. Expected '" + std::string(expected) + "', Got '" + std::string(actual) + "'", locationNode);
+        error("Type Mismatch. Expected '" + std::string(nameOf(expected)) + "', Got '" + std::string(nameOf(actual)) + "'", locationNode);
     }
 
-    void SemanticAnalyser::analyseClass(const ClassNode& class_node,SymbolTable& table) {
+    void SemanticAnalyser::analyseClass(const ClassNode& class_node,SymbolTable& table, std::vector<Diagnostic>* errors) {
+        analyseClassVariables(class_node, table);
+
+        // 2. Process Subroutines
+        // Subroutines only share the class scope, so an error in one says nothing about the next.
+        for (const SubroutineDecNode* sub : class_node.subroutineDecs) {
+            if (!errors) {
+                analyseSubroutine(*sub, table);
+                continue;
+            }
+            try {
+                analyseSubroutine(*sub, table);
+            } catch (const CompileError& e) {
+                errors->push_back(e.diagnostic());
+            }
+        }
+    }
+
+    void SemanticAnalyser::analyseClassVariables(const ClassNode& class_node, SymbolTable& table) {
         currentClassName=class_node.className;
 
 
         // 1. Process Class Variables (Static/Field)
-        for (const std::unique_ptr<ClassVarDecNode>& var:class_node.classVars) {
+        for (const ClassVarDecNode* var : class_node.classVars) {
             const SymbolKind kind = (var->kind == ClassVarKind::STATIC) ? SymbolKind::STATIC : SymbolKind::FIELD;
 
             // Verify the type exists (if it's a class type)
-            if (!registry.classExists(var->type)) {
-                error("Unknown type '" + std::string(var->type) + "'", *var);
+            if (!classExists(var->type)) {
+                error("Unknown type '" + std::string(nameOf(var->type)) + "'", *var);
             }
 
             // Add variables to the class-level symbol table
-            for (const std::string_view& name : var->varNames) {
-                table.define(name, var->type, kind,var->getLine(),var->getCol());
+            for (const NameId name : var->varNames) {
+                define(table, name, var->type, kind, var->getOffset());
             }
         }
-
-        // 2. Process Subroutines
-        for (const std::unique_ptr<SubroutineDecNode>& sub : class_node.subroutineDecs) {
-            analyseSubroutine(*sub, table);
-        }
+        class_node.fieldCount = table.varCount(SymbolKind::FIELD);
+        class_node.staticCount = table.varCount(SymbolKind::STATIC);
     }
 
     void SemanticAnalyser::analyseSubroutine(const SubroutineDecNode &sub, SymbolTable &table) {
         currentSubroutineName=sub.name;
-        // Determine kind string for logic checks
-        if (sub.subType == SubroutineType::CONSTRUCTOR) currentSubroutineKind = "constructor";
-        else if (sub.subType == SubroutineType::FUNCTION) currentSubroutineKind = "function";
-        else currentSubroutineKind = "method";
+        currentSubroutineType=sub.subType;
 
-        if (currentSubroutineKind == "constructor") {
+        if (currentSubroutineType == SubroutineType::CONSTRUCTOR) {
             if (sub.returnType != currentClassName) {
-                error("Constructor '" + std::string(sub.name) +
-                  "' must return type '" + std::string(currentClassName) +
-                  "', but found '" + std::string(sub.name) + "'.",
+                error("Constructor '" + std::string(nameOf(sub.name)) +
+                  "' must return type '" + std::string(nameOf(currentClassName)) +
+                  "', but found '" + std::string(nameOf(sub.name)) + "'.",
                   sub);
             }
         }
 
 
         table.startSubroutine(sub.name);
+        calls.push_back({sub.name, {}});
 
         // 2. Define 'this' for methods
         //  operate on the current instance, so 'this' is the first implicit argument.
         if (sub.subType == SubroutineType::METHOD) {
-            table.define("this", currentClassName, SymbolKind::ARG, sub.getLine(), 0);
+            define(table, Interner::THIS_, currentClassName, SymbolKind::ARG, sub.getOffset());
         }
 
         // 3. Define Arguments
         for (const auto&[type, name] : sub.parameters) {
-            if (!registry.classExists(type)) {
-                error("Unknown type '" + std::string(type) + "' for argument '" + std::string(name) + "'", sub);
+            if (!classExists(type)) {
+                error("Unknown type '" + std::string(nameOf(type)) + "' for argument '" + std::string(nameOf(name)) + "'", sub);
             }
-            table.define(name, type, SymbolKind::ARG, sub.getLine(), 0);
+            define(table, name, type, SymbolKind::ARG, sub.getOffset());
         }
 
         // 4. Define Local Variables
-        for (const std::unique_ptr<VarDecNode>& varDecl : sub.localVars) {
-            if (!registry.classExists(varDecl->type)) {
-                error("Unknown type '" + std::string(varDecl->type) + "'", *varDecl);
+        for (const VarDecNode* varDecl : sub.localVars) {
+            if (!classExists(varDecl->type)) {
+                error("Unknown type '" + std::string(nameOf(varDecl->type)) + "'", *varDecl);
             }
-            for (const std::string_view& name : varDecl->varNames) {
-                table.define(name, varDecl->type, SymbolKind::LCL, varDecl->getLine(), varDecl->getCol());
+            for (const NameId name : varDecl->varNames) {
+                define(table, name, varDecl->type, SymbolKind::LCL, varDecl->getOffset());
             }
         }
+        sub.localCount = table.varCount(SymbolKind::LCL);
 
         // 5. Analyze Statements
         analyseStatements(sub.statements, table);
+
+        std::vector<SubroutineRef>& callees = calls.back().callees;
+        std::sort(callees.begin(), callees.end());
+        callees.erase(std::unique(callees.begin(), callees.end()), callees.end());
     }
 
 
-    void SemanticAnalyser::analyseStatements(const std::vector<std::unique_ptr<StatementNode> > &stmts, SymbolTable &table) const {
-        for (const std::unique_ptr<StatementNode>& stmt : stmts) {
+    void SemanticAnalyser::analyseStatements(const NodeList<StatementNode>& stmts, SymbolTable &table) const {
+        for (const StatementNode* stmt : stmts) {
             switch (stmt->getType()) {
                 case ASTNodeType::LET_STATEMENT:
                     analyseLet(static_cast<const LetStatementNode&>(*stmt), table); // NOLINT(*-pro-type-static-cast-downcast)
@@ -162,24 +217,26 @@ namespace nand2tetris::jack {
 
     void SemanticAnalyser::analyseLet(const LetStatementNode &node, SymbolTable &table)const{
         // 1. Check Variable Existence
-        if (table.kindOf(node.varName) == SymbolKind::NONE) {
-            error("Undefined variable '" + std::string(node.varName) + "'", node);
+        const Symbol* target = table.lookup(node.varName);
+        if (!target) {
+            error("Undefined variable '" + std::string(nameOf(node.varName)) + "'", node);
         }
-        const std::string_view varType = table.typeOf(node.varName);
+        const NameId varType = target->type;
+        node.target = {target->kind, target->index, target->type};
 
         // 2. Array Indexing Check
         if (node.indexExpr) {
-            if (varType != "Array") {
-                error("Cannot index non-array variable '" + std::string(node.varName) + "'", node);
+            if (varType != Interner::ARRAY) {
+                error("Cannot index non-array variable '" + std::string(nameOf(node.varName)) + "'", node);
             }
-            const std::string_view idxType = analyseExpression(*node.indexExpr, table);
-            if (idxType != "int") {
+            const NameId idxType = analyseExpression(*node.indexExpr, table);
+            if (idxType != Interner::INT) {
                 error("Array index must be an integer.", *node.indexExpr);
             }
         }
 
         // 3. Value Check
-        const std::string_view exprType = analyseExpression(*node.valueExpr, table);
+        const NameId exprType = analyseExpression(*node.valueExpr, table);
 
         // If it's a standard assignment (not array index), types must match.
         // Note: Array element assignment (arr[i] = x) is not strictly type-checked in standard Jack
@@ -191,8 +248,8 @@ namespace nand2tetris::jack {
     }
 
     void SemanticAnalyser::analyseIf(const IfStatementNode &node, SymbolTable &table)const {
-        const std::string_view condType = analyseExpression(*node.condition, table);
-        if (condType != "boolean") {
+        const NameId condType = analyseExpression(*node.condition, table);
+        if (condType != Interner::BOOLEAN) {
             error("If condition must be boolean.", *node.condition);
         }
         analyseStatements(node.ifStatements, table);
@@ -203,24 +260,23 @@ namespace nand2tetris::jack {
 
     void SemanticAnalyser::analyseDo(const DoStatementNode &node, SymbolTable &table)const {
         // 'do' just wraps a CallNode. Analyze the call.
-        const CallNode& call = *node.callExpression;
-        analyseSubroutineCall(call.classNameOrVar, call.functionName, call.arguments, table, call);
+        analyseSubroutineCall(*node.callExpression, table);
     }
 
     void SemanticAnalyser::analyseWhile(const WhileStatementNode &node, SymbolTable &table)const {
-        const std::string_view condType = analyseExpression(*node.condition, table);
-        if (condType != "boolean") {
+        const NameId condType = analyseExpression(*node.condition, table);
+        if (condType != Interner::BOOLEAN) {
             error("While condition must be boolean.", *node.condition);
         }
         analyseStatements(node.body, table);
     }
 
     void SemanticAnalyser::analyseReturn(const ReturnStatementNode &node, SymbolTable &table) const {
-        const MethodSignature sig = registry.getSignature(currentClassName, currentSubroutineName);
-        const std::string_view requiredType = sig.returnType;
+        const MethodSignature& sig = registry.getSignature(currentClassName, currentSubroutineName);
+        const NameId requiredType = sig.returnType;
 
         // 1. Constructor Rules
-        if (currentSubroutineKind == "constructor") {
+        if (currentSubroutineType == SubroutineType::CONSTRUCTOR) {
             if (!node.expression) error("Constructor must return 'this'.", node);
 
             // Check if returning 'this'
@@ -233,7 +289,7 @@ namespace nand2tetris::jack {
         }
 
         // 2. Void Function Rules
-        if (requiredType == "void") {
+        if (requiredType == Interner::VOID) {
             if (node.expression) {
                 error("Void function cannot return a value.", *node.expression);
             }
@@ -241,139 +297,142 @@ namespace nand2tetris::jack {
         // 3. Value Function Rules
         else {
             if (!node.expression) {
-                error("Function must return a value of type '" + std::string(requiredType) + "'.", node);
+                error("Function must return a value of type '" + std::string(nameOf(requiredType)) + "'.", node);
             }
-            const std::string_view actualType = analyseExpression(*node.expression, table);
+            const NameId actualType = analyseExpression(*node.expression, table);
             checkTypeMatch(requiredType, actualType, *node.expression);
         }
     }
 
 
-    std::string_view SemanticAnalyser::analyseExpression(const ExpressionNode &node, SymbolTable &table) const {
+    NameId SemanticAnalyser::analyseExpression(const ExpressionNode &node, SymbolTable &table) const {
         switch (node.getType()) {
             case ASTNodeType::INTEGER_LITERAL:
-                return "int";
+                return Interner::INT;
             case ASTNodeType::STRING_LITERAL:
-                return "String";
+                return Interner::STRING;
             case ASTNodeType::KEYWORD_LITERAL: {
                 const auto& n = static_cast<const KeywordLiteralNode&>(node); // NOLINT(*-pro-type-static-cast-downcast)
                 switch(n.value) {
                     case Keyword::TRUE_:
-                    case Keyword::FALSE_: return "boolean";
+                    case Keyword::FALSE_: return Interner::BOOLEAN;
                     case Keyword::THIS_:
-                        if (currentSubroutineKind == "function") {
+                        if (currentSubroutineType == SubroutineType::FUNCTION) {
                             error("'this' cannot be used in a static function.", node);
                         }
                         return currentClassName;
-                    case Keyword::NULL_:  return "null";
-                    default: return "void";
+                    case Keyword::NULL_:  return Interner::NULL_;
+                    default: return Interner::VOID;
                 }
             }
 
             case ASTNodeType::IDENTIFIER: {
                 auto& n = static_cast<const IdentifierNode&>(node); // NOLINT(*-pro-type-static-cast-downcast)
-                const std::string_view type = table.typeOf(n.name);
-                if (type.empty()) {
-                    error("Undefined variable '" + std::string(n.name) + "'", node);
+                const Symbol* symbol = table.lookup(n.name);
+                if (!symbol) {
+                    error("Undefined variable '" + std::string(nameOf(n.name)) + "'", node);
                 }
+                const NameId type = symbol->type;
+                n.binding = {symbol->kind, symbol->index, type};
                 if (n.indexExpr) {
-                    if (type != "Array") error("Cannot index non-array variable.", node);
-                    if (analyseExpression(*n.indexExpr, table) != "int") {
+                    if (type != Interner::ARRAY) error("Cannot index non-array variable.", node);
+                    if (analyseExpression(*n.indexExpr, table) != Interner::INT) {
                         error("Array index must be an integer.", *n.indexExpr);
                     }
-                    return "int"; // Array access is always int
+                    return Interner::INT; // Array access is always int
                 }
-                // Return the type directly from the table to avoid local variable reference issues.
-                return table.typeOf(n.name);
+                return type;
             }
             case ASTNodeType::BINARY_OP: {
                 auto& n = static_cast<const BinaryOpNode&>(node); // NOLINT(*-pro-type-static-cast-downcast)
-                const std::string_view left = analyseExpression(*n.left, table);
-                const std::string_view right = analyseExpression(*n.right, table);
-
-                // Math (+ - * /) -> Returns INT
-                if (std::string("+-*/").find(n.op) != std::string::npos) {
-                    checkTypeMatch("int", left, *n.left);
-                    checkTypeMatch("int", right, *n.right);
-                    return "int";
-                }
-
-                // Inequality (< >) -> Returns BOOLEAN
-                if (n.op == '<' || n.op == '>') {
-                    checkTypeMatch("int", left, *n.left);
-                    checkTypeMatch("int", right, *n.right);
-                    return "boolean";
-                }
+                const NameId left = analyseExpression(*n.left, table);
+                const NameId right = analyseExpression(*n.right, table);
+
+                switch (n.op) {
+                    // Math (+ - * /) -> Returns INT
+                    case '+': case '-': case '*': case '/':
+                        checkTypeMatch(Interner::INT, left, *n.left);
+                        checkTypeMatch(Interner::INT, right, *n.right);
+                        return Interner::INT;
+
+                    // Inequality (< >) -> Returns BOOLEAN
+                    case '<': case '>':
+                        checkTypeMatch(Interner::INT, left, *n.left);
+                        checkTypeMatch(Interner::INT, right, *n.right);
+                        return Interner::BOOLEAN;
+
+                    // Equality (=) -> Returns BOOLEAN
+                    case '=':
+                        // Allow (Alien == Alien) or (Alien == null) or (int == int)
+                        if (left != right && left != Interner::NULL_ && right != Interner::NULL_) {
+                            error("Comparison type mismatch: " + std::string(nameOf(left)) + " vs " + std::string(nameOf(right)), node);
+                        }
+                        return Interner::BOOLEAN;
 
-                // Equality (=) -> Returns BOOLEAN
-                if (n.op == '=') {
-                    // Allow (Alien == Alien) or (Alien == null) or (int == int)
-                    if (left != right && left != "null" && right != "null") {
-                        error("Comparison type mismatch: " + std::string(left) + " vs " + std::string(right), node);
-                    }
-                    return "boolean";
-                }
+                    // Logic (& |) -> Returns BOOLEAN
+                    case '&': case '|':
+                        checkTypeMatch(Interner::BOOLEAN, left, *n.left);
+                        checkTypeMatch(Interner::BOOLEAN, right, *n.right);
+                        return Interner::BOOLEAN;
 
-                // Logic (& |) -> Returns BOOLEAN
-                if (n.op == '&' || n.op == '|') {
-                    checkTypeMatch("boolean", left, *n.left);
-                    checkTypeMatch("boolean", right, *n.right);
-                    return "boolean";
+                    default:
+                        return Interner::VOID;
                 }
-                return "void";
             }
 
             case ASTNodeType::UNARY_OP: {
                 auto& n = static_cast<const UnaryOpNode&>(node); // NOLINT(*-pro-type-static-cast-downcast)
-                const std::string_view inner = analyseExpression(*n.term, table);
+                const NameId inner = analyseExpression(*n.term, table);
 
                 if (n.op == '-') {
-                    checkTypeMatch("int", inner, *n.term);
-                    return "int";
+                    checkTypeMatch(Interner::INT, inner, *n.term);
+                    return Interner::INT;
                 }
                 if (n.op == '~') {
-                    checkTypeMatch("boolean", inner, *n.term);
-                    return "boolean";
+                    checkTypeMatch(Interner::BOOLEAN, inner, *n.term);
+                    return Interner::BOOLEAN;
                 }
-                return "void";
+                return Interner::VOID;
             }
             case ASTNodeType::SUBROUTINE_CALL: {
-                auto& n = static_cast<const CallNode&>(node);  // NOLINT(*-pro-type-static-cast-downcast)
-                return analyseSubroutineCall(n.classNameOrVar, n.functionName, n.arguments, table, node);
+                return analyseSubroutineCall(static_cast<const CallNode&>(node), table); // NOLINT(*-pro-type-static-cast-downcast)
 			}
 			default:
-				return "void";
+				return Interner::VOID;
 		}
 
 	}
 
 
-	std::string_view SemanticAnalyser::analyseSubroutineCall(const std::string_view classNameOrVar, const std::string_view functionName,
-		const std::vector<std::unique_ptr<ExpressionNode> > &args, SymbolTable &table, const Node &locationNode) const {
-		std::string_view targetClass;
-        const std::string_view targetMethod = functionName;
+	NameId SemanticAnalyser::analyseSubroutineCall(const CallNode& call, SymbolTable &table) const {
+		const NameId classNameOrVar = call.classNameOrVar;
+		const NameId functionName = call.functionName;
+		const NodeList<ExpressionNode>& args = call.arguments;
+		const Node& locationNode = call;
+		NameId targetClass = Interner::EMPTY;
+        const NameId targetMethod = functionName;
         bool isMethodCall = false;
 
         // 1. Determine Target Class and Call Type
-        if (classNameOrVar.empty()) { // Implicit 'this' call: foo()
+        if (classNameOrVar == Interner::EMPTY) { // Implicit 'this' call: foo()
             targetClass = currentClassName;
-        	if (!registry.methodExists(targetClass,targetMethod)) {
-        		error("Method '" + std::string(targetMethod) + "' not found in class '" + std::string(targetClass) +
+            const MethodSignature* own = findSignature(targetClass, targetMethod);
+        	if (!own) {
+        		error("Method '" + std::string(nameOf(targetMethod)) + "' not found in class '" + std::string(nameOf(targetClass)) +
         			"'", locationNode);
         	}
-            const auto sig = registry.getSignature(targetClass, targetMethod);
-            if (currentSubroutineKind == "function" && !sig.isStatic) {
-                 error("Cannot call method '" + std::string(functionName) + "' from static function without object.", locationNode);
+            if (currentSubroutineType == SubroutineType::FUNCTION && !own->isStatic) {
+                 error("Cannot call method '" + std::string(nameOf(functionName)) + "' from static function without object.", locationNode);
             }
-            isMethodCall = !sig.isStatic;
+            isMethodCall = !own->isStatic;
         } else {
-            const std::string_view type = table.typeOf(classNameOrVar);
-            if (!type.empty()) { // It's a Variable: a.foo()
-                targetClass = type;
+            if (const Symbol* object = table.lookup(classNameOrVar)) { // It's a Variable: a.foo()
+                targetClass = object->type;
                 isMethodCall = true;
+                call.receiver = {object->kind, object->index, object->type};
             } else { // It's a Class: Math.abs()
-                if (!registry.classExists(classNameOrVar)) {
-                    error("Undefined class '" + std::string(classNameOrVar) + "'", locationNode);
+                if (!classExists(classNameOrVar)) {
+                    error("Undefined class '" + std::string(nameOf(classNameOrVar)) + "'", locationNode);
                 }
                 targetClass = classNameOrVar;
                 isMethodCall = false;
@@ -381,18 +440,20 @@ namespace nand2tetris::jack {
         }
 
         // 2. Verify Method Existence
-        if (!registry.methodExists(targetClass, targetMethod)) {
-            error("Method '" + std::string(targetMethod) + "' not found in class '" + std::string(targetClass) + "'", locationNode);
+        const MethodSignature* found = findSignature(targetClass, targetMethod);
+        if (!found) {
+            error("Method '" + std::string(nameOf(targetMethod)) + "' not found in class '" + std::string(nameOf(targetClass)) + "'", locationNode);
         }
 
-        const auto sig = registry.getSignature(targetClass, targetMethod);
+        const MethodSignature& sig = *found;
+        calls.back().callees.push_back({targetClass, targetMethod});
 
         // 3. Static/Method Mismatch Checks
         if (isMethodCall && sig.isStatic) {
-            error("Cannot call static function '" + std::string(targetMethod) + "' on an object instance.", locationNode);
+            error("Cannot call static function '" + std::string(nameOf(targetMethod)) + "' on an object instance.", locationNode);
         }
         if (!isMethodCall && !sig.isStatic) {
-            error("Cannot call method '" + std::string(targetMethod) + "' as a static function.", locationNode);
+            error("Cannot call method '" + std::string(nameOf(targetMethod)) + "' as a static function.", locationNode);
         }
 
         // 4. Argument Count Check
@@ -403,7 +464,7 @@ namespace nand2tetris::jack {
 
         // 5. Argument Type Check
         for (size_t i = 0; i < args.size(); ++i) {
-            const std::string_view argType = analyseExpression(*args[i], table);
+            const NameId argType = analyseExpression(*args[i], table);
             checkTypeMatch(sig.parameters[i], argType, *args[i]);
         }
 
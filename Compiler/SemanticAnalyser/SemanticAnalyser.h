@@ -6,9 +6,12 @@
 #define NAND2TETRIS_SEMANTIC_ANALYSER_H
 
 
+#include "CallGraph.h"
 #include "GlobalRegistry.h"
 #include "SymbolTable.h"
+#include "../Common/Diagnostics.h"
 #include "../Parser/AST.h"
+#include "../Tokenizer/LineIndex.h"
 
 namespace nand2tetris::jack{
 
@@ -25,33 +28,101 @@ namespace nand2tetris::jack{
              * @brief Constructs a SemanticAnalyser.
              *
              * @param registry The global registry containing class and method signatures.
+             * @param lines The line index of the analysed file, for the positions in error messages.
              */
-            explicit SemanticAnalyser(const GlobalRegistry& registry);
+            SemanticAnalyser(const GlobalRegistry& registry, const LineIndex& lines);
 
             /**
              * @brief Analyzes a class node and its contents.
              *
+             * Without `errors` the first error ends the analysis. With it, an error inside a subroutine is
+             * recorded there and the analysis carries on with the next subroutine, so one pass finds the
+             * errors of every subroutine; an error in the class variables still ends it.
+             *
              * @param class_node The root node of the class AST.
              * @param table The symbol table to use for analysis.
-             * @throws std::runtime_error if any semantic error is found.
+             * @param errors Where to collect the errors of the subroutines (their file is left empty).
+             * @throws CompileError if any semantic error is found (and not collected).
+             */
+            void analyseClass(const ClassNode& class_node,SymbolTable& table, std::vector<Diagnostic>* errors = nullptr);
+
+            /**
+             * @brief Analyzes the class variables (static/field), the first half of analyseClass().
+             *
+             * Subroutines only read the class scope, so once this is done every subroutine can be analysed
+             * independently, each by its own copy of this analyser and of the table.
+             *
+             * @param class_node The root node of the class AST.
+             * @param table The symbol table that receives the class scope.
+             * @throws CompileError if any semantic error is found.
              */
-            void analyseClass(const ClassNode& class_node,SymbolTable& table);
+            void analyseClassVariables(const ClassNode& class_node, SymbolTable& table);
+
+            /**
+             * @brief Analyzes a subroutine declaration.
+             *
+             * Sets up the local symbol table and analyzes the subroutine body.
+             *
+             * @param sub The subroutine declaration node.
+             * @param table The symbol table to use, holding the class scope.
+             * @throws CompileError if any semantic error is found.
+             */
+            void analyseSubroutine(const SubroutineDecNode& sub,SymbolTable& table);
+
+            /**
+             * @brief Returns every other class whose existence or signatures the analysed class relied on.
+             *
+             * If none of these classes changes, the analysis (and the generated code) cannot change either;
+             * the incremental build cache uses this to decide what to recompile.
+             *
+             * @return Class names, sorted and without duplicates. Primitive types are not included.
+             */
+            std::vector<NameId> referencedClasses() const;
+
+            /**
+             * @brief Returns what each analysed subroutine calls, in the order they were analysed.
+             *
+             * Every call is recorded as the registry resolved it, so these are the edges of the whole
+             * program's CallGraph.
+             */
+            const std::vector<SubroutineCalls>& subroutineCalls() const { return calls; }
         private:
             const GlobalRegistry& registry; ///< Reference to the global registry.
+            const LineIndex& lines;         ///< Maps node offsets to lines and columns.
 
             // State
-            std::string_view currentClassName;      ///< Name of the class currently being analyzed.
-            std::string_view currentSubroutineName; ///< Name of the subroutine currently being analyzed.
-            std::string_view currentSubroutineKind; ///< Kind of the current subroutine ("function", "method", "constructor").
+            NameId currentClassName = Interner::EMPTY;      ///< Name of the class currently being analyzed.
+            NameId currentSubroutineName = Interner::EMPTY; ///< Name of the subroutine currently being analyzed.
+            SubroutineType currentSubroutineType = SubroutineType::FUNCTION; ///< Kind of the current subroutine.
+            mutable std::vector<NameId> dependencies; ///< Every class looked up in the registry (may repeat).
+            mutable std::vector<SubroutineCalls> calls; ///< One entry per analysed subroutine.
+
+            /**
+             * @brief registry.classExists(), remembering the class as a dependency.
+             */
+            bool classExists(NameId className) const;
 
             /**
-             * @brief Reports a semantic error and throws an exception.
+             * @brief registry.findSignature(), remembering the class as a dependency.
+             */
+            const MethodSignature* findSignature(NameId className, NameId methodName) const;
+
+            /**
+             * @brief Reports a semantic error by throwing a CompileError.
              *
              * @param message The error message.
              * @param node The AST node where the error occurred (for location info).
              */
             [[noreturn]] void error(std::string_view message, const Node& node) const;
 
+            /**
+             * @brief table.define(), reporting a name defined twice in the same scope.
+             *
+             * @param offset Where the variable is declared.
+             * @throws CompileError if the variable is already defined in the current scope.
+             */
+            void define(SymbolTable& table, NameId name, NameId type, SymbolKind kind, std::uint32_t offset) const;
+
             /**
              * @brief Checks if two types match according to Jack's type rules.
              *
@@ -61,26 +132,16 @@ namespace nand2tetris::jack{
              * @param actual The actual type found.
              * @param locationNode The AST node for error reporting.
              */
-            void checkTypeMatch(std::string_view expected, std::string_view actual,const Node& locationNode) const;
+            void checkTypeMatch(NameId expected, NameId actual,const Node& locationNode) const;
 
 
-            /**
-             * @brief Analyzes a subroutine declaration.
-             *
-             * Sets up the local symbol table and analyzes the subroutine body.
-             *
-             * @param sub The subroutine declaration node.
-             * @param table The symbol table to use.
-             */
-            void analyseSubroutine(const SubroutineDecNode& sub,SymbolTable& table);
-
             /**
              * @brief Analyzes a list of statements.
              *
              * @param stmts The vector of statement nodes.
              * @param table The current symbol table.
              */
-            void analyseStatements(const std::vector<std::unique_ptr<StatementNode>>& stmts, SymbolTable& table) const;
+            void analyseStatements(const NodeList<StatementNode>& stmts, SymbolTable& table) const;
 
             /**
              * @brief Analyzes a 'let' statement.
@@ -140,25 +201,19 @@ namespace nand2tetris::jack{
              * @param table The current symbol table.
              * @return The type of the expression (e.g., "int", "boolean", "MyClass").
              */
-            std::string_view analyseExpression(const ExpressionNode& node, SymbolTable& table)const;
+            NameId analyseExpression(const ExpressionNode& node, SymbolTable& table)const;
 
             /**
              * @brief Analyzes a subroutine call.
              *
              * Resolves the target class/object, checks method existence, verifies argument count and types.
+             * Records the receiver variable (if any) on the node.
              *
-             * @param classNameOrVar The class name or variable name (or empty for implicit 'this').
-             * @param functionName The name of the function/method.
-             * @param args The list of argument expressions.
+             * @param call The call node (also used for error reporting).
              * @param table The current symbol table.
-             * @param locationNode The AST node for error reporting.
              * @return The return type of the called subroutine.
              */
-            std::string_view analyseSubroutineCall(std::string_view classNameOrVar,
-                                               std::string_view functionName,
-                                               const std::vector<std::unique_ptr<ExpressionNode>>& args,
-                                               SymbolTable& table,
-                                               const Node& locationNode)const;
+            NameId analyseSubroutineCall(const CallNode& call, SymbolTable& table)const;
     };
 }
 
@@ -0,0 +1,38 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "StandardLibrary.h"
+#include <algorithm>
+
+namespace nand2tetris::jack {
+
+    namespace {
+        bool byClass(const BuiltinMethod& m, const NameId className) {
+            return m.className < className;
+        }
+    }
+
+    bool isBuiltinClass(const NameId className) {
+        const auto it = std::lower_bound(STANDARD_LIBRARY.begin(), STANDARD_LIBRARY.end(), className, byClass);
+        return it != STANDARD_LIBRARY.end() && it->className == className;
+    }
+
+    Span<BuiltinMethod> builtinMethodsOf(const NameId className) {
+        const auto first = std::lower_bound(STANDARD_LIBRARY.begin(), STANDARD_LIBRARY.end(), className, byClass);
+        auto last = first;
+        while (last != STANDARD_LIBRARY.end() && last->className == className) ++last;
+        return {first, static_cast<std::size_t>(last - first)};
+    }
+
+    const MethodSignature* findBuiltin(const NameId className, const NameId methodName) {
+        const auto it = std::lower_bound(STANDARD_LIBRARY.begin(), STANDARD_LIBRARY.end(), std::make_pair(className, methodName),
+                                         [](const BuiltinMethod& m, const std::pair<NameId, NameId>& key) {
+                                             return m.className != key.first ? m.className < key.first : m.name < key.second;
+                                         });
+        if (it == STANDARD_LIBRARY.end() || it->className != className || it->name != methodName) {
+            return nullptr;
+        }
+        return &it->signature;
+    }
+}
@@ -0,0 +1,199 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_STANDARD_LIBRARY_H
+#define NAND2TETRIS_STANDARD_LIBRARY_H
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+#include "GlobalRegistry.h"
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief One subroutine of the Jack OS API.
+     */
+    struct BuiltinMethod {
+        NameId className;          ///< The OS class (e.g. Math).
+        NameId name;               ///< The subroutine name.
+        MethodSignature signature; ///< Its signature; declaration position is 0:0.
+    };
+
+    namespace stdlib {
+
+        /**
+         * @brief Source form of a table entry, written with names rather than IDs.
+         *
+         * Unused parameter slots stay empty; no OS subroutine takes more than 12 arguments.
+         */
+        struct Spec {
+            std::string_view className;
+            std::string_view name;
+            std::string_view returnType;
+            bool isStatic;
+            std::string_view params[12];
+        };
+
+        // Constructors ('new') are treated as 'static' because you call them on the class (String.new), not an object.
+        inline constexpr Spec SPECS[] = {
+            // --- MATH CLASS ---
+            {"Math", "init",      "void",    true,  {}},
+            {"Math", "abs",       "int",     true,  {"int"}},
+            {"Math", "multiply",  "int",     true,  {"int", "int"}},
+            {"Math", "divide",    "int",     true,  {"int", "int"}},
+            {"Math", "min",       "int",     true,  {"int", "int"}},
+            {"Math", "max",       "int",     true,  {"int", "int"}},
+            {"Math", "sqrt",      "int",     true,  {"int"}},
+            {"Math", "bit",       "boolean", true,  {"int", "int"}},
+
+            // --- STRING CLASS ---
+            {"String", "new",           "String", true,  {"int"}},
+            {"String", "dispose",       "void",   false, {}},
+            {"String", "length",        "int",    false, {}},
+            {"String", "charAt",        "char",   false, {"int"}},
+            {"String", "setCharAt",     "void",   false, {"int", "char"}},
+            {"String", "appendChar",    "String", false, {"char"}},
+            {"String", "eraseLastChar", "void",   false, {}},
+            {"String", "intValue",      "int",    false, {}},
+            {"String", "setInt",        "void",   false, {"int"}},
+            {"String", "backSpace",     "char",   false, {}},
+            {"String", "doubleQuote",   "char",   false, {}},
+            {"String", "newLine",       "char",   false, {}},
+            {"String", "int2String",    "void",   false, {}},
+
+            // --- ARRAY CLASS ---
+            {"Array", "new",     "Array", true,  {"int"}},
+            {"Array", "dispose", "void",  false, {}},
+
+            // --- OUTPUT CLASS ---
+            {"Output", "init",            "void",  true, {}},
+            {"Output", "moveCursor",      "void",  true, {"int", "int"}},
+            {"Output", "printChar",       "void",  true, {"char"}},
+            {"Output", "printString",     "void",  true, {"String"}},
+            {"Output", "printInt",        "void",  true, {"int"}},
+            {"Output", "println",         "void",  true, {}},
+            {"Output", "backSpace",       "void",  true, {}},
+            {"Output", "initMap",         "void",  true, {}},
+            {"Output", "create",          "void",  true, {"int", "int", "int", "int", "int", "int", "int", "int", "int", "int", "int", "int"}},
+            {"Output", "getMap",          "Array", true, {"char"}},
+            {"Output", "incrementCursor", "void",  true, {}},
+            {"Output", "decrementCursor", "void",  true, {}},
+
+            // --- SCREEN CLASS ---
+            {"Screen", "init",          "void", true, {}},
+            {"Screen", "clearScreen",   "void", true, {}},
+            {"Screen", "setColor",      "void", true, {"boolean"}},
+            {"Screen", "drawPixel",     "void", true, {"int", "int"}},
+            {"Screen", "drawLine",      "void", true, {"int", "int", "int", "int"}},
+            {"Screen", "drawRectangle", "void", true, {"int", "int", "int", "int"}},
+            {"Screen", "drawCircle",    "void", true, {"int", "int", "int"}},
+
+            // --- KEYBOARD CLASS ---
+            {"Keyboard", "init",       "void",   true, {}},
+            {"Keyboard", "keyPressed", "char",   true, {}},
+            {"Keyboard", "readChar",   "char",   true, {}},
+            {"Keyboard", "readLine",   "String", true, {"String"}},
+            {"Keyboard", "readInt",    "int",    true, {"String"}},
+
+            // --- MEMORY CLASS ---
+            {"Memory", "init",    "void", true, {}},
+            {"Memory", "peek",    "int",  true, {"int"}},
+            {"Memory", "poke",    "void", true, {"int", "int"}},
+            {"Memory", "alloc",   "int",  true, {"int"}},
+            {"Memory", "deAlloc", "void", true, {"Array"}},
+
+            // --- SYS CLASS ---
+            {"Sys", "init",  "void", true, {}},
+            {"Sys", "halt",  "void", true, {}},
+            {"Sys", "error", "void", true, {"int"}},
+            {"Sys", "wait",  "void", true, {"int"}},
+        };
+
+        inline constexpr std::size_t COUNT = std::size(SPECS);
+
+        constexpr std::size_t paramCount(const Spec& spec) {
+            std::size_t n = 0;
+            while (n < std::size(spec.params) && !spec.params[n].empty()) ++n;
+            return n;
+        }
+
+        constexpr bool lessThan(const Spec& a, const Spec& b) {
+            const NameId ca = Interner::seeded(a.className), cb = Interner::seeded(b.className);
+            return ca != cb ? ca < cb : Interner::seeded(a.name) < Interner::seeded(b.name);
+        }
+
+        // SPECS indices in (class, name) NameId order. Insertion sort: std::sort is not constexpr in C++17.
+        inline constexpr std::array<std::size_t, COUNT> ORDER = [] {
+            std::array<std::size_t, COUNT> order{};
+            for (std::size_t i = 0; i < COUNT; ++i) {
+                std::size_t j = i;
+                while (j > 0 && lessThan(SPECS[i], SPECS[order[j - 1]])) {
+                    order[j] = order[j - 1];
+                    --j;
+                }
+                order[j] = i;
+            }
+            return order;
+        }();
+
+        inline constexpr std::size_t PARAM_TOTAL = [] {
+            std::size_t total = 0;
+            for (const Spec& spec : SPECS) total += paramCount(spec);
+            return total;
+        }();
+
+        // Every parameter type of every entry, laid out in table order.
+        inline constexpr std::array<NameId, PARAM_TOTAL> PARAMS = [] {
+            std::array<NameId, PARAM_TOTAL> params{};
+            std::size_t next = 0;
+            for (const std::size_t i : ORDER) {
+                for (std::size_t p = 0; p < paramCount(SPECS[i]); ++p) {
+                    params[next++] = Interner::seeded(SPECS[i].params[p]);
+                }
+            }
+            return params;
+        }();
+    }
+
+    /**
+     * @brief The Jack OS API, resolved to NameIds and sorted by (class, name) at compile time.
+     *
+     * The GlobalRegistry consults this table for any class the program does not define itself,
+     * so registering the OS costs nothing at startup.
+     */
+    inline constexpr std::array<BuiltinMethod, stdlib::COUNT> STANDARD_LIBRARY = [] {
+        std::array<BuiltinMethod, stdlib::COUNT> table{};
+        std::size_t nextParam = 0;
+        for (std::size_t k = 0; k < stdlib::COUNT; ++k) {
+            const stdlib::Spec& spec = stdlib::SPECS[stdlib::ORDER[k]];
+            const std::size_t n = stdlib::paramCount(spec);
+            table[k] = {Interner::seeded(spec.className), Interner::seeded(spec.name),
+                        MethodSignature{Interner::seeded(spec.returnType),
+                                        Span<NameId>(stdlib::PARAMS.data() + nextParam, n), spec.isStatic, 0}};
+            nextParam += n;
+        }
+        return table;
+    }();
+
+    /**
+     * @brief True if the name is one of the OS classes.
+     */
+    bool isBuiltinClass(NameId className);
+
+    /**
+     * @brief Returns the run of STANDARD_LIBRARY entries belonging to one OS class (empty if it is not one).
+     */
+    Span<BuiltinMethod> builtinMethodsOf(NameId className);
+
+    /**
+     * @brief Looks up an OS subroutine.
+     *
+     * @return The signature, or nullptr if the class is not an OS class or has no such subroutine.
+     */
+    const MethodSignature* findBuiltin(NameId className, NameId methodName);
+}
+
+#endif //NAND2TETRIS_STANDARD_LIBRARY_H
@@ -20,17 +20,28 @@ namespace nand2tetris::jack {
         }
     }
 
-    SymbolTable::SymbolTable() {
+    namespace {
+        // Position of a kind in the running-index array.
+        std::size_t slot(const SymbolKind kind) {
+            return static_cast<std::size_t>(kind);
+        }
+
+        const Symbol* find(const std::vector<Symbol>& scope, const NameId name) {
+            for (const Symbol& symbol : scope) {
+                if (symbol.name == name) return &symbol;
+            }
+            return nullptr;
+        }
+    }
+
+    SymbolTable::SymbolTable(const bool keepHistory) : keepHistory(keepHistory) {
         // Initialize all running indices to 0.
-        indices[SymbolKind::STATIC] = 0;
-        indices[SymbolKind::FIELD] = 0;
-        indices[SymbolKind::ARG] = 0;
-        indices[SymbolKind::LCL] = 0;
+        indices.fill(0);
     }
 
-    void SymbolTable::startSubroutine(const std::string_view name) {
+    void SymbolTable::startSubroutine(const NameId name) {
         // If there was a previous subroutine, save its state to history.
-        if (!currentSubroutineName.empty()) {
+        if (keepHistory && currentSubroutineName != Interner::EMPTY) {
             SubroutineSnapshot snap;
             snap.name = currentSubroutineName;
             snap.symbols = subRoutineScope;
@@ -42,67 +53,37 @@ namespace nand2tetris::jack {
         subRoutineScope.clear();
 
         // Reset indices for subroutine-level variables.
-        indices[SymbolKind::ARG] = 0;
-        indices[SymbolKind::LCL] = 0;
+        indices[slot(SymbolKind::ARG)] = 0;
+        indices[slot(SymbolKind::LCL)] = 0;
 
         currentSubroutineName = name;
     }
 
-    void SymbolTable::startSubroutineFromHistory(const std::string_view name) {
-        subRoutineScope.clear();
-        bool found = false;
-
-        // Find the snapshot by name in the history.
-        for (const auto& snap : history) {
-            if (snap.name == name) {
-                // Restore the symbol table and indices from the snapshot.
-                subRoutineScope = snap.symbols;
-                indices = snap.indices;
-                currentSubroutineName = name;
-                found = true;
-                break;
-            }
-        }
-
-        // If not found (shouldn't happen in valid flow), reset as a new subroutine.
-        if (!found) {
-            indices[SymbolKind::ARG] = 0;
-            indices[SymbolKind::LCL] = 0;
-            currentSubroutineName = name;
-        }
-    }
-
-    const Symbol *SymbolTable::lookup(const std::string_view name) const {
+    const Symbol *SymbolTable::lookup(const NameId name) const {
         // 1. Check the subroutine scope (local variables and arguments) first.
         // This allows local variables to shadow class variables.
-        const auto subIt = subRoutineScope.find(name);
-        if (subIt != subRoutineScope.end()) {
-            return &(subIt->second);
+        if (const Symbol* local = find(subRoutineScope, name)) {
+            return local;
         }
 
         // 2. If not found, check the class scope (static and field variables).
-        const auto classIt = classScope.find(name);
-        if (classIt != classScope.end()) {
-            return &(classIt->second);
-        }
-
-        // 3. Not found in either scope.
-        return nullptr;
+        // 3. Returns nullptr if it is in neither scope.
+        return find(classScope, name);
     }
 
-    SymbolKind SymbolTable::kindOf(const std::string_view name) const {
+    SymbolKind SymbolTable::kindOf(const NameId name) const {
         const Symbol* s=lookup(name);
         // Return the kind of variable if found, otherwise return NONE.
         return (s) ? s->kind:SymbolKind::NONE;
     }
 
-    std::string_view SymbolTable::typeOf(const std::string_view name) const {
+    NameId SymbolTable::typeOf(const NameId name) const {
         const Symbol* s=lookup(name);
-        // Return the type if found, otherwise return empty string.
-        return (s) ? s->type:"";
+        // Return the type if found, otherwise return the empty name.
+        return (s) ? s->type:Interner::EMPTY;
     }
 
-    int SymbolTable::indexOf(const std::string_view name) const {
+    int SymbolTable::indexOf(const NameId name) const {
         const Symbol* s=lookup(name);
         // Return the index if found, otherwise return -1.
         return (s) ? s->index:-1;
@@ -110,16 +91,14 @@ namespace nand2tetris::jack {
 
     int SymbolTable::varCount(const SymbolKind kind) const {
         // Return the current count (next index) for the given kind.
-        const auto it=indices.find(kind);
-        if (it != indices.end()) {
-            return it->second;
+        if (kind == SymbolKind::NONE) {
+            return 0;
         }
-
-        return 0;
+        return indices[slot(kind)];
     }
 
 
-    void SymbolTable::define(const std::string_view name, const std::string_view type, const SymbolKind kind, const int line, const int col) {
+    const Symbol* SymbolTable::define(const NameId name, const NameId type, const SymbolKind kind, const std::uint32_t offset) {
         // Check if the variable is already defined in the *current* scope to prevent redefinition.
         // Note: lookup() checks both scopes, but for redefinition checks, we strictly care about
         // the scope we are about to insert into. However, checking lookup() is a safe conservative check
@@ -140,7 +119,7 @@ namespace nand2tetris::jack {
 
         const Symbol* existing = lookup(name);
 
-        // Refined check: Only throw if the existing symbol is in the SAME scope we are defining in.
+        // Refined check: Only report a collision if the existing symbol is in the SAME scope we are defining in.
         // If we are defining a local (LCL/ARG) and the existing is global (STATIC/FIELD), that's shadowing (usually valid).
         // If we are defining a global and existing is global, that's a redefinition error.
         // If we are defining a local and existing is local, that's a redefinition error.
@@ -158,48 +137,49 @@ namespace nand2tetris::jack {
             // If definingGlobal is true and existingGlobal is false, that shouldn't happen during parsing order usually.
         }
 
-        if (collision) {
-            const std::string msg =
-                "Semantic Error [" + std::to_string(line) + ":" + std::to_string(col) + "]: " +
-                "Variable '" + std::string(name) + "' is already defined as a " +
-                kindToString(existing->kind) + " at [" +
-                std::to_string(existing->declLine) + ":" + std::to_string(existing->declCol) + "].";
-            throw std::runtime_error(msg);
-        }
+        // The caller reports the collision; only it can turn the offsets into lines and columns.
+        if (collision) return existing;
 
         // Create the new symbol, assigning it the current index for its kind.
-        const Symbol symbol = {type, kind,indices[kind]++,line,col};
+        const Symbol symbol = {name, type, kind,indices[slot(kind)]++,offset};
 
-        // Insert into the appropriate scope map.
+        // Insert into the appropriate scope.
         if (kind == SymbolKind::STATIC || kind == SymbolKind::FIELD) {
-            classScope[name] = symbol;
+            classScope.push_back(symbol);
         } else {
-            subRoutineScope[name] = symbol;
+            subRoutineScope.push_back(symbol);
         }
+        return nullptr;
     }
 
-    void SymbolTable::dumpToJSON(std::string_view className, const std::string& path) const {
-        // Create a temporary full history that includes the current active subroutine
+    std::vector<SubroutineSnapshot> SymbolTable::subroutineSnapshots() const {
+        // The full history includes the current active subroutine
         std::vector<SubroutineSnapshot> fullHistory = history;
-        if (!currentSubroutineName.empty()) {
+        if (currentSubroutineName != Interner::EMPTY) {
             SubroutineSnapshot snap;
             snap.name = currentSubroutineName;
             snap.symbols = subRoutineScope;
+            snap.indices = indices;
             fullHistory.push_back(snap);
         }
+        return fullHistory;
+    }
+
+    void SymbolTable::dumpToJSON(const NameId className, const std::string& path) const {
+        const std::vector<SubroutineSnapshot> fullHistory = subroutineSnapshots();
 
         std::ofstream json(path);
         if (!json.is_open()) return;
 
-        json << "{\n  \"className\": \"" << className << "\",\n";
+        json << "{\n  \"className\": \"" << nameOf(className) << "\",\n";
         json << "  \"classSymbols\": [\n";
 
         bool first = true;
-        for (const auto& pair : classScope) {
+        for (const Symbol& symbol : classScope) {
             if (!first) json << ",\n";
-            json << "    {\"name\": \"" << pair.first << "\", \"type\": \"" << pair.second.type
-                 << "\", \"kind\": \"" << kindToString(pair.second.kind)
-                 << "\", \"index\": " << pair.second.index << "}";
+            json << "    {\"name\": \"" << nameOf(symbol.name) << "\", \"type\": \"" << nameOf(symbol.type)
+                 << "\", \"kind\": \"" << kindToString(symbol.kind)
+                 << "\", \"index\": " << symbol.index << "}";
             first = false;
         }
         json << "\n  ],\n";
@@ -208,13 +188,13 @@ namespace nand2tetris::jack {
         bool firstSub = true;
         for (const auto& snap : fullHistory) {
             if (!firstSub) json << ",\n";
-            json << "    {\n      \"name\": \"" << snap.name << "\",\n      \"symbols\": [\n";
+            json << "    {\n      \"name\": \"" << nameOf(snap.name) << "\",\n      \"symbols\": [\n";
             bool firstSym = true;
-            for (const auto& pair : snap.symbols) {
+            for (const Symbol& symbol : snap.symbols) {
                 if (!firstSym) json << ",\n";
-                json << "        {\"name\": \"" << pair.first << "\", \"type\": \"" << pair.second.type
-                     << "\", \"kind\": \"" << kindToString(pair.second.kind)
-                     << "\", \"index\": " << pair.second.index << "}";
+                json << "        {\"name\": \"" << nameOf(symbol.name) << "\", \"type\": \"" << nameOf(symbol.type)
+                     << "\", \"kind\": \"" << kindToString(symbol.kind)
+                     << "\", \"index\": " << symbol.index << "}";
                 firstSym = false;
             }
             json << "\n      ]\n    }";
@@ -5,41 +5,37 @@
 #ifndef NAND2TETRIS_SYMBOL_TABLE_H
 #define NAND2TETRIS_SYMBOL_TABLE_H
 #include "../Parser/Parser.h"
-#include <unordered_map>
+#include <array>
+#include <cstdint>
+#include <vector>
 
 namespace nand2tetris::jack{
 
-    /**
-     * @brief Enumeration representing the kind of symbol.
-     */
-    enum class SymbolKind {
-        STATIC, ///< Static variable (class-level, shared).
-        FIELD,  ///< Field variable (class-level, instance-specific).
-        ARG,    ///< Argument variable (subroutine-level).
-        LCL,    ///< Local variable (subroutine-level).
-        NONE    ///< Represents a symbol not found in the table.
-    };
-
     /**
      * @brief Structure representing a symbol in the symbol table.
      */
     struct Symbol{
-        std::string_view type; ///< The data type of the symbol (e.g., "int", "boolean", "MyClass").
+        NameId name;           ///< The name of the symbol.
+        NameId type;           ///< The data type of the symbol (e.g., "int", "boolean", "MyClass").
         SymbolKind kind;       ///< The kind of the symbol (STATIC, FIELD, ARG, LCL).
         int index;             ///< The running index of the symbol within its kind.
-        int declLine;          ///< The line number where the symbol was declared.
-        int declCol;           ///< The column number where the symbol was declared.
+        std::uint32_t declOffset; ///< Byte offset of the declaration in the source file.
     };
 
+    /**
+     * @brief Returns the name of a symbol kind as used in messages ("static", "field", "argument", "local").
+     */
+    std::string kindToString(SymbolKind kind);
+
     /**
      * @brief Structure representing a snapshot of a subroutine's symbol table state.
      *
-     * Used for restoring the symbol table state during code generation or debugging.
+     * Only kept for the symbol table visualiser (--viz-checker).
      */
     struct SubroutineSnapshot {
-        std::string_view name; ///< The name of the subroutine.
-        std::unordered_map<std::string_view, Symbol> symbols; ///< The symbols defined in this subroutine.
-        std::unordered_map<SymbolKind, int> indices; ///< The running indices at the end of this subroutine.
+        NameId name;                  ///< The name of the subroutine.
+        std::vector<Symbol> symbols;  ///< The symbols defined in this subroutine.
+        std::array<int, 4> indices{}; ///< The running indices at the end of this subroutine.
     };
 
     /**
@@ -54,8 +50,10 @@ namespace nand2tetris::jack{
              * @brief Constructs a new SymbolTable.
              *
              * Initializes indices for all symbol kinds to 0.
+             *
+             * @param keepHistory Keep a snapshot of every finished subroutine for dumpToJSON().
              */
-            SymbolTable();
+            explicit SymbolTable(bool keepHistory = false);
 
             SymbolTable(const SymbolTable& other) = default;
             ~SymbolTable()=default;
@@ -68,16 +66,7 @@ namespace nand2tetris::jack{
              *
              * @param name The name of the subroutine being started.
              */
-            void startSubroutine(std::string_view name);
-
-            /**
-             * @brief Restores a subroutine scope from history.
-             *
-             * Used during code generation to restore the symbol table state of a previously analyzed subroutine.
-             *
-             * @param name The name of the subroutine to restore.
-             */
-            void startSubroutineFromHistory(std::string_view name);
+            void startSubroutine(NameId name);
 
             /**
              * @brief Returns the number of variables of the given kind defined in the current scope.
@@ -95,15 +84,15 @@ namespace nand2tetris::jack{
              * @param name The name of the identifier.
              * @return The SymbolKind of the identifier, or SymbolKind::NONE if not found.
              */
-            SymbolKind kindOf(std::string_view name) const;
+            SymbolKind kindOf(NameId name) const;
 
             /**
              * @brief Returns the type of the named identifier.
              *
              * @param name The name of the identifier.
-             * @return The type of the identifier (e.g., "int"), or an empty string if not found.
+             * @return The type of the identifier (e.g., "int"), or Interner::EMPTY if not found.
              */
-            std::string_view typeOf(std::string_view name) const;
+            NameId typeOf(NameId name) const;
 
             /**
              * @brief Returns the index of the named identifier.
@@ -111,7 +100,7 @@ namespace nand2tetris::jack{
              * @param name The name of the identifier.
              * @return The index of the identifier, or -1 if not found.
              */
-            int indexOf(std::string_view name) const;
+            int indexOf(NameId name) const;
 
             /**
              * @brief Defines a new variable in the symbol table.
@@ -122,11 +111,11 @@ namespace nand2tetris::jack{
              * @param name The name of the variable.
              * @param type The type of the variable.
              * @param kind The kind of the variable.
-             * @param line The line number of the declaration (for error reporting).
-             * @param col The column number of the declaration (for error reporting).
-             * @throws std::runtime_error if the variable is already defined in the current scope.
+             * @param offset The byte offset of the declaration (for error reporting).
+             * @return Nothing; or, if the variable is already defined in the same scope, the earlier
+             *         symbol (and the new one is not added).
              */
-            void define(std::string_view name, std::string_view type, SymbolKind kind,int line, int col);
+            const Symbol* define(NameId name, NameId type, SymbolKind kind, std::uint32_t offset);
 
             /**
              * @brief Dumps the symbol table content to a JSON file.
@@ -136,25 +125,38 @@ namespace nand2tetris::jack{
              * @param className The name of the class being dumped.
              * @param path The file path to write the JSON to.
              */
-            void dumpToJSON(std::string_view className, const std::string& path) const;
+            void dumpToJSON(NameId className, const std::string& path) const;
+
+            /**
+             * @brief Returns the class-level symbols (STATIC, FIELD), in declaration order.
+             */
+            const std::vector<Symbol>& classSymbols() const { return classScope; }
 
-        private:
             /**
-             * @brief Helper to look up a symbol by name.
+             * @brief Returns a snapshot of every finished subroutine (if the history is kept) and of the current one.
+             */
+            std::vector<SubroutineSnapshot> subroutineSnapshots() const;
+
+            /**
+             * @brief Looks up a symbol by name.
              *
              * Checks subroutine scope first, then class scope.
              *
              * @param name The name to look up.
-             * @return A pointer to the Symbol if found, nullptr otherwise.
+             * @return A pointer to the Symbol if found, nullptr otherwise. It stays valid until the scope changes.
              */
-            const Symbol* lookup(std::string_view name) const;
+            const Symbol* lookup(NameId name) const;
+
+        private:
 
-            std::unordered_map<std::string_view,Symbol> classScope;      ///< Stores class-level symbols (STATIC, FIELD).
-            std::unordered_map<std::string_view,Symbol> subRoutineScope; ///< Stores subroutine-level symbols (ARG, LCL).
-            std::unordered_map<SymbolKind, int> indices;                 ///< Tracks the next available index for each SymbolKind.
+            // Scopes are small, so a linear scan over integer IDs beats hashing.
+            std::vector<Symbol> classScope;      ///< Stores class-level symbols (STATIC, FIELD).
+            std::vector<Symbol> subRoutineScope; ///< Stores subroutine-level symbols (ARG, LCL).
+            std::array<int, 4> indices{};        ///< Tracks the next available index for each SymbolKind (NONE excluded).
 
+            bool keepHistory;                        ///< Record finished subroutines in history.
             std::vector<SubroutineSnapshot> history; ///< Stores snapshots of previous subroutines.
-            std::string_view currentSubroutineName;  ///< Name of the currently active subroutine.
+            NameId currentSubroutineName = Interner::EMPTY; ///< Name of the currently active subroutine.
 
     };
 };
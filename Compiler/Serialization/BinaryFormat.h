@@ -0,0 +1,146 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_BINARY_FORMAT_H
+#define NAND2TETRIS_BINARY_FORMAT_H
+
+#include <cstdint>
+
+namespace nand2tetris::jack::binary {
+
+    /*
+     * Layout of a program file (.jkb), written by BinaryWriter and read by BinaryReader and tools/jack_binary.py:
+     *
+     *   FileHeader
+     *   SectionEntry[sectionCount]
+     *   the sections, each starting on a 4-byte boundary
+     *
+     * Every integer is little-endian, every record has a fixed size and only 4-byte fields (or bytes
+     * packed into one), so a mapped file can be read in place. Names and string literals are ids into
+     * the string table; id 0 is the empty string. A record refers to others by index, never by pointer.
+     */
+
+    inline constexpr char MAGIC[4] = {'J', 'K', 'B', '\0'};
+
+    /// Bumped whenever a record changes; readers reject any other version.
+    inline constexpr std::uint32_t FORMAT_VERSION = 1;
+
+    /// Written as 0x01020304, so a reader on a machine of the other byte order notices.
+    inline constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    struct FileHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t sectionCount;
+    };
+
+    enum class SectionKind : std::uint32_t {
+        STRING_OFFSETS = 1, ///< u32[count + 1]: where each string starts in STRING_BYTES, then the total size.
+        STRING_BYTES = 2,   ///< The strings, back to back and without terminators.
+        CLASSES = 3,        ///< ClassEntry: one per class of the program.
+        NODES = 4,          ///< NodeRecord: every class's AST in pre-order.
+        NAMES = 5,          ///< u32 string ids, for the lists of names NodeRecord and MethodEntry refer to.
+        SCOPES = 6,         ///< ScopeEntry: per class, its class scope and then one per subroutine.
+        SYMBOLS = 7,        ///< SymbolEntry.
+        REGISTRY_CLASSES = 8, ///< RegistryClassEntry: the OS classes not replaced, then the program's.
+        REGISTRY_METHODS = 9, ///< MethodEntry, grouped by class.
+    };
+
+    struct SectionEntry {
+        SectionKind kind;
+        std::uint32_t offset; ///< From the start of the file.
+        std::uint32_t size;   ///< In bytes.
+        std::uint32_t count;  ///< Records (for STRING_OFFSETS: strings).
+    };
+
+    struct ClassEntry {
+        std::uint32_t name;
+        std::uint32_t file;       ///< The source path.
+        std::uint32_t firstNode;  ///< Its CLASS node.
+        std::uint32_t nodeEnd;    ///< One past its last node.
+        std::uint32_t firstScope;
+        std::uint32_t scopeCount; ///< 0 if its symbol table was not kept.
+    };
+
+    /// NodeRecord::flags.
+    inline constexpr std::uint8_t HAS_INDEX = 1;      ///< LET_STATEMENT, IDENTIFIER: the first child is `[index]`.
+    inline constexpr std::uint8_t HAS_EXPRESSION = 2; ///< RETURN_STATEMENT: it has a child.
+
+    /**
+     * @brief One AST node. Its children follow it, each followed by its own subtree, up to `end`.
+     *
+     * By type (the children in order):
+     * - CLASS: name; CLASS_VAR_DEC and then SUBROUTINE_DEC children.
+     * - CLASS_VAR_DEC: tag ClassVarKind, name2 the type; names in the list.
+     * - SUBROUTINE_DEC: tag SubroutineType, name, name2 the return type, value the number of VAR_DEC
+     *   children; then its statements. The list holds the parameters as (type, name) pairs.
+     * - VAR_DEC: name2 the type; names in the list.
+     * - LET_STATEMENT: name the variable, binding its target; [index], value.
+     * - IF_STATEMENT: value the number of then-statements; the condition, then- and else-statements.
+     * - WHILE_STATEMENT: the condition and the body.
+     * - DO_STATEMENT: its SUBROUTINE_CALL. RETURN_STATEMENT: [expression].
+     * - INTEGER_LITERAL: value. STRING_LITERAL: name the text. KEYWORD_LITERAL: tag Keyword.
+     * - BINARY_OP: tag the operator; left, right. UNARY_OP: tag the operator; the operand.
+     * - SUBROUTINE_CALL: name the class or variable (0 for `this`), name2 the subroutine, binding the
+     *   receiver variable; the arguments.
+     * - IDENTIFIER: name, binding; [index].
+     */
+    struct NodeRecord {
+        std::uint8_t type;        ///< ASTNodeType.
+        std::uint8_t tag;
+        std::uint8_t flags;
+        std::uint8_t bindingKind; ///< SymbolKind of the variable it names, NONE otherwise.
+        std::uint32_t offset;     ///< Byte offset in the source.
+        std::uint32_t name;
+        std::uint32_t name2;
+        std::int32_t value;
+        std::int32_t bindingIndex;
+        std::uint32_t bindingType;
+        std::uint32_t end;        ///< One past the last node of its subtree.
+        std::uint32_t firstName;  ///< Into NAMES.
+        std::uint32_t nameCount;
+    };
+
+    struct ScopeEntry {
+        std::uint32_t name;        ///< The subroutine, or the class for its class scope.
+        std::uint32_t firstSymbol;
+        std::uint32_t symbolCount;
+    };
+
+    struct SymbolEntry {
+        std::uint32_t name;
+        std::uint32_t type;
+        std::uint32_t kind;       ///< SymbolKind.
+        std::int32_t index;
+        std::uint32_t declOffset;
+    };
+
+    /// RegistryClassEntry::flags.
+    inline constexpr std::uint32_t CLASS_DECLARED = 1;  ///< Compiled from source rather than the built-in OS table.
+    inline constexpr std::uint32_t CLASS_OS_SOURCE = 2; ///< Compiled from the OS sources (--os).
+
+    struct RegistryClassEntry {
+        std::uint32_t name;
+        std::uint32_t flags;
+        std::uint32_t firstMethod;
+        std::uint32_t methodCount;
+    };
+
+    struct MethodEntry {
+        std::uint32_t name;
+        std::uint32_t returnType;
+        std::uint32_t isStatic;
+        std::uint32_t offset;      ///< Byte offset of the declaration.
+        std::uint32_t firstParam;  ///< Parameter types, into NAMES.
+        std::uint32_t paramCount;
+    };
+
+    static_assert(sizeof(FileHeader) == 16 && sizeof(SectionEntry) == 16 && sizeof(ClassEntry) == 24 &&
+                  sizeof(NodeRecord) == 40 && sizeof(ScopeEntry) == 12 && sizeof(SymbolEntry) == 20 &&
+                  sizeof(RegistryClassEntry) == 16 && sizeof(MethodEntry) == 24,
+                  "records must not contain padding: tools/jack_binary.py reads the same layout");
+}
+
+#endif //NAND2TETRIS_BINARY_FORMAT_H
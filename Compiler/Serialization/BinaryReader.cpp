@@ -0,0 +1,146 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "BinaryReader.h"
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "../Parser/AST.h"
+
+namespace nand2tetris::jack {
+
+    namespace {
+        [[noreturn]] void invalid(const std::string& what) {
+            throw std::runtime_error("Invalid binary program file: " + what);
+        }
+
+        constexpr std::uint8_t NODE_TYPE_COUNT = static_cast<std::uint8_t>(ASTNodeType::IDENTIFIER) + 1;
+    }
+
+    BinaryReader::BinaryReader(const std::string_view bytes) : bytes(bytes) {
+        binary::FileHeader header{};
+        if (bytes.size() < sizeof(header)) invalid("too short");
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, binary::MAGIC, sizeof(header.magic)) != 0) invalid("not a .jkb file");
+        if (header.byteOrder != binary::BYTE_ORDER_MARK) invalid("written on a machine of the other byte order");
+        if (header.version != binary::FORMAT_VERSION) {
+            invalid("format version " + std::to_string(header.version) + ", expected " +
+                    std::to_string(binary::FORMAT_VERSION));
+        }
+        if (header.sectionCount > (bytes.size() - sizeof(header)) / sizeof(binary::SectionEntry)) {
+            invalid("section directory out of range");
+        }
+        const RecordView<binary::SectionEntry> entries(bytes.data() + sizeof(header), header.sectionCount);
+        for (std::size_t i = 0; i < entries.size(); ++i) directory.push_back(entries[i]);
+
+        std::size_t count = 0;
+        const std::string_view offsets = section(binary::SectionKind::STRING_OFFSETS, 0, count);
+        if (offsets.size() != (count + 1) * sizeof(std::uint32_t)) invalid("string offsets");
+        stringOffsets = {offsets.data(), count + 1};
+        stringBytes = section(binary::SectionKind::STRING_BYTES, 1, count);
+
+        const auto records = [&](auto& view, const binary::SectionKind kind) {
+            using Record = std::decay_t<decltype(view[0])>;
+            const std::string_view data = section(kind, sizeof(Record), count);
+            view = {data.data(), count};
+        };
+        records(classList, binary::SectionKind::CLASSES);
+        records(nodeList, binary::SectionKind::NODES);
+        records(nameList, binary::SectionKind::NAMES);
+        records(scopeList, binary::SectionKind::SCOPES);
+        records(symbolList, binary::SectionKind::SYMBOLS);
+        records(registryClassList, binary::SectionKind::REGISTRY_CLASSES);
+        records(methodList, binary::SectionKind::REGISTRY_METHODS);
+        validate();
+    }
+
+    std::string_view BinaryReader::section(const binary::SectionKind kind, const std::size_t recordSize,
+                                           std::size_t& count) const {
+        for (const binary::SectionEntry& entry : directory) {
+            if (entry.kind != kind) continue;
+            if (entry.offset % 4 != 0 || entry.offset > bytes.size() || entry.size > bytes.size() - entry.offset) {
+                invalid("section " + std::to_string(static_cast<std::uint32_t>(kind)) + " out of range");
+            }
+            if (recordSize != 0 && entry.size != static_cast<std::uint64_t>(entry.count) * recordSize) {
+                invalid("section " + std::to_string(static_cast<std::uint32_t>(kind)) + " has the wrong size");
+            }
+            count = entry.count;
+            return bytes.substr(entry.offset, entry.size);
+        }
+        invalid("section " + std::to_string(static_cast<std::uint32_t>(kind)) + " missing");
+    }
+
+    void BinaryReader::validate() const {
+        if (stringOffsets[0] != 0) invalid("string offsets");
+        for (std::size_t i = 1; i < stringOffsets.size(); ++i) {
+            if (stringOffsets[i] < stringOffsets[i - 1]) invalid("string offsets");
+        }
+        if (stringOffsets[stringOffsets.size() - 1] != stringBytes.size()) invalid("string offsets");
+
+        const auto checkString = [&](const std::uint32_t id) {
+            if (id >= stringCount()) invalid("string id " + std::to_string(id) + " out of range");
+        };
+        const auto checkRange = [&](const std::uint64_t first, const std::uint64_t count, const std::size_t size,
+                                    const char* what) {
+            if (first > size || count > size - first) invalid(std::string(what) + " out of range");
+        };
+
+        for (std::size_t i = 0; i < nameList.size(); ++i) checkString(nameList[i]);
+        for (std::size_t i = 0; i < nodeList.size(); ++i) {
+            const binary::NodeRecord node = nodeList[i];
+            if (node.type >= NODE_TYPE_COUNT) invalid("node type");
+            if (node.end <= i || node.end > nodeList.size()) invalid("node subtree out of range");
+            checkString(node.name);
+            checkString(node.name2);
+            checkString(node.bindingType);
+            checkRange(node.firstName, node.nameCount, nameList.size(), "node names");
+        }
+        // Subtrees nest: a child's subtree ends within its parent's.
+        for (std::size_t i = 0; i < nodeList.size(); ++i) {
+            const std::uint32_t end = nodeList[i].end;
+            for (std::uint32_t child = static_cast<std::uint32_t>(i) + 1; child < end; child = nodeList[child].end) {
+                if (nodeList[child].end > end) invalid("node subtrees overlap");
+            }
+        }
+        for (std::size_t i = 0; i < classList.size(); ++i) {
+            const binary::ClassEntry entry = classList[i];
+            checkString(entry.name);
+            checkString(entry.file);
+            if (entry.firstNode >= nodeList.size() || nodeList[entry.firstNode].end != entry.nodeEnd) {
+                invalid("class nodes out of range");
+            }
+            checkRange(entry.firstScope, entry.scopeCount, scopeList.size(), "class scopes");
+        }
+        for (std::size_t i = 0; i < scopeList.size(); ++i) {
+            checkString(scopeList[i].name);
+            checkRange(scopeList[i].firstSymbol, scopeList[i].symbolCount, symbolList.size(), "scope symbols");
+        }
+        for (std::size_t i = 0; i < symbolList.size(); ++i) {
+            checkString(symbolList[i].name);
+            checkString(symbolList[i].type);
+        }
+        for (std::size_t i = 0; i < registryClassList.size(); ++i) {
+            checkString(registryClassList[i].name);
+            checkRange(registryClassList[i].firstMethod, registryClassList[i].methodCount, methodList.size(),
+                       "registry methods");
+        }
+        for (std::size_t i = 0; i < methodList.size(); ++i) {
+            checkString(methodList[i].name);
+            checkString(methodList[i].returnType);
+            checkRange(methodList[i].firstParam, methodList[i].paramCount, nameList.size(), "parameters");
+        }
+    }
+
+    std::string_view BinaryReader::string(const std::uint32_t id) const {
+        if (id >= stringCount()) throw std::out_of_range("string id " + std::to_string(id));
+        return stringBytes.substr(stringOffsets[id], stringOffsets[id + 1] - stringOffsets[id]);
+    }
+
+    std::vector<std::uint32_t> BinaryReader::children(const std::uint32_t node) const {
+        std::vector<std::uint32_t> result;
+        const std::uint32_t end = nodeList[node].end;
+        for (std::uint32_t child = node + 1; child < end; child = nodeList[child].end) result.push_back(child);
+        return result;
+    }
+}
@@ -0,0 +1,92 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_BINARY_READER_H
+#define NAND2TETRIS_BINARY_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include "BinaryFormat.h"
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief The records of one section, read in place from the file's bytes.
+     */
+    template <typename T>
+    class RecordView {
+        public:
+            RecordView() = default;
+            RecordView(const char* data, const std::size_t count) : data(data), count(count) {}
+
+            std::size_t size() const { return count; }
+
+            /// Copied out, so the bytes need no particular alignment. The index must be below size().
+            T operator[](const std::size_t i) const {
+                T record;
+                std::memcpy(&record, data + i * sizeof(T), sizeof(T));
+                return record;
+            }
+
+        private:
+            const char* data = nullptr;
+            std::size_t count = 0;
+    };
+
+    /**
+     * @brief Reads a program file written by BinaryWriter, e.g. from a MappedFile, without copying it.
+     *
+     * The constructor checks the whole file once: the header, that every section lies inside the file,
+     * and that every id and index in it is in range. After that no accessor can read out of bounds.
+     */
+    class BinaryReader {
+        public:
+            /**
+             * @param bytes The file; it must outlive the reader.
+             * @throws std::runtime_error If it is not a valid program file of FORMAT_VERSION.
+             */
+            explicit BinaryReader(std::string_view bytes);
+
+            /**
+             * @brief The text of a string id (0 is the empty string).
+             */
+            std::string_view string(std::uint32_t id) const;
+
+            std::size_t stringCount() const { return stringOffsets.size() - 1; }
+
+            RecordView<binary::ClassEntry> classes() const { return classList; }
+            RecordView<binary::NodeRecord> nodes() const { return nodeList; }
+            RecordView<std::uint32_t> names() const { return nameList; }
+            RecordView<binary::ScopeEntry> scopes() const { return scopeList; }
+            RecordView<binary::SymbolEntry> symbols() const { return symbolList; }
+            RecordView<binary::RegistryClassEntry> registryClasses() const { return registryClassList; }
+            RecordView<binary::MethodEntry> methods() const { return methodList; }
+
+            /**
+             * @brief The direct children of a node, in order.
+             */
+            std::vector<std::uint32_t> children(std::uint32_t node) const;
+
+        private:
+            std::string_view section(binary::SectionKind kind, std::size_t recordSize, std::size_t& count) const;
+            void validate() const;
+
+            std::string_view bytes;
+            std::vector<binary::SectionEntry> directory;
+            RecordView<std::uint32_t> stringOffsets;
+            std::string_view stringBytes;
+            RecordView<binary::ClassEntry> classList;
+            RecordView<binary::NodeRecord> nodeList;
+            RecordView<std::uint32_t> nameList;
+            RecordView<binary::ScopeEntry> scopeList;
+            RecordView<binary::SymbolEntry> symbolList;
+            RecordView<binary::RegistryClassEntry> registryClassList;
+            RecordView<binary::MethodEntry> methodList;
+    };
+}
+
+#endif //NAND2TETRIS_BINARY_READER_H
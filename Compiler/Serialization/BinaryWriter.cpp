@@ -0,0 +1,294 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "BinaryWriter.h"
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include "../Common/FileIO.h"
+#include "../Parser/AST.h"
+#include "../SemanticAnalyser/GlobalRegistry.h"
+#include "../SemanticAnalyser/StandardLibrary.h"
+#include "../SemanticAnalyser/SymbolTable.h"
+
+namespace nand2tetris::jack {
+
+    namespace {
+        template <typename T>
+        void appendRecords(std::string& out, const std::vector<T>& records) {
+            out.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+        }
+
+        std::uint32_t checkedSize(const std::size_t size) {
+            if (size > UINT32_MAX) throw std::runtime_error("Program too large for the binary format");
+            return static_cast<std::uint32_t>(size);
+        }
+    }
+
+    std::uint32_t BinaryWriter::string(const std::string_view text) {
+        if (text.empty()) return 0;
+        const auto [it, added] = stringIds.try_emplace(std::string(text), checkedSize(stringOffsets.size() - 1));
+        if (added) {
+            stringBytes.append(text);
+            stringOffsets.push_back(checkedSize(stringBytes.size()));
+        }
+        return it->second;
+    }
+
+    std::uint32_t BinaryWriter::name(const NameId id) {
+        const auto it = nameIds.find(id);
+        if (it != nameIds.end()) return it->second;
+        const std::uint32_t result = string(nameOf(id));
+        nameIds.emplace(id, result);
+        return result;
+    }
+
+    std::uint32_t BinaryWriter::beginNode(const Node& node) {
+        binary::NodeRecord record{};
+        record.type = static_cast<std::uint8_t>(node.getType());
+        record.offset = node.getOffset();
+        record.bindingKind = static_cast<std::uint8_t>(SymbolKind::NONE);
+        record.bindingIndex = -1;
+        nodes.push_back(record);
+        return checkedSize(nodes.size() - 1);
+    }
+
+    void BinaryWriter::setBinding(const std::uint32_t node, const Binding& binding) {
+        nodes[node].bindingKind = static_cast<std::uint8_t>(binding.kind);
+        nodes[node].bindingIndex = binding.index;
+        nodes[node].bindingType = name(binding.type);
+    }
+
+    void BinaryWriter::endNode(const std::uint32_t node) {
+        nodes[node].end = checkedSize(nodes.size());
+    }
+
+    void BinaryWriter::addClass(const std::string_view filePath, const ClassNode& ast, const SymbolTable* table) {
+        binary::ClassEntry entry{};
+        entry.name = name(ast.className);
+        entry.file = string(filePath);
+        entry.firstNode = checkedSize(nodes.size());
+
+        const std::uint32_t root = beginNode(ast);
+        nodes[root].name = entry.name;
+        for (const ClassVarDecNode* var : ast.classVars) {
+            const std::uint32_t i = beginNode(*var);
+            nodes[i].tag = static_cast<std::uint8_t>(var->kind);
+            nodes[i].name2 = name(var->type);
+            nodes[i].firstName = checkedSize(names.size());
+            nodes[i].nameCount = checkedSize(var->varNames.size());
+            for (const NameId varName : var->varNames) names.push_back(name(varName));
+            endNode(i);
+        }
+        for (const SubroutineDecNode* sub : ast.subroutineDecs) writeSubroutine(*sub);
+        endNode(root);
+        entry.nodeEnd = checkedSize(nodes.size());
+
+        entry.firstScope = checkedSize(scopes.size());
+        if (table) {
+            const auto addScope = [&](const NameId scopeName, const std::vector<Symbol>& scopeSymbols) {
+                scopes.push_back({name(scopeName), checkedSize(symbols.size()), checkedSize(scopeSymbols.size())});
+                for (const Symbol& symbol : scopeSymbols) {
+                    symbols.push_back({name(symbol.name), name(symbol.type), static_cast<std::uint32_t>(symbol.kind),
+                                       symbol.index, symbol.declOffset});
+                }
+            };
+            addScope(ast.className, table->classSymbols());
+            for (const SubroutineSnapshot& snapshot : table->subroutineSnapshots()) {
+                addScope(snapshot.name, snapshot.symbols);
+            }
+        }
+        entry.scopeCount = checkedSize(scopes.size()) - entry.firstScope;
+        classes.push_back(entry);
+    }
+
+    void BinaryWriter::writeSubroutine(const SubroutineDecNode& sub) {
+        const std::uint32_t i = beginNode(sub);
+        nodes[i].tag = static_cast<std::uint8_t>(sub.subType);
+        nodes[i].name = name(sub.name);
+        nodes[i].name2 = name(sub.returnType);
+        nodes[i].value = static_cast<std::int32_t>(sub.localVars.size());
+        nodes[i].firstName = checkedSize(names.size());
+        nodes[i].nameCount = checkedSize(sub.parameters.size() * 2);
+        for (const Parameter& parameter : sub.parameters) {
+            names.push_back(name(parameter.type));
+            names.push_back(name(parameter.name));
+        }
+        for (const VarDecNode* var : sub.localVars) {
+            const std::uint32_t v = beginNode(*var);
+            nodes[v].name2 = name(var->type);
+            nodes[v].firstName = checkedSize(names.size());
+            nodes[v].nameCount = checkedSize(var->varNames.size());
+            for (const NameId varName : var->varNames) names.push_back(name(varName));
+            endNode(v);
+        }
+        for (const StatementNode* statement : sub.statements) writeNode(statement);
+        endNode(i);
+    }
+
+    void BinaryWriter::writeNode(const Node* node) {
+        const std::uint32_t i = beginNode(*node);
+        switch (node->getType()) {
+            case ASTNodeType::LET_STATEMENT: {
+                auto& n = static_cast<const LetStatementNode&>(*node); // NOLINT(*-pro-type-static-cast-downcast)
+                nodes[i].name = name(n.varName);
+                setBinding(i, n.target);
+                if (n.indexExpr) {
+                    nodes[i].flags = binary::HAS_INDEX;
+                    writeNode(n.indexExpr);
+                }
+                writeNode(n.valueExpr);
+                break;
+            }
+            case ASTNodeType::IF_STATEMENT: {
+                auto& n = static_cast<const IfStatementNode&>(*node); // NOLINT(*-pro-type-static-cast-downcast)
+                nodes[i].value = static_cast<std::int32_t>(n.ifStatements.size());
+                writeNode(n.condition);
+                for (const StatementNode* statement : n.ifStatements) writeNode(statement);
+                for (const StatementNode* statement : n.elseStatements) writeNode(statement);
+                break;
+            }
+            case ASTNodeType::WHILE_STATEMENT: {
+                auto& n = static_cast<const WhileStatementNode&>(*node); // NOLINT(*-pro-type-static-cast-downcast)
+                writeNode(n.condition);
+                for (const StatementNode* statement : n.body) writeNode(statement);
+                break;
+            }
+            case ASTNodeType::DO_STATEMENT:
+                writeNode(static_cast<const DoStatementNode&>(*node).callExpression); // NOLINT(*-pro-type-static-cast-downcast)
+                break;
+            case ASTNodeType::RETURN_STATEMENT: {
+                auto& n = static_cast<const ReturnStatementNode&>(*node); // NOLINT(*-pro-type-static-cast-downcast)
+                if (n.expression) {
+                    nodes[i].flags = binary::HAS_EXPRESSION;
+                    writeNode(n.expression);
+                }
+                break;
+            }
+            case ASTNodeType::INTEGER_LITERAL:
+                nodes[i].value = static_cast<const IntegerLiteralNode&>(*node).value; // NOLINT(*-pro-type-static-cast-downcast)
+                break;
+            case ASTNodeType::STRING_LITERAL:
+                nodes[i].name = string(static_cast<const StringLiteralNode&>(*node).value); // NOLINT(*-pro-type-static-cast-downcast)
+                break;
+            case ASTNodeType::KEYWORD_LITERAL:
+                nodes[i].tag = static_cast<std::uint8_t>(static_cast<const KeywordLiteralNode&>(*node).value); // NOLINT(*-pro-type-static-cast-downcast)
+                break;
+            case ASTNodeType::BINARY_OP: {
+                auto& n = static_cast<const BinaryOpNode&>(*node); // NOLINT(*-pro-type-static-cast-downcast)
+                nodes[i].tag = static_cast<std::uint8_t>(n.op);
+                writeNode(n.left);
+                writeNode(n.right);
+                break;
+            }
+            case ASTNodeType::UNARY_OP: {
+                auto& n = static_cast<const UnaryOpNode&>(*node); // NOLINT(*-pro-type-static-cast-downcast)
+                nodes[i].tag = static_cast<std::uint8_t>(n.op);
+                writeNode(n.term);
+                break;
+            }
+            case ASTNodeType::SUBROUTINE_CALL: {
+                auto& n = static_cast<const CallNode&>(*node); // NOLINT(*-pro-type-static-cast-downcast)
+                nodes[i].name = name(n.classNameOrVar);
+                nodes[i].name2 = name(n.functionName);
+                setBinding(i, n.receiver);
+                for (const ExpressionNode* argument : n.arguments) writeNode(argument);
+                break;
+            }
+            case ASTNodeType::IDENTIFIER: {
+                auto& n = static_cast<const IdentifierNode&>(*node); // NOLINT(*-pro-type-static-cast-downcast)
+                nodes[i].name = name(n.name);
+                setBinding(i, n.binding);
+                if (n.indexExpr) {
+                    nodes[i].flags = binary::HAS_INDEX;
+                    writeNode(n.indexExpr);
+                }
+                break;
+            }
+            default:
+                throw std::logic_error("Unexpected node in a subroutine body");
+        }
+        endNode(i);
+    }
+
+    void BinaryWriter::addRegistry(const GlobalRegistry& registry) {
+        const auto addMethod = [&](const NameId methodName, const MethodSignature& signature) {
+            methods.push_back({name(methodName), name(signature.returnType), signature.isStatic ? 1u : 0u,
+                               signature.offset, checkedSize(names.size()), checkedSize(signature.parameters.size())});
+            for (const NameId parameter : signature.parameters) names.push_back(name(parameter));
+        };
+
+        // The OS classes first (unless replaced), then every class from the program, as in dumpToJSON().
+        for (std::size_t i = 0; i < STANDARD_LIBRARY.size();) {
+            const NameId className = STANDARD_LIBRARY[i].className;
+            const binary::RegistryClassEntry entry{name(className), 0, checkedSize(methods.size()), 0};
+            for (; i < STANDARD_LIBRARY.size() && STANDARD_LIBRARY[i].className == className; ++i) {
+                if (!registry.isDeclared(className)) addMethod(STANDARD_LIBRARY[i].name, STANDARD_LIBRARY[i].signature);
+            }
+            if (registry.isDeclared(className)) continue;
+            registryClasses.push_back(entry);
+            registryClasses.back().methodCount = checkedSize(methods.size()) - entry.firstMethod;
+        }
+        for (const NameId className : registry.declaredClasses()) {
+            const std::uint32_t flags = binary::CLASS_DECLARED | (registry.isOsSource(className) ? binary::CLASS_OS_SOURCE : 0);
+            const binary::RegistryClassEntry entry{name(className), flags, checkedSize(methods.size()), 0};
+            for (const auto& [methodName, signature] : registry.methodsOf(className)) addMethod(methodName, *signature);
+            registryClasses.push_back(entry);
+            registryClasses.back().methodCount = checkedSize(methods.size()) - entry.firstMethod;
+        }
+    }
+
+    std::string BinaryWriter::finish() const {
+        struct Section {
+            binary::SectionKind kind;
+            std::size_t count;
+            std::string_view bytes;
+        };
+        const auto bytesOf = [](const auto& records) {
+            using Record = typename std::decay_t<decltype(records)>::value_type;
+            return std::string_view(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+        };
+        const Section sections[] = {
+            {binary::SectionKind::STRING_OFFSETS, stringOffsets.size() - 1, bytesOf(stringOffsets)},
+            {binary::SectionKind::STRING_BYTES, stringBytes.size(), stringBytes},
+            {binary::SectionKind::CLASSES, classes.size(), bytesOf(classes)},
+            {binary::SectionKind::NODES, nodes.size(), bytesOf(nodes)},
+            {binary::SectionKind::NAMES, names.size(), bytesOf(names)},
+            {binary::SectionKind::SCOPES, scopes.size(), bytesOf(scopes)},
+            {binary::SectionKind::SYMBOLS, symbols.size(), bytesOf(symbols)},
+            {binary::SectionKind::REGISTRY_CLASSES, registryClasses.size(), bytesOf(registryClasses)},
+            {binary::SectionKind::REGISTRY_METHODS, methods.size(), bytesOf(methods)},
+        };
+        constexpr std::size_t SECTION_COUNT = std::size(sections);
+
+        binary::FileHeader header{};
+        std::memcpy(header.magic, binary::MAGIC, sizeof(header.magic));
+        header.version = binary::FORMAT_VERSION;
+        header.byteOrder = binary::BYTE_ORDER_MARK;
+        header.sectionCount = SECTION_COUNT;
+
+        std::vector<binary::SectionEntry> directory;
+        std::size_t offset = sizeof(binary::FileHeader) + SECTION_COUNT * sizeof(binary::SectionEntry);
+        for (const Section& section : sections) {
+            directory.push_back({section.kind, checkedSize(offset), checkedSize(section.bytes.size()),
+                                 checkedSize(section.count)});
+            offset = (offset + section.bytes.size() + 3) & ~std::size_t{3};
+        }
+
+        std::string out;
+        out.reserve(offset);
+        out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        appendRecords(out, directory);
+        for (const Section& section : sections) {
+            out.append(section.bytes);
+            out.resize((out.size() + 3) & ~std::size_t{3}, '\0');
+        }
+        return out;
+    }
+
+    void BinaryWriter::save(const std::filesystem::path& path) const {
+        writeFileAtomically(path, finish());
+    }
+}
@@ -0,0 +1,82 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_BINARY_WRITER_H
+#define NAND2TETRIS_BINARY_WRITER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "BinaryFormat.h"
+#include "../Common/Interner.h"
+
+namespace nand2tetris::jack {
+
+    class Node;
+    class ClassNode;
+    class SubroutineDecNode;
+    class GlobalRegistry;
+    class SymbolTable;
+    struct Binding;
+
+    /**
+     * @brief Writes the ASTs, symbol tables and registry of a program in the binary format of BinaryFormat.h.
+     *
+     * Compared with printXml() and the dumpToJSON() functions, every node is one fixed-size record and every
+     * name is stored once, in a string table shared by all classes. Add the classes and the registry, then
+     * finish() or save(). Not thread-safe; the writer only reads what it is given.
+     */
+    class BinaryWriter {
+        public:
+            /**
+             * @brief Adds a class: its AST and, if it was kept, its symbol table (see SymbolTable's keepHistory).
+             */
+            void addClass(std::string_view filePath, const ClassNode& ast, const SymbolTable* symbols);
+
+            /**
+             * @brief Adds the frozen registry: every class the program can call, with its signatures.
+             */
+            void addRegistry(const GlobalRegistry& registry);
+
+            /**
+             * @brief The file contents.
+             */
+            std::string finish() const;
+
+            /**
+             * @brief Writes the file.
+             *
+             * @throws std::runtime_error If it cannot be written.
+             */
+            void save(const std::filesystem::path& path) const;
+
+        private:
+            std::uint32_t string(std::string_view text);
+            std::uint32_t name(NameId id);
+
+            std::uint32_t beginNode(const Node& node);
+            void setBinding(std::uint32_t node, const Binding& binding);
+            void endNode(std::uint32_t node);
+            void writeSubroutine(const SubroutineDecNode& sub);
+            void writeNode(const Node* node);
+
+            std::vector<std::uint32_t> stringOffsets{0, 0}; ///< Id 0 is the empty string.
+            std::string stringBytes;
+            std::unordered_map<std::string, std::uint32_t> stringIds;
+            std::unordered_map<NameId, std::uint32_t> nameIds;
+
+            std::vector<binary::ClassEntry> classes;
+            std::vector<binary::NodeRecord> nodes;
+            std::vector<std::uint32_t> names;
+            std::vector<binary::ScopeEntry> scopes;
+            std::vector<binary::SymbolEntry> symbols;
+            std::vector<binary::RegistryClassEntry> registryClasses;
+            std::vector<binary::MethodEntry> methods;
+    };
+}
+
+#endif //NAND2TETRIS_BINARY_WRITER_H
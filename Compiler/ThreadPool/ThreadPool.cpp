@@ -0,0 +1,155 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "ThreadPool.h"
+
+namespace nand2tetris::jack {
+
+    namespace {
+        // Identifies the pool (and queue) the current thread works for, so nested submissions
+        // land on the submitting worker's own queue.
+        thread_local const ThreadPool* currentPool = nullptr;
+        thread_local std::size_t currentIndex = 0;
+    }
+
+    std::size_t ThreadPool::resolveWorkerCount(const std::size_t requested) {
+        if (requested > 0) return requested;
+        const unsigned hw = std::thread::hardware_concurrency();
+        return hw == 0 ? 1 : hw;
+    }
+
+    ThreadPool::ThreadPool(const std::size_t workerCount) {
+        const std::size_t count = resolveWorkerCount(workerCount);
+
+        queues.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        workers.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::scoped_lock lock(sleepMtx);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::enqueue(Task task) {
+        // Workers keep their own children local; everybody else is spread round-robin.
+        const std::size_t index = (currentPool == this)
+            ? currentIndex
+            : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+
+        {
+            std::scoped_lock lock(queues[index]->mtx);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+
+        // Publish under the sleep mutex so a worker that just found the queues empty cannot miss it.
+        {
+            std::scoped_lock lock(sleepMtx);
+            pending.fetch_add(1, std::memory_order_release);
+        }
+        wakeUp.notify_one();
+    }
+
+    bool ThreadPool::tryPopLocal(const std::size_t index, Task &out) {
+        WorkerQueue& q = *queues[index];
+        std::scoped_lock lock(q.mtx);
+        if (q.tasks.empty()) return false;
+        out = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool ThreadPool::trySteal(const std::size_t thief, Task &out) {
+        const std::size_t n = queues.size();
+        for (std::size_t offset = 1; offset < n; ++offset) {
+            WorkerQueue& victim = *queues[(thief + offset) % n];
+            std::scoped_lock lock(victim.mtx);
+            if (victim.tasks.empty()) continue;
+            // Steal the oldest task: it is the one the owner is least likely to touch next.
+            out = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void ThreadPool::workerLoop(const std::size_t index) {
+        currentPool = this;
+        currentIndex = index;
+        WorkerQueue& self = *queues[index];
+
+        while (true) {
+            Task task;
+            bool stolen = false;
+            if (!tryPopLocal(index, task)) {
+                stolen = trySteal(index, task);
+            }
+
+            if (!task) {
+                std::unique_lock lock(sleepMtx);
+                wakeUp.wait(lock, [this] { return stopping || pending.load(std::memory_order_acquire) > 0; });
+                if (stopping && pending.load(std::memory_order_acquire) == 0) return;
+                continue;
+            }
+
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+            if (stolen) self.steals.fetch_add(1, std::memory_order_relaxed);
+
+            const auto begin = std::chrono::steady_clock::now();
+            task(); // packaged_task captures exceptions into the future
+            const auto end = std::chrono::steady_clock::now();
+
+            self.busyNanos.fetch_add(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()), std::memory_order_relaxed);
+            self.tasksRun.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool ThreadPool::runQueuedTask() {
+        const bool isWorker = currentPool == this;
+        const std::size_t index = isWorker ? currentIndex : 0;
+
+        Task task;
+        bool stolen = false;
+        if (!isWorker || !tryPopLocal(index, task)) {
+            // Outside the pool every queue is somebody else's, including queue 0.
+            stolen = (!isWorker && tryPopLocal(index, task)) || trySteal(index, task);
+        }
+        if (!task) return false;
+
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+        task();
+
+        // The time is already counted by the task that is waiting, so only the task itself is recorded.
+        if (isWorker) {
+            WorkerQueue& self = *queues[index];
+            if (stolen) self.steals.fetch_add(1, std::memory_order_relaxed);
+            self.tasksRun.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    std::vector<WorkerStats> ThreadPool::stats() const {
+        std::vector<WorkerStats> result;
+        result.reserve(queues.size());
+        for (const auto& q : queues) {
+            result.push_back({q->busyNanos.load(std::memory_order_relaxed),
+                              q->tasksRun.load(std::memory_order_relaxed),
+                              q->steals.load(std::memory_order_relaxed)});
+        }
+        return result;
+    }
+}
@@ -0,0 +1,134 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_THREAD_POOL_H
+#define NAND2TETRIS_THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief Per-worker counters collected by the ThreadPool.
+     */
+    struct WorkerStats {
+        std::uint64_t busyNanos = 0; ///< Total time spent executing tasks.
+        std::uint64_t tasksRun = 0;  ///< Number of tasks executed by this worker.
+        std::uint64_t steals = 0;    ///< Number of tasks taken from another worker's queue.
+    };
+
+    /**
+     * @brief A fixed-size work-stealing thread pool.
+     *
+     * Each worker owns a double-ended queue. Tasks submitted from inside a worker go to the back of
+     * that worker's own queue and are popped LIFO (good cache locality for nested work). Tasks submitted
+     * from outside the pool are distributed round-robin. An idle worker steals from the front of the
+     * other queues before going to sleep.
+     */
+    class ThreadPool {
+        public:
+            /**
+             * @brief Starts the worker threads.
+             *
+             * @param workerCount Number of workers. 0 selects std::thread::hardware_concurrency().
+             */
+            explicit ThreadPool(std::size_t workerCount = 0);
+
+            /**
+             * @brief Drains all outstanding tasks and joins the workers.
+             */
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            /**
+             * @brief Schedules a callable on the pool.
+             *
+             * @param fn The callable to run.
+             * @return A future holding the result (or the exception thrown by the callable).
+             */
+            template <typename F>
+            auto submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+                using R = std::invoke_result_t<std::decay_t<F>>;
+                auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+                std::future<R> result = task->get_future();
+                enqueue([task] { (*task)(); });
+                return result;
+            }
+
+            /**
+             * @brief Blocks until a future is ready, running queued tasks in the meantime.
+             *
+             * A task that splits itself into subtasks can wait for them here without tying up its
+             * worker: the subtasks sit at the back of its own queue, so it usually ends up running
+             * them itself while the other workers steal from the front.
+             *
+             * @param result The future to wait for.
+             */
+            template <typename R>
+            void waitFor(const std::future<R>& result) {
+                while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                    if (!runQueuedTask()) result.wait_for(std::chrono::microseconds(50));
+                }
+            }
+
+            /**
+             * @brief Returns the number of worker threads.
+             */
+            std::size_t size() const { return workers.size(); }
+
+            /**
+             * @brief Returns a snapshot of the per-worker counters.
+             */
+            std::vector<WorkerStats> stats() const;
+
+            /**
+             * @brief Resolves a user supplied job count (0 = hardware concurrency, never less than 1).
+             */
+            static std::size_t resolveWorkerCount(std::size_t requested);
+
+        private:
+            using Task = std::function<void()>;
+
+            /**
+             * @brief A worker's task queue. Aligned to avoid false sharing between neighbours.
+             */
+            struct alignas(64) WorkerQueue {
+                std::mutex mtx;
+                std::deque<Task> tasks;
+                std::atomic<std::uint64_t> busyNanos{0};
+                std::atomic<std::uint64_t> tasksRun{0};
+                std::atomic<std::uint64_t> steals{0};
+            };
+
+            std::vector<std::unique_ptr<WorkerQueue>> queues;
+            std::vector<std::thread> workers;
+
+            std::mutex sleepMtx;                 ///< Guards the sleep/wake handshake.
+            std::condition_variable wakeUp;      ///< Signalled when work arrives or on shutdown.
+            std::atomic<std::size_t> pending{0}; ///< Tasks queued but not yet picked up.
+            std::atomic<std::size_t> nextQueue{0}; ///< Round-robin cursor for external submissions.
+            bool stopping = false;
+
+            void enqueue(Task task);
+            bool tryPopLocal(std::size_t index, Task& out);
+            bool trySteal(std::size_t thief, Task& out);
+            void workerLoop(std::size_t index);
+            bool runQueuedTask();
+    };
+}
+
+#endif //NAND2TETRIS_THREAD_POOL_H
@@ -0,0 +1,131 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "CharScan.h"
+#include <cstring>
+
+// Both instruction sets are part of the baseline of their 64-bit targets, so no runtime dispatch is
+// needed. Configure with -DJACK_LEXER_SIMD=OFF to build (and check) the scalar paths alone.
+#if !defined(JACK_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define JACK_SCAN_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif !defined(JACK_NO_SIMD) && defined(__ARM_NEON)
+#define JACK_SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace nand2tetris::jack {
+
+    namespace {
+        constexpr std::ptrdiff_t BLOCK = 16;
+
+#if defined(JACK_SCAN_SSE2)
+        int firstSetBit(const unsigned mask) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<int>(index);
+#else
+            return __builtin_ctz(mask);
+#endif
+        }
+
+        // One bit per byte of the block: set where the byte is whitespace (' ' or '\t'..'\r').
+        unsigned spaceMask(const __m128i bytes) {
+            const __m128i space = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+            const __m128i fromTab = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+            const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(fromTab, _mm_set1_epi8(4)), fromTab);
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(space, control)));
+        }
+
+        unsigned stringEndMask(const __m128i bytes) {
+            const __m128i quote = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('"'));
+            const __m128i lf = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'));
+            const __m128i cr = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r'));
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(quote, _mm_or_si128(lf, cr))));
+        }
+#elif defined(JACK_SCAN_NEON)
+        // NEON has no movemask; narrowing the 0x00/0xFF bytes into nibbles gives 4 bits per byte instead.
+        std::uint64_t nibbleMask(const uint8x16_t matches) {
+            return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+        }
+
+        int firstSetNibble(const std::uint64_t mask) {
+            return __builtin_ctzll(mask) / 4;
+        }
+
+        uint8x16_t spaceMatches(const uint8x16_t bytes) {
+            const uint8x16_t space = vceqq_u8(bytes, vdupq_n_u8(' '));
+            const uint8x16_t control = vcleq_u8(vsubq_u8(bytes, vdupq_n_u8('\t')), vdupq_n_u8(4));
+            return vorrq_u8(space, control);
+        }
+
+        uint8x16_t stringEndMatches(const uint8x16_t bytes) {
+            const uint8x16_t quote = vceqq_u8(bytes, vdupq_n_u8('"'));
+            const uint8x16_t lf = vceqq_u8(bytes, vdupq_n_u8('\n'));
+            const uint8x16_t cr = vceqq_u8(bytes, vdupq_n_u8('\r'));
+            return vorrq_u8(quote, vorrq_u8(lf, cr));
+        }
+#endif
+    }
+
+    const char* skipSpaces(const char* p, const char* end) {
+        // Most gaps between tokens are one space; settle those before touching a vector register.
+        if (p == end || !hasCharClass(*p, CHAR_SPACE)) return p;
+        ++p;
+#if defined(JACK_SCAN_SSE2)
+        while (end - p >= BLOCK) {
+            const unsigned other = ~spaceMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) & 0xFFFFu;
+            if (other) return p + firstSetBit(other);
+            p += BLOCK;
+        }
+#elif defined(JACK_SCAN_NEON)
+        while (end - p >= BLOCK) {
+            const std::uint64_t other = ~nibbleMask(spaceMatches(vld1q_u8(reinterpret_cast<const std::uint8_t*>(p))));
+            if (other) return p + firstSetNibble(other);
+            p += BLOCK;
+        }
+#endif
+        while (p < end && hasCharClass(*p, CHAR_SPACE)) ++p;
+        return p;
+    }
+
+    const char* findStringEnd(const char* p, const char* end) {
+#if defined(JACK_SCAN_SSE2)
+        while (end - p >= BLOCK) {
+            const unsigned found = stringEndMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            if (found) return p + firstSetBit(found);
+            p += BLOCK;
+        }
+#elif defined(JACK_SCAN_NEON)
+        while (end - p >= BLOCK) {
+            const std::uint64_t found = nibbleMask(stringEndMatches(vld1q_u8(reinterpret_cast<const std::uint8_t*>(p))));
+            if (found) return p + firstSetNibble(found);
+            p += BLOCK;
+        }
+#endif
+        while (p < end && *p != '"' && *p != '\n' && *p != '\r') ++p;
+        return p;
+    }
+
+    // memchr is already vectorised by every C library we ship on, so the single-byte searches use it.
+    const char* findBlockCommentEnd(const char* p, const char* end) {
+        while (p < end) {
+            const void* star = std::memchr(p, '*', static_cast<std::size_t>(end - p));
+            if (!star) return end;
+            p = static_cast<const char*>(star);
+            if (p + 1 < end && p[1] == '/') return p;
+            ++p;
+        }
+        return end;
+    }
+
+    const char* findLineEnd(const char* p, const char* end) {
+        const void* lf = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+        return lf ? static_cast<const char*>(lf) : end;
+    }
+}
@@ -0,0 +1,74 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_CHAR_SCAN_H
+#define NAND2TETRIS_CHAR_SCAN_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief Character classes of the lexer, as bit flags (a character can have several).
+     */
+    enum CharClass : std::uint8_t {
+        CHAR_SPACE       = 1 << 0, ///< What std::isspace accepts in the "C" locale.
+        CHAR_DIGIT       = 1 << 1, ///< 0-9.
+        CHAR_IDENT_START = 1 << 2, ///< A letter or '_'.
+        CHAR_IDENT       = 1 << 3, ///< A letter, digit or '_'.
+        CHAR_SYMBOL      = 1 << 4  ///< One of Jack's single-character symbols.
+    };
+
+    /**
+     * @brief The class of every byte value, built at compile time.
+     *
+     * Replaces the <cctype> calls (which consult the locale on every character) in the tokenizer's
+     * loops. Bytes from 0x80 up have no class, as with isspace/isalpha in the "C" locale.
+     */
+    inline constexpr std::array<std::uint8_t, 256> CHAR_CLASSES = [] {
+        std::array<std::uint8_t, 256> table{};
+        for (const char c : std::string_view(" \t\n\v\f\r")) table[static_cast<unsigned char>(c)] |= CHAR_SPACE;
+        for (int c = '0'; c <= '9'; ++c) table[c] |= CHAR_DIGIT | CHAR_IDENT;
+        for (int c = 'a'; c <= 'z'; ++c) table[c] |= CHAR_IDENT_START | CHAR_IDENT;
+        for (int c = 'A'; c <= 'Z'; ++c) table[c] |= CHAR_IDENT_START | CHAR_IDENT;
+        table['_'] |= CHAR_IDENT_START | CHAR_IDENT;
+        for (const char c : std::string_view("{}()[].,;+-*/&|<>=~")) table[static_cast<unsigned char>(c)] |= CHAR_SYMBOL;
+        return table;
+    }();
+
+    /**
+     * @brief True if the character has any of the given classes.
+     */
+    constexpr bool hasCharClass(const char c, const std::uint8_t classes) {
+        return (CHAR_CLASSES[static_cast<unsigned char>(c)] & classes) != 0;
+    }
+
+    /**
+     * @brief Returns the first character in [p, end) that is not whitespace, or end.
+     *
+     * Checks 16 bytes at a time with SSE2 or NEON where available (indentation runs are long in
+     * generated code), one at a time otherwise.
+     */
+    const char* skipSpaces(const char* p, const char* end);
+
+    /**
+     * @brief Returns the first '"', '\n' or '\r' in [p, end), or end: where a string constant ends,
+     *        properly or not.
+     */
+    const char* findStringEnd(const char* p, const char* end);
+
+    /**
+     * @brief Returns the '*' of the first "*" "/" pair in [p, end), or end if the comment is not closed.
+     */
+    const char* findBlockCommentEnd(const char* p, const char* end);
+
+    /**
+     * @brief Returns the first '\n' in [p, end), or end.
+     */
+    const char* findLineEnd(const char* p, const char* end);
+}
+
+#endif //NAND2TETRIS_CHAR_SCAN_H
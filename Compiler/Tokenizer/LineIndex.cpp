@@ -0,0 +1,32 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "LineIndex.h"
+#include <algorithm>
+#include <cstring>
+
+namespace nand2tetris::jack {
+
+    SourcePosition LineIndex::position(std::uint32_t offset) const {
+        std::call_once(built, [this] {
+            lineStarts.push_back(0);
+            const char* begin = text.data();
+            const char* end = begin + text.size();
+            for (const char* at = begin; at < end; ++at) {
+                at = static_cast<const char*>(std::memchr(at, '\n', static_cast<std::size_t>(end - at)));
+                if (!at) break;
+                lineStarts.push_back(static_cast<std::uint32_t>(at - begin) + 1);
+            }
+        });
+
+        offset = std::min(offset, static_cast<std::uint32_t>(text.size()));
+        // The last line starting at or before the offset.
+        const auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset) - 1;
+        const std::string_view prefix = text.substr(*it, offset - *it);
+        SourcePosition pos;
+        pos.line = static_cast<std::uint32_t>(it - lineStarts.begin()) + 1;
+        pos.column = static_cast<std::uint32_t>(prefix.size() - std::count(prefix.begin(), prefix.end(), '\r')) + 1;
+        return pos;
+    }
+}
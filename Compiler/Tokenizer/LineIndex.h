@@ -0,0 +1,56 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_LINE_INDEX_H
+#define NAND2TETRIS_LINE_INDEX_H
+
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief A line and column in a source file, both starting at 1.
+     */
+    struct SourcePosition {
+        std::uint32_t line = 1;
+        std::uint32_t column = 1;
+    };
+
+    /**
+     * @brief Turns byte offsets of a source file into lines and columns.
+     *
+     * Tokens and AST nodes only record offsets; a line and column are needed for nothing but error
+     * messages, so the table of line starts is built the first time a position is asked for and the
+     * tokenizer's hot loop never counts lines at all. Lines end at '\n'; a '\r' takes up no column.
+     *
+     * Safe to use from several threads at once (the subroutine tasks of one file share an index).
+     */
+    class LineIndex {
+        public:
+            /**
+             * @param text The source text, which must outlive the index.
+             */
+            explicit LineIndex(std::string_view text) : text(text) {}
+
+            LineIndex(const LineIndex&) = delete;
+            LineIndex& operator=(const LineIndex&) = delete;
+
+            /**
+             * @brief Returns the line and column of a byte offset.
+             *
+             * @param offset An offset into the text; offsets past the end map to the end.
+             */
+            SourcePosition position(std::uint32_t offset) const;
+
+        private:
+            std::string_view text;
+            mutable std::once_flag built;
+            mutable std::vector<std::uint32_t> lineStarts; ///< Offset of the first character of each line.
+    };
+}
+
+#endif //NAND2TETRIS_LINE_INDEX_H
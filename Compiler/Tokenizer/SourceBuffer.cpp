@@ -0,0 +1,238 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "SourceBuffer.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace nand2tetris::jack {
+
+	namespace {
+		constexpr std::size_t READ_CHUNK = 64 * 1024;
+
+		std::atomic<bool> mappingEnabled{true}; // See SourceBuffer::setMappingEnabled.
+
+#ifdef _WIN32
+		// Bulk-reads a stdio stream to EOF. Used for stdin and whenever a file cannot be mapped.
+		std::string readStream(std::FILE* stream, const std::string& name) {
+			std::string text;
+			std::size_t used = 0;
+			while (true) {
+				text.resize(used + READ_CHUNK);
+				const std::size_t n = std::fread(&text[used], 1, READ_CHUNK, stream);
+				used += n;
+				if (n < READ_CHUNK) break;
+			}
+			if (std::ferror(stream)) {
+				throw std::runtime_error("Cannot read Jack file: " + name);
+			}
+			text.resize(used);
+			return text;
+		}
+#else
+		// Closes a descriptor however the function that opened it is left.
+		class FileDescriptor {
+			public:
+				explicit FileDescriptor(const int fd) : fd(fd) {}
+				~FileDescriptor() { if (fd >= 0) ::close(fd); }
+				FileDescriptor(const FileDescriptor&) = delete;
+				FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+				int get() const { return fd; }
+
+			private:
+				int fd;
+		};
+#endif
+	}
+
+	SourceBuffer::~SourceBuffer() {
+		release();
+	}
+
+	SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept {
+		*this = std::move(other);
+	}
+
+	SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+		if (this == &other) return *this;
+		release();
+
+		mapped = other.mapped;
+		size = other.size;
+#ifdef _WIN32
+		mappingHandle = other.mappingHandle;
+		other.mappingHandle = nullptr;
+#endif
+		if (mapped) {
+			data = other.data;
+		} else {
+			// Moving a short std::string copies its inline storage, so re-point at our copy.
+			owned = std::move(other.owned);
+			data = owned.data();
+		}
+
+		other.data = "";
+		other.size = 0;
+		other.mapped = false;
+		other.owned.clear();
+		return *this;
+	}
+
+	void SourceBuffer::release() {
+		if (mapped) {
+#ifdef _WIN32
+			UnmapViewOfFile(data);
+			if (mappingHandle) CloseHandle(mappingHandle);
+			mappingHandle = nullptr;
+#else
+			munmap(const_cast<char*>(data), size);
+#endif
+		}
+		mapped = false;
+		data = "";
+		size = 0;
+		owned.clear();
+	}
+
+	void SourceBuffer::adoptOwned(std::string text) {
+		owned = std::move(text);
+		data = owned.data();
+		size = owned.size();
+		mapped = false;
+	}
+
+	SourceBuffer SourceBuffer::fromString(std::string text) {
+		SourceBuffer buffer;
+		buffer.adoptOwned(std::move(text));
+		return buffer;
+	}
+
+	void SourceBuffer::setMappingEnabled(const bool enabled) {
+		mappingEnabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	SourceBuffer SourceBuffer::fromStdin() {
+#ifdef _WIN32
+		SourceBuffer buffer;
+		buffer.adoptOwned(readStream(stdin, "<stdin>"));
+		return buffer;
+#else
+		return fromDescriptor(STDIN_FILENO, "<stdin>");
+#endif
+	}
+
+#ifdef _WIN32
+	SourceBuffer SourceBuffer::fromFile(const std::string& filePath) {
+		SourceBuffer buffer;
+
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+								  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("Cannot open Jack file: " + filePath);
+		}
+
+		LARGE_INTEGER fileSize{};
+		if (!mappingEnabled.load(std::memory_order_relaxed)) {
+			// Read in bulk below.
+		} else if (GetFileType(file) == FILE_TYPE_DISK && GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping) {
+				const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				if (view) {
+					buffer.data = static_cast<const char*>(view);
+					buffer.size = static_cast<std::size_t>(fileSize.QuadPart);
+					buffer.mapped = true;
+					buffer.mappingHandle = mapping;
+					CloseHandle(file);
+					return buffer;
+				}
+				CloseHandle(mapping);
+			}
+		} else if (GetFileType(file) == FILE_TYPE_DISK) {
+			CloseHandle(file);
+			return buffer; // Empty file: nothing to map.
+		}
+		CloseHandle(file);
+
+		// Pipes, consoles, mapping turned off, or a failed mapping: bulk read instead.
+		const std::unique_ptr<std::FILE, int (*)(std::FILE*)> stream(std::fopen(filePath.c_str(), "rb"), &std::fclose);
+		if (!stream) {
+			throw std::runtime_error("Cannot open Jack file: " + filePath);
+		}
+		buffer.adoptOwned(readStream(stream.get(), filePath));
+		return buffer;
+	}
+#else
+	SourceBuffer SourceBuffer::fromFile(const std::string& filePath) {
+		int opened;
+		do {
+			opened = ::open(filePath.c_str(), O_RDONLY);
+		} while (opened < 0 && errno == EINTR);
+		const FileDescriptor fd(opened);
+		if (fd.get() < 0) {
+			throw std::runtime_error("Cannot open Jack file: " + filePath);
+		}
+
+		struct stat st{};
+		if (mappingEnabled.load(std::memory_order_relaxed) && ::fstat(fd.get(), &st) == 0 && S_ISREG(st.st_mode)) {
+			SourceBuffer buffer;
+			if (st.st_size == 0) {
+				return buffer; // mmap rejects zero-length mappings.
+			}
+
+			const auto length = static_cast<std::size_t>(st.st_size);
+			void* view = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+			if (view != MAP_FAILED) {
+				// The tokenizer walks the file front to back exactly once.
+				// The mapping keeps its own reference to the file, so closing the descriptor does not end it.
+				::madvise(view, length, MADV_SEQUENTIAL);
+				buffer.data = static_cast<const char*>(view);
+				buffer.size = length;
+				buffer.mapped = true;
+				return buffer;
+			}
+		}
+
+		// Pipes, FIFOs, devices, mapping turned off, or a failed mapping: bulk read instead.
+		return fromDescriptor(fd.get(), filePath);
+	}
+
+	SourceBuffer SourceBuffer::fromDescriptor(const int fd, const std::string& name) {
+		std::string text;
+		std::size_t used = 0;
+		while (true) {
+			text.resize(used + READ_CHUNK);
+			const ssize_t n = ::read(fd, &text[used], READ_CHUNK);
+			if (n < 0 && errno == EINTR) continue;
+			if (n < 0) {
+				throw std::runtime_error("Cannot read Jack file: " + name);
+			}
+			if (n == 0) break;
+			used += static_cast<std::size_t>(n);
+		}
+		text.resize(used);
+
+		SourceBuffer buffer;
+		buffer.adoptOwned(std::move(text));
+		return buffer;
+	}
+#endif
+}
@@ -0,0 +1,87 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_SOURCE_BUFFER_H
+#define NAND2TETRIS_SOURCE_BUFFER_H
+
+#include <string>
+#include <string_view>
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief Read-only, immutable storage for the text of one source file.
+     *
+     * Regular files are memory-mapped (mmap on POSIX, MapViewOfFile on Windows), so loading costs no
+     * copy and the pages are shared with the OS page cache. Anything that cannot be mapped (pipes,
+     * character devices, stdin, or a failed mapping) is read in bulk into an owned heap buffer instead.
+     * Either way, view() stays valid and unchanged for the lifetime of the buffer, which is what lets
+     * every token be a std::string_view into it.
+     */
+    class SourceBuffer {
+        public:
+            SourceBuffer() = default;
+            ~SourceBuffer();
+
+            SourceBuffer(const SourceBuffer&) = delete;
+            SourceBuffer& operator=(const SourceBuffer&) = delete;
+            SourceBuffer(SourceBuffer&& other) noexcept;
+            SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+
+            /**
+             * @brief Loads a file, mapping it when possible and enabled.
+             *
+             * @param filePath Path to the file.
+             * @return The loaded buffer.
+             * @throws std::runtime_error if the file cannot be opened or read.
+             */
+            static SourceBuffer fromFile(const std::string& filePath);
+
+            /**
+             * @brief Turns mapping off (or back on) for every later fromFile(); it is on by default.
+             *
+             * A mapping shares the file's pages, so a file truncated while it is being tokenized faults
+             * (SIGBUS) instead of reading short. A compiler that reads sources while they are being edited
+             * (--daemon) turns it off and reads every file into the heap instead.
+             */
+            static void setMappingEnabled(bool enabled);
+
+            /**
+             * @brief Reads all of standard input into an owned buffer.
+             */
+            static SourceBuffer fromStdin();
+
+            /**
+             * @brief Wraps text that already lives in memory (the buffer keeps its own copy).
+             */
+            static SourceBuffer fromString(std::string text);
+
+            /**
+             * @brief Returns the full source text.
+             */
+            std::string_view view() const { return {data, size}; }
+
+            /**
+             * @brief True if the text is backed by a memory mapping rather than the heap.
+             */
+            bool isMapped() const { return mapped; }
+
+        private:
+            const char* data = "";  ///< Start of the text (mapping or owned).
+            std::size_t size = 0;   ///< Length of the text in bytes.
+            bool mapped = false;    ///< True if `data` points into a mapping that must be released.
+            std::string owned;      ///< Backing store for unmapped text.
+#ifdef _WIN32
+            void* mappingHandle = nullptr; ///< Windows file-mapping object.
+#endif
+
+#ifndef _WIN32
+            static SourceBuffer fromDescriptor(int fd, const std::string& name);
+#endif
+            void release();
+            void adoptOwned(std::string text);
+    };
+}
+
+#endif //NAND2TETRIS_SOURCE_BUFFER_H
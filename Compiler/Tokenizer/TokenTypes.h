@@ -5,15 +5,20 @@
 #ifndef NAND2TETRIS_TOKEN_H
 #define NAND2TETRIS_TOKEN_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
+#include "../Common/Interner.h"
 
 namespace nand2tetris::jack {
 
     /**
      * @brief Represents the different types of tokens in the Jack language.
      */
-    enum class TokenType {
+    enum class TokenType : std::uint8_t {
         KEYWORD,        ///< A reserved keyword (e.g., class, method, int).
         SYMBOL,         ///< A symbol or operator (e.g., {, }, +, =).
         IDENTIFIER,     ///< A user-defined identifier (variable name, class name, etc.).
@@ -25,7 +30,7 @@ namespace nand2tetris::jack {
     /**
      * @brief Represents the specific keywords in the Jack language.
      */
-    enum class Keyword {
+    enum class Keyword : std::uint8_t {
         CLASS, METHOD, FUNCTION, CONSTRUCTOR,
         INT, BOOLEAN, CHAR, VOID,
         VAR, STATIC, FIELD, LET, DO, IF,
@@ -38,7 +43,7 @@ namespace nand2tetris::jack {
      * @param kw The Keyword to convert.
      * @return The string representation of the keyword (e.g., "class", "while").
      */
-    inline const char* keywordToString(const Keyword kw) {
+    constexpr const char* keywordToString(const Keyword kw) {
         using K = Keyword;
         switch (kw) {
             case K::CLASS:       return "class";
@@ -66,46 +71,58 @@ namespace nand2tetris::jack {
         return "<unknown>";
     }
 
+    namespace keywords {
+        inline constexpr std::size_t COUNT = 21;      ///< Keyword::CLASS .. Keyword::THIS_.
+        inline constexpr std::size_t SLOTS = 32;
+        inline constexpr std::size_t MIN_LENGTH = 2;  ///< "do", "if"
+        inline constexpr std::size_t MAX_LENGTH = 11; ///< "constructor"
+
+        /**
+         * @brief A perfect hash of the keywords: the first two characters and the length give every
+         *        keyword a slot of its own (the static_assert below checks it). `s` has 2+ characters.
+         */
+        constexpr std::size_t slotOf(const std::string_view s) {
+            return (2 * static_cast<unsigned char>(s[0]) + 14 * static_cast<unsigned char>(s[1]) + 5 * s.size()) % SLOTS;
+        }
+
+        struct Slot {
+            std::string_view text; ///< Empty for an unused slot.
+            Keyword keyword = Keyword::CLASS;
+        };
+
+        inline constexpr std::array<Slot, SLOTS> TABLE = [] {
+            std::array<Slot, SLOTS> table{};
+            for (std::size_t k = 0; k < COUNT; ++k) {
+                const std::string_view text = keywordToString(static_cast<Keyword>(k));
+                table[slotOf(text)] = {text, static_cast<Keyword>(k)};
+            }
+            return table;
+        }();
+
+        static_assert([] {
+            for (std::size_t k = 0; k < COUNT; ++k) {
+                if (TABLE[slotOf(keywordToString(static_cast<Keyword>(k)))].keyword != static_cast<Keyword>(k)) return false;
+            }
+            return true;
+        }(), "Two keywords share a slot: pick new constants for slotOf()");
+    }
+
     /**
      * @brief Checks if a string corresponds to a Jack keyword.
      *
+     * One hash and one comparison against the only keyword that could match; no allocation and
+     * no static initialisation.
+     *
      * @param s The string to check.
      * @param outKw Output parameter where the corresponding Keyword enum will be stored if found.
      * @return true if the string is a keyword, false otherwise.
      */
-
-    inline bool isKeywordString(std::string_view s, Keyword &outKw) {
-        static const std::unordered_map<std::string_view, Keyword> keywordMap = {
-            {"class",       Keyword::CLASS},
-            {"method",      Keyword::METHOD},
-            {"function",    Keyword::FUNCTION},
-            {"constructor", Keyword::CONSTRUCTOR},
-            {"int",         Keyword::INT},
-            {"boolean",     Keyword::BOOLEAN},
-            {"char",        Keyword::CHAR},
-            {"void",        Keyword::VOID},
-            {"var",         Keyword::VAR},
-            {"static",      Keyword::STATIC},
-            {"field",       Keyword::FIELD},
-            {"let",         Keyword::LET},
-            {"do",          Keyword::DO},
-            {"if",          Keyword::IF},
-            {"else",        Keyword::ELSE},
-            {"while",       Keyword::WHILE},
-            {"return",      Keyword::RETURN},
-            {"true",        Keyword::TRUE_},
-            {"false",       Keyword::FALSE_},
-            {"null",        Keyword::NULL_},
-            {"this",        Keyword::THIS_}
-        };
-
-        const auto it = keywordMap.find(s);
-        if (it != keywordMap.end()) {
-            outKw = it->second;
-            return true;
-        }
-
-        return false;
+    constexpr bool isKeywordString(const std::string_view s, Keyword &outKw) {
+        if (s.size() < keywords::MIN_LENGTH || s.size() > keywords::MAX_LENGTH) return false;
+        const keywords::Slot& slot = keywords::TABLE[keywords::slotOf(s)];
+        if (slot.text != s) return false;
+        outKw = slot.keyword;
+        return true;
     }
 
     /**
@@ -127,181 +144,73 @@ namespace nand2tetris::jack {
     }
 
     /**
-     * @brief Base class representing a token in the Jack language.
+     * @brief A single lexical token.
      *
-     * This abstract struct holds common information for all tokens, such as type and location.
+     * Tokens are small, trivially copyable values: the Tokenizer hands them out by value and never
+     * allocates. The token does not hold its text; it records where the text lives in the source
+     * buffer (offset and length), and Tokenizer::text() turns that back into a std::string_view.
+     * Keywords and symbols also carry their decoded value in `code`, and integer constants carry
+     * their value directly, so the parser rarely needs the text at all.
+     * Nor does it hold a line or column: the tokenizer's LineIndex derives those from the offset
+     * when an error is reported.
      */
     struct Token {
-        protected:
-            TokenType type = TokenType::END_OF_FILE; ///< The type of the token.
-            int line;                        ///< The line number where the token appears.
-            int column;                      ///< The column number where the token appears.
-
-        public:
-            /**
-             * @brief Constructs a new Token.
-             *
-             * @param t The type of the token.
-             * @param line The line number.
-             * @param column The column number.
-             */
-            explicit Token(const TokenType t, const int line, const int column)
-                : type(t), line(line), column(column) {}
-
-            /**
-             * @brief Gets the type of the token.
-             * @return The TokenType.
-             */
-            TokenType getType() const { return type; }
-
-            /**
-             * @brief Gets the line number of the token.
-             * @return The line number.
-             */
-            int getLine() const { return line; }
-
-            /**
-             * @brief Gets the column number of the token.
-             * @return The column number.
-             */
-            int getColumn() const { return column; }
-
-            /**
-             * @brief Returns a string representation of the token for debugging.
-             * @return A string describing the token.
-             */
-            virtual std::string toString() const = 0;
-
-            /**
-             * @brief Gets the string value of the token if applicable.
-             * @return A string_view of the token's value.
-             */
-            virtual std::string_view getValue() const { return ""; }
-
-            virtual ~Token() = default;
-    };
-
-    /**
-     * @brief Represents a token that holds text content (Identifier, String Constant, Symbol).
-     */
-    struct TextToken final : public Token {
-        private:
-            std::string_view text; ///< The text content of the token.
-
-        public:
-            /**
-             * @brief Constructs a new TextToken.
-             *
-             * @param t The type of the token.
-             * @param text The text content.
-             * @param line The line number.
-             * @param column The column number.
-             */
-            TextToken(const TokenType t, const std::string_view text, const int line, const int column)
-                : Token(t, line, column), text(text) {};
-
-            /**
-             * @brief Gets the text content of the token.
-             * @return The text content.
-             */
-            std::string_view getText() const { return text; }
-
-            std::string toString() const override {
-                return "[" + std::to_string(line) + ":" + std::to_string(column) + "] " +
-                       typeToString(type) + " '" + std::string(text) + "'";
-            }
+        TokenType type = TokenType::END_OF_FILE; ///< The type of the token.
+        std::uint8_t code = 0;       ///< Keyword enum value (KEYWORD) or the symbol character (SYMBOL).
+        std::uint16_t length = 0;    ///< Length of the token text in bytes.
+        std::uint32_t offset = 0;    ///< Byte offset of the token text within the source buffer.
+        std::uint32_t value = 0;     ///< INT_CONST: the integer value (0-32767). IDENTIFIER: the interned NameId.
 
-            ~TextToken() override = default;
-
-            std::string_view getValue() const override { return text; }
-    };
-
-    /**
-     * @brief Represents an integer constant token.
-     */
-    struct IntToken final : public Token {
-        private:
-            int intVal = 0; ///< The integer value.
-
-        public:
-            /**
-             * @brief Constructs a new IntToken.
-             *
-             * @param val The integer value.
-             * @param line The line number.
-             * @param column The column number.
-             */
-            explicit IntToken(const int val, const int line, const int column)
-                : Token(TokenType::INT_CONST, line, column), intVal(val) {}
-
-            /**
-             * @brief Gets the integer value.
-             * @return The integer value.
-             */
-            int getInt() const { return intVal; }
-
-            std::string toString() const override {
-                return "[" + std::to_string(line) + ":" + std::to_string(column) + "] " +
-                       typeToString(type) + " '" + std::to_string(intVal) + "'";
-            }
-
-            ~IntToken() override = default;
-    };
-
-    /**
-     * @brief Represents a keyword token.
-     */
-    struct KeywordToken final : public Token {
-        private:
-            Keyword keyword{}; ///< The specific keyword.
-
-        public:
-            /**
-             * @brief Constructs a new KeywordToken.
-             *
-             * @param keyword The keyword value.
-             * @param line The line number.
-             * @param column The column number.
-             */
-            explicit KeywordToken(const Keyword keyword, const int line, const int column)
-                : Token(TokenType::KEYWORD, line, column), keyword(keyword) {}
+        /**
+         * @brief Gets the type of the token.
+         * @return The TokenType.
+         */
+        TokenType getType() const { return type; }
 
-            /**
-             * @brief Gets the keyword value.
-             * @return The Keyword.
-             */
-            Keyword getKeyword() const { return keyword; }
+        /**
+         * @brief Gets the offset where the token begins in the source, which for a string constant
+         *        is its opening quote (the text itself starts one byte later).
+         * @return The offset to report the token's position at.
+         */
+        std::uint32_t start() const { return type == TokenType::STRING_CONST ? offset - 1 : offset; }
 
-            std::string toString() const override {
-                return "[" + std::to_string(line) + ":" + std::to_string(column) + "] " +
-                       typeToString(type) + " '" + keywordToString(keyword) + "'";
-            }
+        /**
+         * @brief Gets the integer value of an INT_CONST token.
+         * @return The integer value.
+         */
+        int getInt() const { return static_cast<int>(value); }
 
-            ~KeywordToken() override = default;
+        /**
+         * @brief Gets the interned name of an IDENTIFIER token.
+         * @return The NameId.
+         */
+        NameId getName() const { return value; }
 
-            std::string_view getValue() const override { return keywordToString(this->keyword); }
-    };
+        /**
+         * @brief Gets the keyword of a KEYWORD token.
+         * @return The Keyword.
+         */
+        Keyword getKeyword() const { return static_cast<Keyword>(code); }
 
-    /**
-     * @brief Represents the End-Of-File token.
-     */
-    struct EofToken final : public Token {
         /**
-         * @brief Constructs a new EofToken.
-         *
-         * @param line The line number.
-         * @param column The column number.
+         * @brief Gets the character of a SYMBOL token.
+         * @return The symbol character.
          */
-        EofToken(const int line, const int column)
-            : Token(TokenType::END_OF_FILE, line, column) {}
+        char getSymbol() const { return static_cast<char>(code); }
 
-        std::string toString() const override {
-            return "[" + std::to_string(line) + ":" + std::to_string(column) + "] " +
-                   typeToString(type) + " '<EOF>'";
-        }
+        /**
+         * @brief Checks whether this token is the given keyword.
+         */
+        bool isKeyword(const Keyword kw) const { return type == TokenType::KEYWORD && code == static_cast<std::uint8_t>(kw); }
 
-        ~EofToken() override = default;
+        /**
+         * @brief Checks whether this token is the given symbol.
+         */
+        bool isSymbol(const char c) const { return type == TokenType::SYMBOL && code == static_cast<std::uint8_t>(c); }
     };
+
+    static_assert(sizeof(Token) == 12, "Token is expected to stay a compact 12-byte value");
+    static_assert(std::is_trivially_copyable_v<Token>, "Token must be trivially copyable");
 }
 
 #endif //NAND2TETRIS_TOKEN_H
\ No newline at end of file
@@ -3,10 +3,13 @@
 //
 
 #include "Tokenizer.h"
-#include <fstream>
+#include "CharScan.h"
+#include "../Common/Diagnostics.h"
+#include <algorithm>
 #include <stdexcept>
 #include <unordered_map>
 #include <string_view>
+#include <cstdint>
 
 namespace nand2tetris::jack {
 
@@ -17,21 +20,115 @@ namespace nand2tetris::jack {
         currentToken = fetchNext();
     }
 
-    std::unique_ptr<Token> Tokenizer::fetchNext() {
+    Tokenizer::Tokenizer(const Tokenizer& file, const SourceRange& range)
+        : src(file.src.substr(0, range.end)), pos(range.begin), lineIndex(file.lineIndex), fileName(file.fileName) {
+        // The view is cut at the end of the range but starts where the file does, so offsets stay valid.
+        currentToken = fetchNext();
+    }
+
+    std::vector<SourceRange> Tokenizer::scanSubroutineBodies() const {
+        std::vector<SourceRange> bodies;
+        const char* const begin = src.data();
+        const char* const end = begin + src.size();
+        std::size_t at = 0;
+
+        int depth = 0;
+        bool classClosed = false;
+        while (at < src.size()) {
+            const char c = src[at];
+            if (c == '/' && at + 1 < src.size() && src[at + 1] == '/') {
+                at = static_cast<std::size_t>(findLineEnd(begin + at, end) - begin);
+                continue;
+            }
+            if (c == '/' && at + 1 < src.size() && src[at + 1] == '*') {
+                const char* close = findBlockCommentEnd(begin + at + 2, end);
+                if (close == end) return {}; // Unterminated block comment
+                at = static_cast<std::size_t>(close - begin) + 2;
+                continue;
+            }
+            if (hasCharClass(c, CHAR_SPACE)) {
+                at = static_cast<std::size_t>(skipSpaces(begin + at, end) - begin);
+                continue;
+            }
+            if (classClosed) return {}; // Anything after the class is the parser's to report.
+            if (c == '"') {
+                at = static_cast<std::size_t>(findStringEnd(begin + at + 1, end) - begin);
+                if (at >= src.size() || src[at] != '"') return {};
+                ++at;
+                continue;
+            }
+            if (c == '{') {
+                if (depth == 1) bodies.push_back({static_cast<std::uint32_t>(at), 0});
+                ++depth;
+            } else if (c == '}') {
+                if (depth == 0) return {};
+                --depth;
+                if (depth == 1) {
+                    ++at;
+                    bodies.back().end = static_cast<std::uint32_t>(at);
+                    continue;
+                }
+                classClosed = depth == 0;
+            }
+            ++at;
+        }
+        if (depth != 0) return {};
+        return bodies;
+    }
+
+    std::size_t Tokenizer::countStringConstants(const std::size_t limit) const {
+        std::vector<std::string_view> seen;
+        const char* const begin = src.data();
+        const char* const end = begin + src.size();
+        std::size_t at = 0;
+        while (at < src.size() && seen.size() < limit) {
+            const char c = src[at];
+            if (c == '/' && at + 1 < src.size() && src[at + 1] == '/') {
+                at = static_cast<std::size_t>(findLineEnd(begin + at, end) - begin);
+                continue;
+            }
+            if (c == '/' && at + 1 < src.size() && src[at + 1] == '*') {
+                const char* close = findBlockCommentEnd(begin + at + 2, end);
+                if (close == end) break; // Unterminated block comment
+                at = static_cast<std::size_t>(close - begin) + 2;
+                continue;
+            }
+            if (c == '"') {
+                const std::size_t close = static_cast<std::size_t>(findStringEnd(begin + at + 1, end) - begin);
+                if (close >= src.size() || src[close] != '"') break;
+                const std::string_view constant = src.substr(at + 1, close - at - 1);
+                if (std::find(seen.begin(), seen.end(), constant) == seen.end()) seen.push_back(constant);
+                at = close + 1;
+                continue;
+            }
+            ++at;
+        }
+        return seen.size();
+    }
+
+    void Tokenizer::resumeAfter(const SourceRange& range) {
+        pos = range.end;
+        hasPeek = false;
+        currentToken = fetchNext();
+    }
+
+    Token Tokenizer::fetchNext() {
         // Before attempting to read a token, we must bypass any whitespace or comments
         // that might precede it.
         skipWhitespaceAndComments();
+        ++tokensScanned;
         return nextToken();
     }
 
     const Token& Tokenizer::peek() {
         // Lazy load the lookahead token only when requested.
         // This allows us to see what's coming next without consuming it.
-        if (!peekToken) {
+        if (!hasPeek) {
             peekToken = fetchNext();
+            hasPeek = true;
         }
 
-        return *peekToken;
+        return peekToken;
     }
 
     void Tokenizer::loadFile(const std::string &filePath) {
@@ -39,50 +136,35 @@ namespace nand2tetris::jack {
         if (filePath.length() < 5 || filePath.substr(filePath.length() - 5) != ".jack") {
             throw std::runtime_error("Invalid file extension. Expected a .jack file: " + filePath);
         }
-        std::ifstream in(filePath);
-        if (!in) {
-            throw std::runtime_error("Cannot open Jack file: " + filePath);
+        // Map the file read-only; tokens are views into this buffer, so it never needs copying.
+        source = SourceBuffer::fromFile(filePath);
+        src = source.view();
+
+        // Tokens record 32-bit offsets into the buffer.
+        if (src.size() > UINT32_MAX) {
+            throw std::runtime_error("Jack file too large (max 4 GiB): " + filePath);
         }
-        // Read the entire file into the 'src' string buffer using iterators.
-        src.assign((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        lineIndex = std::make_shared<LineIndex>(src);
 
         // Reset parsing state.
         pos = 0;
-        line = 1;
-        column = 1;
     }
 
     void Tokenizer::advanceChar() {
-        if (pos >= src.size()) {
-            return;
-        }
-        const char c = src[pos++];
-
-        // Handle line endings to keep track of line/column numbers for error reporting.
-        if (c == '\n') {
-            ++line;
-            column = 1;
-        } else if (c == '\r') {
-            // Ignore carriage returns; we count lines on \n.
-        } else {
-            ++column;
-        }
+        // Lines and columns are not tracked here; the LineIndex works them out for an error.
+        if (pos < src.size()) ++pos;
     }
 
     bool Tokenizer::hasMoreTokens() const {
-        // If currentToken is null, we assume we haven't started or are in a valid state
-        // to fetch more, unless we explicitly hit EOF.
-        if (!currentToken) {
-            return true;
-        }
-        return currentToken->getType() != TokenType::END_OF_FILE;
+        return currentToken.getType() != TokenType::END_OF_FILE;
     }
 
     void Tokenizer::advance() {
         // If we have previously peeked, the next token is already waiting in peekToken.
-        // We simply move it to currentToken.
-        if (peekToken) {
-            currentToken = std::move(peekToken);
+        // We simply copy it into currentToken.
+        if (hasPeek) {
+            currentToken = peekToken;
+            hasPeek = false;
             return;
         }
 
@@ -94,165 +176,168 @@ namespace nand2tetris::jack {
     }
 
     void Tokenizer::skipWhitespaceAndComments() {
-        while (pos < src.size()) {
-            const char c = src[pos];
-
+        const char* const begin = src.data();
+        const char* const end = begin + src.size();
+        const char* at = begin + pos;
+        while (true) {
             // Skip standard whitespace characters (space, tab, newline, etc.)
-            if (std::isspace(static_cast<unsigned char>(c))) {
-                advanceChar();
-                continue;
-            }
+            at = skipSpaces(at, end);
+            if (at + 1 >= end || at[0] != '/') break;
 
-            // Check for line comments starting with "//"
-            if (c == '/' && pos + 1 < src.size() && src[pos + 1] == '/') {
-                advanceChar(); // consume first /
-                advanceChar(); // consume second /
-                // Consume everything until the end of the line
-                while (pos < src.size() && src[pos] != '\n') {
-                    advanceChar();
-                }
+            // Check for line comments starting with "//": consume everything until the end of the line.
+            if (at[1] == '/') {
+                at = findLineEnd(at + 2, end);
                 continue;
             }
 
-            // Check for block comments starting with "/*"
-            if (c == '/' && pos + 1 < src.size() && src[pos + 1] == '*') {
-                advanceChar(); // consume /
-                advanceChar(); // consume *
-                // Consume everything until we find the closing "*/"
-                while (pos + 1 < src.size() && !(src[pos] == '*' && src[pos + 1] == '/')) {
-                    advanceChar();
-                }
-
-                if (pos + 1 >= src.size()) {
+            // Check for block comments starting with "/*": consume everything up to the closing "*/".
+            if (at[1] == '*') {
+                const char* close = findBlockCommentEnd(at + 2, end);
+                if (close == end) {
+                    // Reported where the old character-by-character scan stopped: the last character.
+                    pos = static_cast<std::size_t>(std::max(at + 2, end - 1) - begin);
                     errorHere("Unterminated block comment");
                 }
-                advanceChar(); // consume *
-                advanceChar(); // consume /
+                at = close + 2;
                 continue;
             }
 
-            // If we hit a character that isn't whitespace or a comment start, we are done.
+            // A '/' on its own is the division symbol.
             break;
         }
+        pos = static_cast<std::size_t>(at - begin);
     }
 
-    std::unique_ptr<Token> Tokenizer::nextToken() {
+    Token Tokenizer::makeToken(const TokenType type, const std::size_t start) const {
+        const std::size_t length = pos - start;
+        if (length > UINT16_MAX) {
+            errorAt(start, "Token too long (max 65535 characters)");
+        }
+
+        Token token;
+        token.type = type;
+        token.length = static_cast<std::uint16_t>(length);
+        token.offset = static_cast<std::uint32_t>(start);
+        return token;
+    }
+
+    Token Tokenizer::nextToken() {
         // If we've reached the end of the source, return an EOF token.
         if (pos >= src.size()) {
-            return std::make_unique<EofToken>(line, column);
+            return makeToken(TokenType::END_OF_FILE, pos);
         }
 
         // Capture the start position of the token for error reporting.
-        std::size_t tokenLine = line;
-        std::size_t tokenColumn = column;
+        const std::size_t start = pos;
         const char c = src[pos];
 
         // Check for single-character symbols used in Jack.
-        constexpr std::string_view symbols = "{}()[].,;+-*/&|<>=~";
-        if (symbols.find(c) != std::string_view::npos) {
-            std::string_view symView = std::string_view(src).substr(pos, 1);
+        if (hasCharClass(c, CHAR_SYMBOL)) {
             advanceChar();
-            return std::make_unique<TextToken>(TokenType::SYMBOL, symView, tokenLine, tokenColumn);
+            Token token = makeToken(TokenType::SYMBOL, start);
+            token.code = static_cast<std::uint8_t>(c);
+            return token;
         }
 
         // Check for string constants starting with double quotes.
         if (c == '"') {
-            return readString(tokenLine, tokenColumn);
+            return readString(start);
         }
 
         // Check for integer constants (digits).
-        if (std::isdigit(static_cast<unsigned char>(c))) {
-            return readNumber(tokenLine, tokenColumn);
+        if (hasCharClass(c, CHAR_DIGIT)) {
+            return readNumber(start);
         }
 
         // Check for identifiers or keywords (letters or underscore).
-        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
-            return readIdentifierOrKeyword(tokenLine, tokenColumn);
+        if (hasCharClass(c, CHAR_IDENT_START)) {
+            return readIdentifierOrKeyword(start);
         }
 
         errorHere("Unexpected character: '" + std::string(1, c) + "'");
     }
 
-    std::unique_ptr<Token> Tokenizer::readString(const std::size_t tokenline, const std::size_t tokencolumn) {
+    Token Tokenizer::readString(const std::size_t start) {
         advanceChar(); // consume the opening quote "
 
-        const std::size_t start = pos;
-        // Read until we hit the closing quote.
-        while (pos < src.size() && src[pos] != '"') {
-            // Jack strings cannot contain newlines.
-            if (src[pos] == '\n' || src[pos] == '\r') errorAt(tokenline, tokencolumn, "Newline in string");
-            advanceChar();
-        }
-
-        std::string_view val = std::string_view(src).substr(start, pos - start);
+        const std::size_t contents = pos;
+        // Read until we hit the closing quote, or a line end: Jack strings cannot contain newlines.
+        pos = static_cast<std::size_t>(findStringEnd(src.data() + pos, src.data() + src.size()) - src.data());
+        if (pos < src.size() && src[pos] != '"') errorAt(start, "Newline in string");
 
         if (pos >= src.size()) {
-            errorAt(tokenline, tokencolumn, "Unterminated string constant");
+            errorAt(start, "Unterminated string constant");
         }
+
+        // The token covers the contents only, not the quotes.
+        const Token token = makeToken(TokenType::STRING_CONST, contents);
         advanceChar(); // consume the closing quote "
-        return std::make_unique<TextToken>(TokenType::STRING_CONST, val, tokenline, tokencolumn);
+        return token;
     }
 
     const Token& Tokenizer::current() const {
-        if (!currentToken) {
-            throw std::logic_error("Tokenizer::current() called with no current token");
-        }
-        return *currentToken;
+        return currentToken;
     }
 
-    std::unique_ptr<Token> Tokenizer::readNumber(const std::size_t tokenline, const std::size_t tokencolumn) {
+    Token Tokenizer::readNumber(const std::size_t start) {
         int value = 0;
 
         // Consume consecutive digits.
-        while (pos < src.size() && std::isdigit(static_cast<unsigned char>(src[pos]))) {
+        while (pos < src.size() && hasCharClass(src[pos], CHAR_DIGIT)) {
             const int digit = src[pos] - '0';
 
             // Check for overflow BEFORE updating the value.
             // The maximum allowed integer in Jack is 32767.
             // If value > 3276, then value * 10 >= 32760. Adding any digit > 7 would exceed 32767.
             if (value > 3276 || (value == 3276 && digit > 7)) {
-                errorAt(tokenline, tokencolumn, "Integer constant too large (max 32767)");
+                errorAt(start, "Integer constant too large (max 32767)");
             }
 
             value = value * 10 + digit;
             advanceChar();
         }
 
-        return std::make_unique<IntToken>(value, tokenline, tokencolumn);
+        Token token = makeToken(TokenType::INT_CONST, start);
+        token.value = static_cast<std::uint32_t>(value);
+        return token;
     }
 
-    std::unique_ptr<Token> Tokenizer::readIdentifierOrKeyword(const std::size_t tokenline, const std::size_t tokencolumn) {
-        const std::size_t start = pos;
+    Token Tokenizer::readIdentifierOrKeyword(const std::size_t start) {
         // Consume alphanumeric characters and underscores.
-        while (pos < src.size() && (std::isalnum(static_cast<unsigned char>(src[pos])) || src[pos] == '_')) {
-            advanceChar();
+        while (pos < src.size() && hasCharClass(src[pos], CHAR_IDENT)) {
+            ++pos;
         }
 
         // Extract the text we just scanned.
-        std::string_view s = std::string_view(src).substr(start, pos - start);
+        const std::string_view s = src.substr(start, pos - start);
 
         // Check if this text matches a reserved keyword.
         Keyword kw;
         if (isKeywordString(s, kw)) {
-            return std::make_unique<KeywordToken>(kw, tokenline, tokencolumn);
+            Token token = makeToken(TokenType::KEYWORD, start);
+            token.code = static_cast<std::uint8_t>(kw);
+            return token;
         }
 
-        // Otherwise, it's a user-defined identifier.
-        return std::make_unique<TextToken>(TokenType::IDENTIFIER, s, tokenline, tokencolumn);
+        // Otherwise, it's a user-defined identifier. Intern it now so later phases compare IDs.
+        Token token = makeToken(TokenType::IDENTIFIER, start);
+        token.value = Interner::global().intern(s);
+        return token;
     }
 
-    [[noreturn]] void Tokenizer::errorAt(const std::size_t errLine, const std::size_t errColumn, const std::string_view message) const {
+    [[noreturn]] void Tokenizer::errorAt(const std::size_t errOffset, const std::string_view message) const {
         // Format a standard error message: file:line:col: message
+        const SourcePosition at = lineIndex->position(static_cast<std::uint32_t>(errOffset));
         const std::string full =
             fileName + ":" +
-            std::to_string(errLine) + ":" +
-            std::to_string(errColumn) + ": " +
+            std::to_string(at.line) + ":" +
+            std::to_string(at.column) + ": " +
             std::string(message);
-        throw std::runtime_error(full);
+        throw CompileError(fileName, at.line, at.column, full);
     }
 
     [[noreturn]] void Tokenizer::errorHere(const std::string_view message) const {
-        errorAt(line, column, message);
+        errorAt(pos, message);
     }
 
     std::string Tokenizer::getFilePath() {
@@ -5,13 +5,25 @@
 #ifndef NAND2TETRIS_TOKENIZER_H
 #define NAND2TETRIS_TOKENIZER_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
-#include <memory>
+#include <vector>
 #include "TokenTypes.h"
+#include "SourceBuffer.h"
+#include "LineIndex.h"
 
 namespace nand2tetris::jack {
 
+    /**
+     * @brief A byte range of a source file.
+     */
+    struct SourceRange {
+        std::uint32_t begin = 0; ///< Offset of the first character.
+        std::uint32_t end = 0;   ///< Offset one past the last character.
+    };
+
     /**
      * @brief A tokenizer for the Jack language.
      *
@@ -28,6 +40,45 @@ namespace nand2tetris::jack {
              */
             explicit Tokenizer(const std::string& filePath);
 
+            /**
+             * @brief Constructs a Tokenizer over part of a file another Tokenizer has loaded.
+             *
+             * Tokens keep their offsets in the whole file, and the stream ends
+             * (END_OF_FILE) at the end of the range. The source text stays owned by `file`, which
+             * must outlive this tokenizer.
+             *
+             * @param file The tokenizer that owns the source.
+             * @param range The part of the source to tokenize.
+             */
+            Tokenizer(const Tokenizer& file, const SourceRange& range);
+
+            /**
+             * @brief Finds the body of every subroutine with a quick scan over the whole file.
+             *
+             * Matches braces without tokenizing, skipping comments and string constants, and takes
+             * every brace block directly inside the class body as a subroutine body (`{` to `}`
+             * inclusive). The parser only relies on the result where it agrees with what it parsed.
+             *
+             * @return The bodies in source order, or nothing if the braces do not balance or the
+             *         file is malformed in a way the scan cannot see past.
+             */
+            std::vector<SourceRange> scanSubroutineBodies() const;
+
+            /**
+             * @brief Counts the distinct string constants of the file with a quick scan, up to `limit`.
+             *
+             * Skips comments like scanSubroutineBodies(). Used to budget the string pool before any
+             * body is parsed; a malformed file is counted as far as the scan gets.
+             */
+            std::size_t countStringConstants(std::size_t limit) const;
+
+            /**
+             * @brief Continues tokenizing right after a range, discarding the current and peeked tokens.
+             *
+             * @param range A range of this tokenizer's source (e.g. a body to be parsed elsewhere).
+             */
+            void resumeAfter(const SourceRange& range);
+
             /**
              * @brief Checks if there are more tokens in the input.
              *
@@ -45,8 +96,7 @@ namespace nand2tetris::jack {
             /**
              * @brief Returns the current token.
              *
-             * @return A reference to the current Token object.
-             * @throws std::logic_error if there is no current token.
+             * @return A reference to the current Token.
              */
             const Token& current() const;
 
@@ -54,42 +104,68 @@ namespace nand2tetris::jack {
             /**
              * @brief Peeks at the next token without advancing the current token.
              *
-             * @return A reference to the next Token object.
+             * @return A reference to the next Token.
              */
             const Token& peek();
 
+            /**
+             * @brief Returns the source text of a token produced by this tokenizer.
+             *
+             * @param token The token.
+             * @return A view of the token's text in the source buffer (empty for EOF).
+             */
+            std::string_view text(const Token& token) const { return src.substr(token.offset, token.length); }
+
+            /**
+             * @brief Returns the whole source text.
+             */
+            std::string_view sourceText() const { return src; }
+
+            /**
+             * @brief Returns the number of tokens scanned so far (for the --trace counters).
+             */
+            std::size_t tokenCount() const { return tokensScanned; }
+
+            /**
+             * @brief Returns the line index of the source, for turning offsets into lines and columns.
+             */
+            const LineIndex& lines() const { return *lineIndex; }
+
             /**
              * @brief Reports an error at the current tokenizer position and throws an exception.
              *
              * @param message The error message.
+             * @throws CompileError Always.
              */
             [[noreturn]] void errorHere(std::string_view message) const;
 
             /**
              * @brief Reports an error at a specific location and throws an exception.
              *
-             * @param errLine The line number of the error.
-             * @param errColumn The column number of the error.
+             * @param errOffset The byte offset of the error in the source.
              * @param message The error message.
+             * @throws CompileError Always, with the file, line and column of the offset.
              */
-            [[noreturn]] void errorAt(size_t errLine, size_t errColumn, std::string_view message) const;
+            [[noreturn]] void errorAt(std::size_t errOffset, std::string_view message) const;
 
             std::string getFilePath();
 
 
         private:
-            std::string src;        ///< The source code content.
+            SourceBuffer source;    ///< Owns the file text (memory-mapped where possible).
+            std::string_view src;   ///< The source code content (a view of `source`).
             std::size_t pos = 0;    ///< Current character position in the source.
-            std::size_t line = 1;   ///< Current line number.
-            std::size_t column = 1; ///< Current column number.
+            std::shared_ptr<const LineIndex> lineIndex; ///< Shared with the tokenizers of the file's ranges.
 
             std::string fileName;   ///< The name of the file being tokenized.
 
-            std::unique_ptr<Token> currentToken; ///< The current token.
-            std::unique_ptr<Token> peekToken = nullptr; ///< The next token (used for lookahead).
+            Token currentToken;        ///< The current token.
+            Token peekToken;           ///< The next token (used for lookahead), valid if hasPeek.
+            bool hasPeek = false;      ///< True once peekToken holds the lookahead token.
+            std::size_t tokensScanned = 0; ///< Tokens returned by fetchNext().
 
             /**
-             * @brief Loads the content of the file into the source buffer.
+             * @brief Maps (or reads) the content of the file into the source buffer.
              *
              * @param filePath The path to the file.
              */
@@ -103,49 +179,53 @@ namespace nand2tetris::jack {
             /**
              * @brief Scans and returns the next token from the source.
              *
-             * @return A unique_ptr to the next Token.
+             * @return The next Token.
              */
-            std::unique_ptr<Token> nextToken();
+            Token nextToken();
 
             /**
              * @brief Helper to fetch the next token, handling whitespace skipping.
              *
-             * @return A unique_ptr to the next Token.
+             * @return The next Token.
              */
-            std::unique_ptr<Token> fetchNext();
+            Token fetchNext();
+
+            /**
+             * @brief Builds a token covering src[start, pos).
+             *
+             * @param type The token type.
+             * @param start Offset of the first character of the token.
+             * @return The assembled Token.
+             */
+            Token makeToken(TokenType type, std::size_t start) const;
 
 
             /**
              * @brief Reads an identifier or a keyword from the source.
              *
-             * @param tokenline The starting line of the token.
-             * @param tokencolumn The starting column of the token.
-             * @return A unique_ptr to the resulting Token.
+             * @param start Offset of the first character of the token.
+             * @return The resulting Token.
              */
-            std::unique_ptr<Token> readIdentifierOrKeyword(std::size_t tokenline, std::size_t tokencolumn);
+            Token readIdentifierOrKeyword(std::size_t start);
 
             /**
              * @brief Reads an integer constant from the source.
              *
-             * @param tokenline The starting line of the token.
-             * @param tokencolumn The starting column of the token.
-             * @return A unique_ptr to the resulting Token.
+             * @param start Offset of the first character of the token.
+             * @return The resulting Token.
              */
-            std::unique_ptr<Token> readNumber(std::size_t tokenline, std::size_t tokencolumn);
+            Token readNumber(std::size_t start);
 
             /**
              * @brief Reads a string constant from the source.
              *
-             * @param tokenline The starting line of the token.
-             * @param tokencolumn The starting column of the token.
-             * @return A unique_ptr to the resulting Token.
+             * @param start Offset of the first character of the token.
+             * @return The resulting Token.
              */
-            std::unique_ptr<Token> readString(std::size_t tokenline, std::size_t tokencolumn);
+            Token readString(std::size_t start);
 
             /**
              * @brief Advances the current character position.
-             *
-             * Updates line and column counters accordingly.
              */
             void advanceChar();
 
@@ -0,0 +1,98 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "VMCode.h"
+#include <charconv>
+
+namespace nand2tetris::jack {
+
+	namespace {
+		// Indexed by Segment; each entry already carries the separator that follows it.
+		constexpr std::string_view PUSH_PREFIX[] = {
+			"push constant ", "push argument ", "push local ", "push static ",
+			"push this ", "push that ", "push pointer ", "push temp "
+		};
+		constexpr std::string_view POP_PREFIX[] = {
+			"pop constant ", "pop argument ", "pop local ", "pop static ",
+			"pop this ", "pop that ", "pop pointer ", "pop temp "
+		};
+		// Indexed by Command.
+		constexpr std::string_view COMMAND_LINE[] = {
+			"add\n", "sub\n", "neg\n", "eq\n", "gt\n", "lt\n", "and\n", "or\n", "not\n"
+		};
+
+		void appendInt(std::string& out, const int value) {
+			char digits[16];
+			const auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+			out.append(digits, end);
+		}
+	}
+
+	std::uint32_t VMCode::symbol(const std::string_view text) {
+		const auto it = ids.find(text);
+		if (it != ids.end()) return it->second;
+
+		const std::string_view stored = storage.emplace_back(text);
+		const auto id = static_cast<std::uint32_t>(names.size());
+		names.push_back(stored);
+		ids.emplace(stored, id);
+		return id;
+	}
+
+	bool VMCode::findSymbol(const std::string_view text, std::uint32_t& id) const {
+		const auto it = ids.find(text);
+		if (it == ids.end()) return false;
+		id = it->second;
+		return true;
+	}
+
+	std::string VMCode::render(const std::size_t reserveBytes) const {
+		std::string out;
+		out.reserve(reserveBytes);
+		for (const VMInstruction& in : instructions) {
+			switch (in.op) {
+				case VMOp::PUSH:
+					out.append(PUSH_PREFIX[static_cast<int>(in.segment)]);
+					appendInt(out, in.value);
+					break;
+				case VMOp::POP:
+					out.append(POP_PREFIX[static_cast<int>(in.segment)]);
+					appendInt(out, in.value);
+					break;
+				case VMOp::ARITHMETIC:
+					out.append(COMMAND_LINE[static_cast<int>(in.command)]);
+					continue;
+				case VMOp::LABEL:
+					out.append("label ");
+					out.append(names[in.symbol]);
+					break;
+				case VMOp::GOTO:
+					out.append("goto ");
+					out.append(names[in.symbol]);
+					break;
+				case VMOp::IF_GOTO:
+					out.append("if-goto ");
+					out.append(names[in.symbol]);
+					break;
+				case VMOp::CALL:
+					out.append("call ");
+					out.append(names[in.symbol]);
+					out.push_back(' ');
+					appendInt(out, in.value);
+					break;
+				case VMOp::FUNCTION:
+					out.append("function ");
+					out.append(names[in.symbol]);
+					out.push_back(' ');
+					appendInt(out, in.value);
+					break;
+				case VMOp::RETURN:
+					out.append("return");
+					break;
+			}
+			out.push_back('\n');
+		}
+		return out;
+	}
+}
@@ -0,0 +1,96 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_VM_CODE_H
+#define NAND2TETRIS_VM_CODE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace nand2tetris::jack {
+
+	enum class Segment : std::uint8_t {CONST, ARG, LOCAL, STATIC, THIS, THAT, POINTER, TEMP};
+
+	enum class Command : std::uint8_t {ADD, SUB, NEG, EQ, GT, LT, AND, OR, NOT};
+
+	/**
+	 * @brief The kind of a VM command.
+	 */
+	enum class VMOp : std::uint8_t {PUSH, POP, ARITHMETIC, LABEL, GOTO, IF_GOTO, CALL, FUNCTION, RETURN};
+
+	/**
+	 * @brief One VM command in compact form.
+	 *
+	 * Labels and function names are stored as symbol IDs of the owning VMCode, so instructions are
+	 * small, trivially copyable, and cheap to compare and rearrange.
+	 */
+	struct VMInstruction {
+		VMOp op;
+		Segment segment = Segment::CONST;  ///< PUSH / POP only.
+		Command command = Command::ADD;    ///< ARITHMETIC only.
+		std::int32_t value = 0;            ///< Segment index (PUSH, POP), nArgs (CALL) or nLocals (FUNCTION).
+		std::uint32_t symbol = 0;          ///< Label (LABEL, GOTO, IF_GOTO) or function name (CALL, FUNCTION).
+
+		bool is(const VMOp o) const { return op == o; }
+		bool is(const Command c) const { return op == VMOp::ARITHMETIC && command == c; }
+		bool isPush(const Segment s) const { return op == VMOp::PUSH && segment == s; }
+		bool isPop(const Segment s) const { return op == VMOp::POP && segment == s; }
+	};
+
+	/**
+	 * @brief The VM code of one class: an instruction list plus the names it refers to.
+	 *
+	 * Code generation appends to it through VMWriter, optimisation passes rewrite it in place,
+	 * and render() turns it into .vm text at the very end.
+	 */
+	class VMCode {
+		public:
+			VMCode() = default;
+			VMCode(const VMCode&) = delete;
+			VMCode& operator=(const VMCode&) = delete;
+
+			std::vector<VMInstruction> instructions;
+
+			/**
+			 * @brief Returns the ID of a label or function name, adding it if it is new.
+			 */
+			std::uint32_t symbol(std::string_view text);
+
+			/**
+			 * @brief Returns the ID of a name if it is already known.
+			 *
+			 * @return True and sets `id` if found.
+			 */
+			bool findSymbol(std::string_view text, std::uint32_t& id) const;
+
+			/**
+			 * @brief Returns the text of a symbol.
+			 */
+			std::string_view symbolText(const std::uint32_t id) const { return names[id]; }
+
+			/**
+			 * @brief Returns the number of symbols; IDs are `0 .. symbolCount() - 1`.
+			 */
+			std::size_t symbolCount() const { return names.size(); }
+
+			/**
+			 * @brief Formats the instructions as .vm text.
+			 *
+			 * @param reserveBytes Initial capacity of the result, to avoid regrowing on large classes.
+			 */
+			std::string render(std::size_t reserveBytes = 0) const;
+
+		private:
+			std::deque<std::string> storage;   ///< Owns the symbol text (deque: elements never move).
+			std::vector<std::string_view> names;
+			std::unordered_map<std::string_view, std::uint32_t> ids;
+	};
+}
+
+#endif //NAND2TETRIS_VM_CODE_H
@@ -3,77 +3,64 @@
 //
 
 #include "VMWriter.h"
+#include "../Common/FileIO.h"
 
 namespace nand2tetris::jack {
-	VMWriter::VMWriter(std::ostream &out):out(out) {};
-
-	// ReSharper disable once CppMemberFunctionMayBeStatic
-	std::string VMWriter::segmentToString(const Segment seg) { // NOLINT(*-convert-member-functions-to-static)
-		switch (seg) {
-			case Segment::CONST: return "constant";
-			case Segment::ARG:     return "argument";
-			case Segment::LOCAL:   return "local";
-			case Segment::STATIC:  return "static";
-			case Segment::THIS:    return "this";
-			case Segment::THAT:    return "that";
-			case Segment::POINTER: return "pointer";
-			case Segment::TEMP:    return "temp";
-		}
-		return "unknown";
+
+	VMWriter::VMWriter(const std::size_t reserveInstructions) {
+		vmCode.instructions.reserve(reserveInstructions);
 	}
-	// ReSharper disable once CppMemberFunctionMayBeStatic
-	std::string VMWriter::commandToString(const Command cmd) {// NOLINT(*-convert-member-functions-to-static)
-		switch (cmd) {
-			case Command::ADD: return "add";
-			case Command::SUB: return "sub";
-			case Command::NEG: return "neg";
-			case Command::EQ:  return "eq";
-			case Command::GT:  return "gt";
-			case Command::LT:  return "lt";
-			case Command::AND: return "and";
-			case Command::OR:  return "or";
-			case Command::NOT: return "not";
-		}
-		return "unknown";
+
+	std::uint32_t VMWriter::qualifiedName(const std::string_view className, const std::string_view subroutine) {
+		scratch.assign(className);
+		scratch.push_back('.');
+		scratch.append(subroutine);
+		return vmCode.symbol(scratch);
 	}
 
 	void VMWriter::writePush(const Segment segment, const int index) {
-		out << "push " << segmentToString(segment) << " " << index << "\n";
+		vmCode.instructions.push_back({VMOp::PUSH, segment, Command::ADD, index});
 	}
 
 	void VMWriter::writePop(const Segment segment, const int index) {
-		out << "pop " << segmentToString(segment) << " " << index << "\n";
+		vmCode.instructions.push_back({VMOp::POP, segment, Command::ADD, index});
 	}
 
-	void VMWriter::writeArithmetic(Command command) {
-		out << commandToString(command) << "\n";
+	void VMWriter::writeArithmetic(const Command command) {
+		vmCode.instructions.push_back({VMOp::ARITHMETIC, Segment::CONST, command});
 	}
 
-	void VMWriter::writeLabel(const std::string &label) const {
-		out << "label " << label << "\n";
+	void VMWriter::writeLabel(const std::string_view label) {
+		vmCode.instructions.push_back({VMOp::LABEL, Segment::CONST, Command::ADD, 0, vmCode.symbol(label)});
 	}
 
-	void VMWriter::writeGoto(const std::string &label) const {
-		out << "goto " << label << "\n";
+	void VMWriter::writeGoto(const std::string_view label) {
+		vmCode.instructions.push_back({VMOp::GOTO, Segment::CONST, Command::ADD, 0, vmCode.symbol(label)});
 	}
 
-	void VMWriter::writeIf(const std::string& label) const {
-		out << "if-goto " << label << "\n";
+	void VMWriter::writeIf(const std::string_view label) {
+		vmCode.instructions.push_back({VMOp::IF_GOTO, Segment::CONST, Command::ADD, 0, vmCode.symbol(label)});
 	}
 
-	void VMWriter::writeCall(const std::string& name, int nArgs) const {
-		out << "call " << name << " " << nArgs << "\n";
+	void VMWriter::writeCall(const std::string_view name, const int nArgs) {
+		vmCode.instructions.push_back({VMOp::CALL, Segment::CONST, Command::ADD, nArgs, vmCode.symbol(name)});
 	}
 
-	void VMWriter::writeFunction(const std::string& name, int nLocals) const {
-		out << "function " << name << " " << nLocals << "\n";
+	void VMWriter::writeCall(const std::string_view className, const std::string_view subroutine, const int nArgs) {
+		const std::uint32_t name = qualifiedName(className, subroutine);
+		vmCode.instructions.push_back({VMOp::CALL, Segment::CONST, Command::ADD, nArgs, name});
 	}
 
-	void VMWriter::writeReturn() const {
-		out << "return\n";
+	void VMWriter::writeFunction(const std::string_view className, const std::string_view subroutine, const int nLocals) {
+		const std::uint32_t name = qualifiedName(className, subroutine);
+		vmCode.instructions.push_back({VMOp::FUNCTION, Segment::CONST, Command::ADD, nLocals, name});
 	}
 
-	void VMWriter::writeStringConstant(const std::string_view& str) {
+	void VMWriter::writeReturn() {
+		vmCode.instructions.push_back({VMOp::RETURN});
+	}
+
+	void VMWriter::writeStringConstant(const std::string_view str) {
 		// 1. Push length of string
 		writePush(Segment::CONST, static_cast<int>(str.length()));
 
@@ -81,14 +68,20 @@ namespace nand2tetris::jack {
 		writeCall("String.new", 1);
 
 		// 3. Append characters one by one
+		const std::uint32_t appendChar = vmCode.symbol("String.appendChar");
 		for (const char c : str) {
 			// Push the character code
 			writePush(Segment::CONST, static_cast<int>(c));
 			// Call String.appendChar(this, char)
 			// Note: appendChar returns 'this', so the stack stays valid for the next call
-			writeCall("String.appendChar", 2);
+			vmCode.instructions.push_back({VMOp::CALL, Segment::CONST, Command::ADD, 2, appendChar});
 		}
 	}
 
-
+	std::string VMWriter::saveTo(const std::filesystem::path& path) const {
+		// Lines average well under 16 bytes.
+		std::string text = vmCode.render(vmCode.instructions.size() * 16);
+		writeFileAtomically(path, text);
+		return text;
+	}
 }
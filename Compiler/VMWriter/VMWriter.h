@@ -5,39 +5,69 @@
 #ifndef NAND2TETRIS_VM_WRITER_H
 #define NAND2TETRIS_VM_WRITER_H
 
-#include <ostream>
+#include <cstddef>
+#include <filesystem>
 #include <string>
+#include <string_view>
+#include "VMCode.h"
 namespace nand2tetris::jack {
 
-	enum class Segment {CONST, ARG, LOCAL, STATIC, THIS, THAT, POINTER, TEMP};
-
-	enum class Command {ADD, SUB, NEG, EQ, GT, LT, AND, OR, NOT};
+	/**
+	 * @brief Records VM commands into a VMCode instruction list.
+	 *
+	 * Nothing is formatted or written until saveTo(), which renders the (possibly optimised) code and
+	 * writes the whole file at once, so a class that fails half-way through code generation never
+	 * leaves a truncated .vm file.
+	 */
 	class VMWriter {
 		public:
-			explicit VMWriter(std::ostream &out);
+			/**
+			 * @param reserveInstructions Initial capacity; a good guess avoids regrowing on large classes.
+			 */
+			explicit VMWriter(std::size_t reserveInstructions = 1024);
 			~VMWriter()=default;
 
 			void writePush(Segment segment, int index);
 			void writePop(Segment segment, int index);
 			void writeArithmetic(Command command);
 
-			void writeLabel(const std::string& label) const;
-			void writeGoto(const std::string& label) const;
-			void writeIf(const std::string& label) const;
+			void writeLabel(std::string_view label);
+			void writeGoto(std::string_view label);
+			void writeIf(std::string_view label);
+
+			void writeCall(std::string_view name, int nArgs);
+			void writeCall(std::string_view className, std::string_view subroutine, int nArgs);
+			void writeFunction(std::string_view className, std::string_view subroutine, int nLocals);
+			void writeReturn();
+
+			void writeStringConstant(std::string_view str);
+
+			/**
+			 * @brief The code written so far, for optimisation passes to work on.
+			 */
+			VMCode& code() { return vmCode; }
+			const VMCode& code() const { return vmCode; }
 
-			void writeCall(const std::string& name, int nArgs) const;
-			void writeFunction(const std::string& name, int nLocals) const;
-			void writeReturn() const;
+			/**
+			 * @brief The code written so far as .vm text.
+			 */
+			std::string contents() const { return vmCode.render(); }
 
-			void writeStringConstant(const std::string_view& str);
+			/**
+			 * @brief Writes the code to `path` in a single write, atomically replacing any old file.
+			 *
+			 * @return The text that was written.
+			 * @throws std::runtime_error If the file cannot be written.
+			 */
+			std::string saveTo(const std::filesystem::path& path) const;
 
 		private:
-			std::ostream& out;
-			std::string segmentToString(Segment seg) ;
-			std::string commandToString(Command cmd) ;
+			VMCode vmCode;
+			std::string scratch; ///< Reused to join "Class.subroutine" names.
 
+			std::uint32_t qualifiedName(std::string_view className, std::string_view subroutine);
 	};
 }
 
 
-#endif //NAND2TETRIS_VM_WRITER_H
\ No newline at end of file
+#endif //NAND2TETRIS_VM_WRITER_H
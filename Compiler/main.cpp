@@ -10,6 +10,13 @@
 #include <thread>
 #include <functional>
 #include <cstdlib>
+#include <atomic>
+#include <algorithm>
+#include <optional>
+#include <exception>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
 
 
 
@@ -18,7 +25,21 @@
 #include "Parser/AST.h"
 #include "SemanticAnalyser/GlobalRegistry.h"
 #include "SemanticAnalyser/SemanticAnalyser.h"
+#include "SemanticAnalyser/StandardLibrary.h"
 #include "CodeGenerator/CodeGenerator.h"
+#include "CodeGenerator/StringPool.h"
+#include "HackTranslator/HackTranslator.h"
+#include "Serialization/BinaryWriter.h"
+#include "Linker/ProgramLinker.h"
+#include "Optimizer/ConstantFolder.h"
+#include "Optimizer/Peephole.h"
+#include "ThreadPool/ThreadPool.h"
+#include "Common/Arena.h"
+#include "Common/Diagnostics.h"
+#include "Common/FileIO.h"
+#include "Common/Hash.h"
+#include "Common/Trace.h"
+#include "BuildCache/BuildCache.h"
 
 
 #ifdef _WIN32
@@ -63,53 +84,744 @@ double getPeakMemoryMB() {
 #endif
 }
 
+// What a class takes of the Hack static segment: the statics it declares, and a slot for each literal it
+// would pool (up to StringPool::MAX_PER_CLASS; none for an OS class, which never pools).
+struct StaticDemand {
+	std::size_t declared = 0;
+	std::size_t literals = 0;
+};
+
+StaticDemand staticDemandOf(const Tokenizer& tokenizer, const ClassNode& ast) {
+	const bool pools = !isBuiltinClass(ast.getClassName());
+	return {ast.countDeclaredStatics(), pools ? tokenizer.countStringConstants(StringPool::MAX_PER_CLASS) : 0};
+}
+
 // This struct holds the entire lifecycle state of a single .jack file.
-// It keeps the Tokenizer (source string owner), AST, and SymbolTable alive.
+// It keeps the Tokenizer (source string owner) and AST arena alive, plus the SymbolTable for --viz-checker.
+// The AST lives entirely inside the arena and is released with it in one go.
 struct CompilationUnit {
 	std::string filePath;
 	std::unique_ptr<Tokenizer> tokenizer;
-	std::unique_ptr<ClassNode> ast;
-	std::shared_ptr<SymbolTable> symbolTable;
+	std::unique_ptr<Arena> arena;
+	ClassNode* ast = nullptr;
+	std::vector<std::unique_ptr<Arena>> bodyArenas; // One per subroutine body parsed as its own task.
+	bool splitBySubroutine = false;                 // Analysed and generated one subroutine per task, too.
+	std::shared_ptr<SymbolTable> symbolTable; // Only kept for --viz-checker; codegen uses the AST bindings.
+
+	// Filled in along the way for the build cache.
+	std::optional<SourceStamp> stamp;      // Size and mtime of the source, taken before it was read.
+	std::vector<NameId> dependencies;      // Other classes the analysis looked at.
+	std::vector<SubroutineCalls> calls;    // What each subroutine calls, for the call graph of --dce.
+	std::vector<std::string> removed;      // Subroutines --dce left out of the generated code.
+	bool folded = false;                   // -O1 constants already folded, before taking bodies for --inline.
+	std::size_t callsInlined = 0;          // Call sites --inline replaced by the callee's body.
+	std::string vmCode;                    // The generated code, or its Hack assembly with --emit=asm (only kept when caching or linking).
+	std::size_t vmCommandsSaved = 0;       // By the peephole optimiser.
+	std::vector<std::string> pooledStrings; // Literals the class takes from the string pool.
+	StaticDemand statics;                  // Counted once parsed, for the budget of the static segment.
+	bool failed = false;                   // Its errors were reported; it is neither generated nor cached.
+};
+
+// Settings that change what code generation produces or keeps.
+struct CompileOptions {
+	int optLevel = 0;      // -O<n>: 0 = code as generated, 1 = constant folding and peephole optimiser.
+	bool poolStrings = true; // Build string literals once at start-up (off with --strict-strings).
+	std::size_t poolLimit = StringPool::MAX_PER_CLASS; // Literals pooled per class, so every static fits in RAM 16-255.
+	bool keepCode = false; // Keep the generated text in the unit for the build cache.
+	bool keepSymbols = false; // Keep each class's symbol table, with its scope history, for --viz-checker.
+	bool eliminateDeadCode = false; // --dce: leave out the subroutines the program can never call.
+	const CallGraph* callGraph = nullptr; // With --dce, solved once every class is analysed.
+	bool inlineCalls = false; // --inline: copy small leaf subroutines into their call sites.
+	const InlineTable* inlineTable = nullptr; // With --inline, filled once every class is analysed.
+	bool emitAsm = false; // --emit=asm: translate each class to Hack assembly and link one .asm instead of writing .vm files.
+	bool writeFiles = true; // Off for the OS library, which only lives in its cache.
+	fs::path osDir;         // --os: the folder of the OS sources linked with the program.
+	fs::path programDir;    // --os: where the OS classes' .vm files go, i.e. the folder of Main.jack.
+	fs::path outputFile;    // --output: link the whole program into this file instead of a .vm per class.
+	bool singlePass = false; // --single-pass: check and generate each subroutine in one go (see singlePassJob).
+};
+
+// Where a class's .vm file goes: next to its source, except that the OS classes of --os go to the program.
+fs::path vmPathOf(const std::string& sourcePath, const CompileOptions& options) {
+	fs::path path(sourcePath);
+	if (!options.osDir.empty() && path.parent_path() == options.osDir) path = options.programDir / path.filename();
+	return path.replace_extension(".vm");
+}
+
+// A file whose source has not changed since the last build, with what the cache knows about it.
+struct CachedFile {
+	std::string filePath;
+	const CacheEntry* entry;
+	SourceStamp stamp;
+};
+
+// CPU time spent in each phase, summed over all workers.
+// Phases overlap once classes are pipelined, so wall-clock per phase is no longer meaningful.
+// With --trace every job and subroutine task is also recorded on a timeline, per file and per thread.
+// Every job reports the errors of its file to `diagnostics` instead of throwing them at the build.
+struct PhaseTimes {
+	std::atomic<std::uint64_t> parseNanos{0};
+	std::atomic<std::uint64_t> analyseNanos{0};
+	std::atomic<std::uint64_t> codeGenNanos{0};
+	TraceRecorder* trace = nullptr;
+	Diagnostics* diagnostics = nullptr;
 };
 
+// The title of a file's spans in the trace.
+std::string traceName(const std::string& filePath) {
+	return fs::path(filePath).filename().string();
+}
+
+// The title of a subroutine task's span in the trace, e.g. "Main.jack main".
+std::string traceName(const std::string& filePath, const SubroutineDecNode& subroutine) {
+	return traceName(filePath) + " " + std::string(nameOf(subroutine.getName()));
+}
+
+// Nodes in the unit's AST, counted by the arenas that hold them.
+std::size_t astNodeCount(const CompilationUnit& unit) {
+	std::size_t nodes = unit.arena->objectCount();
+	for (const auto& arena : unit.bodyArenas) nodes += arena->objectCount();
+	return nodes;
+}
+
+// Adds the time elapsed since 'begin' to a phase counter.
+void chargePhase(std::atomic<std::uint64_t>& counter, const std::chrono::steady_clock::time_point begin) {
+	counter.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - begin).count()), std::memory_order_relaxed);
+}
+
+// Classes at least this big are parsed, analysed and generated one subroutine per task, so a single huge
+// class does not leave the other workers idle. The output is the same either way.
+constexpr std::size_t SPLIT_CLASS_BYTES = 64 * 1024;
+
+// Waits for the per-subroutine tasks of one class and reports the error of every task that failed, for
+// the class's file. Every task is waited for first, since they all work on the unit's memory.
+// Returns false if any task failed.
+bool joinSubroutineTasks(ThreadPool& pool, std::vector<std::future<void>>& tasks, Diagnostics& diagnostics,
+                         const std::string& filePath) {
+	bool ok = true;
+	for (auto& task : tasks) {
+		pool.waitFor(task);
+		try {
+			task.get();
+		} catch (...) {
+			diagnostics.reportCurrentException(filePath);
+			ok = false;
+		}
+	}
+	return ok;
+}
+
 // Job 1: Parse
 // Reads the file, tokenizes it, and builds the AST.
 // Also registers the class and its methods into the GlobalRegistry.
-CompilationUnit parseJob(const std::string& filePath, GlobalRegistry* registry) {
-	auto tokenizer = std::make_unique<Tokenizer>(filePath);
-	const auto symbolTable = std::make_shared<SymbolTable>();
-	Parser parser(*tokenizer, *registry);
-	auto ast = parser.parse();
+// Files restored from the build cache already have their signatures registered, hence registerSignatures.
+// Given a pool, a big class is parsed as an outline (fields and signatures) followed by one task per body.
+// Errors are reported, not thrown: a unit that fails is returned with `failed` set. A split class
+// reports the error of every body, and of the outline, in one go.
+CompilationUnit parseJob(const std::string& filePath, GlobalRegistry* registry, PhaseTimes& times,
+                         const bool registerSignatures = true, ThreadPool* pool = nullptr) {
+	TraceSpan span(times.trace, "parse", traceName(filePath), filePath);
+	const auto begin = std::chrono::steady_clock::now();
+	CompilationUnit unit;
+	unit.filePath = filePath;
+	try {
+		unit.tokenizer = std::make_unique<Tokenizer>(filePath);
+	} catch (...) {
+		times.diagnostics->reportCurrentException(filePath);
+		unit.failed = true;
+		return unit;
+	}
+	unit.arena = std::make_unique<Arena>();
+	Parser parser(*unit.tokenizer, *registry, *unit.arena, registerSignatures);
+
+	std::vector<SourceRange> bodies;
+	if (pool && pool->size() > 1 && unit.tokenizer->sourceText().size() >= SPLIT_CLASS_BYTES) {
+		bodies = unit.tokenizer->scanSubroutineBodies();
+	}
+	if (bodies.size() > 1) parser.deferBodies(bodies);
+
+	// The bodies skipped before an error in the outline are still parsed, for their own errors.
+	try {
+		unit.ast = parser.parse();
+	} catch (...) {
+		times.diagnostics->reportCurrentException(filePath);
+		unit.failed = true;
+	}
+	chargePhase(times.parseNanos, begin);
+	if (unit.failed && parser.deferredBodies().empty()) return unit;
+
+	const std::vector<DeferredBody>& deferred = parser.deferredBodies();
+	std::atomic<std::size_t> bodyTokens{0};
+	if (!deferred.empty()) {
+		std::vector<std::future<void>> tasks;
+		tasks.reserve(deferred.size());
+		for (const DeferredBody& body : deferred) {
+			// The AST takes about six bytes per byte of source; a full-size block per body would mostly sit empty.
+			const std::size_t blockSize = std::clamp<std::size_t>((body.range.end - body.range.begin) * 8, 4 * 1024, 64 * 1024);
+			Arena& bodyArena = *unit.bodyArenas.emplace_back(std::make_unique<Arena>(blockSize));
+			tasks.push_back(pool->submit([&unit, &body, &bodyArena, &bodyTokens, registry, &times] {
+				TraceSpan bodySpan(times.trace, "parse", traceName(unit.filePath, *body.subroutine), unit.filePath);
+				const auto bodyBegin = std::chrono::steady_clock::now();
+				Tokenizer bodyTokenizer(*unit.tokenizer, body.range);
+				Parser(bodyTokenizer, *registry, bodyArena, false).parseBody(body);
+				chargePhase(times.parseNanos, bodyBegin);
+				bodyTokens.fetch_add(bodyTokenizer.tokenCount(), std::memory_order_relaxed);
+				bodySpan.set("bytes", body.range.end - body.range.begin);
+				bodySpan.set("tokens", bodyTokenizer.tokenCount());
+				bodySpan.set("ast_nodes", bodyArena.objectCount());
+			}));
+		}
+		if (!joinSubroutineTasks(*pool, tasks, *times.diagnostics, unit.filePath)) unit.failed = true;
+		if (unit.failed) return unit;
+		unit.splitBySubroutine = true;
+	}
+	unit.statics = staticDemandOf(*unit.tokenizer, *unit.ast);
+	span.set("bytes", unit.tokenizer->sourceText().size());
+	span.set("tokens", unit.tokenizer->tokenCount() + bodyTokens.load());
+	span.set("ast_nodes", astNodeCount(unit));
 	log("[Parsed]    " + filePath);
-	return {filePath, std::move(tokenizer), std::move(ast),symbolTable};
+	return unit;
 };
 
+// Job 1, streaming (--max-inflight): parses only the outline of a file, fields and signatures, to register
+// its signatures, and drops it again. The class is parsed in full once every signature is known.
+// Returns false if the file has errors; they are reported. Otherwise `demand` is set from the outline.
+bool outlineJob(const std::string& filePath, GlobalRegistry* registry, PhaseTimes& times, StaticDemand& demand) {
+	TraceSpan span(times.trace, "parse", traceName(filePath), filePath);
+	const auto begin = std::chrono::steady_clock::now();
+	try {
+		Tokenizer tokenizer(filePath);
+		Arena arena;
+		Parser parser(tokenizer, *registry, arena);
+		const std::vector<SourceRange> bodies = tokenizer.scanSubroutineBodies();
+		parser.deferBodies(bodies);
+		try {
+			demand = staticDemandOf(tokenizer, *parser.parse());
+		} catch (...) {
+			times.diagnostics->reportCurrentException(filePath);
+			// The bodies skipped before the outline error would have been parsed by a full parse, too.
+			for (const DeferredBody& body : parser.deferredBodies()) {
+				try {
+					Tokenizer bodyTokenizer(tokenizer, body.range);
+					Parser(bodyTokenizer, *registry, arena, false).parseBody(body);
+				} catch (...) {
+					times.diagnostics->reportCurrentException(filePath);
+				}
+			}
+			return false;
+		}
+		chargePhase(times.parseNanos, begin);
+		span.set("bytes", tokenizer.sourceText().size());
+		span.set("tokens", tokenizer.tokenCount());
+	} catch (...) {
+		times.diagnostics->reportCurrentException(filePath);
+		return false;
+	}
+	log("[Outlined]  " + filePath);
+	return true;
+}
+
 // Job 2: Analyze
 // Performs semantic analysis (type checking, scope resolution) on the AST.
-void analyzeJob(const CompilationUnit& unit, const GlobalRegistry* registry) {
-	if (!unit.ast) return; // Skip if parse failed
-	SemanticAnalyser analyser(*registry);
-	analyser.analyseClass(*unit.ast,*unit.symbolTable);
+// Every variable reference leaves with its slot binding, so the symbol table is normally dropped here.
+// A split class has each subroutine checked by its own task, against a copy of the class scope.
+// Every subroutine is checked even after one fails; all their errors are reported and the unit is failed.
+void analyzeJob(CompilationUnit& unit, const GlobalRegistry* registry, PhaseTimes& times, const CompileOptions& options,
+                ThreadPool* pool = nullptr) {
+	if (!unit.ast || unit.failed) return; // Skip if parse failed
+	TraceSpan span(times.trace, "analyse", traceName(unit.filePath), unit.filePath);
+	span.set("ast_nodes", astNodeCount(unit));
+	const auto begin = std::chrono::steady_clock::now();
+	SemanticAnalyser analyser(*registry, unit.tokenizer->lines());
+	// The visualiser wants one table holding every scope, so it keeps the class in one piece.
+	if (pool && unit.splitBySubroutine && !options.keepSymbols) {
+		SymbolTable classScope;
+		try {
+			analyser.analyseClassVariables(*unit.ast, classScope);
+		} catch (...) {
+			times.diagnostics->reportCurrentException(unit.filePath);
+			unit.failed = true;
+			return;
+		}
+		const auto subroutines = unit.ast->getSubroutines();
+		std::vector<std::vector<NameId>> dependencies(subroutines.size());
+		std::vector<SubroutineCalls> calls(subroutines.size());
+		std::vector<std::future<void>> tasks;
+		tasks.reserve(subroutines.size());
+		for (std::size_t i = 0; i < subroutines.size(); ++i) {
+			tasks.push_back(pool->submit([&, i] {
+				TraceSpan subSpan(times.trace, "analyse", traceName(unit.filePath, *subroutines[i]), unit.filePath);
+				const auto subBegin = std::chrono::steady_clock::now();
+				SemanticAnalyser subAnalyser(analyser);
+				SymbolTable table(classScope);
+				subAnalyser.analyseSubroutine(*subroutines[i], table);
+				dependencies[i] = subAnalyser.referencedClasses();
+				calls[i] = subAnalyser.subroutineCalls().back();
+				chargePhase(times.analyseNanos, subBegin);
+			}));
+		}
+		chargePhase(times.analyseNanos, begin);
+		if (!joinSubroutineTasks(*pool, tasks, *times.diagnostics, unit.filePath)) {
+			unit.failed = true;
+			return;
+		}
+
+		unit.dependencies = analyser.referencedClasses();
+		for (const auto& classes : dependencies) {
+			unit.dependencies.insert(unit.dependencies.end(), classes.begin(), classes.end());
+		}
+		std::sort(unit.dependencies.begin(), unit.dependencies.end());
+		unit.dependencies.erase(std::unique(unit.dependencies.begin(), unit.dependencies.end()), unit.dependencies.end());
+		unit.calls = std::move(calls);
+		log("[Verified]  " + unit.filePath);
+		return;
+	}
+
+	std::vector<Diagnostic> errors;
+	try {
+		if (options.keepSymbols) {
+			unit.symbolTable = std::make_shared<SymbolTable>(true);
+			analyser.analyseClass(*unit.ast, *unit.symbolTable, &errors);
+		} else {
+			SymbolTable table;
+			analyser.analyseClass(*unit.ast, table, &errors);
+		}
+	} catch (...) {
+		times.diagnostics->reportCurrentException(unit.filePath);
+		unit.failed = true;
+	}
+	for (Diagnostic& error : errors) {
+		error.file = unit.filePath;
+		times.diagnostics->report(std::move(error));
+	}
+	if (!errors.empty()) unit.failed = true;
+	if (unit.failed) return;
+	unit.dependencies = analyser.referencedClasses();
+	unit.calls = analyser.subroutineCalls();
+	chargePhase(times.analyseNanos, begin);
 	log("[Verified]  " + unit.filePath);
 }
 
+// Logs, per subroutine of the class, which calls were inlined: "Main.main <- Point.getX x2, Point.getY".
+void logInlinedCalls(const CompilationUnit& unit, const std::vector<InlinedCall>& calls) {
+	const std::string className(nameOf(unit.ast->getClassName()));
+	for (std::size_t i = 0; i < calls.size();) {
+		const NameId caller = calls[i].caller;
+		std::vector<std::pair<std::string, int>> callees; // In order of first call.
+		for (; i < calls.size() && calls[i].caller == caller; ++i) {
+			const std::string callee = std::string(nameOf(calls[i].callee.className)) + "." +
+			                           std::string(nameOf(calls[i].callee.subroutine));
+			const auto it = std::find_if(callees.begin(), callees.end(), [&](const auto& c) { return c.first == callee; });
+			if (it == callees.end()) callees.emplace_back(callee, 1);
+			else ++it->second;
+		}
+		std::string names;
+		for (const auto& [callee, count] : callees) {
+			names += (names.empty() ? "" : ", ") + callee + (count > 1 ? " x" + std::to_string(count) : "");
+		}
+		log("[Inlined]   " + className + "." + std::string(nameOf(caller)) + " <- " + names);
+	}
+}
+
+// The code of one subroutine of a split class, generated on its own and appended in declaration order.
+struct SubroutineFragment {
+	VMWriter writer;
+	CodeGenerator generator;
+
+	SubroutineFragment(const CodeGenerator& context, const std::size_t reserve) : writer(reserve), generator(context, writer) {}
+};
+
+// The end of Job 3, once every subroutine of the class is generated: the optimiser, then the .vm (or .asm).
+void writeClass(CompilationUnit& unit, VMWriter& writer, const CodeGenerator& generator, PhaseTimes& times,
+                const CompileOptions& options, TraceSpan& span) {
+	const auto begin = std::chrono::steady_clock::now();
+	const fs::path outputPath = vmPathOf(unit.filePath, options);
+	unit.pooledStrings.assign(generator.pooledStrings().begin(), generator.pooledStrings().end());
+	if (options.callGraph) {
+		unit.removed.clear();
+		for (const NameId name : options.callGraph->unreachableOf(unit.ast->getClassName())) unit.removed.emplace_back(nameOf(name));
+		if (!unit.removed.empty()) {
+			std::string names;
+			for (const std::string& name : unit.removed) names += (names.empty() ? "" : ", ") + name;
+			log("[Pruned]    " + unit.filePath + ": " + names);
+		}
+	}
+	unit.callsInlined = generator.inlinedCalls().size();
+	if (options.inlineTable) logInlinedCalls(unit, generator.inlinedCalls());
+
+	if (options.optLevel >= 1) {
+		const OptimizationStats stats = PeepholeOptimizer(writer.code()).run();
+		unit.vmCommandsSaved = stats.saved();
+		log("[Optimized] " + unit.filePath + ": " + std::to_string(stats.before) + " -> " +
+		    std::to_string(stats.after) + " VM commands (saved " + std::to_string(stats.saved()) + ")");
+	}
+
+	std::string text = options.emitAsm   ? HackTranslator::translate(writer.code(), nameOf(unit.ast->getClassName()))
+	                   : options.writeFiles ? writer.saveTo(outputPath)
+	                                        : writer.contents();
+	span.set("vm_commands", writer.code().instructions.size());
+	if (options.optLevel >= 1) span.set("vm_commands_saved", unit.vmCommandsSaved);
+	span.set("bytes_written", text.size());
+	if (options.keepCode || options.emitAsm) unit.vmCode = std::move(text);
+
+	chargePhase(times.codeGenNanos, begin);
+	log(options.emitAsm ? "[Translated] " + unit.filePath
+	    : options.writeFiles ? "[Generated] " + outputPath.string()
+	                         : "[Compiled]  " + unit.filePath);
+}
+
 // Job 3: Compile
 // Generates VM code from the AST and writes it to a .vm file.
-void compileJob(const CompilationUnit& unit, const GlobalRegistry* registry) {
-	if (!unit.ast) return;
+// A split class has each subroutine generated by its own task; the optimisers still see the whole class.
+void compileJob(CompilationUnit& unit, const GlobalRegistry* registry, PhaseTimes& times, const CompileOptions& options,
+                ThreadPool* pool = nullptr) {
+	if (!unit.ast || unit.failed) return;
+	TraceSpan span(times.trace, "codegen", traceName(unit.filePath), unit.filePath);
+	auto begin = std::chrono::steady_clock::now();
+
+	// Classes generate roughly one VM command per four bytes of source; reserving that avoids regrowing.
+	VMWriter writer(unit.tokenizer->sourceText().size() / 4);
+	if (options.optLevel >= 1 && !unit.folded) ConstantFolder(*registry, *unit.arena).foldClass(*unit.ast);
+	CodeGenerator generator(*registry, writer, options.poolStrings, options.poolLimit, options.callGraph, options.inlineTable);
+	if (pool && unit.splitBySubroutine) {
+		generator.beginClass(*unit.ast);
+		const auto subroutines = unit.ast->getSubroutines();
+		const std::size_t reserve = unit.tokenizer->sourceText().size() / 4 / subroutines.size();
+		std::vector<std::unique_ptr<SubroutineFragment>> fragments;
+		std::vector<std::future<void>> tasks;
+		fragments.reserve(subroutines.size());
+		tasks.reserve(subroutines.size());
+		for (std::size_t i = 0; i < subroutines.size(); ++i) {
+			if (!generator.emits(*subroutines[i])) continue;
+			SubroutineFragment& fragment = *fragments.emplace_back(std::make_unique<SubroutineFragment>(generator, reserve));
+			tasks.push_back(pool->submit([&fragment, &times, &unit, sub = subroutines[i]] {
+				TraceSpan subSpan(times.trace, "codegen", traceName(unit.filePath, *sub), unit.filePath);
+				const auto subBegin = std::chrono::steady_clock::now();
+				fragment.generator.compileSubroutine(*sub);
+				chargePhase(times.codeGenNanos, subBegin);
+				subSpan.set("vm_commands", fragment.writer.code().instructions.size());
+			}));
+		}
+		chargePhase(times.codeGenNanos, begin);
+		if (!joinSubroutineTasks(*pool, tasks, *times.diagnostics, unit.filePath)) {
+			unit.failed = true;
+			return;
+		}
+		begin = std::chrono::steady_clock::now();
+		for (const auto& fragment : fragments) generator.appendSubroutine(fragment->generator);
+		generator.endClass();
+	} else {
+		generator.compileClass(*unit.ast);
+	}
+	chargePhase(times.codeGenNanos, begin);
+	writeClass(unit, writer, generator, times, options, span);
+}
+
+// Job 2 + 3, fused (--single-pass)
+// Checks each subroutine and generates its code straight away, while its part of the tree is still in cache,
+// instead of walking the whole class once to analyse it and once more to generate it. The output is the
+// same. Only for a class built on its own (buildJob): with --dce or --inline every class is analysed first.
+// Once a subroutine fails, the rest are still checked but no more code is generated.
+void singlePassJob(CompilationUnit& unit, const GlobalRegistry* registry, PhaseTimes& times, const CompileOptions& options) {
+	if (!unit.ast || unit.failed) return;
+	TraceSpan span(times.trace, "analyse+codegen", traceName(unit.filePath), unit.filePath);
+	span.set("ast_nodes", astNodeCount(unit));
+	auto begin = std::chrono::steady_clock::now();
+	SemanticAnalyser analyser(*registry, unit.tokenizer->lines());
+	SymbolTable classTable;
+	if (options.keepSymbols) unit.symbolTable = std::make_shared<SymbolTable>(true);
+	SymbolTable& table = options.keepSymbols ? *unit.symbolTable : classTable;
+	VMWriter writer(unit.tokenizer->sourceText().size() / 4);
+	CodeGenerator generator(*registry, writer, options.poolStrings, options.poolLimit, options.callGraph, options.inlineTable);
+	ConstantFolder folder(*registry, *unit.arena);
+	std::vector<Diagnostic> errors;
+	try {
+		analyser.analyseClassVariables(*unit.ast, table);
+		chargePhase(times.analyseNanos, begin);
+		begin = std::chrono::steady_clock::now();
+		generator.beginClass(*unit.ast);
+		chargePhase(times.codeGenNanos, begin);
+		for (SubroutineDecNode* sub : unit.ast->getSubroutines()) {
+			begin = std::chrono::steady_clock::now();
+			try {
+				analyser.analyseSubroutine(*sub, table);
+			} catch (const CompileError& e) {
+				errors.push_back(e.diagnostic());
+			}
+			chargePhase(times.analyseNanos, begin);
+			if (!errors.empty()) continue;
+			begin = std::chrono::steady_clock::now();
+			if (options.optLevel >= 1) folder.foldSubroutine(*sub);
+			if (generator.emits(*sub)) generator.compileSubroutine(*sub);
+			chargePhase(times.codeGenNanos, begin);
+		}
+	} catch (...) {
+		times.diagnostics->reportCurrentException(unit.filePath);
+		unit.failed = true;
+	}
+	for (Diagnostic& error : errors) {
+		error.file = unit.filePath;
+		times.diagnostics->report(std::move(error));
+	}
+	if (!errors.empty()) unit.failed = true;
+	if (unit.failed) return;
+	unit.dependencies = analyser.referencedClasses();
+	unit.calls = analyser.subroutineCalls();
+	log("[Verified]  " + unit.filePath);
+
+	begin = std::chrono::steady_clock::now();
+	generator.endClass();
+	chargePhase(times.codeGenNanos, begin);
+	writeClass(unit, writer, generator, times, options, span);
+}
+
+// What the rest of the build needs from a class once its .vm is written: its strings for the pool, its
+// cache entry and its numbers for the report. With --max-inflight this is all that is kept of a unit.
+struct CompiledClass {
+	std::string className;
+	std::vector<std::string> pooledStrings;
+	std::size_t vmCommandsSaved = 0;
+	std::size_t callsInlined = 0;
+	std::optional<CacheEntry> cacheEntry; // When caching, for files with a source stamp.
+	std::string code;                     // With --emit=asm or --output, the class's code, linked at the end of the build.
+	std::string filePath;
+	std::optional<SourceStamp> stamp;
+};
+
+// Runs job(i) for every i in [0, count) on the pool, with at most `limit` jobs started and not yet finished.
+// The caller blocks while the limit is reached (it must not be a pool worker). Rethrows the first failure
+// in index order once every job has finished.
+template <typename Job>
+void runBounded(ThreadPool& pool, const std::size_t count, const std::size_t limit, const Job& job) {
+	std::mutex mtx;
+	std::condition_variable finished;
+	std::size_t running = 0;
+
+	// Frees the slot even when the job throws.
+	struct Slot {
+		std::mutex& mtx;
+		std::condition_variable& finished;
+		std::size_t& running;
+		~Slot() {
+			std::scoped_lock lock(mtx);
+			--running;
+			finished.notify_one();
+		}
+	};
+
+	std::vector<std::future<void>> tasks;
+	tasks.reserve(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		{
+			std::unique_lock lock(mtx);
+			finished.wait(lock, [&] { return running < limit; });
+			++running;
+		}
+		tasks.push_back(pool.submit([&, i] {
+			Slot slot{mtx, finished, running};
+			job(i);
+		}));
+	}
+	for (auto& t : tasks) t.wait();
+	for (auto& t : tasks) t.get();
+}
+
+// Job 2 + 3: Build
+// Once the registry holds every signature a class only depends on itself, so it goes
+// straight from analysis to code generation without waiting for any other class.
+// A split class keeps its two phases even with --single-pass: its subroutines already run as tasks of their
+// own, and those tasks could not share the class's arena to fold at -O1.
+void buildJob(CompilationUnit& unit, const GlobalRegistry* registry, PhaseTimes& times, const CompileOptions& options,
+              ThreadPool* pool = nullptr) {
+	if (options.singlePass && !(pool && unit.splitBySubroutine)) {
+		singlePassJob(unit, registry, times, options);
+		return;
+	}
+	analyzeJob(unit, registry, times, options, pool);
+	compileJob(unit, registry, times, options, pool);
+}
+
+// True if a file still has the contents it had when the cache entry was written.
+// Size and mtime settle almost every case; only a touched-but-same-size file is read and hashed.
+bool sourceUnchanged(const CacheEntry& entry, const std::string& filePath, const SourceStamp& stamp) {
+	if (stamp.size != entry.sourceSize) return false;
+	if (stamp.time == entry.sourceTime) return true;
+	const std::optional<std::string> contents = readFile(filePath);
+	return contents && fnv1a(*contents) == entry.sourceHash;
+}
+
+// Puts a cached class's signatures into the registry, exactly as parsing the file would have.
+void registerCachedSignatures(const CachedFile& file, GlobalRegistry& registry) {
+	Interner& names = Interner::global();
+	const CacheEntry& entry = *file.entry;
+	const NameId className = names.intern(entry.className);
+	if (!registry.registerClass(className)) {
+		// Only the offset is cached; the file is unchanged, so read it again for the line and column.
+		const std::string text = readFile(file.filePath).value_or(std::string());
+		const SourcePosition at = LineIndex(text).position(entry.classOffset);
+		throw CompileError(file.filePath, at.line, at.column, file.filePath + ":" + std::to_string(at.line) + ":" +
+			std::to_string(at.column) + ": Duplicate class definition: Class '" + entry.className +
+			"' is already defined.");
+	}
+	// The cached methods were registered without conflict when the file was parsed, and a second
+	// declaration of the class elsewhere already fails above, so a duplicate cannot come up here.
+	for (const CachedMethod& m : entry.methods) {
+		std::vector<NameId> params;
+		params.reserve(m.parameters.size());
+		for (const std::string& p : m.parameters) params.push_back(names.intern(p));
+		registry.registerMethod(className, names.intern(m.name), names.intern(m.returnType), params,
+			m.isStatic, m.offset);
+	}
+}
+
+// A cached class's part of the call graph, with its names interned again.
+std::vector<SubroutineCalls> cachedCalls(const CacheEntry& entry) {
+	Interner& names = Interner::global();
+	std::vector<SubroutineCalls> calls;
+	calls.reserve(entry.calls.size());
+	for (const CachedCalls& c : entry.calls) {
+		SubroutineCalls& sub = calls.emplace_back();
+		sub.subroutine = names.intern(c.subroutine);
+		sub.callees.reserve(c.callees.size());
+		for (const auto& [className, subroutine] : c.callees) {
+			sub.callees.push_back({names.intern(className), names.intern(subroutine)});
+		}
+	}
+	return calls;
+}
+
+// True if the cached code of a class left out exactly what the call graph now finds unreachable.
+bool sameSubroutinesRemoved(const CacheEntry& entry, const CallGraph& graph) {
+	const std::vector<NameId> unreachable = graph.unreachableOf(Interner::global().intern(entry.className));
+	return std::equal(unreachable.begin(), unreachable.end(), entry.removed.begin(), entry.removed.end(),
+		[](const NameId name, const std::string& removed) { return nameOf(name) == removed; });
+}
+
+// True if every class the cached file depended on still looks the same to it.
+bool dependenciesUnchanged(const CacheEntry& entry, const GlobalRegistry& registry) {
+	Interner& names = Interner::global();
+	return std::all_of(entry.dependencies.begin(), entry.dependencies.end(), [&](const CachedDependency& d) {
+		return registry.fingerprint(names.intern(d.className)) == d.fingerprint;
+	});
+}
+
+// True if a cached class pooled the literals it would pool now: how many fit moves with the program's statics.
+bool poolUnchanged(const CacheEntry& entry, const std::size_t poolLimit) {
+	return std::min<std::size_t>(entry.poolableLiterals, entry.poolLimit) ==
+	       std::min<std::size_t>(entry.poolableLiterals, poolLimit);
+}
+
+// True if no class a cached file calls is being compiled again, so with --inline the bodies the file
+// copied from them are still the same.
+bool inlinedCalleesUnchanged(const CacheEntry& entry, const std::vector<std::string>& rebuiltClasses) {
+	return std::none_of(entry.calls.begin(), entry.calls.end(), [&](const CachedCalls& c) {
+		return std::any_of(c.callees.begin(), c.callees.end(), [&](const auto& callee) {
+			return std::find(rebuiltClasses.begin(), rebuiltClasses.end(), callee.first) != rebuiltClasses.end();
+		});
+	});
+}
+
+// Records a freshly compiled file for the next build.
+CacheEntry makeCacheEntry(const CompilationUnit& unit, const GlobalRegistry& registry, const CompileOptions& options) {
+	CacheEntry entry;
+	entry.sourcePath = unit.filePath;
+	entry.sourceSize = unit.stamp->size;
+	entry.sourceTime = unit.stamp->time;
+	entry.sourceHash = fnv1a(unit.tokenizer->sourceText());
+
+	const NameId className = unit.ast->getClassName();
+	entry.className = std::string(nameOf(className));
+	entry.classOffset = unit.ast->getOffset();
+	for (const auto& [name, sig] : registry.methodsOf(className)) {
+		CachedMethod m{std::string(nameOf(name)), std::string(nameOf(sig->returnType)), {}, sig->isStatic, sig->offset};
+		for (const NameId p : sig->parameters) m.parameters.emplace_back(nameOf(p));
+		entry.methods.push_back(std::move(m));
+	}
 
-	fs::path p(unit.filePath);
-	const fs::path outputPath = p.replace_extension(".vm");
+	for (const NameId dep : unit.dependencies) {
+		entry.dependencies.push_back({std::string(nameOf(dep)), registry.fingerprint(dep)});
+	}
+	for (const SubroutineCalls& c : unit.calls) {
+		CachedCalls& cached = entry.calls.emplace_back();
+		cached.subroutine = std::string(nameOf(c.subroutine));
+		for (const SubroutineRef& callee : c.callees) {
+			cached.callees.emplace_back(nameOf(callee.className), nameOf(callee.subroutine));
+		}
+	}
+	entry.vmCode = unit.vmCode;
+	entry.pooledStrings = unit.pooledStrings;
+	entry.removed = unit.removed;
+	entry.declaredStatics = static_cast<std::uint32_t>(unit.statics.declared);
+	entry.poolableLiterals = static_cast<std::uint32_t>(unit.statics.literals);
+	entry.poolLimit = static_cast<std::uint32_t>(options.poolLimit);
+	if (options.inlineTable) {
+		for (const auto& [subroutine, body] : options.inlineTable->bodiesOf(className)) {
+			entry.inlineBodies.push_back({std::string(nameOf(subroutine)), *body});
+		}
+	}
+	return entry;
+}
 
-	std::ofstream out(outputPath);
-	if (!out) {
-		throw std::runtime_error("Could not open output file: " + outputPath.string());
+// Keeps what the end of the build needs from a unit that has been generated.
+CompiledClass compiledClass(const CompilationUnit& unit, const GlobalRegistry& registry, const bool caching,
+                            const CompileOptions& options) {
+	CompiledClass compiled{std::string(nameOf(unit.ast->getClassName())), unit.pooledStrings, unit.vmCommandsSaved,
+	                       unit.callsInlined, std::nullopt, {}, unit.filePath, unit.stamp};
+	if (caching && unit.stamp) compiled.cacheEntry = makeCacheEntry(unit, registry, options);
+	if (options.emitAsm || !options.outputFile.empty()) compiled.code = unit.vmCode;
+	return compiled;
+}
+
+// Prints how busy each pool worker was over the build window, counting from the stats taken at its start
+// (the pool may have built the OS library of --os before).
+// Low utilisation with a long wall-clock time means workers sat waiting at a phase barrier.
+void printWorkerReport(const ThreadPool& pool, const std::vector<WorkerStats>& before,
+                       const std::chrono::duration<double, std::milli> window) {
+	const double windowMs = window.count();
+	std::vector<WorkerStats> stats = pool.stats();
+	for (std::size_t i = 0; i < stats.size() && i < before.size(); ++i) {
+		stats[i].busyNanos -= before[i].busyNanos;
+		stats[i].tasksRun -= before[i].tasksRun;
+		stats[i].steals -= before[i].steals;
+	}
+
+	double totalBusyMs = 0.0;
+	for (const auto& s : stats) totalBusyMs += static_cast<double>(s.busyNanos) / 1e6;
+	const double capacityMs = windowMs * static_cast<double>(stats.size());
+
+	std::cout << " Workers:        " << stats.size() << " (" << (capacityMs > 0 ? 100.0 * totalBusyMs / capacityMs : 0.0)
+			  << "% utilised, " << (capacityMs - totalBusyMs) << " ms idle)" << std::endl;
+	for (std::size_t i = 0; i < stats.size(); ++i) {
+		const double busyMs = static_cast<double>(stats[i].busyNanos) / 1e6;
+		std::cout << "  Worker " << i << ":      " << busyMs << " ms busy ("
+				  << (windowMs > 0 ? 100.0 * busyMs / windowMs : 0.0) << "%), "
+				  << stats[i].tasksRun << " tasks, " << stats[i].steals << " stolen" << std::endl;
 	}
+}
 
-	CodeGenerator generator(*registry, out,*unit.symbolTable);
-	generator.compileClass(*unit.ast);
+// Prints how much AST arena memory each file needed.
+void printArenaReport(const std::vector<CompilationUnit>& units) {
+	std::size_t totalUsed = 0;
+	std::size_t totalReserved = 0;
+	for (const auto& unit : units) {
+		totalUsed += unit.arena->bytesUsed();
+		totalReserved += unit.arena->bytesReserved();
+		for (const auto& body : unit.bodyArenas) {
+			totalUsed += body->bytesUsed();
+			totalReserved += body->bytesReserved();
+		}
+	}
 
-	log("[Generated] " + outputPath.string());
+	std::cout << " AST Arena:      " << static_cast<double>(totalUsed) / 1024.0 << " KB used, "
+			  << static_cast<double>(totalReserved) / 1024.0 << " KB reserved" << std::endl;
+	for (const auto& unit : units) {
+		std::size_t used = unit.arena->bytesUsed();
+		for (const auto& body : unit.bodyArenas) used += body->bytesUsed();
+		std::cout << "  " << fs::path(unit.filePath).filename().string() << ": " << used << " bytes";
+		if (!unit.bodyArenas.empty()) std::cout << " (split into " << unit.bodyArenas.size() << " subroutines)";
+		std::cout << std::endl;
+	}
 }
 
 // Validates that the Main class has a static void main() function.
@@ -117,7 +829,8 @@ void compileJob(const CompilationUnit& unit, const GlobalRegistry* registry) {
 void validateMainEntry(const GlobalRegistry& registry) {
 	try {
 		// 1. Fetch the signature from the registry
-		const auto sig = registry.getSignature("Main", "main");
+		Interner& names = Interner::global();
+		const MethodSignature& sig = registry.getSignature(names.intern("Main"), names.intern("main"));
 
 		// 2. Check: Must be Static (Function)
 		if (!sig.isStatic) {
@@ -125,7 +838,7 @@ void validateMainEntry(const GlobalRegistry& registry) {
 		}
 
 		// 3. Check: Must return Void
-		if (sig.returnType != "void") {
+		if (sig.returnType != Interner::VOID) {
 			throw std::runtime_error("Error: 'Main.main' must have a 'void' return type.");
 		}
 
@@ -135,8 +848,8 @@ void validateMainEntry(const GlobalRegistry& registry) {
 	}
 }
 
-// Helper to find the 'tools' directory for visualization scripts.
-std::string getToolsDir() {
+// Helper to find a folder of the installed toolchain (~/.jack_toolchain/<name>), or "" if there is none.
+std::string getInstalledDir(const std::string& name) {
 	fs::path homeDir;
 
 	// Check Env Vars
@@ -148,15 +861,20 @@ std::string getToolsDir() {
 	if (home) homeDir = home;
 #endif
 
-	// Check Installed Location (~/.jack_toolchain/tools)
+	// Check Installed Location (~/.jack_toolchain/<name>)
 	if (!homeDir.empty()) {
-		const fs::path installedTools = homeDir / ".jack_toolchain" / "tools";
-		if (fs::exists(installedTools)) return installedTools.string();
+		const fs::path installed = homeDir / ".jack_toolchain" / name;
+		if (fs::exists(installed)) return installed.string();
 	}
 
 	return "";
 }
 
+// Helper to find the 'tools' directory for visualization scripts.
+std::string getToolsDir() {
+	return getInstalledDir("tools");
+}
+
 // Helper to get a temporary file path.
 fs::path getTempPath(const std::string& filename) {
 	try {
@@ -166,27 +884,19 @@ fs::path getTempPath(const std::string& filename) {
 	}
 }
 
-// Launches the unified visualization dashboard (Registry + Symbol Tables).
-void runUnifiedViz(const GlobalRegistry& registry, const std::vector<CompilationUnit>& units) {
-	// 1. Dump Registry to Temp
-	std::string regPath = getTempPath("jack_unified_reg.json").string();
-	registry.dumpToJSON(regPath);
-
-	// 2. Dump Symbol Tables for all files
-	std::vector<std::string> symPaths;
+// Writes the registry and every unit's AST (and symbol table, if kept) into one binary program file.
+void saveProgramBinary(const fs::path& path, const GlobalRegistry& registry, const std::vector<CompilationUnit>& units) {
+	BinaryWriter writer;
 	for (const auto& unit : units) {
-		if (!unit.symbolTable) continue;
-
-		// Create a unique filename for each symbol table
-		size_t h = std::hash<std::string>{}(unit.filePath);
-		std::string name = fs::path(unit.filePath).stem().string();
-		std::string path = "/tmp/jack_sym_" + name + "_" + std::to_string(h) + ".json";
-
-		unit.symbolTable->dumpToJSON(name, path);
-		symPaths.push_back(path);
+		if (unit.ast) writer.addClass(unit.filePath, *unit.ast, unit.symbolTable.get());
 	}
+	writer.addRegistry(registry);
+	writer.save(path);
+}
 
-	// 3. Locate the Python Script
+// Launches the unified visualization dashboard (Registry + Symbol Tables).
+void runUnifiedViz(const GlobalRegistry& registry, const std::vector<CompilationUnit>& units) {
+	// 1. Locate the Python Script
 	std::string toolsDir = getToolsDir();
 	if (toolsDir.empty()) {
 		std::cerr << "Error: 'tools' folder not found. Cannot launch visualization." << std::endl;
@@ -196,29 +906,27 @@ void runUnifiedViz(const GlobalRegistry& registry, const std::vector<Compilation
 	fs::path script = fs::path(toolsDir) / "unified_viz.py";
 	std::string absScriptPath = fs::absolute(script).string();
 
-	// 4. Construct Command
+	// 2. Dump the Registry and all Symbol Tables to one Temp file (the dashboard removes it)
+	const std::string programPath = getTempPath("jack_unified_" + std::to_string(getpid()) + ".jkb").string();
+	saveProgramBinary(programPath, registry, units);
+
+	// 3. Construct Command
 	std::string cmd;
 	#ifdef _WIN32
-		cmd = "python \"" + absScriptPath + "\" --registry \"" + regPath + "\"";
+		cmd = "python \"" + absScriptPath + "\" --program \"" + programPath + "\"";
 	#else
-		cmd = "python3 \"" + absScriptPath + "\" --registry \"" + regPath + "\"";
+		cmd = "python3 \"" + absScriptPath + "\" --program \"" + programPath + "\"";
 	#endif
 
-	if (!symPaths.empty()) {
-		cmd += " --symbols";
-		for (const auto& p : symPaths) cmd += " \"" + p + "\"";
-	}
-
-	// 5. Run (Blocks until you close the dashboard)
+	// 4. Run (Blocks until you close the dashboard)
 	std::system(cmd.c_str());
 
-	// 6. Cleanup Temp Files
-	if (fs::exists(regPath)) fs::remove(regPath);
-	for (const auto& p : symPaths) if (fs::exists(p)) fs::remove(p);
+	// 5. Cleanup Temp File
+	if (fs::exists(programPath)) fs::remove(programPath);
 }
 
 // Launches the AST visualization tool for all compiled units.
-void runBatchAstViz(const std::vector<CompilationUnit>& units) {
+void runBatchAstViz(const GlobalRegistry& registry, const std::vector<CompilationUnit>& units) {
 	std::string toolsDir = getToolsDir();
 	if (toolsDir.empty()) {
 		std::cerr << "Error: 'tools' folder not found." << std::endl;
@@ -228,196 +936,1217 @@ void runBatchAstViz(const std::vector<CompilationUnit>& units) {
 	fs::path scriptPath = fs::path(toolsDir) / "jack_viz.py";
 	std::string absScriptPath = fs::absolute(scriptPath).string();
 
-	std::vector<std::string> tempFiles;
-	std::string pyArgs = "";
-
-	// 1. Generate ALL XML files
-	for (const auto& unit : units) {
-		if (!unit.ast) continue;
-
-		// Create unique filename
-		size_t pathHash = std::hash<std::string>{}(unit.filePath);
-		std::string niceName = fs::path(unit.filePath).stem().string();
-		std::string xmlFilename = niceName + "_" + std::to_string(pathHash) + ".xml";
-
-		fs::path xmlPath = getTempPath(xmlFilename);
-
-		std::ofstream xmlFile(xmlPath);
-		unit.ast->printXml(xmlFile, 0);
-		xmlFile.close();
-
-		tempFiles.push_back(xmlPath.string());
-
-		pyArgs += " \"" + xmlPath.string() + "\"";
-	}
-	if (tempFiles.empty()) return;
+	// 1. Generate one binary file holding ALL ASTs
+	const fs::path programPath = getTempPath("jack_ast_" + std::to_string(getpid()) + ".jkb");
+	saveProgramBinary(programPath, registry, units);
 
 	// 2. Build the command
 	std::string cmd;
 	#ifdef _WIN32
 		// Windows: start /b (background)
-		cmd = "start /b python \"" + absScriptPath + "\"" + pyArgs;
+		cmd = "start /b python \"" + absScriptPath + "\" \"" + programPath.string() + "\"";
 	#else
 		// Linux/Mac: python3, rm, &
-		std::string cleanupCmd = "rm -f";
-		for (const auto& f : tempFiles) cleanupCmd += " \"" + f + "\"";
-		cmd = "(python3 \"" + absScriptPath + "\"" + pyArgs + " && " + cleanupCmd + ") &";
+		cmd = "(python3 \"" + absScriptPath + "\" \"" + programPath.string() + "\" && rm -f \"" +
+		      programPath.string() + "\") &";
 	#endif
 
 	std::system(cmd.c_str());
 }
 
-int main(int argc, char* argv[]) {
-	// Optimization: Disable C-style I/O synchronization for speed
-	std::ios_base::sync_with_stdio(false);
+// What the command line asked for. With --daemon, every build runs with the same settings.
+struct Settings {
+	std::vector<fs::path> inputs; // The .jack files and folders given (folders are listed again on every build).
+	CompileOptions options;
+	std::size_t jobs = 0; // 0 = hardware concurrency
+	bool useCache = true;
+	bool vizAst = false;
+	bool vizSymbols = false;
+	fs::path programPath; // Empty without --dump-program.
+	bool daemon = false;
+	fs::path tracePath;   // Empty without --trace.
+	std::size_t maxInflight = 0; // --max-inflight: 0 = every unit stays in memory until the build is done.
+	bool library = false; // Builds the OS library of --os: no Main.jack, nothing linked, only the cache is written.
+};
 
-	if (argc < 2) {
-		std::cerr << "Usage: JackCompiler <file.jack or directory>" << std::endl;
-		return 1;
+// A source file whose class is in the daemon's registry, as it was when the class was registered.
+struct RegisteredSource {
+	NameId className;
+	SourceStamp stamp;
+};
+
+// What outlives a single build: the workers and the build cache.
+// A normal run makes one build with it; a daemon keeps it warm across all of its rebuilds.
+struct Session {
+	ThreadPool pool; // One fixed set of workers serves every phase; no phase spawns threads of its own.
+	std::unique_ptr<BuildCache> cache;
+	fs::path cacheFile;
+	std::unique_ptr<BuildCache> osLibrary; // With --os: the OS classes, compiled once and kept next to their sources.
+	fs::path osLibraryFile;
+	// --daemon: the registry of the last successful build, and the file each of its classes came from.
+	// The next build only removes and registers again the classes whose file changed (see parseProgram).
+	std::unique_ptr<GlobalRegistry> registry;
+	std::unordered_map<std::string, RegisteredSource> registered;
+
+	explicit Session(const std::size_t jobs) : pool(jobs) {}
+};
+
+// The outcome of one build, for the daemon's reply.
+struct BuildSummary {
+	bool ok = false;
+	std::size_t compiled = 0;
+	std::size_t upToDate = 0;
+};
+
+// Lists the .jack files to compile: the files given, and the .jack files directly inside each folder given.
+std::vector<std::string> collectSourceFiles(const std::vector<fs::path>& inputs) {
+	std::vector<std::string> files;
+	for (const fs::path& input : inputs) {
+		if (!fs::is_directory(input)) {
+			files.push_back(fs::absolute(input).string());
+			continue;
+		}
+		bool foundAny = false;
+		// Iterate over files in the directory
+		for (const auto& entry : fs::directory_iterator(input)) {
+			if (entry.path().extension() == ".jack") {
+				files.push_back(fs::absolute(entry.path()).string());
+				foundAny = true;
+			}
+		}
+		if (!foundAny) {
+			std::cerr << "Warning: No .jack files found in folder: " << input << std::endl;
+		}
 	}
+	return files;
+}
 
+// Writes the build cache out. Failing to do so only costs the next build some time.
+void saveCache(const BuildCache& cache) {
 	try {
-		const auto startTotal = std::chrono::high_resolution_clock::now();
+		cache.save();
+	} catch (const std::exception& e) {
+		std::cerr << "Warning: " << e.what() << " (build cache not updated)" << std::endl;
+	}
+}
 
-		std::vector<std::string> userFiles;
+BuildSummary build(const Settings& settings, Session& session);
+
+// Brings the OS library of --os up to date: the OS sources built on their own, always with the optimising
+// passes, into a cache in their folder that holds both the signatures and the code. Only classes whose
+// source changed are compiled again, so normally this just loads the cache. False if the OS fails to build.
+bool updateOsLibrary(const Settings& settings, Session& session) {
+	Settings library;
+	library.inputs = {settings.options.osDir};
+	library.jobs = settings.jobs;
+	library.options.optLevel = 1;
+	library.options.poolStrings = false; // OS classes never take their strings from the pool anyway.
+	library.options.inlineCalls = true;
+	library.options.emitAsm = settings.options.emitAsm;
+	library.options.writeFiles = false;
+	library.library = true;
+	const BuildSummary summary = build(library, session);
+	if (summary.ok && summary.compiled > 0 && !settings.daemon) {
+		log("[OS]        " + settings.options.osDir.string() + ": " + std::to_string(summary.compiled) +
+		    " classes compiled into the library");
+	}
+	return summary.ok;
+}
 
-		bool vizAst = false;
-		bool vizSymbols = false;
-		// Iterate through ALL command line arguments
-		for (int i = 1; i < argc; ++i) {
-			std::string arg = argv[i];
-			if (arg == "--viz-ast") {
-				vizAst = true;
-				continue;
+// Prints every error of a failed build, sorted by file and line, with their count.
+void reportFailure(const Diagnostics& diagnostics) {
+	std::cerr << "\n COMPILATION FAILED" << std::endl;
+	diagnostics.print(std::cerr);
+}
+
+// Everything one build carries from phase to phase. build() runs the phases below in order; each works on
+// what the ones before it left here, and a phase that returns false has ended the build (its errors are
+// in `diagnostics`).
+struct BuildState {
+	const Settings& settings;
+	Session& session;
+	Diagnostics& diagnostics;
+	TraceRecorder* trace = nullptr;
+	CompileOptions options;
+	bool linkVm = false;    // --output links the .vm code of every class in memory instead of writing a file per class.
+	bool streaming = false; // --max-inflight: no unit is kept past the phase that uses it.
+
+	// Collected: the sources, and which of them the build cache already has.
+	std::vector<std::string> userFiles;
+	std::size_t firstOsFile = 0; // The OS classes of --os come last.
+	const BuildCache* osLibrary = nullptr;
+	fs::path mainDir;
+	BuildCache* cache = nullptr;
+	std::vector<std::optional<SourceStamp>> stamps;
+	std::vector<std::size_t> toParse; // Indices into userFiles, largest file first.
+	std::vector<CachedFile> cachedFiles;
+
+	// Parsed: every signature is in the registry, and every class is either up to date or in `units`
+	// (with streaming, in `sources`, to be parsed again).
+	std::unique_ptr<GlobalRegistry> registry;
+	PhaseTimes phaseTimes;
+	std::vector<CompilationUnit> units;
+	std::vector<StaticDemand> outlined; // Streaming keeps only this of each parsed file.
+	std::vector<const CachedFile*> upToDate;
+	std::vector<const CachedFile*> toRebuild;
+	std::vector<std::pair<std::string, std::optional<SourceStamp>>> sources;
+
+	// Whole-program analysis (--dce, --inline).
+	CallGraph callGraph;
+	InlineTable inlineTable;
+
+	// Generated.
+	std::vector<CompiledClass> compiled;
+
+	std::chrono::high_resolution_clock::time_point startTotal;
+	std::chrono::high_resolution_clock::time_point startParse;
+	std::chrono::high_resolution_clock::time_point endParse;
+	std::chrono::high_resolution_clock::time_point startBuild;
+	std::chrono::high_resolution_clock::time_point endBuild;
+	std::vector<WorkerStats> statsBefore;
+
+	BuildState(const Settings& settings, Session& session, Diagnostics& diagnostics)
+		: settings(settings), session(session), diagnostics(diagnostics), options(settings.options) {}
+};
+
+// Phase 0: lists the sources (adding the OS classes of --os), orders them largest first and looks each up
+// in the build cache. False if there is nothing to build; the reason is printed.
+bool collectSources(BuildState& state) {
+	const Settings& settings = state.settings;
+	CompileOptions& options = state.options;
+	std::vector<std::string>& userFiles = state.userFiles;
+	userFiles = collectSourceFiles(settings.inputs);
+	state.linkVm = !options.outputFile.empty() && !options.emitAsm;
+	if (state.linkVm) options.writeFiles = false;
+
+	if (userFiles.empty()) {
+		std::cerr << "No files provided." << std::endl;
+		return false;
+	}
+
+	// Check for Main.jack
+	bool hasMain = settings.library;
+	fs::path& mainDir = state.mainDir;
+	mainDir = settings.library ? settings.inputs.front() : fs::path();
+	for (const auto& file : userFiles) {
+		if (!settings.library && fs::path(file).filename() == "Main.jack") {
+			hasMain = true;
+			mainDir = fs::path(file).parent_path();
+			break;
+		}
+	}
+
+	if (!hasMain) {
+		std::cerr << "\nError: Compilation Failed." << std::endl;
+		std::cerr << "Reason: Missing 'Main.jack'" << std::endl;
+		std::cerr << "The list of files to compile must include the Main class." << std::endl;
+		return false;
+	}
+
+	// --- OS LIBRARY (--os) ---
+	// Every OS class the program does not write itself is added from the library, and from then on is
+	// built like any other class (the library stands in for its cache entry), except that its .vm file
+	// goes next to Main.jack. A program class with the name of an OS class replaces it.
+	state.firstOsFile = settings.library ? 0 : userFiles.size();
+	if (!settings.library && !options.osDir.empty()) {
+		if (!updateOsLibrary(settings, state.session)) {
+			std::cerr << "Error: The OS in " << options.osDir << " failed to compile." << std::endl;
+			return false;
+		}
+		state.osLibrary = state.session.osLibrary.get();
+		options.programDir = mainDir;
+		std::vector<std::string> programClasses;
+		for (const auto& file : userFiles) programClasses.push_back(fs::path(file).stem().string());
+		for (std::string& file : collectSourceFiles({options.osDir})) {
+			const std::string name = fs::path(file).stem().string();
+			if (std::find(programClasses.begin(), programClasses.end(), name) == programClasses.end()) {
+				userFiles.push_back(std::move(file));
 			}
-			if (arg == "--viz-checker") {
-				vizSymbols = true;
-				continue;
+		}
+	}
+
+	// Biggest files first: the longest tasks start immediately and the small ones fill the gaps,
+	// instead of one late-starting giant class becoming the straggler.
+	std::vector<std::uintmax_t> fileSizes;
+	fileSizes.reserve(userFiles.size());
+	for (const auto& f : userFiles) {
+		std::error_code ec;
+		const std::uintmax_t size = fs::file_size(f, ec);
+		fileSizes.push_back(ec ? 0 : size);
+	}
+	std::vector<std::size_t> order(userFiles.size());
+	for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&](const std::size_t a, const std::size_t b) {
+		return fileSizes[a] > fileSizes[b];
+	});
+
+	// --- BUILD CACHE ---
+	// Files whose source is unchanged contribute their signatures from the cache instead of being parsed.
+	// The visualisers need every AST, so they bypass the lookup (the cache is still refreshed).
+	// The key covers every option that changes the output, so switching them never reuses stale code.
+	// A daemon loads it once and then keeps it up to date in memory.
+	// The OS library has a cache of its own, one per output format, in the folder of the OS sources.
+	const fs::path cacheFile = settings.library ? mainDir / (options.emitAsm ? ".jack_os_asm" : ".jack_os_vm")
+	                                            : mainDir / ".jack_cache";
+	std::unique_ptr<BuildCache>& sessionCache = settings.library ? state.session.osLibrary : state.session.cache;
+	fs::path& sessionCacheFile = settings.library ? state.session.osLibraryFile : state.session.cacheFile;
+	if (!sessionCache || sessionCacheFile != cacheFile) {
+		sessionCache = std::make_unique<BuildCache>(cacheFile, "vm-O" + std::to_string(options.optLevel) +
+		                                            (options.poolStrings ? "-pool" : "-strict") +
+		                                            (options.eliminateDeadCode ? "-dce" : "") +
+		                                            (options.inlineCalls ? "-inline" : "") +
+		                                            (options.emitAsm ? "-asm" : "") +
+		                                            (state.osLibrary ? "-os" : ""));
+		sessionCacheFile = cacheFile;
+		if (settings.useCache && !settings.vizAst && !settings.vizSymbols && settings.programPath.empty()) sessionCache->load();
+	}
+	state.cache = sessionCache.get();
+
+	state.stamps.resize(userFiles.size());
+	for (const std::size_t i : order) {
+		const bool fromLibrary = state.osLibrary && i >= state.firstOsFile;
+		std::optional<SourceStamp>& stamp = state.stamps[i];
+		if (settings.useCache || fromLibrary) stamp = BuildCache::stamp(userFiles[i]);
+		const CacheEntry* entry = state.cache->find(userFiles[i]);
+		if (fromLibrary && !(entry && stamp && sourceUnchanged(*entry, userFiles[i], *stamp))) {
+			entry = state.osLibrary->find(userFiles[i]);
+		}
+		if (entry && stamp && sourceUnchanged(*entry, userFiles[i], *stamp)) {
+			state.cachedFiles.push_back({userFiles[i], entry, *stamp});
+		} else {
+			state.toParse.push_back(i);
+		}
+	}
+	return true;
+}
+
+// The statics of every class and the slots of their pooled literals share the 240 words of the static
+// segment. Each class pools as many literals as still fit and builds the rest in place; a program whose
+// own statics do not fit cannot run at all, which is reported.
+void budgetStaticSegment(BuildState& state) {
+	std::size_t declaredStatics = 0;
+	std::vector<std::size_t> literals;
+	const auto addDemand = [&](const StaticDemand& demand) {
+		declaredStatics += demand.declared;
+		literals.push_back(demand.literals);
+	};
+	for (const CachedFile& file : state.cachedFiles) addDemand({file.entry->declaredStatics, file.entry->poolableLiterals});
+	for (const CompilationUnit& unit : state.units) addDemand(unit.statics);
+	for (const StaticDemand& demand : state.outlined) addDemand(demand);
+	if (declaredStatics > ProgramLinker::MAX_STATICS) {
+		state.diagnostics.report({"", 0, 0, "Error: The program declares " + std::to_string(declaredStatics) +
+			" static variables, more than the " + std::to_string(ProgramLinker::MAX_STATICS) + " the Hack RAM holds."});
+	} else if (state.options.poolStrings) {
+		state.options.poolLimit = StringPool::perClassLimit(ProgramLinker::MAX_STATICS - declaredStatics, literals);
+		if (state.options.poolLimit < StringPool::MAX_PER_CLASS) {
+			log("[Strings]   At most " + std::to_string(state.options.poolLimit) + " pooled literals per class, to fit the static segment");
+		}
+	}
+}
+
+// A daemon keeps its registry from one build to the next; the OS library of --os is built afresh.
+bool keepsRegistry(const Settings& settings) {
+	return settings.daemon && settings.useCache && !settings.library;
+}
+
+// Phase 1: Parsing
+// This is the only global barrier: analysis needs every signature, and signatures are registered while
+// parsing. Cached files register theirs from the cache; the ones whose dependencies changed are parsed
+// again once every signature is in. False if any file has syntax errors.
+// Streaming (--max-inflight) keeps no unit past this phase: only the registry, i.e. the signatures
+// and the names they use, stays behind. Each class is then parsed again, compiled and released,
+// with a bounded number in memory at a time. The visualisers need every unit, so they turn it off.
+bool parseProgram(BuildState& state) {
+	const Settings& settings = state.settings;
+	const CompileOptions& options = state.options;
+	const std::vector<std::string>& userFiles = state.userFiles;
+	Session& session = state.session;
+	PhaseTimes& phaseTimes = state.phaseTimes;
+	ThreadPool& pool = state.session.pool;
+	TraceRecorder* trace = state.trace;
+	const bool streaming = state.streaming =
+		settings.maxInflight > 0 && !settings.vizAst && !settings.vizSymbols && settings.programPath.empty();
+
+	state.startParse = std::chrono::high_resolution_clock::now();
+	state.statsBefore = pool.stats();
+	if (trace) trace->begin("build", "Parsing", state.mainDir.string());
+
+	// A daemon starts from the registry of its last successful build. A cached file registered there with
+	// the same stamp keeps its class; the class of every other file it registered is removed first.
+	const bool reusable = keepsRegistry(settings);
+	std::vector<bool> stillRegistered(state.cachedFiles.size(), false);
+	if (reusable && session.registry) {
+		state.registry = std::move(session.registry);
+		state.registry->thaw();
+		std::unordered_map<std::string, RegisteredSource> registered = std::move(session.registered);
+		for (std::size_t i = 0; i < state.cachedFiles.size(); ++i) {
+			const auto it = registered.find(state.cachedFiles[i].filePath);
+			if (it == registered.end() || !(it->second.stamp == state.cachedFiles[i].stamp)) continue;
+			stillRegistered[i] = true;
+			registered.erase(it);
+		}
+		for (const auto& [file, source] : registered) state.registry->removeClass(source.className);
+	} else {
+		state.registry = std::make_unique<GlobalRegistry>(reusable);
+	}
+	GlobalRegistry& registry = *state.registry;
+	for (std::size_t i = 0; i < state.cachedFiles.size(); ++i) {
+		if (stillRegistered[i]) continue;
+		const CachedFile& file = state.cachedFiles[i];
+		try {
+			registerCachedSignatures(file, registry);
+		} catch (...) {
+			state.diagnostics.reportCurrentException(file.filePath);
+		}
+	}
+
+	if (streaming) {
+		state.outlined.resize(state.toParse.size());
+		runBounded(pool, state.toParse.size(), settings.maxInflight, [&](const std::size_t t) {
+			outlineJob(userFiles[state.toParse[t]], &registry, phaseTimes, state.outlined[t]);
+		});
+	} else {
+		std::vector<std::future<CompilationUnit>> parseTasks;
+		parseTasks.reserve(state.toParse.size());
+		for (const std::size_t i : state.toParse) {
+			const std::string& f = userFiles[i];
+			parseTasks.push_back(pool.submit([&f, &registry, &phaseTimes, &pool] {
+				return parseJob(f, &registry, phaseTimes, true, &pool);
+			}));
+		}
+
+		// Every task is waited for before a failure is rethrown: they all use this build's registry.
+		for (auto& t : parseTasks) t.wait();
+		for (std::size_t t = 0; t < parseTasks.size(); ++t) {
+			auto unit = parseTasks[t].get();
+			unit.stamp = state.stamps[state.toParse[t]];
+			if (unit.ast && !unit.failed) state.units.push_back(std::move(unit));
+		}
+	}
+	budgetStaticSegment(state);
+	// Analysis would trip over every signature a failed file did not get to register, so this is as
+	// far as a build with syntax errors, or too many statics, goes (having found the errors of every file).
+	if (state.diagnostics.count() > 0) {
+		if (trace) trace->end({{"files", state.toParse.size()}, {"cached", state.cachedFiles.size()}});
+		return false;
+	}
+	// Sys.init calls the program's Main.main, which the OS library only knows by its required signature.
+	if (settings.library) {
+		Interner& names = Interner::global();
+		registry.registerClass(names.intern("Main"));
+		registry.registerMethod(names.intern("Main"), names.intern("main"), Interner::VOID, {}, true, 0);
+	}
+	// The OS classes keep behaving like the built-in OS, e.g. -O1 still does arithmetic on Math's behalf.
+	for (std::size_t i = state.firstOsFile; i < userFiles.size(); ++i) {
+		registry.markOsSource(Interner::global().intern(fs::path(userFiles[i]).stem().string()));
+	}
+	// Every signature is in; from here on the registry is read-only and lock-free.
+	registry.freeze();
+
+	// A cached file whose dependencies changed must be rebuilt; parse it again, without re-registering.
+	std::vector<const CachedFile*>& upToDate = state.upToDate;
+	std::vector<const CachedFile*>& toRebuild = state.toRebuild;
+	for (const CachedFile& file : state.cachedFiles) {
+		if (dependenciesUnchanged(*file.entry, registry) && poolUnchanged(*file.entry, options.poolLimit)) {
+			upToDate.push_back(&file);
+		} else {
+			toRebuild.push_back(&file);
+		}
+	}
+	// A caller holds copies of its callees' bodies, so it is rebuilt whenever a class it calls is.
+	if (options.inlineCalls) {
+		std::vector<std::string> rebuiltClasses; // A class is named after its file.
+		for (const std::size_t i : state.toParse) rebuiltClasses.push_back(fs::path(userFiles[i]).stem().string());
+		for (const CachedFile* file : toRebuild) rebuiltClasses.push_back(file->entry->className);
+		const std::vector<const CachedFile*> unchanged = std::move(upToDate);
+		upToDate.clear();
+		for (const CachedFile* file : unchanged) {
+			if (inlinedCalleesUnchanged(*file->entry, rebuiltClasses)) {
+				upToDate.push_back(file);
+			} else {
+				toRebuild.push_back(file);
 			}
+		}
+	}
+	if (!streaming) {
+		std::vector<std::future<CompilationUnit>> reparseTasks;
+		reparseTasks.reserve(toRebuild.size());
+		for (const CachedFile* file : toRebuild) {
+			reparseTasks.push_back(pool.submit([file, &registry, &phaseTimes, &pool] {
+				CompilationUnit unit = parseJob(file->filePath, &registry, phaseTimes, false, &pool);
+				unit.stamp = file->stamp;
+				return unit;
+			}));
+		}
+		for (auto& t : reparseTasks) t.wait();
+		for (auto& t : reparseTasks) {
+			auto unit = t.get();
+			if (unit.ast && !unit.failed) state.units.push_back(std::move(unit));
+		}
+	}
+	state.endParse = std::chrono::high_resolution_clock::now();
+	if (trace) trace->end({{"files", state.toParse.size()}, {"cached", state.cachedFiles.size()}});
+
+	// Validate Entry Point. Every class can still be checked without it, so the build carries on.
+	if (!settings.library) {
+		try {
+			validateMainEntry(registry);
+		} catch (...) {
+			state.diagnostics.reportCurrentException((state.mainDir / "Main.jack").string());
+		}
+	}
 
-			fs::path inputPathArg = arg;
+	// Streaming compiles these again, one bounded batch at a time, in the order `units` would have had.
+	if (streaming) {
+		state.sources.reserve(state.toParse.size() + toRebuild.size());
+		for (const std::size_t i : state.toParse) state.sources.emplace_back(userFiles[i], state.stamps[i]);
+		for (const CachedFile* file : toRebuild) state.sources.emplace_back(file->filePath, file->stamp);
+	}
+	return true;
+}
 
-			if (!fs::exists(inputPathArg)) {
-				std::cerr << "Error: Path does not exist: " << inputPathArg << std::endl;
-				return 1;
+// -O1 folds before the bodies of --inline are taken, so callers get the optimised code of their callees.
+void prepareForInlining(CompilationUnit& unit, const GlobalRegistry& registry, const CompileOptions& options) {
+	if (options.inlineCalls && options.optLevel >= 1) {
+		ConstantFolder(registry, *unit.arena).foldClass(*unit.ast);
+		unit.folded = true;
+	}
+}
+
+// Phase 2a: Whole-program analysis (--dce, --inline)
+// The call graph and the table of bodies to inline span the whole program, so every class is
+// analysed before any code is generated; cached classes bring their part of both along. Streaming
+// analyses in a pass of its own and keeps only the calls and the bodies.
+// With --dce, a cached class whose unreachable subroutines changed is compiled again.
+// False if any class has errors: without it the call graph and the inline table are incomplete.
+bool analyseWholeProgram(BuildState& state) {
+	const Settings& settings = state.settings;
+	CompileOptions& options = state.options;
+	GlobalRegistry& registry = *state.registry;
+	PhaseTimes& phaseTimes = state.phaseTimes;
+	ThreadPool& pool = state.session.pool;
+	TraceRecorder* trace = state.trace;
+	CallGraph& callGraph = state.callGraph;
+	InlineTable& inlineTable = state.inlineTable;
+	std::vector<CompilationUnit>& units = state.units;
+	state.startBuild = std::chrono::high_resolution_clock::now();
+	if (!options.eliminateDeadCode && !options.inlineCalls) return true;
+
+	if (trace) trace->begin("build", "Whole program", state.mainDir.string());
+	if (state.streaming) {
+		const auto& sources = state.sources;
+		std::vector<std::pair<NameId, std::vector<SubroutineCalls>>> streamedCalls(sources.size());
+		std::mutex inlineMutex;
+		runBounded(pool, sources.size(), settings.maxInflight, [&](const std::size_t t) {
+			CompilationUnit unit = parseJob(sources[t].first, &registry, phaseTimes, false, &pool);
+			analyzeJob(unit, &registry, phaseTimes, options, &pool);
+			if (unit.failed) return;
+			prepareForInlining(unit, registry, options);
+			if (options.inlineCalls) {
+				std::scoped_lock lock(inlineMutex);
+				inlineTable.addClass(registry, *unit.ast, options.poolStrings, options.poolLimit);
 			}
+			streamedCalls[t] = {unit.ast->getClassName(), std::move(unit.calls)};
+		});
+		for (const auto& [className, calls] : streamedCalls) callGraph.addClass(className, calls);
+	} else {
+		std::vector<std::future<void>> analyseTasks;
+		analyseTasks.reserve(units.size());
+		for (auto& unit : units) {
+			analyseTasks.push_back(pool.submit([&unit, &registry, &phaseTimes, &options, &pool] {
+				analyzeJob(unit, &registry, phaseTimes, options, &pool);
+				if (!unit.failed) prepareForInlining(unit, registry, options);
+			}));
+		}
+		for (auto& t : analyseTasks) t.wait();
+		for (auto& t : analyseTasks) t.get();
+		for (const auto& unit : units) {
+			if (unit.failed) continue;
+			callGraph.addClass(unit.ast->getClassName(), unit.calls);
+			if (options.inlineCalls) inlineTable.addClass(registry, *unit.ast, options.poolStrings, options.poolLimit);
+		}
+	}
+	for (const CachedFile* file : state.upToDate) {
+		const NameId className = Interner::global().intern(file->entry->className);
+		callGraph.addClass(className, cachedCalls(*file->entry));
+		for (const CachedInline& cached : file->entry->inlineBodies) {
+			inlineTable.add(className, Interner::global().intern(cached.subroutine), cached.body);
+		}
+	}
+	if (options.inlineCalls) options.inlineTable = &inlineTable;
+	if (state.diagnostics.count() > 0) {
+		if (trace) trace->end({});
+		return false;
+	}
 
-			if (fs::is_directory(inputPathArg)) {
-				bool foundAny = false;
-				// Iterate over files in the directory
-				for (const auto& entry : fs::directory_iterator(inputPathArg)) {
-					if (entry.path().extension() == ".jack") {
-						userFiles.push_back(fs::absolute(entry.path()).string());
-						foundAny = true;
-					}
-				}
-				if (!foundAny) {
-					std::cerr << "Warning: No .jack files found in folder: " << inputPathArg << std::endl;
-				}
+	if (options.eliminateDeadCode) {
+		callGraph.addDefaultRoots();
+		callGraph.solve();
+		options.callGraph = &callGraph;
+
+		std::vector<const CachedFile*> stillUpToDate;
+		for (const CachedFile* file : state.upToDate) {
+			if (sameSubroutinesRemoved(*file->entry, callGraph)) {
+				stillUpToDate.push_back(file);
+			} else if (state.streaming) {
+				state.sources.emplace_back(file->filePath, file->stamp);
 			} else {
-				if (inputPathArg.extension() != ".jack") {
-					std::cerr << "Error: Invalid file type. Only .jack files are allowed." << std::endl;
-					std::cerr << "Offending file: " << inputPathArg << std::endl;
-					return 1;
-				}
-				userFiles.push_back(fs::absolute(inputPathArg).string());
+				CompilationUnit unit = parseJob(file->filePath, &registry, phaseTimes, false, &pool);
+				unit.stamp = file->stamp;
+				analyzeJob(unit, &registry, phaseTimes, options, &pool);
+				if (unit.failed) continue;
+				prepareForInlining(unit, registry, options);
+				units.push_back(std::move(unit));
 			}
 		}
+		state.upToDate = std::move(stillUpToDate);
+		if (trace) {
+			trace->end({{"subroutines", callGraph.subroutineCount()}, {"removed", callGraph.unreachableCount()},
+			            {"inlinable", inlineTable.size()}});
+		}
+	} else if (trace) {
+		trace->end({{"inlinable", inlineTable.size()}});
+	}
+	return true;
+}
 
-		if (userFiles.empty()) {
-			std::cerr << "No files provided." << std::endl;
-			return 1;
+// Phase 2b + 3: Analysis and code generation (pipelined per class)
+// Units are already in largest-first order. With --dce or --inline they were analysed above.
+// Up-to-date files only need their .vm put back if it went missing or was changed. False if any class
+// has errors; the classes that did compile are kept in the cache, so fixing the errors only rebuilds the
+// rest. Nothing is linked then: the program is incomplete.
+bool generateClasses(BuildState& state) {
+	const Settings& settings = state.settings;
+	CompileOptions& options = state.options;
+	GlobalRegistry& registry = *state.registry;
+	PhaseTimes& phaseTimes = state.phaseTimes;
+	ThreadPool& pool = state.session.pool;
+	TraceRecorder* trace = state.trace;
+	Diagnostics& diagnostics = state.diagnostics;
+	std::vector<CompiledClass>& compiled = state.compiled;
+
+	// A .vm of the right size is read back, so an edit that keeps the size is repaired too.
+	// With --emit=asm there is no file per class; the cached code goes into the linked program.
+	for (const CachedFile* file : state.upToDate) {
+		const fs::path outputPath = vmPathOf(file->filePath, options);
+		const bool writesVm = !options.emitAsm && options.writeFiles;
+		const std::optional<SourceStamp> existing = writesVm ? BuildCache::stamp(outputPath) : std::nullopt;
+		if (writesVm && (!existing || existing->size != file->entry->vmCode.size() ||
+		                 readFile(outputPath) != file->entry->vmCode)) {
+			writeFileAtomically(outputPath, file->entry->vmCode);
+		}
+		if (!settings.daemon && !settings.library) log("[Cached]    " + file->filePath);
+	}
+
+	if (trace) trace->begin("build", "Analysis+Gen", state.mainDir.string());
+	options.keepCode = settings.useCache || state.linkVm;
+	options.keepSymbols = settings.vizSymbols || !settings.programPath.empty();
+	// A failure (even one that is not an error in the source, such as an unwritable .vm) is its unit's
+	// alone: it is reported and the other classes carry on.
+	const auto isolate = [&](CompilationUnit& unit, const auto& job) {
+		try {
+			job();
+		} catch (...) {
+			diagnostics.reportCurrentException(unit.filePath);
+			unit.failed = true;
+		}
+	};
+	if (state.streaming) {
+		const auto& sources = state.sources;
+		std::vector<std::optional<CompiledClass>> streamed(sources.size());
+		runBounded(pool, sources.size(), settings.maxInflight, [&](const std::size_t t) {
+			CompilationUnit unit = parseJob(sources[t].first, &registry, phaseTimes, false, &pool);
+			unit.stamp = sources[t].second;
+			isolate(unit, [&] { buildJob(unit, &registry, phaseTimes, options, &pool); });
+			if (!unit.failed) streamed[t] = compiledClass(unit, registry, settings.useCache, options);
+		});
+		for (auto& c : streamed) {
+			if (c) compiled.push_back(std::move(*c));
+		}
+	} else {
+		std::vector<std::future<void>> buildTasks;
+		buildTasks.reserve(state.units.size());
+		for (auto& unit : state.units) {
+			buildTasks.push_back(pool.submit([&unit, &registry, &phaseTimes, &options, &pool, &isolate] {
+				isolate(unit, [&] {
+					if (options.eliminateDeadCode || options.inlineCalls) {
+						compileJob(unit, &registry, phaseTimes, options, &pool);
+					} else {
+						buildJob(unit, &registry, phaseTimes, options, &pool);
+					}
+				});
+			}));
+		}
+
+		// A failed class must not unwind the units while other classes are still being built.
+		for (auto& t : buildTasks) t.wait();
+		for (auto& t : buildTasks) {
+			t.get();
+		}
+		compiled.reserve(state.units.size());
+		for (const auto& unit : state.units) {
+			if (!unit.failed) compiled.push_back(compiledClass(unit, registry, settings.useCache, options));
 		}
+	}
 
-		// Check for Main.jack
-		bool hasMain = false;
-		for (const auto& file : userFiles) {
-			if (fs::path(file).filename() == "Main.jack") {
-				hasMain = true;
-				break;
+	if (diagnostics.count() > 0) {
+		if (trace) trace->end({{"files", compiled.size()}});
+		if (settings.useCache) {
+			std::vector<CacheEntry> entries;
+			for (const CachedFile* file : state.upToDate) entries.push_back(*file->entry);
+			for (auto& c : compiled) {
+				if (c.cacheEntry) entries.push_back(std::move(*c.cacheEntry));
 			}
+			state.cache->replace(std::move(entries));
+			saveCache(*state.cache);
 		}
+		return false;
+	}
+	return true;
+}
 
-		if (!hasMain) {
-			std::cerr << "\nError: Compilation Failed." << std::endl;
-			std::cerr << "Reason: Missing 'Main.jack'" << std::endl;
-			std::cerr << "The list of files to compile must include the Main class." << std::endl;
-			return 1;
+// Phase 4: Link
+// The string pool covers the whole program, so it is rewritten on every build (it is small).
+// With --emit=asm or --output the classes then go into one program: the runtime of a Hack program, then
+// every class by name so the output does not depend on which worker finished first. Without --output the
+// .asm is named after the folder, as the VM translator names it.
+void linkProgram(BuildState& state) {
+	const CompileOptions& options = state.options;
+	const std::vector<CompiledClass>& compiled = state.compiled;
+	const fs::path poolPath = state.mainDir / StringPool::FILE_NAME;
+	std::string poolCode; // With --emit=asm or --output, linked with the classes.
+	if (options.poolStrings) {
+		std::vector<ClassStrings> pooled;
+		pooled.reserve(state.upToDate.size() + compiled.size());
+		for (const CachedFile* file : state.upToDate) pooled.push_back({file->entry->className, file->entry->pooledStrings});
+		for (const auto& c : compiled) pooled.push_back({c.className, c.pooledStrings});
+		VMWriter poolWriter;
+		StringPool::writeInit(poolWriter, std::move(pooled));
+		if (options.emitAsm) {
+			poolCode = HackTranslator::translate(poolWriter.code(), StringPool::CLASS_NAME);
+		} else if (state.linkVm) {
+			poolCode = poolWriter.contents();
+		} else {
+			poolWriter.saveTo(poolPath);
+			log("[Generated] " + poolPath.string());
 		}
+	} else if (options.writeFiles) {
+		std::error_code ec;
+		fs::remove(poolPath, ec); // Left over from a pooled build; Main.main no longer calls it.
+	}
 
+	if (!(options.emitAsm || state.linkVm) || state.settings.library) return;
+	std::vector<std::pair<std::string_view, std::string_view>> parts;
+	parts.reserve(state.upToDate.size() + compiled.size() + 1);
+	for (const CachedFile* file : state.upToDate) parts.emplace_back(file->entry->className, file->entry->vmCode);
+	for (const auto& c : compiled) parts.emplace_back(c.className, c.code);
+	if (options.poolStrings) parts.emplace_back(StringPool::CLASS_NAME, poolCode);
+	std::sort(parts.begin(), parts.end());
+
+	ProgramLinker linker;
+	if (options.emitAsm) {
+		linker.append(ProgramLinker::RUNTIME_PART, HackTranslator::runtime());
+		for (const auto& [className, code] : parts) linker.append(className, code);
+	} else {
+		for (const auto& [className, code] : parts) linker.appendVm(className, code);
+	}
 
-		GlobalRegistry registry;
+	const fs::path linkedPath = !options.outputFile.empty() ? options.outputFile
+	                                                        : state.mainDir / (state.mainDir.filename().string() + ".asm");
+	const ProgramLinker::WriteResult written = linker.write(linkedPath);
+	switch (written.outcome) {
+		case ProgramLinker::Outcome::WRITTEN:
+			log("[Linked]    " + linkedPath.string() + " (" + std::to_string(parts.size()) + " classes)");
+			break;
+		case ProgramLinker::Outcome::PATCHED:
+			log("[Linked]    " + linkedPath.string() + " (" + std::to_string(written.partsWritten) + " of " +
+			    std::to_string(parts.size()) + " classes rewritten in place)");
+			break;
+		case ProgramLinker::Outcome::UNCHANGED:
+			log("[Linked]    " + linkedPath.string() + " (up to date)");
+			break;
+	}
 
-		// --- PHASE 1: PARSING ---
-		const auto startParse = std::chrono::high_resolution_clock::now();
-		std::vector<std::future<CompilationUnit>> parseTasks;
+	const std::string& program = linker.program();
+	if (options.emitAsm) {
+		const std::vector<std::string> undefined = HackTranslator::undefinedFunctions(program);
+		if (!undefined.empty()) {
+			std::string names;
+			for (const std::string& name : undefined) names += (names.empty() ? "" : ", ") + name;
+			std::cerr << "Warning: " << linkedPath.filename().string() << " calls functions it does not define: "
+					  << names << " (link the OS with --os to run it on the CPU emulator)"
+					  << std::endl;
+		}
+		const std::size_t instructions = HackTranslator::instructionCount(program);
+		if (instructions > HackTranslator::ROM_SIZE) {
+			std::cerr << "Warning: " << linkedPath.filename().string() << " has " << instructions
+					  << " instructions, more than the " << HackTranslator::ROM_SIZE
+					  << " the Hack ROM holds (try -O1 and --dce)" << std::endl;
+		}
+	} else if (linker.staticCount() > ProgramLinker::MAX_STATICS) {
+		std::cerr << "Warning: " << linkedPath.filename().string() << " has " << linker.staticCount()
+				  << " static variables, more than the " << ProgramLinker::MAX_STATICS << " the Hack RAM holds"
+				  << std::endl;
+	}
+}
 
-		parseTasks.reserve(userFiles.size());
-		for (const auto& f : userFiles) {
-			parseTasks.push_back(std::async(std::launch::async, parseJob, f, &registry));
+// Remembers this build in the cache. Failing to write it only costs the next build some time.
+void updateCache(BuildState& state) {
+	const Settings& settings = state.settings;
+	if (!settings.useCache) return;
+	// With nothing compiled, no file dropped and no stamp moved, the cache file already says all of this.
+	const bool changed = !state.compiled.empty() || state.upToDate.size() != state.cache->size() ||
+		std::any_of(state.upToDate.begin(), state.upToDate.end(), [](const CachedFile* file) {
+			return file->entry->sourceSize != file->stamp.size || file->entry->sourceTime != file->stamp.time;
+		});
+	if (!changed) return;
+
+	std::vector<CacheEntry> entries;
+	entries.reserve(state.upToDate.size() + state.compiled.size());
+	for (const CachedFile* file : state.upToDate) {
+		entries.push_back(*file->entry);
+		entries.back().sourceSize = file->stamp.size;
+		entries.back().sourceTime = file->stamp.time;
+	}
+	for (auto& c : state.compiled) {
+		if (!c.cacheEntry) continue;
+		if (settings.library) {
+			// Every program's Main has main() as above (validateMainEntry), so the rest of it does not matter.
+			auto& deps = c.cacheEntry->dependencies;
+			deps.erase(std::remove_if(deps.begin(), deps.end(), [](const CachedDependency& d) {
+				return d.className == "Main";
+			}), deps.end());
 		}
+		entries.push_back(std::move(*c.cacheEntry));
+	}
+	state.cache->replace(std::move(entries));
+	// An OS library that was merely checked is left as it is. A daemon saves after every build too, since it
+	// may well be stopped by a signal rather than by "quit".
+	if (!(settings.library && state.compiled.empty())) saveCache(*state.cache);
+}
 
-		std::vector<CompilationUnit> units;
-		for (auto& t : parseTasks) {
-			auto unit = t.get();
-			if (unit.ast) units.push_back(std::move(unit));
+// Hands the registry of a successful daemon build to the next build, with the file of each class.
+// A file without a stamp cannot be checked for changes, so then the next build starts afresh.
+void keepRegistry(BuildState& state) {
+	Session& session = state.session;
+	session.registered.clear();
+	Interner& names = Interner::global();
+	for (const CachedFile* file : state.upToDate) {
+		session.registered[file->filePath] = {names.intern(file->entry->className), file->stamp};
+	}
+	for (const CompiledClass& c : state.compiled) {
+		if (!c.stamp) {
+			session.registered.clear();
+			return;
 		}
-		const auto endParse = std::chrono::high_resolution_clock::now();
+		session.registered[c.filePath] = {names.intern(c.className), *c.stamp};
+	}
+	session.registry = std::move(state.registry);
+}
+
+// Phase 5: Report
+// Prints the summary of a successful build, then hands the program to --dump-program and the visualisers.
+void reportBuild(const BuildState& state, const std::chrono::high_resolution_clock::time_point endTotal) {
+	const Settings& settings = state.settings;
+	const CompileOptions& options = state.options;
+	const std::vector<CompiledClass>& compiled = state.compiled;
+	const PhaseTimes& phaseTimes = state.phaseTimes;
+	std::cout << "\n========================================" << std::endl;
+	std::cout << " BUILD SUCCESSFUL" << std::endl;
+	std::cout << "========================================" << std::endl;
+	std::cout << " Files Compiled: " << compiled.size() << std::endl;
+	if (settings.useCache) std::cout << " Up To Date:     " << state.upToDate.size() << " (from build cache)" << std::endl;
+	if (options.optLevel >= 1) {
+		std::size_t saved = 0;
+		for (const auto& c : compiled) saved += c.vmCommandsSaved;
+		std::cout << " Peephole:       " << saved << " VM commands saved" << std::endl;
+	}
+	if (options.callGraph) {
+		std::cout << " Dead code:      " << state.callGraph.unreachableCount() << " of " << state.callGraph.subroutineCount()
+				  << " subroutines removed" << std::endl;
+	}
+	if (options.inlineTable) {
+		std::size_t inlined = 0;
+		for (const auto& c : compiled) inlined += c.callsInlined;
+		std::cout << " Inlined:        " << inlined << " call sites (" << state.inlineTable.size()
+				  << " subroutines small enough)" << std::endl;
+	}
+	std::cout << " Parsing:        " << std::chrono::duration<double, std::milli>(state.endParse - state.startParse).count() << " ms" << std::endl;
+	std::cout << " Analysis+Gen:   " << std::chrono::duration<double, std::milli>(state.endBuild - state.startBuild).count() << " ms" << std::endl;
+	std::cout << " CPU per phase:  parse " << static_cast<double>(phaseTimes.parseNanos.load()) / 1e6
+			  << " ms, analysis " << static_cast<double>(phaseTimes.analyseNanos.load()) / 1e6
+			  << " ms, code gen " << static_cast<double>(phaseTimes.codeGenNanos.load()) / 1e6 << " ms" << std::endl;
+	std::cout << " Total Time:     " << std::chrono::duration<double, std::milli>(endTotal - state.startTotal).count() << " ms" << std::endl;
+	std::cout << " Peak Memory:    " << getPeakMemoryMB() << " MB" << std::endl;
+	if (state.streaming) {
+		std::cout << " Streaming:      at most " << settings.maxInflight << " files in memory at once" << std::endl;
+	} else {
+		printArenaReport(state.units);
+	}
+	printWorkerReport(state.session.pool, state.statsBefore, endTotal - state.startParse);
+	if (state.trace) std::cout << " Trace:          " << settings.tracePath.string() << std::endl;
+	std::cout << "========================================" << std::endl;
 
-		// Validate Entry Point
-		validateMainEntry(registry);
+	if (!settings.programPath.empty()) {
+		saveProgramBinary(settings.programPath, *state.registry, state.units);
+		log("[Saved]     " + settings.programPath.string());
+	}
 
+	// --- VISUALIZATION ---
+	if (settings.vizAst) {
+		runBatchAstViz(*state.registry, state.units);
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+	}
 
-		// --- PHASE 2: SEMANTIC ANALYSIS ---
-		const auto startAnalyze = std::chrono::high_resolution_clock::now();
-		std::vector<std::future<void>> analysisTasks;
 
-		analysisTasks.reserve(units.size());
-		for (const auto& unit : units) {
-			analysisTasks.push_back(std::async(std::launch::async, analyzeJob, std::ref(unit), &registry));
+	if (settings.vizSymbols) {
+		runUnifiedViz(*state.registry, state.units);
+	}
+}
+
+// Compiles the program once: everything from listing the sources to the report (and the visualisers).
+// Errors are reported here; the summary says whether the build succeeded.
+// An error in a file fails only that file's unit; the others are still compiled, so one build reports
+// the errors of every file. The build stops early only where later phases would need the failed units:
+// after parsing (the signatures are incomplete) and, with --dce or --inline, after the whole-program analysis.
+BuildSummary build(const Settings& settings, Session& session) {
+	// Live outside the try block so a failed build still reports every error and leaves its timeline behind.
+	std::unique_ptr<TraceRecorder> trace;
+	Diagnostics diagnostics;
+	BuildSummary summary;
+	const auto writeTrace = [&] {
+		if (!trace) return;
+		try {
+			trace->write(settings.tracePath);
+		} catch (const std::exception& traceError) {
+			std::cerr << "Warning: " << traceError.what() << " (trace not written)" << std::endl;
 		}
+	};
+	const auto fail = [&] {
+		reportFailure(diagnostics);
+		writeTrace();
+		return summary;
+	};
 
-		for (auto& t : analysisTasks) {
-			t.get();
+	try {
+		BuildState state(settings, session, diagnostics);
+		state.startTotal = std::chrono::high_resolution_clock::now();
+		if (!settings.tracePath.empty()) trace = std::make_unique<TraceRecorder>();
+		state.trace = trace.get();
+		state.phaseTimes.trace = trace.get();
+		state.phaseTimes.diagnostics = &diagnostics;
+
+		if (!collectSources(state)) return {};
+		if (!parseProgram(state)) return fail();
+		if (!analyseWholeProgram(state)) return fail();
+		if (!generateClasses(state)) return fail();
+		linkProgram(state);
+		state.endBuild = std::chrono::high_resolution_clock::now();
+		if (trace) trace->end({{"files", state.compiled.size()}});
+		if (keepsRegistry(settings)) keepRegistry(state); // Before updateCache() replaces the entries it reads.
+		updateCache(state);
+
+		const auto endTotal = std::chrono::high_resolution_clock::now();
+		if (trace) trace->write(settings.tracePath);
+		summary = {true, state.compiled.size(), state.upToDate.size()};
+		if (settings.daemon || settings.library) return summary;
+		reportBuild(state, endTotal);
+	}catch (const std::exception& e) {
+		// Anything not tied to one file (an unwritable cache or linked program, ...) still ends the build.
+		diagnostics.report({"", 0, 0, e.what()});
+		fail();
+	}
+	return summary;
+}
+
+// How often the daemon looks for changed sources.
+constexpr std::chrono::milliseconds DAEMON_POLL_INTERVAL{100};
+
+// Size and mtime of every source file, to notice edits, new files and deleted files.
+std::vector<std::pair<std::string, std::optional<SourceStamp>>> sourceSnapshot(const std::vector<fs::path>& inputs) {
+	std::vector<std::pair<std::string, std::optional<SourceStamp>>> snapshot;
+	std::error_code ec;
+	for (const fs::path& input : inputs) {
+		if (!fs::is_directory(input, ec)) {
+			snapshot.emplace_back(input.string(), BuildCache::stamp(input));
+			continue;
+		}
+		for (fs::directory_iterator it(input, ec), end; !ec && it != end; it.increment(ec)) {
+			if (it->path().extension() == ".jack") snapshot.emplace_back(it->path().string(), BuildCache::stamp(it->path()));
 		}
-		const auto endAnalyze = std::chrono::high_resolution_clock::now();
+	}
+	std::sort(snapshot.begin(), snapshot.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+	return snapshot;
+}
 
-		// --- PHASE 3: CODE GENERATION ---
-		const auto startCodeGen = std::chrono::high_resolution_clock::now();
-		std::vector<std::future<void>> compileTasks;
+// The daemon's standard input, read line by line on a thread of its own so the daemon can poll for
+// changes while it waits. Reading stops at "quit" or at the end of the input; only "quit" stops the
+// daemon, which keeps watching the sources when started without an input (e.g. `</dev/null`).
+class CommandReader {
+	public:
+		CommandReader() : reader([this] { readLoop(); }) {}
+		~CommandReader() { reader.join(); }
+
+		CommandReader(const CommandReader&) = delete;
+		CommandReader& operator=(const CommandReader&) = delete;
+
+		// Waits up to `timeout` for a command; nothing if none arrived (or "quit" did, see quitRequested()).
+		std::optional<std::string> next(const std::chrono::milliseconds timeout) {
+			std::unique_lock lock(mtx);
+			arrived.wait_for(lock, timeout, [this] { return !commands.empty() || quit; });
+			if (commands.empty()) return std::nullopt;
+			std::string command = std::move(commands.front());
+			commands.pop_front();
+			return command;
+		}
 
-		compileTasks.reserve(units.size());
-		for (auto& unit : units) {
-			compileTasks.push_back(std::async(std::launch::async, compileJob, std::ref(unit), &registry));
+		// True once every command before "quit" has been handed out.
+		bool quitRequested() {
+			std::scoped_lock lock(mtx);
+			return quit && commands.empty();
 		}
 
-		for (auto& t : compileTasks) {
-			t.get();
+	private:
+		std::mutex mtx;
+		std::condition_variable arrived;
+		std::deque<std::string> commands;
+		bool quit = false;
+		std::thread reader;
+
+		void readLoop() {
+			std::string line;
+			while (std::getline(std::cin, line)) {
+				if (!line.empty() && line.back() == '\r') line.pop_back();
+				std::scoped_lock lock(mtx);
+				if (line == "quit") {
+					quit = true;
+					arrived.notify_one();
+					return;
+				}
+				commands.push_back(line);
+				arrived.notify_one();
+			}
 		}
-		const auto endCodeGen = std::chrono::high_resolution_clock::now();
-		const auto endTotal = std::chrono::high_resolution_clock::now();
+};
 
-		// --- REPORT ---
-		std::cout << "\n========================================" << std::endl;
-		std::cout << " BUILD SUCCESSFUL" << std::endl;
-		std::cout << "========================================" << std::endl;
-		std::cout << " Files Compiled: " << units.size() << std::endl;
-		std::cout << " Parsing:        " << std::chrono::duration<double, std::milli>(endParse - startParse).count() << " ms" << std::endl;
-		std::cout << " Static Analysis:" << std::chrono::duration<double, std::milli>(endAnalyze - startAnalyze).count() << " ms" << std::endl;
-		std::cout << " Code Gen:       " << std::chrono::duration<double, std::milli>(endCodeGen - startCodeGen).count() << " ms" << std::endl;
-		std::cout << " Total Time:     " << std::chrono::duration<double, std::milli>(endTotal - startTotal).count() << " ms" << std::endl;
-		std::cout << " Peak Memory:    " << getPeakMemoryMB() << " MB" << std::endl;
-		std::cout << "========================================" << std::endl;
+// --daemon: builds, then rebuilds whenever a source file changes or a "build" line arrives on stdin,
+// until "quit" arrives or the process is stopped by a signal. The workers, the interned names and the build cache stay warm
+// between builds, so a rebuild only re-parses, re-checks and re-generates the classes that changed and
+// the classes whose view of them changed. Each build ends with one "[Daemon]" line on stdout, and saves
+// the build cache, so a daemon that is killed leaves it as up to date as its last build.
+// Sources are read rather than mapped: an editor may truncate a file while the daemon tokenizes it.
+int runDaemon(const Settings& settings) {
+	SourceBuffer::setMappingEnabled(false);
+	Session session(settings.jobs);
+	CommandReader input;
+	log("[Daemon]    Watching for changes; send \"build\" to rebuild now, \"quit\" to stop.");
+
+	auto snapshot = sourceSnapshot(settings.inputs);
+	bool rebuild = true;
+	for (;;) {
+		if (rebuild) {
+			const auto begin = std::chrono::steady_clock::now();
+			const BuildSummary summary = build(settings, session);
+			const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+			if (summary.ok) {
+				log("[Daemon]    Build OK in " + std::to_string(ms) + " ms (" + std::to_string(summary.compiled) +
+				    " compiled, " + std::to_string(summary.upToDate) + " up to date)");
+			} else {
+				log("[Daemon]    Build FAILED in " + std::to_string(ms) + " ms");
+			}
+		}
 
-		// --- VISUALIZATION ---
-		if (vizAst) {
-			runBatchAstViz(units);
-			std::this_thread::sleep_for(std::chrono::seconds(1));
+		const std::optional<std::string> command = input.next(DAEMON_POLL_INTERVAL);
+		if (!command && input.quitRequested()) break;
+		if (command && !command->empty() && *command != "build") {
+			std::cerr << "Error: Unknown daemon command: " << *command << " (expected build or quit)" << std::endl;
+			rebuild = false;
+			continue;
 		}
+		// Snapshot before building, so an edit made during the build triggers another one.
+		auto current = sourceSnapshot(settings.inputs);
+		rebuild = command.has_value() || current != snapshot;
+		snapshot = std::move(current);
+	}
 
+	return 0;
+}
 
-		if (vizSymbols) {
-			runUnifiedViz(registry, units);
+int main(int argc, char* argv[]) {
+	// Optimization: Disable C-style I/O synchronization for speed
+	std::ios_base::sync_with_stdio(false);
+
+	if (argc < 2) {
+		std::cerr << "Usage: JackCompiler <file.jack or directory> [--jobs N] [-O0|-O1] [--strict-strings] [--dce] [--inline] [--single-pass] [--os[=DIR]] [--emit=vm|asm] [--output=FILE] [--no-cache] [--trace=FILE] [--max-inflight N] [--daemon] [--dump-program=FILE] [--viz-ast] [--viz-checker]" << std::endl;
+		return 1;
+	}
+
+	Settings settings;
+	try {
+		// Iterate through ALL command line arguments
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (arg == "--jobs" || arg.rfind("--jobs=", 0) == 0) {
+				std::string value;
+				if (arg == "--jobs") {
+					if (i + 1 >= argc) {
+						std::cerr << "Error: --jobs requires a value." << std::endl;
+						return 1;
+					}
+					value = argv[++i];
+				} else {
+					value = arg.substr(7);
+				}
+				try {
+					const long parsed = std::stol(value);
+					if (parsed < 1) throw std::invalid_argument(value);
+					settings.jobs = static_cast<std::size_t>(parsed);
+				} catch (const std::exception&) {
+					std::cerr << "Error: Invalid job count: " << value << std::endl;
+					return 1;
+				}
+				continue;
+			}
+			if (arg.rfind("-O", 0) == 0) {
+				if (arg != "-O0" && arg != "-O1") {
+					std::cerr << "Error: Unknown optimisation level: " << arg << std::endl;
+					return 1;
+				}
+				settings.options.optLevel = arg[2] - '0';
+				continue;
+			}
+			if (arg == "--strict-strings") {
+				settings.options.poolStrings = false;
+				continue;
+			}
+			if (arg.rfind("--emit=", 0) == 0) {
+				const std::string format = arg.substr(7);
+				if (format != "vm" && format != "asm") {
+					std::cerr << "Error: Unknown output format: " << format << " (expected vm or asm)" << std::endl;
+					return 1;
+				}
+				settings.options.emitAsm = format == "asm";
+				continue;
+			}
+			if (arg == "--dce") {
+				settings.options.eliminateDeadCode = true;
+				continue;
+			}
+			if (arg == "--inline") {
+				settings.options.inlineCalls = true;
+				continue;
+			}
+			if (arg == "--single-pass") {
+				settings.options.singlePass = true;
+				continue;
+			}
+			if (arg == "--os" || arg.rfind("--os=", 0) == 0) {
+				const fs::path dir = arg == "--os" ? fs::path(getInstalledDir("os")) : fs::path(arg.substr(5));
+				if (dir.empty() || !fs::is_directory(dir)) {
+					std::cerr << "Error: OS sources not found" << (dir.empty() ? "" : ": " + dir.string())
+							  << " (install the toolchain, or give their folder with --os=DIR)" << std::endl;
+					return 1;
+				}
+				// In the form collectSourceFiles gives the files inside it, so their folder compares equal.
+				fs::path osDir = fs::absolute(dir).lexically_normal();
+				if (osDir.filename().empty()) osDir = osDir.parent_path();
+				settings.options.osDir = osDir;
+				continue;
+			}
+			if (arg == "--output" || arg.rfind("--output=", 0) == 0) {
+				fs::path output;
+				if (arg == "--output") {
+					if (i + 1 >= argc) {
+						std::cerr << "Error: --output requires a file name." << std::endl;
+						return 1;
+					}
+					output = argv[++i];
+				} else {
+					output = arg.substr(9);
+				}
+				if (output.empty() || fs::is_directory(output)) {
+					std::cerr << "Error: --output requires a file name." << std::endl;
+					return 1;
+				}
+				// The daemon and the build cache work with absolute paths.
+				settings.options.outputFile = fs::absolute(output).lexically_normal();
+				continue;
+			}
+			if (arg == "--no-cache") {
+				settings.useCache = false;
+				continue;
+			}
+			if (arg == "--trace" || arg.rfind("--trace=", 0) == 0) {
+				if (arg == "--trace") {
+					if (i + 1 >= argc) {
+						std::cerr << "Error: --trace requires a file name." << std::endl;
+						return 1;
+					}
+					settings.tracePath = argv[++i];
+				} else {
+					settings.tracePath = arg.substr(8);
+				}
+				if (settings.tracePath.empty()) {
+					std::cerr << "Error: --trace requires a file name." << std::endl;
+					return 1;
+				}
+				continue;
+			}
+			if (arg == "--max-inflight" || arg.rfind("--max-inflight=", 0) == 0) {
+				std::string value;
+				if (arg == "--max-inflight") {
+					if (i + 1 >= argc) {
+						std::cerr << "Error: --max-inflight requires a value." << std::endl;
+						return 1;
+					}
+					value = argv[++i];
+				} else {
+					value = arg.substr(15);
+				}
+				try {
+					const long parsed = std::stol(value);
+					if (parsed < 1) throw std::invalid_argument(value);
+					settings.maxInflight = static_cast<std::size_t>(parsed);
+				} catch (const std::exception&) {
+					std::cerr << "Error: Invalid file count: " << value << std::endl;
+					return 1;
+				}
+				continue;
+			}
+			if (arg == "--daemon") {
+				settings.daemon = true;
+				continue;
+			}
+			if (arg.rfind("--dump-program=", 0) == 0) {
+				settings.programPath = arg.substr(15);
+				if (settings.programPath.empty()) {
+					std::cerr << "Error: --dump-program requires a file name." << std::endl;
+					return 1;
+				}
+				continue;
+			}
+			if (arg == "--viz-ast") {
+				settings.vizAst = true;
+				continue;
+			}
+			if (arg == "--viz-checker") {
+				settings.vizSymbols = true;
+				continue;
+			}
+
+			fs::path inputPathArg = arg;
+
+			if (!fs::exists(inputPathArg)) {
+				std::cerr << "Error: Path does not exist: " << inputPathArg << std::endl;
+				return 1;
+			}
+
+			if (!fs::is_directory(inputPathArg) && inputPathArg.extension() != ".jack") {
+				std::cerr << "Error: Invalid file type. Only .jack files are allowed." << std::endl;
+				std::cerr << "Offending file: " << inputPathArg << std::endl;
+				return 1;
+			}
+			settings.inputs.push_back(inputPathArg);
 		}
 
 	}catch (const std::exception& e) {
@@ -426,5 +2155,16 @@ int main(int argc, char* argv[]) {
 		return 1;
 	}
 
-	return 0;
-}
\ No newline at end of file
+	if (settings.maxInflight > 0 && (settings.vizAst || settings.vizSymbols || !settings.programPath.empty())) {
+		std::cerr << "Warning: The visualisers and --dump-program need every file in memory; --max-inflight is ignored." << std::endl;
+	}
+	if (settings.daemon) {
+		if (settings.vizAst || settings.vizSymbols || !settings.programPath.empty()) {
+			std::cerr << "Error: --daemon cannot be combined with --viz-ast, --viz-checker or --dump-program." << std::endl;
+			return 1;
+		}
+		return runDaemon(settings);
+	}
+	Session session(settings.jobs);
+	return build(settings, session).ok ? 0 : 1;
+}
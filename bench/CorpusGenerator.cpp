@@ -0,0 +1,256 @@
+//
+// Created on 14/10/2026.
+//
+
+#include "CorpusGenerator.h"
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include "Common/FileIO.h"
+
+namespace fs = std::filesystem;
+
+namespace nand2tetris::jack {
+
+    namespace {
+        constexpr std::string_view MAIN_CLASS =
+            "class Main {\n"
+            "    function void main() {\n"
+            "        return;\n"
+            "    }\n"
+            "}\n";
+
+        /// Appends `suffix` to every identifier in `names`, leaving comments and string constants alone.
+        std::string renameClasses(const std::string_view text, const std::unordered_set<std::string_view>& names,
+                                  const std::string_view suffix) {
+            std::string out;
+            out.reserve(text.size() + text.size() / 16);
+            std::size_t at = 0;
+            while (at < text.size()) {
+                const char c = text[at];
+                std::size_t end = at + 1;
+                if (c == '/' && at + 1 < text.size() && text[at + 1] == '/') {
+                    end = text.find('\n', at);
+                } else if (c == '/' && at + 1 < text.size() && text[at + 1] == '*') {
+                    end = text.find("*/", at + 2);
+                    if (end != std::string_view::npos) end += 2;
+                } else if (c == '"') {
+                    end = text.find('"', at + 1);
+                    if (end != std::string_view::npos) end += 1;
+                } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                    while (end < text.size() && (std::isalnum(static_cast<unsigned char>(text[end])) || text[end] == '_')) ++end;
+                    out.append(text.substr(at, end - at));
+                    if (names.count(text.substr(at, end - at))) out.append(suffix);
+                    at = end;
+                    continue;
+                }
+                if (end == std::string_view::npos) end = text.size();
+                out.append(text.substr(at, end - at));
+                at = end;
+            }
+            return out;
+        }
+
+        void writeClass(const fs::path& dir, const std::string& className, const std::string_view text,
+                        std::vector<fs::path>& files) {
+            fs::path path = dir / (className + ".jack");
+            writeFileAtomically(path, text);
+            files.push_back(std::move(path));
+        }
+
+        std::size_t totalBytes(const std::vector<fs::path>& files) {
+            std::size_t bytes = 0;
+            for (const auto& f : files) bytes += static_cast<std::size_t>(fs::file_size(f));
+            return bytes;
+        }
+
+        /// Samples the analyser rejects (EverythingTest assigns a String to a char field).
+        constexpr std::string_view SKIPPED_SAMPLES[] = {"EverythingTest"};
+
+        constexpr std::string_view OPERATORS[] = {" + ", " - ", " & ", " | ", " * ", " / "};
+        constexpr std::string_view COMPARISONS[] = {" < ", " > ", " = "};
+    }
+
+    bool parseCorpusShape(const std::string_view name, CorpusShape& shape) {
+        for (const CorpusShape s : {CorpusShape::SAMPLES, CorpusShape::SMALL, CorpusShape::GIANT, CorpusShape::NESTED}) {
+            if (name == corpusShapeName(s)) {
+                shape = s;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char* corpusShapeName(const CorpusShape shape) {
+        switch (shape) {
+            case CorpusShape::SAMPLES: return "samples";
+            case CorpusShape::SMALL:   return "small";
+            case CorpusShape::GIANT:   return "giant";
+            case CorpusShape::NESTED:  return "nested";
+        }
+        return "<unknown>";
+    }
+
+    CorpusGenerator::CorpusGenerator(CorpusOptions options) : options(std::move(options)), random(this->options.seed) {}
+
+    std::vector<fs::path> CorpusGenerator::writeTo(const fs::path& dir) {
+        fs::create_directories(dir);
+        std::vector<fs::path> files;
+        writeClass(dir, "Main", MAIN_CLASS, files);
+        switch (options.shape) {
+            case CorpusShape::SAMPLES: writeSamples(dir, files); break;
+            case CorpusShape::SMALL:   writeSmallClasses(dir, files); break;
+            case CorpusShape::GIANT:   writeGiantClass(dir, files); break;
+            case CorpusShape::NESTED:  writeNested(dir, files); break;
+        }
+        return files;
+    }
+
+    void CorpusGenerator::writeSamples(const fs::path& dir, std::vector<fs::path>& files) {
+        // Classes only refer to classes of their own folder, so each folder is copied as a whole.
+        std::map<fs::path, std::vector<std::pair<std::string, std::string>>> folders;
+        for (const auto& entry : fs::recursive_directory_iterator(options.samplesDir)) {
+            const std::string stem = entry.path().stem().string();
+            if (entry.path().extension() != ".jack" || stem == "Main" ||
+                std::find(std::begin(SKIPPED_SAMPLES), std::end(SKIPPED_SAMPLES), stem) != std::end(SKIPPED_SAMPLES)) continue;
+            std::optional<std::string> text = readFile(entry.path());
+            if (!text) throw std::runtime_error("Cannot read sample: " + entry.path().string());
+            folders[entry.path().parent_path()].emplace_back(stem, std::move(*text));
+        }
+        if (folders.empty()) throw std::runtime_error("No .jack samples in " + options.samplesDir.string());
+        for (auto& [folder, classes] : folders) std::sort(classes.begin(), classes.end());
+
+        std::size_t bytes = totalBytes(files);
+        for (int copy = 1; bytes < options.targetBytes; ++copy) {
+            const std::string suffix = "_" + std::to_string(copy);
+            for (const auto& [folder, classes] : folders) {
+                std::unordered_set<std::string_view> names;
+                for (const auto& [name, text] : classes) names.insert(name);
+                for (const auto& [name, text] : classes) {
+                    const std::string renamed = renameClasses(text, names, suffix);
+                    writeClass(dir, name + suffix, renamed, files);
+                    bytes += renamed.size();
+                }
+                if (bytes >= options.targetBytes) break;
+            }
+        }
+    }
+
+    void CorpusGenerator::writeSmallClasses(const fs::path& dir, std::vector<fs::path>& files) {
+        std::size_t bytes = totalBytes(files);
+        for (int index = 0; bytes < options.targetBytes; ++index) {
+            const std::string className = "Small" + std::to_string(index);
+            std::string out = "class " + className + " {\n    field int a, b;\n    static int count;\n\n";
+            out += "    constructor " + className + " new() {\n        let a = 1;\n        let b = 2;\n"
+                   "        let count = count + 1;\n        return this;\n    }\n\n";
+            // Each class calls into one earlier class, so analysis has cross-class lookups to do.
+            const std::string callee = index > 0 ? "Small" + std::to_string(pick(index)) + ".mix0" : "";
+            for (int sub = 0; sub < 3; ++sub) appendSubroutines(out, className, sub, sub == 0 ? callee : "");
+            out += "}\n";
+            writeClass(dir, className, out, files);
+            bytes += out.size();
+        }
+    }
+
+    void CorpusGenerator::writeGiantClass(const fs::path& dir, std::vector<fs::path>& files) {
+        std::string out = "class Giant {\n    field int a, b;\n    static int count;\n\n"
+                          "    constructor Giant new() {\n        let a = 1;\n        let b = 2;\n"
+                          "        return this;\n    }\n\n";
+        const std::size_t target = options.targetBytes > MAIN_CLASS.size() ? options.targetBytes - MAIN_CLASS.size() : 0;
+        for (int index = 0; out.size() < target; ++index) {
+            const std::string callee = index > 0 ? "Giant.mix" + std::to_string(pick(index)) : "";
+            appendSubroutines(out, "Giant", index, callee);
+        }
+        out += "}\n";
+        writeClass(dir, "Giant", out, files);
+    }
+
+    void CorpusGenerator::writeNested(const fs::path& dir, std::vector<fs::path>& files) {
+        static const Names names = {"p", "q", "x", "y"};
+        std::size_t bytes = totalBytes(files);
+        for (int index = 0; bytes < options.targetBytes; ++index) {
+            const std::string className = "Nested" + std::to_string(index);
+            std::string out = "class " + className + " {\n";
+            for (int sub = 0; sub < 4; ++sub) {
+                out += "    function int eval" + std::to_string(sub) + "(int p, int q) {\n"
+                       "        var int x, y;\n        var Array t;\n        let t = Array.new(4);\n"
+                       "        let x = p;\n        let y = q;\n";
+                for (int statement = 0; statement < 4; ++statement) {
+                    out += "        let " + std::string(statement % 2 ? "y" : "x") + " = " +
+                           nestedExpression(options.nestingDepth, names) + ";\n";
+                }
+                const std::string condition = nestedExpression(options.nestingDepth / 2, names);
+                out += "        if (((" + condition + ") + 0)" + std::string(COMPARISONS[pick(3)]) +
+                       "0) {\n            let x = y;\n        }\n        do t.dispose();\n        return x;\n    }\n\n";
+            }
+            out += "}\n";
+            writeClass(dir, className, out, files);
+            bytes += out.size();
+        }
+    }
+
+    void CorpusGenerator::appendSubroutines(std::string& out, const std::string& className, const int index,
+                                            const std::string& callee) {
+        static const Names mixNames = {"p", "q", "x", "y"};
+        static const Names walkNames = {"n", "i", "sum", "a", "b"};
+        const std::string id = std::to_string(index);
+
+        out += "    function int mix" + id + "(int p, int q) {\n        var int x, y;\n";
+        out += "        let x = " + expression(3, mixNames) + ";\n        let y = 0;\n";
+        out += "        while (y < " + std::to_string(2 + pick(6)) + ") {\n";
+        out += "            let x = x + " + expression(2, mixNames) + ";\n            let y = y + 1;\n        }\n";
+        const std::string limit = std::to_string(pick(1000));
+        out += "        if (x > " + limit + ") {\n            let x = x - " + term(mixNames) +
+               ";\n        } else {\n            let x = -x;\n        }\n";
+        out += callee.empty() ? "        return x;\n    }\n\n" : "        return x + " + callee + "(y, x);\n    }\n\n";
+
+        out += "    method int walk" + id + "(int n) {\n        var int i, sum;\n        var Array data;\n"
+               "        var String text;\n        let data = Array.new(8);\n";
+        out += "        let text = \"" + className + " walk " + id + "\";\n        let i = 0;\n        let sum = 0;\n";
+        out += "        while (i < 8) {\n            let data[i] = " + expression(2, walkNames) + ";\n"
+               "            let sum = sum + data[i];\n            let i = i + 1;\n        }\n";
+        out += "        if ((sum > a) & (~(b = 0))) {\n            let a = sum;\n        } else {\n"
+               "            let b = b + text.length();\n        }\n";
+        out += "        do text.dispose();\n        do data.dispose();\n        return sum + " + className + ".mix" + id + "(n, a);\n    }\n\n";
+    }
+
+    std::string CorpusGenerator::term(const Names& names) {
+        if (pick(3) == 0) return std::to_string(pick(100));
+        return std::string(names[pick(static_cast<std::uint32_t>(names.size()))]);
+    }
+
+    // The random choices are made one statement at a time: the operands of `+` may be evaluated in any order.
+    std::string CorpusGenerator::expression(const int depth, const Names& names) {
+        if (depth <= 0 || pick(4) == 0) return term(names);
+        const std::uint32_t kind = pick(8);
+        if (kind == 0) return "-" + term(names);
+        const std::string left = expression(depth - 1, names);
+        if (kind == 1) return "Math.max(" + left + ", " + term(names) + ")";
+        const std::string_view op = OPERATORS[pick(6)];
+        return "(" + left + std::string(op) + expression(depth - 1, names) + ")";
+    }
+
+    std::string CorpusGenerator::nestedExpression(const int depth, const Names& names) {
+        // One nested operand per level keeps the size linear in the depth.
+        if (depth <= 0) return term(names);
+        const std::string inner = nestedExpression(depth - 1, names);
+        switch (pick(6)) {
+            case 0:  return "-(" + inner + ")";
+            case 1:  return "~(" + inner + ")";
+            case 2:  return "t[(" + inner + ") + 0]"; // An index must have type int, `inner` may be boolean.
+            case 3:  return "Math.min(" + inner + ", " + term(names) + ")";
+            case 4: {
+                const std::string left = term(names);
+                return "(" + left + std::string(OPERATORS[pick(6)]) + inner + ")";
+            }
+            default: {
+                const std::string_view op = OPERATORS[pick(6)];
+                return "(" + inner + std::string(op) + term(names) + ")";
+            }
+        }
+    }
+}
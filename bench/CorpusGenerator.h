@@ -0,0 +1,88 @@
+//
+// Created on 14/10/2026.
+//
+
+#ifndef NAND2TETRIS_CORPUS_GENERATOR_H
+#define NAND2TETRIS_CORPUS_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief What a generated benchmark corpus looks like.
+     */
+    enum class CorpusShape : std::uint8_t {
+        SAMPLES, ///< Copies of the JackCode samples, with the classes renamed per copy.
+        SMALL,   ///< Many small classes calling each other.
+        GIANT,   ///< One class with a great many subroutines.
+        NESTED   ///< Few statements, each with a deeply nested expression.
+    };
+
+    /**
+     * @brief Parses a shape name ("samples", "small", "giant", "nested").
+     *
+     * @return True and sets `shape` if the name is known.
+     */
+    bool parseCorpusShape(std::string_view name, CorpusShape& shape);
+
+    /**
+     * @brief Returns the name parseCorpusShape() accepts for a shape.
+     */
+    const char* corpusShapeName(CorpusShape shape);
+
+    struct CorpusOptions {
+        CorpusShape shape = CorpusShape::SAMPLES;
+        std::size_t targetBytes = 1024 * 1024; ///< Stop adding classes once the corpus is this big.
+        int nestingDepth = 48;                 ///< Expression depth for the NESTED shape.
+        std::uint32_t seed = 1;                ///< Same seed and options, same corpus (on every platform).
+        std::filesystem::path samplesDir;      ///< Where the SAMPLES shape reads its .jack files from.
+    };
+
+    /**
+     * @brief Writes a synthetic Jack program for the benchmarks.
+     *
+     * The result always compiles: every class only refers to itself, to earlier classes of the corpus
+     * or to the OS, and a trivial Main.jack is included so the folder also builds with the compiler.
+     * Only the random engine's raw output is used (no std distributions, whose results differ between
+     * standard libraries), so a seed names the same corpus everywhere.
+     */
+    class CorpusGenerator {
+        public:
+            explicit CorpusGenerator(CorpusOptions options);
+
+            /**
+             * @brief Generates the corpus into a directory, which is created if needed.
+             *
+             * @return The paths of the files written, Main.jack first.
+             * @throws std::runtime_error if a sample cannot be read or a file cannot be written.
+             */
+            std::vector<std::filesystem::path> writeTo(const std::filesystem::path& dir);
+
+        private:
+            CorpusOptions options;
+            std::mt19937 random;
+
+            /// A pseudo-random integer in [0, n) (modulo bias is irrelevant here).
+            std::uint32_t pick(std::uint32_t n) { return static_cast<std::uint32_t>(random() % n); }
+
+            void writeSamples(const std::filesystem::path& dir, std::vector<std::filesystem::path>& files);
+            void writeSmallClasses(const std::filesystem::path& dir, std::vector<std::filesystem::path>& files);
+            void writeGiantClass(const std::filesystem::path& dir, std::vector<std::filesystem::path>& files);
+            void writeNested(const std::filesystem::path& dir, std::vector<std::filesystem::path>& files);
+
+            using Names = std::vector<std::string_view>;
+            std::string expression(int depth, const Names& names);
+            std::string nestedExpression(int depth, const Names& names);
+            std::string term(const Names& names);
+            void appendSubroutines(std::string& out, const std::string& className, int index, const std::string& callee);
+    };
+}
+
+#endif //NAND2TETRIS_CORPUS_GENERATOR_H
@@ -0,0 +1,49 @@
+//
+// Created on 15/10/2026.
+//
+
+#ifndef NAND2TETRIS_EXECUTION_PROFILE_H
+#define NAND2TETRIS_EXECUTION_PROFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Common/Hash.h"
+
+namespace nand2tetris::jack {
+
+    /// The Hack memory map, shared by the VM interpreter and the CPU emulator.
+    inline constexpr std::size_t RAM_WORDS = 32768;
+    inline constexpr std::size_t SCREEN_BASE = 16384;
+    inline constexpr std::size_t SCREEN_WORDS = 8192;
+
+    /**
+     * @brief What one run of a program did: how much work each subroutine took, and what it left on screen.
+     */
+    struct ExecutionProfile {
+        std::vector<std::string> subroutines; ///< Names, in program order.
+        std::vector<std::uint64_t> executed;  ///< VM commands or Hack instructions run inside each subroutine.
+        std::vector<std::uint64_t> calls;     ///< Times each subroutine was entered (VM only; 0 on Hack).
+        std::uint64_t total = 0;              ///< All of `executed`.
+        bool halted = false;                  ///< False if the step limit stopped the program first.
+        std::uint64_t screenHash = 0;         ///< fnv1a of the screen memory when the program stopped.
+    };
+
+    /**
+     * @brief Hashes the screen memory map of `ram` (little-endian words, the same on every host).
+     */
+    inline std::uint64_t hashScreen(const std::vector<std::int16_t>& ram) {
+        std::uint64_t hash = FNV_OFFSET_BASIS;
+        for (std::size_t i = SCREEN_BASE; i < SCREEN_BASE + SCREEN_WORDS; ++i) {
+            const auto word = static_cast<std::uint16_t>(ram[i]);
+            const char bytes[2] = {static_cast<char>(word & 0xFF), static_cast<char>(word >> 8)};
+            hash = fnv1a(std::string_view(bytes, 2), hash);
+        }
+        return hash;
+    }
+}
+
+#endif //NAND2TETRIS_EXECUTION_PROFILE_H
@@ -0,0 +1,218 @@
+//
+// Created on 15/10/2026.
+//
+
+#include "HackEmulator.h"
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Linker/ProgramLinker.h"
+
+namespace nand2tetris::jack {
+
+    namespace {
+        constexpr std::int32_t FIRST_VARIABLE = 16;
+
+        struct Computation {
+            std::string_view mnemonic;
+            bool useM;
+            std::uint8_t alu;
+        };
+
+        // The comp field of the Hack spec, as the ALU control bits zx nx zy ny f no.
+        constexpr Computation COMPUTATIONS[] = {
+            {"0", false, 0b101010}, {"1", false, 0b111111}, {"-1", false, 0b111010},
+            {"D", false, 0b001100}, {"A", false, 0b110000}, {"!D", false, 0b001101}, {"!A", false, 0b110001},
+            {"-D", false, 0b001111}, {"-A", false, 0b110011}, {"D+1", false, 0b011111}, {"A+1", false, 0b110111},
+            {"D-1", false, 0b001110}, {"A-1", false, 0b110010}, {"D+A", false, 0b000010}, {"D-A", false, 0b010011},
+            {"A-D", false, 0b000111}, {"D&A", false, 0b000000}, {"D|A", false, 0b010101},
+            {"M", true, 0b110000}, {"!M", true, 0b110001}, {"-M", true, 0b110011}, {"M+1", true, 0b110111},
+            {"M-1", true, 0b110010}, {"D+M", true, 0b000010}, {"D-M", true, 0b010011}, {"M-D", true, 0b000111},
+            {"D&M", true, 0b000000}, {"D|M", true, 0b010101}
+        };
+
+        const std::unordered_map<std::string_view, std::int32_t> PREDEFINED = {
+            {"SP", 0}, {"LCL", 1}, {"ARG", 2}, {"THIS", 3}, {"THAT", 4},
+            {"R0", 0}, {"R1", 1}, {"R2", 2}, {"R3", 3}, {"R4", 4}, {"R5", 5}, {"R6", 6}, {"R7", 7},
+            {"R8", 8}, {"R9", 9}, {"R10", 10}, {"R11", 11}, {"R12", 12}, {"R13", 13}, {"R14", 14}, {"R15", 15},
+            {"SCREEN", 16384}, {"KBD", 24576}
+        };
+
+        const Computation* findComputation(const std::string_view comp) {
+            for (const Computation& c : COMPUTATIONS) {
+                if (c.mnemonic == comp) return &c;
+            }
+            // Assemblers also accept the commutative operations written the other way round (A+D, M&D, 1+D).
+            if (comp.size() == 3 && (comp[1] == '+' || comp[1] == '&' || comp[1] == '|')) {
+                const char swapped[3] = {comp[2], comp[1], comp[0]};
+                const std::string_view other(swapped, 3);
+                for (const Computation& c : COMPUTATIONS) {
+                    if (c.mnemonic == other) return &c;
+                }
+            }
+            return nullptr;
+        }
+
+        std::uint8_t parseJump(const std::string_view jump, bool& valid) {
+            constexpr std::string_view JUMPS[] = {"", "JGT", "JEQ", "JGE", "JLT", "JNE", "JLE", "JMP"};
+            for (std::uint8_t i = 0; i < 8; ++i) {
+                if (JUMPS[i] == jump) return i;
+            }
+            valid = false;
+            return 0;
+        }
+
+        std::int16_t compute(const std::uint8_t alu, std::int16_t x, std::int16_t y) {
+            if (alu & 0b100000) x = 0;
+            if (alu & 0b010000) x = static_cast<std::int16_t>(~x);
+            if (alu & 0b001000) y = 0;
+            if (alu & 0b000100) y = static_cast<std::int16_t>(~y);
+            auto out = static_cast<std::int16_t>((alu & 0b000010) ? x + y : x & y);
+            if (alu & 0b000001) out = static_cast<std::int16_t>(~out);
+            return out;
+        }
+    }
+
+    HackEmulator::HackEmulator(const std::string_view assembly, const std::vector<std::string>& functions) {
+        const std::unordered_set<std::string_view> functionSet(functions.begin(), functions.end());
+        names.emplace_back(ProgramLinker::RUNTIME_PART);
+
+        // Pass 1: strip the source down to its instructions and give every label its ROM address.
+        std::vector<std::string> lines;
+        std::unordered_map<std::string, std::int32_t> symbols(PREDEFINED.begin(), PREDEFINED.end());
+        std::size_t at = 0;
+        while (at < assembly.size()) {
+            std::size_t end = assembly.find('\n', at);
+            if (end == std::string_view::npos) end = assembly.size();
+            std::string_view line = assembly.substr(at, end - at);
+            at = end + 1;
+            if (const std::size_t comment = line.find("//"); comment != std::string_view::npos) line = line.substr(0, comment);
+            std::string text;
+            for (const char c : line) {
+                if (!std::isspace(static_cast<unsigned char>(c))) text += c;
+            }
+            if (text.empty()) continue;
+
+            if (text.front() == '(') {
+                if (text.size() < 3 || text.back() != ')') throw std::runtime_error("Not a label: " + text);
+                const std::string label = text.substr(1, text.size() - 2);
+                symbols[label] = static_cast<std::int32_t>(lines.size());
+                if (functionSet.count(label)) {
+                    owner.resize(lines.size(), static_cast<std::uint32_t>(names.size() - 1));
+                    names.push_back(label);
+                }
+                continue;
+            }
+            lines.push_back(std::move(text));
+        }
+        owner.resize(lines.size(), static_cast<std::uint32_t>(names.size() - 1));
+
+        // Pass 2: decode, giving each new symbol the next variable address.
+        std::int32_t nextVariable = FIRST_VARIABLE;
+        rom.reserve(lines.size());
+        for (const std::string& text : lines) {
+            Instruction in;
+            if (text.front() == '@') {
+                const std::string_view operand = std::string_view(text).substr(1);
+                std::int32_t value = 0;
+                if (std::isdigit(static_cast<unsigned char>(operand.front()))) {
+                    const auto [end, ec] = std::from_chars(operand.data(), operand.data() + operand.size(), value);
+                    if (ec != std::errc() || end != operand.data() + operand.size() || value > 32767) {
+                        throw std::runtime_error("Not a Hack constant: " + text);
+                    }
+                } else {
+                    const auto [it, added] = symbols.try_emplace(std::string(operand), nextVariable);
+                    if (added) ++nextVariable;
+                    value = it->second;
+                }
+                in.value = static_cast<std::int16_t>(value);
+                rom.push_back(in);
+                continue;
+            }
+
+            std::string_view rest = text;
+            std::string_view dest;
+            std::string_view jump;
+            if (const std::size_t eq = rest.find('='); eq != std::string_view::npos) {
+                dest = rest.substr(0, eq);
+                rest = rest.substr(eq + 1);
+            }
+            if (const std::size_t semicolon = rest.find(';'); semicolon != std::string_view::npos) {
+                jump = rest.substr(semicolon + 1);
+                rest = rest.substr(0, semicolon);
+            }
+            bool valid = true;
+            const Computation* comp = findComputation(rest);
+            in.address = false;
+            in.jump = parseJump(jump, valid);
+            for (const char c : dest) {
+                const std::uint8_t bit = c == 'A' ? 4 : c == 'D' ? 2 : c == 'M' ? 1 : 0;
+                if (bit == 0 || (in.dest & bit)) valid = false;
+                in.dest |= bit;
+            }
+            if (!comp || !valid) throw std::runtime_error("Not a Hack instruction: " + text);
+            in.alu = comp->alu;
+            in.useM = comp->useM;
+            rom.push_back(in);
+        }
+
+        haltLoop.assign(rom.size(), false);
+        for (std::size_t i = 0; i + 1 < rom.size(); ++i) {
+            const Instruction& next = rom[i + 1];
+            haltLoop[i] = rom[i].address && rom[i].value == static_cast<std::int32_t>(i) && !next.address &&
+                          next.alu == 0b101010 && !next.useM && next.dest == 0 && next.jump == 7;
+        }
+    }
+
+    ExecutionProfile HackEmulator::run(const std::uint64_t maxSteps) {
+        if (!fitsRom()) throw std::runtime_error("Program too big: " + std::to_string(rom.size()) + " instructions for a 32K ROM");
+        std::vector<std::int16_t> ram(RAM_WORDS, 0);
+        ExecutionProfile profile;
+        profile.subroutines = names;
+        profile.executed.assign(names.size(), 0);
+        profile.calls.assign(names.size(), 0);
+
+        auto memory = [&](const std::int16_t address, const std::size_t pc) -> std::int16_t& {
+            if (address < 0) {
+                throw std::runtime_error(names[owner[pc]] + " accesses RAM out of range: " +
+                                         std::to_string(static_cast<std::uint16_t>(address)));
+            }
+            return ram[static_cast<std::size_t>(address)];
+        };
+
+        std::int16_t a = 0;
+        std::int16_t d = 0;
+        std::size_t pc = 0;
+        std::uint64_t steps = 0;
+        while (steps < maxSteps) {
+            if (pc >= rom.size()) throw std::runtime_error("The program ran past the end of the ROM");
+            if (haltLoop[pc]) {
+                profile.halted = true;
+                break;
+            }
+            ++profile.executed[owner[pc]];
+            ++steps;
+
+            const Instruction& in = rom[pc];
+            if (in.address) {
+                a = in.value;
+                ++pc;
+                continue;
+            }
+            const std::int16_t address = a;
+            const std::int16_t out = compute(in.alu, d, in.useM ? memory(address, pc) : a);
+            if (in.dest & 1) memory(address, pc) = out;
+            if (in.dest & 4) a = out;
+            if (in.dest & 2) d = out;
+            const bool taken = ((in.jump & 4) && out < 0) || ((in.jump & 2) && out == 0) || ((in.jump & 1) && out > 0);
+            pc = taken ? static_cast<std::uint16_t>(address) : pc + 1;
+        }
+
+        for (const std::uint64_t count : profile.executed) profile.total += count;
+        profile.screenHash = hashScreen(ram);
+        return profile;
+    }
+}
@@ -0,0 +1,74 @@
+//
+// Created on 15/10/2026.
+//
+
+#ifndef NAND2TETRIS_HACK_EMULATOR_H
+#define NAND2TETRIS_HACK_EMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ExecutionProfile.h"
+#include "HackTranslator/HackTranslator.h"
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief Assembles a Hack program and runs it on an emulated Hack CPU.
+     *
+     * The assembler is the usual two-pass one (predefined symbols, labels, then variables from RAM 16).
+     * Instructions are decoded once, into the ALU control bits of the Hack CPU, so running them is a
+     * table lookup and a few bit operations each. The program stops when it reaches the halting idiom
+     * `(L) @L 0;JMP` (the end of the bootstrap, or Sys.halt) or after the step limit.
+     */
+    class HackEmulator {
+        public:
+            /**
+             * @brief Assembles the program.
+             *
+             * @param functions The functions of the program (e.g. VMInterpreter::functions() of its .vm
+             *        build): the labels that start a subroutine. Instructions before the first of them, the
+             *        bootstrap and the shared call, return and comparison routines, count as
+             *        ProgramLinker::RUNTIME_PART.
+             * @throws std::runtime_error On a line that is not a Hack instruction.
+             */
+            HackEmulator(std::string_view assembly, const std::vector<std::string>& functions);
+
+            /**
+             * @brief Runs the program from a cleared RAM, starting at ROM address 0.
+             *
+             * @throws std::runtime_error If the program does not fit the ROM, or reads or writes outside the RAM.
+             */
+            ExecutionProfile run(std::uint64_t maxSteps);
+
+            /**
+             * @brief The number of instructions in ROM.
+             */
+            std::size_t romSize() const { return rom.size(); }
+
+            /**
+             * @brief Whether the program fits the 32K ROM; one that does not cannot address all its labels.
+             */
+            bool fitsRom() const { return rom.size() <= HackTranslator::ROM_SIZE; }
+
+        private:
+            struct Instruction {
+                std::int16_t value = 0;   ///< A-instructions: the constant.
+                bool address = true;      ///< An A-instruction.
+                std::uint8_t alu = 0;     ///< zx nx zy ny f no, high bit first.
+                bool useM = false;        ///< The ALU's y input is M rather than A.
+                std::uint8_t dest = 0;    ///< A = 4, D = 2, M = 1.
+                std::uint8_t jump = 0;    ///< lt = 4, eq = 2, gt = 1.
+            };
+
+            std::vector<Instruction> rom;
+            std::vector<std::uint32_t> owner;   ///< Per ROM address: its subroutine's index in `names`.
+            std::vector<bool> haltLoop;         ///< Per ROM address: `@self` followed by `0;JMP`.
+            std::vector<std::string> names;
+    };
+}
+
+#endif //NAND2TETRIS_HACK_EMULATOR_H
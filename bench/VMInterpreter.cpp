@@ -0,0 +1,285 @@
+//
+// Created on 15/10/2026.
+//
+
+#include "VMInterpreter.h"
+#include <charconv>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace nand2tetris::jack {
+
+    namespace {
+        constexpr std::string_view SEGMENT_NAMES[] = {
+            "constant", "argument", "local", "static", "this", "that", "pointer", "temp"
+        };
+        constexpr std::string_view COMMAND_NAMES[] = {"add", "sub", "neg", "eq", "gt", "lt", "and", "or", "not"};
+
+        // The pointer registers, as in the Hack memory map.
+        constexpr std::int32_t SP = 0, LCL = 1, ARG = 2, THIS = 3, THAT = 4;
+        constexpr std::int32_t TEMP_BASE = 5, STATIC_BASE = 16, STACK_BASE = 256;
+
+        // The return address the bootstrap hands Sys.init; returning to it ends the program.
+        constexpr std::int16_t NO_RETURN = -1;
+
+        std::vector<std::string_view> splitWords(const std::string_view line) {
+            std::vector<std::string_view> words;
+            std::size_t at = 0;
+            while (at < line.size()) {
+                while (at < line.size() && (line[at] == ' ' || line[at] == '\t' || line[at] == '\r')) ++at;
+                std::size_t end = at;
+                while (end < line.size() && line[end] != ' ' && line[end] != '\t' && line[end] != '\r') ++end;
+                if (end > at) words.push_back(line.substr(at, end - at));
+                at = end;
+            }
+            return words;
+        }
+
+        bool parseNumber(const std::string_view text, std::int32_t& value) {
+            const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+            return ec == std::errc() && end == text.data() + text.size() && value >= 0;
+        }
+
+        template <typename Enum, std::size_t N>
+        bool parseName(const std::string_view text, const std::string_view (&names)[N], Enum& value) {
+            for (std::size_t i = 0; i < N; ++i) {
+                if (names[i] == text) {
+                    value = static_cast<Enum>(i);
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    VMInterpreter::VMInterpreter(const std::string_view program) {
+        std::size_t lineNumber = 0;
+        std::size_t at = 0;
+        while (at < program.size()) {
+            std::size_t end = program.find('\n', at);
+            if (end == std::string_view::npos) end = program.size();
+            std::string_view line = program.substr(at, end - at);
+            at = end + 1;
+            ++lineNumber;
+            if (const std::size_t comment = line.find("//"); comment != std::string_view::npos) line = line.substr(0, comment);
+            const std::vector<std::string_view> words = splitWords(line);
+            if (words.empty()) continue;
+
+            VMInstruction in{VMOp::RETURN};
+            const std::string_view op = words[0];
+            bool valid = false;
+            if ((op == "push" || op == "pop") && words.size() == 3) {
+                in.op = op == "push" ? VMOp::PUSH : VMOp::POP;
+                valid = parseName(words[1], SEGMENT_NAMES, in.segment) && parseNumber(words[2], in.value) &&
+                        !(in.op == VMOp::POP && in.segment == Segment::CONST);
+            } else if ((op == "label" || op == "goto" || op == "if-goto") && words.size() == 2) {
+                in.op = op == "label" ? VMOp::LABEL : op == "goto" ? VMOp::GOTO : VMOp::IF_GOTO;
+                in.symbol = code.symbol(words[1]);
+                valid = true;
+            } else if ((op == "call" || op == "function") && words.size() == 3) {
+                in.op = op == "call" ? VMOp::CALL : VMOp::FUNCTION;
+                in.symbol = code.symbol(words[1]);
+                valid = parseNumber(words[2], in.value);
+            } else if (op == "return" && words.size() == 1) {
+                valid = true;
+            } else if (words.size() == 1) {
+                in.op = VMOp::ARITHMETIC;
+                valid = parseName(op, COMMAND_NAMES, in.command);
+            }
+            if (!valid) throw std::runtime_error("Line " + std::to_string(lineNumber) + " is not a VM command: " + std::string(line));
+            code.instructions.push_back(in);
+        }
+
+        const std::vector<VMInstruction>& instructions = code.instructions;
+        if (instructions.size() > 32767) throw std::runtime_error("Program too big: return addresses must fit in a RAM word");
+        if (instructions.empty() || !instructions.front().is(VMOp::FUNCTION)) {
+            throw std::runtime_error("The program must start with a function");
+        }
+
+        // Functions by name, and labels by (function, name): every function has its own label scope.
+        std::unordered_map<std::uint32_t, std::uint32_t> functionAt;
+        std::unordered_map<std::uint64_t, std::uint32_t> labelAt;
+        owner.resize(instructions.size());
+        for (std::uint32_t i = 0; i < instructions.size(); ++i) {
+            const VMInstruction& in = instructions[i];
+            if (in.is(VMOp::FUNCTION)) {
+                if (!functionAt.emplace(in.symbol, i).second) {
+                    throw std::runtime_error("Function defined twice: " + std::string(code.symbolText(in.symbol)));
+                }
+                functionNames.emplace_back(code.symbolText(in.symbol));
+            }
+            owner[i] = static_cast<std::uint32_t>(functionNames.size() - 1);
+            if (in.is(VMOp::LABEL)) labelAt[(static_cast<std::uint64_t>(owner[i]) << 32) | in.symbol] = i;
+        }
+
+        target.assign(instructions.size(), 0);
+        haltLoop.assign(instructions.size(), false);
+        for (std::uint32_t i = 0; i < instructions.size(); ++i) {
+            const VMInstruction& in = instructions[i];
+            if (in.is(VMOp::GOTO) || in.is(VMOp::IF_GOTO)) {
+                const auto it = labelAt.find((static_cast<std::uint64_t>(owner[i]) << 32) | in.symbol);
+                if (it == labelAt.end()) {
+                    throw std::runtime_error(functionNames[owner[i]] + " jumps to a missing label: " +
+                                             std::string(code.symbolText(in.symbol)));
+                }
+                target[i] = it->second;
+                haltLoop[i] = in.is(VMOp::GOTO) && it->second + 1 == i;
+            } else if (in.is(VMOp::CALL)) {
+                const auto it = functionAt.find(in.symbol);
+                if (it == functionAt.end()) {
+                    throw std::runtime_error(functionNames[owner[i]] + " calls an undefined function: " +
+                                             std::string(code.symbolText(in.symbol)));
+                }
+                target[i] = it->second;
+            }
+        }
+
+        std::uint32_t init = 0;
+        if (!code.findSymbol("Sys.init", init) || !functionAt.count(init)) {
+            throw std::runtime_error("The program has no Sys.init");
+        }
+        entry = functionAt[init];
+    }
+
+    std::int16_t& VMInterpreter::at(const std::int32_t address) {
+        if (address < 0 || address >= static_cast<std::int32_t>(RAM_WORDS)) {
+            throw std::runtime_error(functionNames[currentFunction] + " accesses RAM out of range: " + std::to_string(address));
+        }
+        return ram[static_cast<std::size_t>(address)];
+    }
+
+    std::int16_t& VMInterpreter::segmentWord(const Segment segment, const std::int32_t index) {
+        switch (segment) {
+            case Segment::ARG: return at(ram[ARG] + index);
+            case Segment::LOCAL: return at(ram[LCL] + index);
+            case Segment::THIS: return at(ram[THIS] + index);
+            case Segment::THAT: return at(ram[THAT] + index);
+            case Segment::POINTER: return at(THIS + index);
+            case Segment::TEMP: return at(TEMP_BASE + index);
+            case Segment::STATIC: return at(STATIC_BASE + index);
+            case Segment::CONST: break;
+        }
+        throw std::runtime_error("The constant segment has no memory");
+    }
+
+    ExecutionProfile VMInterpreter::run(const std::uint64_t maxSteps) {
+        ram.assign(RAM_WORDS, 0);
+        ExecutionProfile profile;
+        profile.subroutines = functionNames;
+        profile.executed.assign(functionNames.size(), 0);
+        profile.calls.assign(functionNames.size(), 0);
+
+        auto push = [&](const std::int32_t value) {
+            at(ram[SP]) = static_cast<std::int16_t>(value);
+            ++ram[SP];
+        };
+        auto pop = [&]() -> std::int16_t {
+            --ram[SP];
+            return at(ram[SP]);
+        };
+        auto call = [&](const std::int32_t returnAddress, const std::int32_t nArgs) {
+            push(returnAddress);
+            push(ram[LCL]);
+            push(ram[ARG]);
+            push(ram[THIS]);
+            push(ram[THAT]);
+            ram[ARG] = static_cast<std::int16_t>(ram[SP] - nArgs - 5);
+            ram[LCL] = ram[SP];
+        };
+
+        // The bootstrap: SP = 256, call Sys.init.
+        ram[SP] = STACK_BASE;
+        call(NO_RETURN, 0);
+
+        const std::vector<VMInstruction>& instructions = code.instructions;
+        std::uint32_t pc = entry;
+        std::uint64_t steps = 0;
+        while (!profile.halted && steps < maxSteps) {
+            if (pc >= instructions.size()) throw std::runtime_error("The program ran past its last command");
+            const VMInstruction& in = instructions[pc];
+            if (in.is(VMOp::LABEL)) {
+                ++pc;
+                continue;
+            }
+            if (haltLoop[pc]) {
+                profile.halted = true;
+                break;
+            }
+            currentFunction = owner[pc];
+            ++profile.executed[currentFunction];
+            ++steps;
+
+            switch (in.op) {
+                case VMOp::PUSH:
+                    push(in.segment == Segment::CONST ? in.value : segmentWord(in.segment, in.value));
+                    ++pc;
+                    break;
+                case VMOp::POP: {
+                    const std::int16_t value = pop();
+                    segmentWord(in.segment, in.value) = value;
+                    ++pc;
+                    break;
+                }
+                case VMOp::ARITHMETIC: {
+                    if (in.command == Command::NEG || in.command == Command::NOT) {
+                        const std::int32_t x = pop();
+                        push(in.command == Command::NEG ? -x : ~x);
+                    } else {
+                        const std::int32_t y = pop();
+                        const std::int32_t x = pop();
+                        switch (in.command) {
+                            case Command::ADD: push(x + y); break;
+                            case Command::SUB: push(x - y); break;
+                            case Command::EQ: push(x == y ? -1 : 0); break;
+                            case Command::GT: push(x > y ? -1 : 0); break;
+                            case Command::LT: push(x < y ? -1 : 0); break;
+                            case Command::AND: push(x & y); break;
+                            case Command::OR: push(x | y); break;
+                            default: break;
+                        }
+                    }
+                    ++pc;
+                    break;
+                }
+                case VMOp::GOTO:
+                    pc = target[pc];
+                    break;
+                case VMOp::IF_GOTO:
+                    pc = pop() != 0 ? target[pc] : pc + 1;
+                    break;
+                case VMOp::CALL:
+                    call(static_cast<std::int32_t>(pc + 1), in.value);
+                    pc = target[pc];
+                    break;
+                case VMOp::FUNCTION:
+                    ++profile.calls[currentFunction];
+                    for (std::int32_t i = 0; i < in.value; ++i) push(0);
+                    ++pc;
+                    break;
+                case VMOp::RETURN: {
+                    const std::int32_t frame = ram[LCL];
+                    // Read before `argument 0` is overwritten: with no arguments it is the same word.
+                    const std::int16_t returnAddress = at(frame - 5);
+                    at(ram[ARG]) = pop();
+                    ram[SP] = static_cast<std::int16_t>(ram[ARG] + 1);
+                    ram[THAT] = at(frame - 1);
+                    ram[THIS] = at(frame - 2);
+                    ram[ARG] = at(frame - 3);
+                    ram[LCL] = at(frame - 4);
+                    if (returnAddress == NO_RETURN) {
+                        profile.halted = true;
+                        break;
+                    }
+                    pc = static_cast<std::uint32_t>(returnAddress);
+                    break;
+                }
+                case VMOp::LABEL:
+                    break;
+            }
+        }
+
+        for (const std::uint64_t count : profile.executed) profile.total += count;
+        profile.screenHash = hashScreen(ram);
+        return profile;
+    }
+}
@@ -0,0 +1,64 @@
+//
+// Created on 15/10/2026.
+//
+
+#ifndef NAND2TETRIS_VM_INTERPRETER_H
+#define NAND2TETRIS_VM_INTERPRETER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ExecutionProfile.h"
+#include "VMWriter/VMCode.h"
+
+namespace nand2tetris::jack {
+
+    /**
+     * @brief Runs a linked .vm program (one file with every class and the OS, as written by --output).
+     *
+     * Follows the VM emulator of nand2tetris: the stack starts at 256, `Sys.init` is called as by the
+     * bootstrap, statics are numbered from RAM 16 across the whole file, and labels are scoped to their
+     * function. The program stops when it enters a `label L; goto L` loop (Sys.halt) or after the step
+     * limit. Labels are not counted as executed commands.
+     */
+    class VMInterpreter {
+        public:
+            /**
+             * @brief Parses the program and resolves every jump and call.
+             *
+             * @throws std::runtime_error On a line that is not a VM command, a jump to a label missing from its
+             *         function, or a call to a function the program does not define.
+             */
+            explicit VMInterpreter(std::string_view program);
+
+            /**
+             * @brief Runs the program from a cleared RAM.
+             *
+             * @throws std::runtime_error If the program reads or writes outside the RAM.
+             */
+            ExecutionProfile run(std::uint64_t maxSteps);
+
+            /**
+             * @brief The functions of the program, in file order.
+             */
+            const std::vector<std::string>& functions() const { return functionNames; }
+
+        private:
+            std::int16_t& at(std::int32_t address);
+            std::int16_t& segmentWord(Segment segment, std::int32_t index);
+
+            VMCode code;
+            std::vector<std::uint32_t> target;  ///< Per instruction: the jump target or the callee's FUNCTION.
+            std::vector<std::uint32_t> owner;   ///< Per instruction: its function's index.
+            std::vector<bool> haltLoop;         ///< Per instruction: a goto to the label just before it.
+            std::vector<std::string> functionNames;
+            std::uint32_t entry = 0;            ///< The FUNCTION instruction of Sys.init.
+            std::vector<std::int16_t> ram;
+            std::size_t currentFunction = 0;
+    };
+}
+
+#endif //NAND2TETRIS_VM_INTERPRETER_H
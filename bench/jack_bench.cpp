@@ -0,0 +1,322 @@
+//
+// Created on 14/10/2026.
+//
+// jack_bench: times each compiler phase on its own, over a generated corpus.
+//
+// Every phase runs single-threaded over the whole corpus, `--warmup` times unmeasured and then `--runs`
+// times measured; the report gives the spread of the measured runs and the throughput at the median.
+// The corpus is fixed by its options and seed, and its hash is printed so results from different
+// machines can be compared like for like.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "CorpusGenerator.h"
+#include "CodeGenerator/CodeGenerator.h"
+#include "Common/Arena.h"
+#include "Common/FileIO.h"
+#include "Common/Hash.h"
+#include "Parser/Parser.h"
+#include "SemanticAnalyser/GlobalRegistry.h"
+#include "SemanticAnalyser/SemanticAnalyser.h"
+#include "Serialization/BinaryReader.h"
+#include "Serialization/BinaryWriter.h"
+#include "Tokenizer/Tokenizer.h"
+#include "VMWriter/VMWriter.h"
+
+using namespace nand2tetris::jack;
+namespace fs = std::filesystem;
+
+namespace {
+
+    struct BenchOptions {
+        CorpusOptions corpus;
+        int runs = 10;
+        int warmup = 2;
+        std::string phase = "all";
+        bool csv = false;
+        std::optional<fs::path> keepDir; // Write the corpus here and leave it; otherwise a temp dir is used.
+    };
+
+    // One parsed class, kept alive for the analysis and code generation phases.
+    struct ParsedClass {
+        std::unique_ptr<Tokenizer> tokenizer;
+        std::unique_ptr<Arena> arena;
+        ClassNode* ast = nullptr;
+    };
+
+    // What one run of a phase produced, for the throughput figures (the same on every run).
+    struct Work {
+        std::size_t items = 0;
+        const char* unit = "";
+    };
+
+    struct Summary {
+        double median = 0, mean = 0, stddev = 0, min = 0, max = 0;
+    };
+
+    Summary summarise(std::vector<double> samples) {
+        Summary s;
+        std::sort(samples.begin(), samples.end());
+        const std::size_t n = samples.size();
+        s.min = samples.front();
+        s.max = samples.back();
+        s.median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+        for (const double x : samples) s.mean += x;
+        s.mean /= static_cast<double>(n);
+        if (n > 1) {
+            double squares = 0;
+            for (const double x : samples) squares += (x - s.mean) * (x - s.mean);
+            s.stddev = std::sqrt(squares / static_cast<double>(n - 1));
+        }
+        return s;
+    }
+
+    // Runs `body` warmup + runs times and returns the measured durations in milliseconds.
+    std::vector<double> measure(const BenchOptions& options, const std::function<void()>& body) {
+        std::vector<double> samples;
+        samples.reserve(static_cast<std::size_t>(options.runs));
+        for (int i = 0; i < options.warmup + options.runs; ++i) {
+            const auto begin = std::chrono::steady_clock::now();
+            body();
+            const auto end = std::chrono::steady_clock::now();
+            if (i >= options.warmup) samples.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+        }
+        return samples;
+    }
+
+    void printHeader(const BenchOptions& options) {
+        if (options.csv) {
+            std::cout << "phase,runs,median_ms,mean_ms,stddev_ms,min_ms,max_ms,source_mb_per_s,items,item_unit,items_per_s\n";
+            return;
+        }
+        std::cout << std::left << std::setw(10) << "phase" << std::right
+                  << std::setw(11) << "median ms" << std::setw(11) << "mean ms" << std::setw(10) << "stddev"
+                  << std::setw(10) << "min ms" << std::setw(10) << "max ms" << std::setw(12) << "MB/s"
+                  << "   per second\n";
+    }
+
+    void printPhase(const BenchOptions& options, const char* name, const std::vector<double>& samples,
+                    const std::size_t sourceBytes, const Work& work) {
+        const Summary s = summarise(samples);
+        const double seconds = s.median / 1000.0;
+        const double megabytesPerSecond = static_cast<double>(sourceBytes) / (1024.0 * 1024.0) / seconds;
+        const double itemsPerSecond = static_cast<double>(work.items) / seconds;
+        if (options.csv) {
+            std::cout << name << ',' << samples.size() << ',' << s.median << ',' << s.mean << ',' << s.stddev << ','
+                      << s.min << ',' << s.max << ',' << megabytesPerSecond << ',' << work.items << ',' << work.unit << ','
+                      << itemsPerSecond << '\n';
+            return;
+        }
+        const double relative = s.mean > 0 ? 100.0 * s.stddev / s.mean : 0.0;
+        std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(11) << s.median << std::setw(11) << s.mean
+                  << std::setw(9) << std::setprecision(1) << relative << '%'
+                  << std::setw(10) << std::setprecision(3) << s.min << std::setw(10) << s.max
+                  << std::setw(12) << std::setprecision(1) << megabytesPerSecond
+                  << "   " << std::setprecision(2) << itemsPerSecond / 1e6 << " M " << work.unit << "/s\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+
+    std::vector<ParsedClass> parseAll(const std::vector<fs::path>& files, GlobalRegistry& registry) {
+        std::vector<ParsedClass> classes;
+        classes.reserve(files.size());
+        for (const auto& file : files) {
+            ParsedClass parsed{std::make_unique<Tokenizer>(file.string()), std::make_unique<Arena>()};
+            Parser parser(*parsed.tokenizer, registry, *parsed.arena);
+            parsed.ast = parser.parse();
+            classes.push_back(std::move(parsed));
+        }
+        return classes;
+    }
+
+    bool wants(const BenchOptions& options, const std::string& phase) {
+        return options.phase == "all" || options.phase == phase;
+    }
+
+    void usage() {
+        std::cerr << "Usage: jack_bench [--shape samples|small|giant|nested] [--size-kb N] [--depth N] [--seed N]\n"
+                     "                  [--runs N] [--warmup N] [--phase all|tokenize|parse|analyse|codegen|serialize]\n"
+                     "                  [--samples DIR] [--keep DIR] [--csv]" << std::endl;
+    }
+
+    // Parses a whole-number option value; false if it is not one or is below `minimum`.
+    bool parseCount(const std::string& text, const long minimum, long& value) {
+        char* end = nullptr;
+        value = std::strtol(text.c_str(), &end, 10);
+        return !text.empty() && *end == '\0' && value >= minimum;
+    }
+
+    bool parseArguments(const int argc, char* argv[], BenchOptions& options) {
+        options.corpus.samplesDir = JACK_SAMPLES_DIR;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--csv") {
+                options.csv = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                std::cerr << "Error: Unknown option or missing value: " << arg << std::endl;
+                return false;
+            }
+            const std::string value = argv[++i];
+            long number = 0;
+            if (arg == "--shape") {
+                if (!parseCorpusShape(value, options.corpus.shape)) {
+                    std::cerr << "Error: Unknown corpus shape: " << value << std::endl;
+                    return false;
+                }
+            } else if (arg == "--phase") {
+                if (value != "all" && value != "tokenize" && value != "parse" && value != "analyse" && value != "codegen" &&
+                    value != "serialize") {
+                    std::cerr << "Error: Unknown phase: " << value << std::endl;
+                    return false;
+                }
+                options.phase = value;
+            } else if (arg == "--samples") {
+                options.corpus.samplesDir = value;
+            } else if (arg == "--keep") {
+                options.keepDir = fs::path(value);
+            } else if ((arg == "--size-kb" || arg == "--depth" || arg == "--seed" || arg == "--runs" || arg == "--warmup") &&
+                       parseCount(value, arg == "--warmup" || arg == "--seed" ? 0 : 1, number)) {
+                if (arg == "--size-kb") options.corpus.targetBytes = static_cast<std::size_t>(number) * 1024;
+                if (arg == "--depth") options.corpus.nestingDepth = static_cast<int>(number);
+                if (arg == "--seed") options.corpus.seed = static_cast<std::uint32_t>(number);
+                if (arg == "--runs") options.runs = static_cast<int>(number);
+                if (arg == "--warmup") options.warmup = static_cast<int>(number);
+            } else {
+                std::cerr << "Error: Invalid option: " << arg << " " << value << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::ios_base::sync_with_stdio(false);
+
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+
+    const fs::path corpusDir = options.keepDir ? *options.keepDir
+        : fs::temp_directory_path() / ("jack_bench_" + std::to_string(options.corpus.seed) + "_" +
+                                       std::to_string(static_cast<long long>(std::chrono::steady_clock::now().time_since_epoch().count())));
+    try {
+        const std::vector<fs::path> files = CorpusGenerator(options.corpus).writeTo(corpusDir);
+
+        std::size_t sourceBytes = 0;
+        std::uint64_t corpusHash = FNV_OFFSET_BASIS;
+        for (const auto& file : files) {
+            const std::optional<std::string> text = readFile(file);
+            if (!text) throw std::runtime_error("Cannot read back " + file.string());
+            sourceBytes += text->size();
+            corpusHash = fnv1a(*text, corpusHash);
+        }
+
+        // One untimed pass gathers the counts the throughput figures are based on, and checks the corpus.
+        auto registry = std::make_unique<GlobalRegistry>();
+        std::vector<ParsedClass> classes = parseAll(files, *registry);
+        registry->freeze();
+        std::size_t tokens = 0;
+        for (const auto& file : files) {
+            for (Tokenizer tokenizer(file.string()); tokenizer.hasMoreTokens(); tokenizer.advance()) ++tokens;
+        }
+        std::size_t nodes = 0;
+        for (const auto& parsed : classes) nodes += parsed.arena->objectCount();
+        std::size_t commands = 0;
+        for (const auto& parsed : classes) {
+            SymbolTable table;
+            SemanticAnalyser(*registry, parsed.tokenizer->lines()).analyseClass(*parsed.ast, table);
+            VMWriter writer;
+            CodeGenerator(*registry, writer).compileClass(*parsed.ast);
+            commands += writer.code().instructions.size();
+        }
+
+        if (!options.csv) {
+            std::cout << "corpus:  " << corpusShapeName(options.corpus.shape) << ", seed " << options.corpus.seed << ", "
+                      << files.size() << " files, " << sourceBytes << " bytes, hash " << std::hex << corpusHash << std::dec << '\n'
+                      << "         " << tokens << " tokens, " << nodes << " AST nodes, " << commands << " VM commands\n"
+                      << "runs:    " << options.runs << " measured after " << options.warmup << " warm-up\n\n";
+        }
+        printHeader(options);
+
+        if (wants(options, "tokenize")) {
+            const auto samples = measure(options, [&] {
+                for (const auto& file : files) {
+                    for (Tokenizer tokenizer(file.string()); tokenizer.hasMoreTokens(); tokenizer.advance()) {}
+                }
+            });
+            printPhase(options, "tokenize", samples, sourceBytes, {tokens, "tokens"});
+        }
+
+        // Parsing includes tokenizing: the parser pulls tokens on demand.
+        if (wants(options, "parse")) {
+            const auto samples = measure(options, [&] {
+                GlobalRegistry fresh;
+                parseAll(files, fresh);
+            });
+            printPhase(options, "parse", samples, sourceBytes, {nodes, "nodes"});
+        }
+
+        // Analysis and code generation run over the ASTs parsed above; both only update per-node bindings.
+        if (wants(options, "analyse")) {
+            const auto samples = measure(options, [&] {
+                for (const auto& parsed : classes) {
+                    SymbolTable table;
+                    SemanticAnalyser(*registry, parsed.tokenizer->lines()).analyseClass(*parsed.ast, table);
+                }
+            });
+            printPhase(options, "analyse", samples, sourceBytes, {nodes, "nodes"});
+        }
+
+        // Code generation includes rendering the .vm text, but not writing it to disk.
+        if (wants(options, "codegen")) {
+            const auto samples = measure(options, [&] {
+                for (const auto& parsed : classes) {
+                    VMWriter writer(parsed.tokenizer->sourceText().size() / 4);
+                    CodeGenerator(*registry, writer).compileClass(*parsed.ast);
+                    const std::string text = writer.contents();
+                }
+            });
+            printPhase(options, "codegen", samples, sourceBytes, {commands, "commands"});
+        }
+
+        // Serialization writes the binary program file in memory and reads it back in (without symbol tables).
+        if (wants(options, "serialize")) {
+            const auto samples = measure(options, [&] {
+                BinaryWriter writer;
+                for (std::size_t i = 0; i < classes.size(); ++i) writer.addClass(files[i].string(), *classes[i].ast, nullptr);
+                writer.addRegistry(*registry);
+                const std::string bytes = writer.finish();
+                const BinaryReader reader(bytes);
+            });
+            printPhase(options, "serialize", samples, sourceBytes, {nodes, "nodes"});
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        if (!options.keepDir) fs::remove_all(corpusDir);
+        return 1;
+    }
+
+    if (!options.keepDir) {
+        std::error_code ec;
+        fs::remove_all(corpusDir, ec);
+    }
+    return 0;
+}
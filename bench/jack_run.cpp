@@ -0,0 +1,424 @@
+//
+// Created on 15/10/2026.
+//
+// jack_run: runs the sample programs as compiled and counts what the generated code costs at run time.
+//
+// Each program is compiled by the compiler binary itself (so any build of it can be measured, see
+// `--compiler`) once per optimisation configuration, linked with the OS into one .vm and one .asm file.
+// The .vm runs on the VM interpreter and the .asm on the Hack CPU emulator; the report gives the VM
+// commands and Hack instructions executed, per program and per subroutine. Every run has to leave the
+// screen exactly as the unoptimised VM run does, so a pass that changes what a program does fails the
+// harness. `--results` saves the counts as CSV and `--baseline` compares a run with such a file, e.g.
+// one written with the previous compiler version.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Common/FileIO.h"
+#include "HackEmulator.h"
+#include "Linker/ProgramLinker.h"
+#include "VMInterpreter.h"
+
+using namespace nand2tetris::jack;
+namespace fs = std::filesystem;
+
+namespace {
+
+    struct RunOptions {
+        fs::path compiler = JACK_COMPILER;
+        fs::path osDir = JACK_OS_DIR;
+        fs::path samplesDir = JACK_SAMPLES_DIR;
+        std::string program = "all";
+        std::uint64_t maxSteps = 2'000'000'000;
+        int top = 10;
+        std::optional<fs::path> resultsFile;
+        std::optional<fs::path> baselineFile;
+        std::optional<fs::path> keepDir; // Build in this folder and leave it; otherwise a temp dir is used.
+    };
+
+    struct Config {
+        std::string_view name;
+        std::string_view flags;
+    };
+
+    // The first is the reference: every other run must leave the screen as it does.
+    constexpr Config CONFIGS[] = {
+        {"O0", ""},
+        {"O1", "-O1"},
+        {"O1-inline", "-O1 --inline"},
+        {"O1-inline-dce", "-O1 --inline --dce"}
+    };
+
+    constexpr std::string_view BENCHMARK_MAIN =
+        "class Main {\n"
+        "    function void main() {\n"
+        "        do Benchmark.main();\n"
+        "        return;\n"
+        "    }\n"
+        "}\n";
+
+    // StressTest has no constructor; its object is just a block for its hundred fields.
+    constexpr std::string_view STRESS_MAIN =
+        "class Main {\n"
+        "    function void main() {\n"
+        "        var StressTest test;\n"
+        "        let test = Memory.alloc(100);\n"
+        "        do test.runStress();\n"
+        "        return;\n"
+        "    }\n"
+        "}\n";
+
+    struct SampleProgram {
+        std::string_view name;
+        std::string_view source; ///< A .jack file or a folder of the samples directory.
+        std::string_view driver; ///< The Main.jack to add, for a class that has none.
+    };
+
+    constexpr SampleProgram PROGRAMS[] = {
+        {"Benchmark", "Benchmark.jack", BENCHMARK_MAIN},
+        {"StressTest", "StressTest.jack", STRESS_MAIN},
+        {"JackProject", "JackProject", ""},
+        {"StringPoolBudget", "StringPoolBudget", ""}
+    };
+
+    // One program built with one configuration and run on both machines.
+    struct Measurement {
+        std::string program;
+        std::string config;
+        ExecutionProfile vm;
+        ExecutionProfile hack;  ///< Empty if the program does not fit the ROM.
+        std::size_t romSize = 0;
+        bool ranOnHack = false;
+    };
+
+    // The totals of a results file, by "program,config".
+    struct BaselineTotal {
+        std::uint64_t vmCommands = 0;
+        std::uint64_t hackInstructions = 0;
+        std::string screenHash;
+    };
+
+    std::string quoted(const fs::path& path) {
+        return "\"" + path.string() + "\"";
+    }
+
+    std::string hex(const std::uint64_t value) {
+        std::ostringstream out;
+        out << std::hex << std::setw(16) << std::setfill('0') << value;
+        return out.str();
+    }
+
+    std::string hackTotal(const Measurement& run) {
+        return run.ranOnHack ? std::to_string(run.hack.total) : "-";
+    }
+
+    std::string percentChange(const std::uint64_t now, const std::uint64_t before) {
+        if (before == 0) return "-";
+        std::ostringstream out;
+        const double change = 100.0 * (static_cast<double>(now) - static_cast<double>(before)) / static_cast<double>(before);
+        out << std::showpos << std::fixed << std::setprecision(1) << change << '%';
+        return out.str();
+    }
+
+    std::uint64_t countOf(const ExecutionProfile& profile, const std::string& subroutine) {
+        for (std::size_t i = 0; i < profile.subroutines.size(); ++i) {
+            if (profile.subroutines[i] == subroutine) return profile.executed[i];
+        }
+        return 0;
+    }
+
+    // Copies a sample (and its driver) into `dir`, the folder the compiler is pointed at.
+    void stageProgram(const RunOptions& options, const SampleProgram& program, const fs::path& dir) {
+        fs::create_directories(dir);
+        const fs::path source = options.samplesDir / program.source;
+        if (fs::is_directory(source)) {
+            for (const auto& entry : fs::directory_iterator(source)) {
+                if (entry.path().extension() == ".jack") fs::copy_file(entry.path(), dir / entry.path().filename());
+            }
+        } else {
+            fs::copy_file(source, dir / source.filename());
+        }
+        if (!program.driver.empty()) writeFileAtomically(dir / "Main.jack", program.driver);
+    }
+
+    // Only the sources: a library cache from another compiler version must not be reused.
+    void stageOs(const RunOptions& options, const fs::path& dir) {
+        fs::create_directories(dir);
+        for (const auto& entry : fs::directory_iterator(options.osDir)) {
+            if (entry.path().extension() == ".jack") fs::copy_file(entry.path(), dir / entry.path().filename());
+        }
+    }
+
+    std::string compile(const RunOptions& options, const fs::path& sources, const fs::path& os, const fs::path& output,
+                        const Config& config, const bool assembly) {
+        const fs::path log = fs::path(output).concat(".log");
+        std::string command = quoted(options.compiler) + " " + quoted(sources) + " --os=" + quoted(os) +
+                              " --output=" + quoted(output) + " --no-cache";
+        if (!config.flags.empty()) command += " " + std::string(config.flags);
+        if (assembly) command += " --emit=asm";
+        command += " > " + quoted(log) + " 2>&1";
+        if (std::system(command.c_str()) != 0) {
+            throw std::runtime_error("The compiler failed:\n" + readFile(log).value_or("(no output)"));
+        }
+        std::optional<std::string> program = readFile(output);
+        if (!program) throw std::runtime_error("The compiler wrote no " + output.filename().string());
+        return std::move(*program);
+    }
+
+    Measurement measure(const RunOptions& options, const SampleProgram& program, const Config& config,
+                        const fs::path& sources, const fs::path& os, const fs::path& workDir) {
+        const std::string stem = std::string(program.name) + "." + std::string(config.name);
+        Measurement result;
+        result.program = std::string(program.name);
+        result.config = std::string(config.name);
+
+        VMInterpreter vm(compile(options, sources, os, workDir / (stem + ".vm"), config, false));
+        result.vm = vm.run(options.maxSteps);
+
+        HackEmulator hack(compile(options, sources, os, workDir / (stem + ".asm"), config, true), vm.functions());
+        result.romSize = hack.romSize();
+        if (hack.fitsRom()) {
+            result.hack = hack.run(options.maxSteps);
+            result.ranOnHack = true;
+        }
+        return result;
+    }
+
+    void printProgram(const RunOptions& options, const std::vector<Measurement>& runs) {
+        const Measurement& reference = runs.front();
+        std::cout << reference.program << '\n'
+                  << "  " << std::left << std::setw(16) << "config" << std::right << std::setw(14) << "VM commands"
+                  << std::setw(9) << "vs O0" << std::setw(16) << "Hack instr." << std::setw(9) << "vs O0"
+                  << std::setw(8) << "ROM" << "   screen\n";
+        for (const Measurement& run : runs) {
+            std::cout << "  " << std::left << std::setw(16) << run.config << std::right
+                      << std::setw(14) << run.vm.total << std::setw(9) << percentChange(run.vm.total, reference.vm.total)
+                      << std::setw(16) << hackTotal(run)
+                      << std::setw(9) << (run.ranOnHack ? percentChange(run.hack.total, reference.hack.total) : "-")
+                      << std::setw(8) << run.romSize << "   " << hex(run.vm.screenHash).substr(0, 8)
+                      << (run.ranOnHack ? "" : "   (too big for the 32K ROM)") << '\n';
+        }
+
+        // Without Hack counts, the subroutines are ranked by VM commands instead.
+        const bool byHack = reference.ranOnHack;
+        const ExecutionProfile& ranked = byHack ? reference.hack : reference.vm;
+
+        // The subroutines that cost the most unoptimised, and what each configuration made of them.
+        std::vector<std::size_t> order(ranked.subroutines.size());
+        for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](const std::size_t a, const std::size_t b) {
+            return ranked.executed[a] > ranked.executed[b];
+        });
+        if (order.size() > static_cast<std::size_t>(options.top)) order.resize(static_cast<std::size_t>(options.top));
+
+        std::cout << "  " << std::left << std::setw(30) << (byHack ? "Hack instructions by subroutine" : "VM commands by subroutine")
+                  << std::right << std::setw(10) << "calls";
+        for (const Measurement& run : runs) std::cout << std::setw(15) << run.config;
+        std::cout << '\n';
+        for (const std::size_t i : order) {
+            const std::string& name = ranked.subroutines[i];
+            const std::uint64_t calls = [&] {
+                for (std::size_t f = 0; f < reference.vm.subroutines.size(); ++f) {
+                    if (reference.vm.subroutines[f] == name) return reference.vm.calls[f];
+                }
+                return std::uint64_t{0};
+            }();
+            std::cout << "    " << std::left << std::setw(28) << name << std::right << std::setw(10) << calls;
+            for (const Measurement& run : runs) std::cout << std::setw(15) << countOf(byHack ? run.hack : run.vm, name);
+            std::cout << '\n';
+        }
+        std::cout << '\n';
+    }
+
+    void writeResults(const fs::path& path, const std::vector<Measurement>& all) {
+        std::ostringstream out;
+        out << "program,config,subroutine,calls,vm_commands,hack_instructions,screen_hash\n";
+        for (const Measurement& run : all) {
+            // Hack instructions are left empty for a program that did not fit the ROM.
+            const auto hackCount = [&](const std::string& name) {
+                return run.ranOnHack ? std::to_string(countOf(run.hack, name)) : std::string();
+            };
+            out << run.program << ',' << run.config << ",(total),," << run.vm.total << ','
+                << (run.ranOnHack ? std::to_string(run.hack.total) : "") << ',' << hex(run.vm.screenHash) << '\n';
+            if (run.ranOnHack) {
+                out << run.program << ',' << run.config << ',' << ProgramLinker::RUNTIME_PART << ",0,0,"
+                    << hackCount(std::string(ProgramLinker::RUNTIME_PART)) << ",\n";
+            }
+            for (std::size_t f = 0; f < run.vm.subroutines.size(); ++f) {
+                const std::string& name = run.vm.subroutines[f];
+                out << run.program << ',' << run.config << ',' << name << ',' << run.vm.calls[f] << ','
+                    << run.vm.executed[f] << ',' << hackCount(name) << ",\n";
+            }
+        }
+        writeFileAtomically(path, out.str());
+    }
+
+    std::map<std::string, BaselineTotal> readBaseline(const fs::path& path) {
+        const std::optional<std::string> text = readFile(path);
+        if (!text) throw std::runtime_error("Cannot read the baseline " + path.string());
+        std::map<std::string, BaselineTotal> totals;
+        std::istringstream lines(*text);
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::vector<std::string> fields;
+            std::istringstream columns(line);
+            for (std::string field; std::getline(columns, field, ',');) fields.push_back(field);
+            if (fields.size() < 7 || fields[2] != "(total)") continue;
+            totals[fields[0] + "," + fields[1]] = {std::stoull(fields[4]), fields[5].empty() ? 0 : std::stoull(fields[5]),
+                                                   fields[6]};
+        }
+        return totals;
+    }
+
+    // Prints how the run compares with the baseline; false if any program now leaves a different screen.
+    bool compareWithBaseline(const fs::path& path, const std::vector<Measurement>& all) {
+        const std::map<std::string, BaselineTotal> baseline = readBaseline(path);
+        bool same = true;
+        std::cout << "Against " << path.string() << ":\n";
+        for (const Measurement& run : all) {
+            const auto it = baseline.find(run.program + "," + run.config);
+            if (it == baseline.end()) continue;
+            const bool screen = it->second.screenHash == hex(run.vm.screenHash);
+            same = same && screen;
+            std::cout << "  " << std::left << std::setw(14) << run.program << std::setw(16) << run.config << std::right
+                      << "VM commands " << std::setw(8) << percentChange(run.vm.total, it->second.vmCommands)
+                      << "   Hack instructions " << std::setw(8)
+                      << (run.ranOnHack ? percentChange(run.hack.total, it->second.hackInstructions) : "-")
+                      << "   " << (screen ? "same screen" : "SCREEN CHANGED") << '\n';
+        }
+        std::cout << '\n';
+        return same;
+    }
+
+    void usage() {
+        std::cerr << "Usage: jack_run [--program all|Benchmark|StressTest|JackProject|StringPoolBudget] [--compiler PATH] [--os DIR]\n"
+                     "                [--samples DIR] [--max-steps N] [--top N] [--results FILE] [--baseline FILE]\n"
+                     "                [--keep DIR]" << std::endl;
+    }
+
+    bool parseArguments(const int argc, char* argv[], RunOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "Error: Unknown option or missing value: " << arg << std::endl;
+                return false;
+            }
+            const std::string value = argv[++i];
+            char* end = nullptr;
+            const unsigned long long number = std::strtoull(value.c_str(), &end, 10);
+            const bool isNumber = !value.empty() && *end == '\0';
+            if (arg == "--program") {
+                bool known = value == "all";
+                for (const SampleProgram& program : PROGRAMS) known = known || program.name == value;
+                if (!known) {
+                    std::cerr << "Error: Unknown program: " << value << std::endl;
+                    return false;
+                }
+                options.program = value;
+            } else if (arg == "--compiler") {
+                options.compiler = value;
+            } else if (arg == "--os") {
+                options.osDir = value;
+            } else if (arg == "--samples") {
+                options.samplesDir = value;
+            } else if (arg == "--results") {
+                options.resultsFile = fs::path(value);
+            } else if (arg == "--baseline") {
+                options.baselineFile = fs::path(value);
+            } else if (arg == "--keep") {
+                options.keepDir = fs::path(value);
+            } else if (arg == "--max-steps" && isNumber && number > 0) {
+                options.maxSteps = number;
+            } else if (arg == "--top" && isNumber) {
+                options.top = static_cast<int>(number);
+            } else {
+                std::cerr << "Error: Invalid option: " << arg << " " << value << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::ios_base::sync_with_stdio(false);
+
+    RunOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+
+    const fs::path workDir = options.keepDir ? *options.keepDir
+        : fs::temp_directory_path() / ("jack_run_" +
+                                       std::to_string(static_cast<long long>(std::chrono::steady_clock::now().time_since_epoch().count())));
+    std::vector<Measurement> all;
+    std::vector<std::string> failures;
+    try {
+        std::cout << "compiler: " << options.compiler.string() << '\n'
+                  << "limit:    " << options.maxSteps << " steps per run\n\n";
+        const fs::path os = workDir / "os";
+        stageOs(options, os);
+
+        for (const SampleProgram& program : PROGRAMS) {
+            if (options.program != "all" && options.program != program.name) continue;
+            const fs::path sources = workDir / program.name;
+            stageProgram(options, program, sources);
+
+            std::vector<Measurement> runs;
+            for (const Config& config : CONFIGS) {
+                const std::string what = std::string(program.name) + " " + std::string(config.name);
+                try {
+                    Measurement run = measure(options, program, config, sources, os, workDir);
+                    if (!run.vm.halted) failures.push_back(what + ": the VM program did not halt within the step limit");
+                    if (run.ranOnHack && !run.hack.halted) {
+                        failures.push_back(what + ": the Hack program did not halt within the step limit");
+                    }
+                    if (run.ranOnHack && run.hack.screenHash != run.vm.screenHash) {
+                        failures.push_back(what + ": the Hack program leaves a different screen than the VM program");
+                    }
+                    if (!runs.empty() && run.vm.screenHash != runs.front().vm.screenHash) {
+                        failures.push_back(what + ": leaves a different screen than " + runs.front().config);
+                    }
+                    runs.push_back(std::move(run));
+                } catch (const std::exception& e) {
+                    failures.push_back(what + ": " + e.what());
+                }
+            }
+            if (runs.empty()) continue;
+            printProgram(options, runs);
+            all.insert(all.end(), runs.begin(), runs.end());
+        }
+
+        if (options.baselineFile && !compareWithBaseline(*options.baselineFile, all)) {
+            failures.emplace_back("The output differs from the baseline");
+        }
+        if (options.resultsFile) {
+            writeResults(*options.resultsFile, all);
+            std::cout << "Results written to " << options.resultsFile->string() << '\n';
+        }
+    } catch (const std::exception& e) {
+        failures.emplace_back(e.what());
+    }
+
+    if (!options.keepDir) {
+        std::error_code ec;
+        fs::remove_all(workDir, ec);
+    }
+    for (const std::string& failure : failures) std::cerr << "FAILED: " << failure << '\n';
+    std::cerr.flush();
+    return failures.empty() ? 0 : 1;
+}
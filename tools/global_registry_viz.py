@@ -7,6 +7,7 @@ from textual.app import App, ComposeResult
 from textual.widgets import Header, Footer, DataTable, Input
 from textual.containers import Container
 from textual.binding import Binding
+from jack_binary import Program
 
 # ==================================================================================================
 # WIDGET: Registry Browser
@@ -49,12 +50,15 @@ class RegistryBrowser(Container):
         # 2. Parse JSON
         # We keep specific exceptions for IO/JSON as they are expected runtime conditions
         try:
-            with open(self.json_path, 'r') as f:
-                data = json.load(f)
+            if self.json_path.endswith(".jkb"):
+                data = Program(self.json_path).registry_json()
+            else:
+                with open(self.json_path, 'r') as f:
+                    data = json.load(f)
         except json.JSONDecodeError as e:
             self.notify(f"Invalid JSON format: {e}", severity="error")
             raise # Re-raise to ensure visibility in logs/traceback if needed
-        except IOError as e:
+        except (IOError, ValueError) as e:
             self.notify(f"IO Error reading file: {e}", severity="error")
             raise
 
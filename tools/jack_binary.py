@@ -0,0 +1,332 @@
+import os
+import struct
+import sys
+import json
+import xml.etree.ElementTree as ET
+
+
+# ==================================================================================================
+# READER: Binary Program Files (.jkb)
+# Reads what the compiler's BinaryWriter writes (layout: Compiler/Serialization/BinaryFormat.h) and turns
+# it back into the XML tree and JSON documents the visualisers were written for.
+# ==================================================================================================
+FORMAT_VERSION = 1
+BYTE_ORDER_MARK = 0x01020304
+
+STRING_OFFSETS, STRING_BYTES, CLASSES, NODES, NAMES, SCOPES, SYMBOLS, REGISTRY_CLASSES, REGISTRY_METHODS = range(1, 10)
+
+# Record layouts, little-endian, field for field as in BinaryFormat.h
+CLASS_ENTRY = struct.Struct("<6I")
+NODE_RECORD = struct.Struct("<4B3I2iI3I")
+SCOPE_ENTRY = struct.Struct("<3I")
+SYMBOL_ENTRY = struct.Struct("<3IiI")
+REGISTRY_CLASS_ENTRY = struct.Struct("<4I")
+METHOD_ENTRY = struct.Struct("<6I")
+
+# ASTNodeType
+(CLASS, CLASS_VAR_DEC, SUBROUTINE_DEC, VAR_DEC, LET_STATEMENT, IF_STATEMENT, WHILE_STATEMENT, DO_STATEMENT,
+ RETURN_STATEMENT, INTEGER_LITERAL, STRING_LITERAL, KEYWORD_LITERAL, BINARY_OP, UNARY_OP, SUBROUTINE_CALL,
+ IDENTIFIER) = range(16)
+
+HAS_INDEX = 1
+HAS_EXPRESSION = 2
+CLASS_DECLARED = 1
+
+SYMBOL_KINDS = ["static", "field", "argument", "local", "none"]
+SUBROUTINE_TYPES = ["constructor", "function", "method"]
+KEYWORD_LITERALS = {17: "true", 18: "false", 19: "null", 20: "this"}
+PRIMITIVES = ("int", "char", "boolean")
+
+
+class Node:
+    __slots__ = ("type", "tag", "flags", "binding_kind", "offset", "name", "name2", "value",
+                 "binding_index", "binding_type", "end", "first_name", "name_count")
+
+    def __init__(self, fields):
+        (self.type, self.tag, self.flags, self.binding_kind, self.offset, self.name, self.name2, self.value,
+         self.binding_index, self.binding_type, self.end, self.first_name, self.name_count) = fields
+
+
+class Program:
+    """A .jkb file: the ASTs, symbol tables and registry of one program."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if len(data) < 16 or data[:4] != b"JKB\0":
+            raise ValueError(f"{path}: not a binary program file")
+        version, byte_order, section_count = struct.unpack_from("<3I", data, 4)
+        if byte_order != BYTE_ORDER_MARK:
+            raise ValueError(f"{path}: written on a machine of the other byte order")
+        if version != FORMAT_VERSION:
+            raise ValueError(f"{path}: format version {version}, expected {FORMAT_VERSION}")
+
+        sections = {}
+        for i in range(section_count):
+            kind, offset, size, count = struct.unpack_from("<4I", data, 16 + 16 * i)
+            if offset + size > len(data):
+                raise ValueError(f"{path}: section {kind} out of range")
+            sections[kind] = (data[offset:offset + size], count)
+
+        def records(kind, layout):
+            raw, count = sections[kind]
+            return [layout.unpack_from(raw, i * layout.size) for i in range(count)]
+
+        offsets_raw, string_count = sections[STRING_OFFSETS]
+        offsets = struct.unpack_from(f"<{string_count + 1}I", offsets_raw)
+        blob = sections[STRING_BYTES][0]
+        self.strings = [blob[offsets[i]:offsets[i + 1]].decode("utf-8", "replace") for i in range(string_count)]
+
+        names_raw, name_count = sections[NAMES]
+        self.names = list(struct.unpack_from(f"<{name_count}I", names_raw))
+        self.classes = records(CLASSES, CLASS_ENTRY)
+        self.nodes = [Node(fields) for fields in records(NODES, NODE_RECORD)]
+        self.scopes = records(SCOPES, SCOPE_ENTRY)
+        self.symbols = records(SYMBOLS, SYMBOL_ENTRY)
+        self.registry_classes = records(REGISTRY_CLASSES, REGISTRY_CLASS_ENTRY)
+        self.methods = records(REGISTRY_METHODS, METHOD_ENTRY)
+
+    def string(self, string_id):
+        return self.strings[string_id]
+
+    def class_name(self, index):
+        return self.string(self.classes[index][0])
+
+    def class_file(self, index):
+        return self.string(self.classes[index][1])
+
+    def children(self, index):
+        result = []
+        child = index + 1
+        while child < self.nodes[index].end:
+            result.append(child)
+            child = self.nodes[child].end
+        return result
+
+    def name_list(self, first, count):
+        return [self.string(n) for n in self.names[first:first + count]]
+
+    # ----------------------------------------------------------------------------------------------
+    # AST -> the XML tree Node::printXml writes
+    # ----------------------------------------------------------------------------------------------
+    def ast_xml(self, index):
+        """Returns the class's AST as the ElementTree Node::printXml would have written."""
+        return self._class(self.classes[index][2])
+
+    @staticmethod
+    def _leaf(parent, tag, text):
+        element = ET.SubElement(parent, tag)
+        element.text = f" {text} "
+        return element
+
+    def _type(self, parent, type_name, keywords=PRIMITIVES):
+        self._leaf(parent, "keyword" if type_name in keywords else "identifier", type_name)
+
+    def _names(self, parent, node):
+        names = self.name_list(node.first_name, node.name_count)
+        for i, name in enumerate(names):
+            self._leaf(parent, "identifier", name)
+            if i < len(names) - 1:
+                self._leaf(parent, "symbol", ",")
+        self._leaf(parent, "symbol", ";")
+
+    def _class(self, index):
+        node = self.nodes[index]
+        root = ET.Element("class")
+        self._leaf(root, "keyword", "class")
+        self._leaf(root, "identifier", self.string(node.name))
+        self._leaf(root, "symbol", "{")
+        for child in self.children(index):
+            if self.nodes[child].type == CLASS_VAR_DEC:
+                var = self.nodes[child]
+                element = ET.SubElement(root, "classVarDec")
+                self._leaf(element, "keyword", "static" if var.tag == 0 else "field")
+                self._type(element, self.string(var.name2))
+                self._names(element, var)
+            else:
+                self._subroutine(root, child)
+        self._leaf(root, "symbol", "}")
+        return root
+
+    def _subroutine(self, parent, index):
+        node = self.nodes[index]
+        element = ET.SubElement(parent, "subroutineDec")
+        self._leaf(element, "keyword", SUBROUTINE_TYPES[node.tag])
+        self._type(element, self.string(node.name2), PRIMITIVES + ("void",))
+        self._leaf(element, "identifier", self.string(node.name))
+        self._leaf(element, "symbol", "(")
+        parameters = ET.SubElement(element, "parameterList")
+        pairs = self.name_list(node.first_name, node.name_count)
+        for i in range(0, len(pairs), 2):
+            self._type(parameters, pairs[i])
+            self._leaf(parameters, "identifier", pairs[i + 1])
+            if i < len(pairs) - 2:
+                self._leaf(parameters, "symbol", ",")
+        self._leaf(element, "symbol", ")")
+        body = ET.SubElement(element, "subroutineBody")
+        self._leaf(body, "symbol", "{")
+        children = self.children(index)
+        for child in children[:node.value]:
+            var = self.nodes[child]
+            var_dec = ET.SubElement(body, "varDec")
+            self._leaf(var_dec, "keyword", "var")
+            self._type(var_dec, self.string(var.name2))
+            self._names(var_dec, var)
+        self._statements(body, children[node.value:])
+        self._leaf(body, "symbol", "}")
+
+    def _statements(self, parent, indices):
+        statements = ET.SubElement(parent, "statements")
+        for index in indices:
+            self._statement(statements, index)
+
+    def _expression(self, parent, index):
+        expression = ET.SubElement(parent, "expression")
+        self._term(expression, index)
+
+    def _block(self, parent, keyword, condition, body):
+        self._leaf(parent, "keyword", keyword)
+        self._leaf(parent, "symbol", "(")
+        self._expression(parent, condition)
+        self._leaf(parent, "symbol", ")")
+        self._leaf(parent, "symbol", "{")
+        self._statements(parent, body)
+        self._leaf(parent, "symbol", "}")
+
+    def _statement(self, parent, index):
+        node = self.nodes[index]
+        children = self.children(index)
+        if node.type == LET_STATEMENT:
+            element = ET.SubElement(parent, "letStatement")
+            self._leaf(element, "keyword", "let")
+            self._leaf(element, "identifier", self.string(node.name))
+            if node.flags & HAS_INDEX:
+                self._leaf(element, "symbol", "[")
+                self._expression(element, children[0])
+                self._leaf(element, "symbol", "]")
+            self._leaf(element, "symbol", "=")
+            self._expression(element, children[-1])
+            self._leaf(element, "symbol", ";")
+        elif node.type == IF_STATEMENT:
+            element = ET.SubElement(parent, "ifStatement")
+            self._block(element, "if", children[0], children[1:1 + node.value])
+            if len(children) > 1 + node.value:
+                self._leaf(element, "keyword", "else")
+                self._leaf(element, "symbol", "{")
+                self._statements(element, children[1 + node.value:])
+                self._leaf(element, "symbol", "}")
+        elif node.type == WHILE_STATEMENT:
+            element = ET.SubElement(parent, "whileStatement")
+            self._block(element, "while", children[0], children[1:])
+        elif node.type == DO_STATEMENT:
+            element = ET.SubElement(parent, "doStatement")
+            self._leaf(element, "keyword", "do")
+            self._call(element, children[0])
+            self._leaf(element, "symbol", ";")
+        elif node.type == RETURN_STATEMENT:
+            element = ET.SubElement(parent, "returnStatement")
+            self._leaf(element, "keyword", "return")
+            if node.flags & HAS_EXPRESSION:
+                self._expression(element, children[0])
+            self._leaf(element, "symbol", ";")
+
+    def _call(self, parent, index):
+        node = self.nodes[index]
+        if node.name:
+            self._leaf(parent, "identifier", self.string(node.name))
+            self._leaf(parent, "symbol", ".")
+        self._leaf(parent, "identifier", self.string(node.name2))
+        self._leaf(parent, "symbol", "(")
+        arguments = ET.SubElement(parent, "expressionList")
+        children = self.children(index)
+        for i, child in enumerate(children):
+            self._expression(arguments, child)
+            if i < len(children) - 1:
+                self._leaf(arguments, "symbol", ",")
+        self._leaf(parent, "symbol", ")")
+
+    def _term(self, parent, index):
+        # A binary operation writes its operands and operator straight into the enclosing element.
+        node = self.nodes[index]
+        children = self.children(index)
+        if node.type == BINARY_OP:
+            self._term(parent, children[0])
+            self._leaf(parent, "symbol", chr(node.tag))
+            self._term(parent, children[1])
+            return
+        term = ET.SubElement(parent, "term")
+        if node.type == INTEGER_LITERAL:
+            self._leaf(term, "integerConstant", node.value)
+        elif node.type == STRING_LITERAL:
+            self._leaf(term, "stringConstant", self.string(node.name))
+        elif node.type == KEYWORD_LITERAL:
+            self._leaf(term, "keyword", KEYWORD_LITERALS.get(node.tag, "no"))
+        elif node.type == UNARY_OP:
+            self._leaf(term, "symbol", chr(node.tag))
+            self._term(term, children[0])
+        elif node.type == SUBROUTINE_CALL:
+            self._call(term, index)
+        elif node.type == IDENTIFIER:
+            self._leaf(term, "identifier", self.string(node.name))
+            if node.flags & HAS_INDEX:
+                self._leaf(term, "symbol", "[")
+                self._expression(term, children[0])
+                self._leaf(term, "symbol", "]")
+
+    # ----------------------------------------------------------------------------------------------
+    # Symbol tables and registry -> the JSON SymbolTable::dumpToJSON and GlobalRegistry::dumpToJSON write
+    # ----------------------------------------------------------------------------------------------
+    def _scope_symbols(self, scope):
+        _, first, count = scope
+        return [{"name": self.string(name), "type": self.string(type_id), "kind": SYMBOL_KINDS[kind], "index": index}
+                for name, type_id, kind, index, _ in self.symbols[first:first + count]]
+
+    def has_symbols(self, index):
+        return self.classes[index][5] > 0
+
+    def symbols_json(self, index):
+        """Returns the class's symbol table as SymbolTable::dumpToJSON writes it (empty if it was not kept)."""
+        _, _, _, _, first_scope, scope_count = self.classes[index]
+        scopes = self.scopes[first_scope:first_scope + scope_count]
+        return {
+            "className": self.class_name(index),
+            "classSymbols": self._scope_symbols(scopes[0]) if scopes else [],
+            "subroutines": [{"name": self.string(scope[0]), "symbols": self._scope_symbols(scope)}
+                            for scope in scopes[1:]],
+        }
+
+    def registry_json(self):
+        """Returns the registry as GlobalRegistry::dumpToJSON writes it."""
+        registry = []
+        for class_id, _, first_method, method_count in self.registry_classes:
+            for name, return_type, is_static, _, first_param, param_count in self.methods[first_method:first_method + method_count]:
+                registry.append({
+                    "class": self.string(class_id),
+                    "method": self.string(name),
+                    "type": "function" if is_static else "method",
+                    "return": self.string(return_type),
+                    "params": ", ".join(self.name_list(first_param, param_count)),
+                })
+        return {"registry": registry}
+
+
+# ==================================================================================================
+# MAIN: Conversion to the XML / JSON files
+# ==================================================================================================
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print("Usage: python3 jack_binary.py <program.jkb> <output_folder>", file=sys.stderr)
+        print("Writes <Class>.xml and <Class>.json for every class, and registry.json.", file=sys.stderr)
+        sys.exit(1)
+
+    program = Program(sys.argv[1])
+    out_dir = sys.argv[2]
+    os.makedirs(out_dir, exist_ok=True)
+    for i in range(len(program.classes)):
+        name = program.class_name(i)
+        ET.ElementTree(program.ast_xml(i)).write(os.path.join(out_dir, name + ".xml"), encoding="unicode")
+        if program.has_symbols(i):
+            with open(os.path.join(out_dir, name + ".json"), "w") as f:
+                json.dump(program.symbols_json(i), f, indent=2)
+    with open(os.path.join(out_dir, "registry.json"), "w") as f:
+        json.dump(program.registry_json(), f, indent=2)
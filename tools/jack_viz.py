@@ -3,6 +3,7 @@ import os
 import xml.etree.ElementTree as ET
 import json
 import webview
+from jack_binary import Program
 
 
 # 1. PARSER
@@ -171,7 +172,7 @@ if __name__ == "__main__":
     # Validation: Arguments
     if len(sys.argv) < 2:
         print("Error: No XML files provided.", file=sys.stderr)
-        print("Usage: python jack_viz.py <file1.xml> <file2.xml> ...", file=sys.stderr)
+        print("Usage: python jack_viz.py <file1.xml> <file2.xml> ... | <program.jkb>", file=sys.stderr)
         sys.exit(1)
 
     xml_files = sys.argv[1:]
@@ -186,6 +187,16 @@ if __name__ == "__main__":
             continue
 
         try:
+            if xml_path.endswith(".jkb"):
+                # A binary program file holds every class's AST
+                program = Program(xml_path)
+                for i in range(len(program.classes)):
+                    files_payload.append({
+                        "filename": program.class_name(i) + ".jack",
+                        "tree": parse_node(program.ast_xml(i))
+                    })
+                continue
+
             tree = ET.parse(xml_path)
 
             # Extract clean name: "Main_18293.xml" -> "Main.jack"
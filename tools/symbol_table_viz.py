@@ -7,6 +7,7 @@ from textual.app import App, ComposeResult
 from textual.widgets import Header, Footer, DataTable, Tree, Label
 from textual.containers import Container, Vertical, Horizontal
 from textual.binding import Binding
+from jack_binary import Program
 
 # ==================================================================================================
 # WIDGET: Symbol Table Browser
@@ -42,7 +43,7 @@ class SymbolTableBrowser(Container):
         self.load_files()
 
     def load_files(self):
-        """Loads JSON files and populates the navigation tree."""
+        """Loads JSON files (or binary program files) and populates the navigation tree."""
         # Removed broad try/except to allow errors to surface
         tree = self.query_one("#file_tree", Tree)
         tree.root.expand()
@@ -56,34 +57,16 @@ class SymbolTableBrowser(Container):
                 continue
             
             try:
-                with open(path, 'r') as f:
-                    data = json.load(f)
-
-                # Use class name as key, fallback to filename
-                name = data.get("className", os.path.basename(path))
-                self.data_cache[name] = data
-
-                # Add File Node (Class)
-                file_node = tree.root.add(f"📄 {name}", expand=True)
-                file_node.data = {"type": "file", "class": name}
-
-                # Add Scopes
-                # 1. Class Scope (Static/Field)
-                c_node = file_node.add("🔒 Class Scope")
-                c_node.data = {"type": "scope", "class": name, "scope": "class"}
-
-                # 2. Subroutines (Local/Argument)
-                subroutines = data.get("subroutines", [])
-                if isinstance(subroutines, list):
-                    for sub in subroutines:
-                        sub_name = sub.get('name', 'unknown')
-                        s_node = file_node.add(f"ƒ {sub_name}")
-                        s_node.data = {"type": "scope", "class": name, "scope": sub_name}
+                if path.endswith(".jkb"):
+                    # A binary program file holds every class's symbol table
+                    program = Program(path)
+                    documents = [program.symbols_json(i) for i in range(len(program.classes)) if program.has_symbols(i)]
                 else:
-                    self.notify(f"Invalid 'subroutines' format in {name}", severity="warning")
-                    # We don't raise here to allow partial loading of other files, 
-                    # but we notify. If strictness is required, we could raise.
+                    with open(path, 'r') as f:
+                        documents = [json.load(f)]
 
+                for data in documents:
+                    self.add_class(data, path)
             except json.JSONDecodeError as e:
                 self.notify(f"Invalid JSON in {path}: {e}", severity="error")
                 raise # Re-raise to ensure visibility
@@ -91,6 +74,35 @@ class SymbolTableBrowser(Container):
                 self.notify(f"Error loading {path}: {e}", severity="error")
                 raise # Re-raise to ensure visibility
 
+    def add_class(self, data, path):
+        """Adds one class's symbol table to the cache and the navigation tree."""
+        tree = self.query_one("#file_tree", Tree)
+
+        # Use class name as key, fallback to filename
+        name = data.get("className", os.path.basename(path))
+        self.data_cache[name] = data
+
+        # Add File Node (Class)
+        file_node = tree.root.add(f"📄 {name}", expand=True)
+        file_node.data = {"type": "file", "class": name}
+
+        # Add Scopes
+        # 1. Class Scope (Static/Field)
+        c_node = file_node.add("🔒 Class Scope")
+        c_node.data = {"type": "scope", "class": name, "scope": "class"}
+
+        # 2. Subroutines (Local/Argument)
+        subroutines = data.get("subroutines", [])
+        if isinstance(subroutines, list):
+            for sub in subroutines:
+                sub_name = sub.get('name', 'unknown')
+                s_node = file_node.add(f"ƒ {sub_name}")
+                s_node.data = {"type": "scope", "class": name, "scope": sub_name}
+        else:
+            self.notify(f"Invalid 'subroutines' format in {name}", severity="warning")
+            # We don't raise here to allow partial loading of other files, 
+            # but we notify. If strictness is required, we could raise.
+
     def on_tree_node_selected(self, event: Tree.NodeSelected):
         """Handles tree node selection to update the symbol table."""
         # Removed broad try/except to allow errors to surface
@@ -79,18 +79,25 @@ def cleanup_files(paths):
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description="Unified Dashboard for Jack Compiler Visualization")
-    parser.add_argument("--registry", required=True, help="Path to the global registry JSON file")
+    parser.add_argument("--program", help="Path to a binary program file (.jkb) holding the registry and symbol tables")
+    parser.add_argument("--registry", help="Path to the global registry JSON file")
     parser.add_argument("--symbols", nargs="+", default=[], help="List of paths to symbol table JSON files")
     
     # Removed try/except around parse_args as argparse handles errors well
     args = parser.parse_args()
+    if not args.program and not args.registry:
+        parser.error("one of --program or --registry is required")
 
     # Register cleanup for all temp files
-    files_to_clean = [args.registry] + args.symbols
+    files_to_clean = [args.program, args.registry] + args.symbols
     atexit.register(cleanup_files, files_to_clean)
 
+    # The program file stands in for whichever JSON files were not given
+    registry_path = args.registry or args.program
+    symbol_paths = args.symbols or ([args.program] if args.program else [])
+
     try:
-        app = UnifiedDashboard(args.registry, args.symbols)
+        app = UnifiedDashboard(registry_path, symbol_paths)
         app.run()
     except KeyboardInterrupt:
         print("\nInterrupted by user")